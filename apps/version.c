@@ -18,7 +18,8 @@
 
 typedef enum OPTION_choice {
     OPT_COMMON,
-    OPT_B, OPT_D, OPT_E, OPT_M, OPT_F, OPT_O, OPT_P, OPT_V, OPT_A, OPT_R, OPT_C
+    OPT_B, OPT_D, OPT_E, OPT_M, OPT_F, OPT_O, OPT_P, OPT_V, OPT_A, OPT_R, OPT_C,
+    OPT_I
 #if defined(_WIN32)
     ,OPT_W
 #endif
@@ -40,6 +41,7 @@ const OPTIONS version_options[] = {
     {"r", OPT_R, '-', "Show random seeding options"},
     {"v", OPT_V, '-', "Show library version"},
     {"c", OPT_C, '-', "Show CPU settings info"},
+    {"i", OPT_I, '-', "Show library initialisation timings"},
 #if defined(_WIN32)
     {"w", OPT_W, '-', "Show Windows install context"},
 #endif
@@ -50,7 +52,7 @@ int version_main(int argc, char **argv)
 {
     int ret = 1, dirty = 0, seed = 0;
     int cflags = 0, version = 0, date = 0, options = 0, platform = 0, dir = 0;
-    int engdir = 0, moddir = 0, cpuinfo = 0;
+    int engdir = 0, moddir = 0, cpuinfo = 0, inittimes = 0;
 #if defined(_WIN32)
     int windows = 0;
 #endif
@@ -99,6 +101,9 @@ opthelp:
         case OPT_C:
             dirty = cpuinfo = 1;
             break;
+        case OPT_I:
+            dirty = inittimes = 1;
+            break;
 #if defined(_WIN32)
         case OPT_W:
             dirty = windows = 1;
@@ -106,7 +111,7 @@ opthelp:
 #endif
         case OPT_A:
             seed = options = cflags = version = date = platform
-                = dir = engdir = moddir = cpuinfo
+                = dir = engdir = moddir = cpuinfo = inittimes
                 = 1;
             break;
         }
@@ -149,6 +154,20 @@ opthelp:
     if (windows)
         printf("%s\n", OpenSSL_version(OPENSSL_WINCTX));
 #endif
+    if (inittimes) {
+        const char *name;
+        uint64_t usec;
+        int mallocs;
+        size_t i;
+
+        printf("Initialisation phases:\n");
+        for (i = 0; OPENSSL_get_init_phase(i, &name, &usec, &mallocs); i++) {
+            printf("    %-32s %8llu us", name, (unsigned long long)usec);
+            if (mallocs >= 0)
+                printf(" %8d allocations", mallocs);
+            printf("\n");
+        }
+    }
     ret = 0;
  end:
     return ret;
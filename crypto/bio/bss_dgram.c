@@ -137,6 +137,36 @@
 #  endif
 # endif
 
+# if M_METHOD == M_METHOD_RECVMMSG && defined(OPENSSL_SYS_LINUX)
+#  include <netinet/udp.h>
+# endif
+# if M_METHOD == M_METHOD_RECVMMSG && defined(IP_TOS) && defined(IP_RECVTOS)
+/*
+ * The ECN codepoint of a datagram is carried in the low bits of the IPv4 TOS
+ * or IPv6 traffic class, which is set and received using a control message.
+ */
+#  define SUPPORT_ECN
+#  define BIO_ECN_CMSG_ALLOC_LEN    BIO_CMSG_SPACE(sizeof(int))
+# elif M_METHOD == M_METHOD_RECVMMSG
+#  define BIO_ECN_CMSG_ALLOC_LEN    0
+# endif
+# if M_METHOD == M_METHOD_RECVMMSG && defined(UDP_SEGMENT)
+/*
+ * Runs of equal-size datagrams are handed to the kernel as a single UDP GSO
+ * send, which is limited in the number of segments and the total size. The
+ * control buffers have room for the segment size, which is also reported by
+ * the kernel for a coalesced UDP GRO receive.
+ */
+#  define BIO_GSO_MAX_SEGS          64
+#  define BIO_GSO_MAX_BYTES         65000
+#  define BIO_SEG_CMSG_ALLOC_LEN    \
+        (BIO_CMSG_ALLOC_LEN + BIO_ECN_CMSG_ALLOC_LEN    \
+         + BIO_CMSG_SPACE(sizeof(int)))
+# elif M_METHOD == M_METHOD_RECVMMSG
+#  define BIO_SEG_CMSG_ALLOC_LEN    \
+        (BIO_CMSG_ALLOC_LEN + BIO_ECN_CMSG_ALLOC_LEN)
+# endif
+
 # define BIO_MSG_N(array, stride, n) (*(BIO_MSG *)((char *)(array) + (n)*(stride)))
 
 static int dgram_write(BIO *h, const char *buf, int num);
@@ -216,6 +246,9 @@ typedef struct bio_dgram_data_st {
     OSSL_TIME socket_timeout;
     unsigned int peekmode;
     char local_addr_enabled;
+    char gso_disabled;
+    char gro_enabled;
+    char ecn_enabled;
 } bio_dgram_data;
 
 # ifndef OPENSSL_NO_SCTP
@@ -544,6 +577,39 @@ static int enable_local_addr(BIO *b, int enable) {
 }
 # endif
 
+/* Enables reception of the ECN codepoint of received datagrams. */
+# if defined(SUPPORT_ECN)
+static int enable_ecn(BIO *b, int enable) {
+    int af = dgram_get_sock_family(b);
+
+    if (af == AF_INET) {
+        if (setsockopt(b->num, IPPROTO_IP, IP_RECVTOS,
+                       (void *)&enable, sizeof(enable)) < 0)
+            return 0;
+
+        return 1;
+    }
+
+#  if OPENSSL_USE_IPV6 && defined(IPV6_TCLASS) && defined(IPV6_RECVTCLASS)
+    if (af == AF_INET6) {
+        if (setsockopt(b->num, IPPROTO_IPV6, IPV6_RECVTCLASS,
+                       (void *)&enable, sizeof(enable)) < 0)
+            return 0;
+
+        /*
+         * Also covers IPv4-mapped addresses on a dual-stack socket, where this
+         * is supported.
+         */
+        (void)setsockopt(b->num, IPPROTO_IP, IP_RECVTOS,
+                         (void *)&enable, sizeof(enable));
+        return 1;
+    }
+#  endif
+
+    return 0;
+}
+# endif
+
 static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
 {
     long ret = 1;
@@ -999,6 +1065,40 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
         *(int *)ptr = data->local_addr_enabled;
         break;
 
+    case BIO_CTRL_DGRAM_SET_GRO:
+# if M_METHOD == M_METHOD_RECVMMSG && defined(UDP_GRO)
+        num = num > 0;
+        if (num != data->gro_enabled) {
+            sockopt_val = (int)num;
+            if (setsockopt(b->num, SOL_UDP, UDP_GRO,
+                           (void *)&sockopt_val, sizeof(sockopt_val)) < 0) {
+                ret = 0;
+                break;
+            }
+
+            data->gro_enabled = (char)num;
+        }
+# else
+        ret = 0;
+# endif
+        break;
+
+    case BIO_CTRL_DGRAM_SET_ECN:
+# if defined(SUPPORT_ECN)
+        num = num > 0;
+        if (num != data->ecn_enabled) {
+            if (enable_ecn(b, (int)num) < 1) {
+                ret = 0;
+                break;
+            }
+
+            data->ecn_enabled = (char)num;
+        }
+# else
+        ret = 0;
+# endif
+        break;
+
     case BIO_CTRL_DGRAM_GET_EFFECTIVE_CAPS:
         ret = (long)(BIO_DGRAM_CAP_HANDLES_DST_ADDR
                      | BIO_DGRAM_CAP_HANDLES_SRC_ADDR
@@ -1300,6 +1400,69 @@ static int pack_local(BIO *b, MSGHDR_TYPE *mh, const BIO_ADDR *local) {
 }
 # endif
 
+# if defined(SUPPORT_ECN)
+/*
+ * Appends a control message setting the ECN codepoint of a datagram to be sent,
+ * after any control message already packed by pack_local().
+ */
+static void pack_ecn(BIO *b, struct msghdr *mh, unsigned char *control,
+                     int ecn)
+{
+    struct cmsghdr *cmsg;
+
+    if (mh->msg_control == NULL) {
+        mh->msg_control    = control;
+        mh->msg_controllen = 0;
+    }
+
+    cmsg = (struct cmsghdr *)((unsigned char *)mh->msg_control
+                              + mh->msg_controllen);
+    cmsg->cmsg_len   = BIO_CMSG_LEN(sizeof(ecn));
+#  if OPENSSL_USE_IPV6 && defined(IPV6_TCLASS)
+    if (dgram_get_sock_family(b) == AF_INET6) {
+        cmsg->cmsg_level = IPPROTO_IPV6;
+        cmsg->cmsg_type  = IPV6_TCLASS;
+    } else
+#  endif
+    {
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type  = IP_TOS;
+    }
+
+    memcpy(BIO_CMSG_DATA(cmsg), &ecn, sizeof(ecn));
+    mh->msg_controllen += BIO_CMSG_SPACE(sizeof(ecn));
+}
+
+/* Returns the message flags holding the ECN codepoint of a received datagram. */
+static uint64_t extract_ecn(struct msghdr *mh)
+{
+    struct cmsghdr *cmsg;
+    int tos;
+
+    for (cmsg = BIO_CMSG_FIRSTHDR(mh); cmsg != NULL;
+         cmsg = BIO_CMSG_NXTHDR(mh, cmsg)) {
+        if (!(cmsg->cmsg_level == IPPROTO_IP
+              && (cmsg->cmsg_type == IP_TOS || cmsg->cmsg_type == IP_RECVTOS))
+#  if OPENSSL_USE_IPV6 && defined(IPV6_TCLASS)
+            && !(cmsg->cmsg_level == IPPROTO_IPV6
+                 && cmsg->cmsg_type == IPV6_TCLASS)
+#  endif
+            )
+            continue;
+
+        /* Linux reports the IPv4 TOS as a single byte, but the class as int */
+        if (cmsg->cmsg_len >= BIO_CMSG_LEN(sizeof(tos)))
+            memcpy(&tos, BIO_CMSG_DATA(cmsg), sizeof(tos));
+        else
+            tos = *(unsigned char *)BIO_CMSG_DATA(cmsg);
+
+        return (uint64_t)tos & BIO_MSG_ECN_MASK;
+    }
+
+    return 0;
+}
+# endif
+
 /*
  * Converts flags passed to BIO_sendmmsg or BIO_recvmmsg to syscall flags. You
  * should mask out any system flags returned by this function you cannot support
@@ -1311,6 +1474,98 @@ static int translate_flags(uint64_t flags) {
 }
 # endif
 
+# if M_METHOD == M_METHOD_RECVMMSG && defined(UDP_SEGMENT)
+static int gso_same_dest(struct msghdr *a, struct msghdr *b)
+{
+    struct cmsghdr *ca, *cb;
+
+    if (a->msg_namelen != b->msg_namelen
+        || (a->msg_namelen != 0
+            && memcmp(a->msg_name, b->msg_name, a->msg_namelen) != 0)
+        || a->msg_controllen != b->msg_controllen)
+        return 0;
+
+    if (a->msg_controllen == 0)
+        return 1;
+
+    /*
+     * Only compare each control message up to its length, as the padding
+     * following it is not initialised.
+     */
+    for (ca = BIO_CMSG_FIRSTHDR(a), cb = BIO_CMSG_FIRSTHDR(b);
+         ca != NULL && cb != NULL;
+         ca = BIO_CMSG_NXTHDR(a, ca), cb = BIO_CMSG_NXTHDR(b, cb))
+        if (ca->cmsg_len != cb->cmsg_len
+            || memcmp(ca, cb, ca->cmsg_len) != 0)
+            return 0;
+
+    return ca == NULL && cb == NULL;
+}
+
+/*
+ * Coalesces runs of consecutive datagrams for the same peer and local address
+ * into single UDP GSO sends. All datagrams in a run are of the same size,
+ * except the last, which may be shorter. The datagrams are not copied: the
+ * iovecs of a run are passed together, and the kernel splits the run back into
+ * the original datagrams. On return, segs[i] is the number of datagrams sent
+ * by mh[i]. Returns the number of entries of mh to send.
+ */
+static size_t pack_gso(struct mmsghdr *mh, struct iovec *iov,
+                       unsigned char (*control)[BIO_SEG_CMSG_ALLOC_LEN],
+                       size_t *segs, size_t num_msg)
+{
+    size_t i, j, n, seglen, total;
+    uint16_t gso_size;
+    struct cmsghdr *cmsg;
+
+    for (i = 0, n = 0; i < num_msg; i = j, ++n) {
+        seglen = iov[i].iov_len;
+        total = seglen;
+        for (j = i + 1; seglen > 0 && j < num_msg; ++j) {
+            if (j - i == BIO_GSO_MAX_SEGS
+                || iov[j].iov_len > seglen
+                || total + iov[j].iov_len > BIO_GSO_MAX_BYTES
+                || !gso_same_dest(&mh[i].msg_hdr, &mh[j].msg_hdr))
+                break;
+
+            total += iov[j].iov_len;
+            if (iov[j].iov_len < seglen) {
+                /* A short datagram ends the run */
+                ++j;
+                break;
+            }
+        }
+
+        mh[n] = mh[i];
+        segs[n] = j - i;
+        if (segs[n] == 1)
+            continue;
+
+        mh[n].msg_hdr.msg_iovlen  = segs[n];
+        mh[n].msg_hdr.msg_control = control[i];
+        cmsg = (struct cmsghdr *)(control[i] + mh[n].msg_hdr.msg_controllen);
+        cmsg->cmsg_len   = BIO_CMSG_LEN(sizeof(gso_size));
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type  = UDP_SEGMENT;
+        gso_size = (uint16_t)seglen;
+        memcpy(BIO_CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+        mh[n].msg_hdr.msg_controllen += BIO_CMSG_SPACE(sizeof(gso_size));
+    }
+
+    return n;
+}
+
+/*
+ * Errors which indicate that the kernel, the device or the socket cannot do
+ * UDP GSO, rather than that the datagrams themselves could not be sent.
+ */
+static int gso_unsupported(int err)
+{
+    return err == EIO || err == EINVAL || err == ENOPROTOOPT
+        || err == EOPNOTSUPP;
+}
+# endif
+
 static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
                           size_t num_msg, uint64_t flags, size_t *num_processed)
 {
@@ -1321,10 +1576,11 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
 #  define BIO_MAX_MSGS_PER_CALL   64
     int sysflags;
     bio_dgram_data *data = (bio_dgram_data *)b->ptr;
-    size_t i;
+    size_t i, j, k, n;
     struct mmsghdr mh[BIO_MAX_MSGS_PER_CALL];
     struct iovec iov[BIO_MAX_MSGS_PER_CALL];
-    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_CMSG_ALLOC_LEN];
+    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_SEG_CMSG_ALLOC_LEN];
+    size_t segs[BIO_MAX_MSGS_PER_CALL];
     int have_local_enabled = data->local_addr_enabled;
 # elif M_METHOD == M_METHOD_RECVMSG
     int sysflags;
@@ -1369,6 +1625,9 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
     if (num_msg > BIO_MAX_MSGS_PER_CALL)
         num_msg = BIO_MAX_MSGS_PER_CALL;
 
+#  if defined(UDP_SEGMENT)
+ retry:
+#  endif
     for (i = 0; i < num_msg; ++i) {
         translate_msg(b, &mh[i].msg_hdr, &iov[i],
                       control[i], &BIO_MSG_N(msg, stride, i));
@@ -1388,22 +1647,57 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
                 return 0;
             }
         }
+
+#  if defined(SUPPORT_ECN)
+        if (data->ecn_enabled
+            && BIO_MSG_ECN(BIO_MSG_N(msg, stride, i).flags) != 0)
+            pack_ecn(b, &mh[i].msg_hdr, control[i],
+                     (int)BIO_MSG_ECN(BIO_MSG_N(msg, stride, i).flags));
+#  endif
     }
 
+    for (i = 0; i < num_msg; ++i)
+        segs[i] = 1;
+    n = num_msg;
+
+#  if defined(UDP_SEGMENT)
+    /*
+     * GSO cannot be used on other socket types, such as AF_UNIX, which would
+     * silently ignore the UDP_SEGMENT control message.
+     */
+    if (!data->gso_disabled && num_msg > 1
+        && (dgram_get_sock_family(b) == AF_INET
+#   if OPENSSL_USE_IPV6
+            || dgram_get_sock_family(b) == AF_INET6
+#   endif
+            ))
+        n = pack_gso(mh, iov, control, segs, num_msg);
+#  endif
+
     /* Do the batch */
-    ret = sendmmsg(b->num, mh, num_msg, sysflags);
+    ret = sendmmsg(b->num, mh, n, sysflags);
     if (ret < 0) {
+#  if defined(UDP_SEGMENT)
+        if (segs[0] > 1 && gso_unsupported(get_last_socket_error())) {
+            /* Do not try again, and resend the batch without GSO */
+            data->gso_disabled = 1;
+            goto retry;
+        }
+#  endif
         ERR_raise(ERR_LIB_SYS, get_last_socket_error());
         *num_processed = 0;
         return 0;
     }
 
-    for (i = 0; i < (size_t)ret; ++i) {
-        BIO_MSG_N(msg, stride, i).data_len = mh[i].msg_len;
-        BIO_MSG_N(msg, stride, i).flags    = 0;
+    for (k = 0, i = 0; k < (size_t)ret; ++k) {
+        for (j = 0; j < segs[k]; ++j, ++i) {
+            BIO_MSG_N(msg, stride, i).data_len
+                = segs[k] == 1 ? mh[k].msg_len : iov[i].iov_len;
+            BIO_MSG_N(msg, stride, i).flags    = 0;
+        }
     }
 
-    *num_processed = (size_t)ret;
+    *num_processed = i;
     return 1;
 
 # elif M_METHOD == M_METHOD_RECVMSG
@@ -1512,6 +1806,30 @@ static int dgram_sendmmsg(BIO *b, BIO_MSG *msg, size_t stride,
 # endif
 }
 
+# if M_METHOD == M_METHOD_RECVMMSG && defined(UDP_GRO)
+/*
+ * Returns the message flags for a received message of len bytes, which
+ * report the segment size if the kernel coalesced several datagrams into it.
+ */
+static uint64_t extract_gro(struct msghdr *mh, size_t len)
+{
+    struct cmsghdr *cmsg;
+    int seg_len;
+
+    for (cmsg = BIO_CMSG_FIRSTHDR(mh); cmsg != NULL;
+         cmsg = BIO_CMSG_NXTHDR(mh, cmsg)) {
+        if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO)
+            continue;
+
+        memcpy(&seg_len, BIO_CMSG_DATA(cmsg), sizeof(seg_len));
+        if (seg_len > 0 && (size_t)seg_len < len)
+            return (uint64_t)seg_len << BIO_MSG_GRO_SEG_SHIFT;
+    }
+
+    return 0;
+}
+# endif
+
 static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
                           size_t stride, size_t num_msg,
                           uint64_t flags, size_t *num_processed)
@@ -1525,7 +1843,7 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
     size_t i;
     struct mmsghdr mh[BIO_MAX_MSGS_PER_CALL];
     struct iovec iov[BIO_MAX_MSGS_PER_CALL];
-    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_CMSG_ALLOC_LEN];
+    unsigned char control[BIO_MAX_MSGS_PER_CALL][BIO_SEG_CMSG_ALLOC_LEN];
     int have_local_enabled = data->local_addr_enabled;
 # elif M_METHOD == M_METHOD_RECVMSG
     int sysflags;
@@ -1581,6 +1899,15 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
             *num_processed = 0;
             return 0;
         }
+
+        /*
+         * Make room for the segment size of a coalesced receive and the ECN
+         * codepoint.
+         */
+        if (data->gro_enabled || data->ecn_enabled) {
+            mh[i].msg_hdr.msg_control    = control[i];
+            mh[i].msg_hdr.msg_controllen = sizeof(control[i]);
+        }
     }
 
     /* Do the batch */
@@ -1594,6 +1921,15 @@ static int dgram_recvmmsg(BIO *b, BIO_MSG *msg,
     for (i = 0; i < (size_t)ret; ++i) {
         BIO_MSG_N(msg, stride, i).data_len = mh[i].msg_len;
         BIO_MSG_N(msg, stride, i).flags    = 0;
+#  if defined(UDP_GRO)
+        if (data->gro_enabled)
+            BIO_MSG_N(msg, stride, i).flags
+                = extract_gro(&mh[i].msg_hdr, mh[i].msg_len);
+#  endif
+#  if defined(SUPPORT_ECN)
+        if (data->ecn_enabled)
+            BIO_MSG_N(msg, stride, i).flags |= extract_ecn(&mh[i].msg_hdr);
+#  endif
         /*
          * *(msg->peer) will have been filled in by recvmmsg;
          * for msg->local we parse the control data returned
@@ -11,7 +11,9 @@
 #include "internal/tsan_assist.h"
 #include "internal/hashtable.h"
 #include "internal/sizes.h"
+#include "internal/thread_once.h"
 #include "crypto/context.h"
+#include "crypto/cryptlib.h"
 
 #define NAMEMAP_HT_BUCKETS 2048
 
@@ -378,7 +380,10 @@ int ossl_namemap_add_names(OSSL_NAMEMAP *namemap, int number,
 #ifndef FIPS_MODULE
 #include <openssl/evp.h>
 
-/* Creates an initial namemap with names found in the legacy method db */
+/*
+ * Creates an initial namemap with names found in the legacy method db.
+ * These are called with the namemap write lock held.
+ */
 static void get_legacy_evp_names(int base_nid, int nid, const char *pem_name,
                                  void *arg)
 {
@@ -386,22 +391,22 @@ static void get_legacy_evp_names(int base_nid, int nid, const char *pem_name,
     ASN1_OBJECT *obj;
 
     if (base_nid != NID_undef) {
-        num = ossl_namemap_add_name(arg, num, OBJ_nid2sn(base_nid));
-        num = ossl_namemap_add_name(arg, num, OBJ_nid2ln(base_nid));
+        num = namemap_add_name(arg, num, OBJ_nid2sn(base_nid));
+        num = namemap_add_name(arg, num, OBJ_nid2ln(base_nid));
     }
 
     if (nid != NID_undef) {
-        num = ossl_namemap_add_name(arg, num, OBJ_nid2sn(nid));
-        num = ossl_namemap_add_name(arg, num, OBJ_nid2ln(nid));
+        num = namemap_add_name(arg, num, OBJ_nid2sn(nid));
+        num = namemap_add_name(arg, num, OBJ_nid2ln(nid));
         if ((obj = OBJ_nid2obj(nid)) != NULL) {
             char txtoid[OSSL_MAX_NAME_SIZE];
 
             if (OBJ_obj2txt(txtoid, sizeof(txtoid), obj, 1) > 0)
-                num = ossl_namemap_add_name(arg, num, txtoid);
+                num = namemap_add_name(arg, num, txtoid);
         }
     }
     if (pem_name != NULL)
-        num = ossl_namemap_add_name(arg, num, pem_name);
+        num = namemap_add_name(arg, num, pem_name);
 }
 
 static void get_legacy_cipher_names(const OBJ_NAME *on, void *arg)
@@ -458,6 +463,137 @@ static void get_legacy_pkey_meth_names(const EVP_PKEY_ASN1_METHOD *ameth,
         }
     }
 }
+
+/*
+ * The legacy names are the same for every library context, but collecting
+ * them involves many OBJ lookups and OID to text conversions.  They are
+ * therefore collected once into a snapshot, which is then copied into the
+ * namemap of each new library context.  Should the legacy databases have
+ * changed size since, the names are collected again and the snapshot is
+ * replaced.
+ */
+static CRYPTO_ONCE legacy_snapshot_init = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_RWLOCK *legacy_snapshot_lock = NULL;
+static STACK_OF(NAMES) *legacy_snapshot = NULL;
+static size_t legacy_snapshot_dbsize = 0;
+
+DEFINE_RUN_ONCE_STATIC(do_legacy_snapshot_init)
+{
+    legacy_snapshot_lock = CRYPTO_THREAD_lock_new();
+    return legacy_snapshot_lock != NULL;
+}
+
+static void count_legacy_names(const OBJ_NAME *on, void *arg)
+{
+    (*(size_t *)arg)++;
+}
+
+static size_t legacy_db_size(void)
+{
+    size_t n = (size_t)EVP_PKEY_asn1_get_count();
+
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_CIPHER_METH, count_legacy_names, &n);
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_MD_METH, count_legacy_names, &n);
+    return n;
+}
+
+static char *name_string_dup(const char *name)
+{
+    return OPENSSL_strdup(name);
+}
+
+static NAMES *names_dup(const NAMES *n)
+{
+    return sk_OPENSSL_STRING_deep_copy(n, name_string_dup, name_string_free);
+}
+
+/* This function is not thread safe, the namemap must be locked */
+static int namemap_copy_snapshot(OSSL_NAMEMAP *namemap,
+                                 const STACK_OF(NAMES) *snapshot)
+{
+    HT_VALUE val = { 0 };
+    NAMENUM_KEY key;
+    NAMES *names;
+    int i, j, number;
+
+    for (i = 0; i < sk_NAMES_num(snapshot); i++) {
+        if ((names = names_dup(sk_NAMES_value(snapshot, i))) == NULL)
+            return 0;
+        if (!sk_NAMES_push(namemap->numnames, names)) {
+            names_free(names);
+            return 0;
+        }
+        number = sk_NAMES_num(namemap->numnames);
+        for (j = 0; j < sk_OPENSSL_STRING_num(names); j++) {
+            HT_INIT_KEY(&key);
+            HT_SET_KEY_STRING_CASE(&key, name,
+                                   sk_OPENSSL_STRING_value(names, j));
+            val.value = (void *)(intptr_t)number;
+            if (ossl_ht_insert(namemap->namenum_ht, TO_HT_KEY(&key), &val,
+                               NULL) < 1) {
+                ERR_raise(ERR_LIB_CRYPTO, CRYPTO_R_TOO_MANY_NAMES);
+                return 0;
+            }
+        }
+        /* Using tsan_store alone here is safe since we're under lock */
+        tsan_store(&namemap->max_number, number);
+    }
+    return 1;
+}
+
+/* This function is not thread safe, the namemap must be locked */
+static void namemap_add_legacy_names(OSSL_NAMEMAP *namemap)
+{
+    STACK_OF(NAMES) *snapshot;
+    size_t dbsize = legacy_db_size();
+    int i, end, copied = 0;
+
+    if (!RUN_ONCE(&legacy_snapshot_init, do_legacy_snapshot_init)
+        || !CRYPTO_THREAD_read_lock(legacy_snapshot_lock))
+        return;
+    if (legacy_snapshot != NULL && legacy_snapshot_dbsize == dbsize)
+        copied = namemap_copy_snapshot(namemap, legacy_snapshot);
+    CRYPTO_THREAD_unlock(legacy_snapshot_lock);
+    if (copied)
+        return;
+
+    /* Start over if the copy failed half way */
+    if (namemap->max_number != 0) {
+        ossl_ht_flush(namemap->namenum_ht);
+        sk_NAMES_pop_free(namemap->numnames, names_free);
+        if ((namemap->numnames = sk_NAMES_new_null()) == NULL)
+            return;
+        tsan_store(&namemap->max_number, 0);
+    }
+
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_CIPHER_METH,
+                    get_legacy_cipher_names, namemap);
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_MD_METH,
+                    get_legacy_md_names, namemap);
+
+    /* We also pilfer data from the legacy EVP_PKEY_ASN1_METHODs */
+    for (i = 0, end = EVP_PKEY_asn1_get_count(); i < end; i++)
+        get_legacy_pkey_meth_names(EVP_PKEY_asn1_get0(i), namemap);
+
+    /* Keep the result for the next library context */
+    snapshot = sk_NAMES_deep_copy(namemap->numnames, names_dup, names_free);
+    if (snapshot == NULL || !CRYPTO_THREAD_write_lock(legacy_snapshot_lock)) {
+        sk_NAMES_pop_free(snapshot, names_free);
+        return;
+    }
+    sk_NAMES_pop_free(legacy_snapshot, names_free);
+    legacy_snapshot = snapshot;
+    legacy_snapshot_dbsize = dbsize;
+    CRYPTO_THREAD_unlock(legacy_snapshot_lock);
+}
+
+void ossl_namemap_cleanup_int(void)
+{
+    sk_NAMES_pop_free(legacy_snapshot, names_free);
+    legacy_snapshot = NULL;
+    CRYPTO_THREAD_lock_free(legacy_snapshot_lock);
+    legacy_snapshot_lock = NULL;
+}
 #endif
 
 /*-
@@ -486,20 +622,21 @@ OSSL_NAMEMAP *ossl_namemap_stored(OSSL_LIB_CTX *libctx)
         return NULL;
     }
     if (nms == 1) {
-        int i, end;
-
         /* Before pilfering, we make sure the legacy database is populated */
         OPENSSL_init_crypto(OPENSSL_INIT_ADD_ALL_CIPHERS
                             | OPENSSL_INIT_ADD_ALL_DIGESTS, NULL);
 
-        OBJ_NAME_do_all(OBJ_NAME_TYPE_CIPHER_METH,
-                        get_legacy_cipher_names, namemap);
-        OBJ_NAME_do_all(OBJ_NAME_TYPE_MD_METH,
-                        get_legacy_md_names, namemap);
+        if (!CRYPTO_THREAD_write_lock(namemap->lock))
+            return NULL;
+        /* Another thread may have beaten us to it */
+        if (namemap->max_number == 0) {
+            OSSL_INIT_PHASE phase;
 
-        /* We also pilfer data from the legacy EVP_PKEY_ASN1_METHODs */
-        for (i = 0, end = EVP_PKEY_asn1_get_count(); i < end; i++)
-            get_legacy_pkey_meth_names(EVP_PKEY_asn1_get0(i), namemap);
+            ossl_init_phase_start(&phase, "namemap", NULL);
+            namemap_add_legacy_names(namemap);
+            ossl_init_phase_end(&phase);
+        }
+        CRYPTO_THREAD_unlock(namemap->lock);
     }
 #endif
 
@@ -17,6 +17,7 @@
 #include <openssl/x509err.h>
 #include <openssl/trace.h>
 #include "internal/bio.h"
+#include "internal/err.h"
 #include "internal/provider.h"
 #include "internal/namemap.h"
 #include "crypto/decoder.h"
@@ -992,7 +993,7 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
          * We only care about errors reported from decoder implementations
          * if it returns false (i.e. there was a fatal error).
          */
-        ERR_set_mark();
+        ossl_err_set_speculative_mark();
 
         new_data.current_decoder_inst_index = i;
         new_data.flag_input_structure_checked
@@ -1017,10 +1018,10 @@ static int decoder_process(const OSSL_PARAM params[], void *arg)
 
         /* Break on error or if we tried to construct an object already */
         if (!ok || data->flag_construct_called) {
-            ERR_clear_last_mark();
+            ossl_err_clear_speculative_mark();
             break;
         }
-        ERR_pop_to_mark();
+        ossl_err_pop_speculative_mark();
 
         /*
          * Break if the decoder implementation that we called recursed, since
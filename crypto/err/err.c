@@ -831,13 +831,15 @@ void ERR_add_error_vdata(int num, va_list args)
     i = es->top;
 
     /*
-     * If err_data is allocated already, reuse the space.
-     * Otherwise, allocate a small new buffer.
+     * If err_data is allocated already, reuse the space, keeping its string
+     * if there is one.  Otherwise, allocate a small new buffer.
      */
-    if ((es->err_data_flags[i] & flags) == flags
-            && ossl_assert(es->err_data[i] != NULL)) {
+    if ((es->err_data_flags[i] & ERR_TXT_MALLOCED) != 0
+            && es->err_data[i] != NULL && es->err_data_size[i] > 0) {
         str = es->err_data[i];
         size = es->err_data_size[i];
+        if ((es->err_data_flags[i] & ERR_TXT_STRING) == 0)
+            str[0] = '\0';
 
         /*
          * To protect the string we just grabbed from tampering by other
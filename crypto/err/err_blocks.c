@@ -34,7 +34,10 @@ void ERR_set_debug(const char *file, int line, const char *func)
     if (es == NULL)
         return;
 
-    err_set_debug(es, es->top, file, line, func);
+    if (es->err_speculative > 0)
+        err_borrow_debug(es, es->top, file, line, func);
+    else
+        err_set_debug(es, es->top, file, line, func);
 }
 
 void ERR_set_error(int lib, int reason, const char *fmt, ...)
@@ -99,8 +102,12 @@ void ERR_vset_error(int lib, int reason, const char *fmt, va_list args)
          * fails, we keep what we have.
          * (According to documentation, realloc leaves the old buffer untouched
          * if it fails)
+         * Errors raised in a speculative region are almost always thrown
+         * away, so there we keep the maximized buffer for the next error
+         * that gets this slot instead.
          */
-        if ((rbuf = OPENSSL_realloc(buf, printed_len + 1)) != NULL) {
+        if (es->err_speculative == 0
+            && (rbuf = OPENSSL_realloc(buf, printed_len + 1)) != NULL) {
             buf = rbuf;
             buf_size = printed_len + 1;
             buf[printed_len] = '\0';
@@ -11,6 +11,14 @@
 #include <openssl/err.h>
 #include <openssl/e_os2.h>
 
+/*
+ * Private slot flag: the file and function strings of the slot are borrowed
+ * from the caller instead of being copies owned by the error state.  This is
+ * only ever the case for errors raised inside a speculative region, see
+ * ossl_err_set_speculative_mark().
+ */
+#define ERR_FLAG_DEBUG_BORROWED 0x10
+
 static ossl_inline void err_get_slot(ERR_STATE *es)
 {
     es->top = (es->top + 1) % ERR_NUM_ERRORS;
@@ -46,6 +54,17 @@ static ossl_inline void err_set_error(ERR_STATE *es, size_t i,
         : ERR_PACK(lib, 0, reason);
 }
 
+static ossl_inline void err_free_debug(ERR_STATE *es, size_t i)
+{
+    if ((es->err_flags[i] & ERR_FLAG_DEBUG_BORROWED) == 0) {
+        OPENSSL_free(es->err_file[i]);
+        OPENSSL_free(es->err_func[i]);
+    }
+    es->err_file[i] = NULL;
+    es->err_func[i] = NULL;
+    es->err_flags[i] &= ~ERR_FLAG_DEBUG_BORROWED;
+}
+
 static ossl_inline void err_set_debug(ERR_STATE *es, size_t i,
                                       const char *file, int line,
                                       const char *fn)
@@ -54,23 +73,48 @@ static ossl_inline void err_set_debug(ERR_STATE *es, size_t i,
      * We dup the file and fn strings because they may be provider owned. If the
      * provider gets unloaded, they may not be valid anymore.
      */
-    OPENSSL_free(es->err_file[i]);
-    if (file == NULL || file[0] == '\0')
-        es->err_file[i] = NULL;
-    else if ((es->err_file[i] = CRYPTO_malloc(strlen(file) + 1,
-                                              NULL, 0)) != NULL)
+    err_free_debug(es, i);
+    if (file != NULL && file[0] != '\0'
+        && (es->err_file[i] = CRYPTO_malloc(strlen(file) + 1,
+                                            NULL, 0)) != NULL)
         /* We cannot use OPENSSL_strdup due to possible recursion */
         strcpy(es->err_file[i], file);
 
     es->err_line[i] = line;
-    OPENSSL_free(es->err_func[i]);
-    if (fn == NULL || fn[0] == '\0')
-        es->err_func[i] = NULL;
-    else if ((es->err_func[i] = CRYPTO_malloc(strlen(fn) + 1,
-                                              NULL, 0)) != NULL)
+    if (fn != NULL && fn[0] != '\0'
+        && (es->err_func[i] = CRYPTO_malloc(strlen(fn) + 1,
+                                            NULL, 0)) != NULL)
         strcpy(es->err_func[i], fn);
 }
 
+/*
+ * Inside a speculative region the strings are only borrowed.  The region
+ * ends before the code that raised the error can go away, and any error that
+ * survives it gets its own copies, see ossl_err_clear_speculative_mark().
+ */
+static ossl_inline void err_borrow_debug(ERR_STATE *es, size_t i,
+                                         const char *file, int line,
+                                         const char *fn)
+{
+    err_free_debug(es, i);
+    if (file != NULL && file[0] != '\0')
+        es->err_file[i] = (char *)file;
+    es->err_line[i] = line;
+    if (fn != NULL && fn[0] != '\0')
+        es->err_func[i] = (char *)fn;
+    es->err_flags[i] |= ERR_FLAG_DEBUG_BORROWED;
+}
+
+/* Give a slot its own copies of borrowed file and function strings */
+static ossl_inline void err_own_debug(ERR_STATE *es, size_t i)
+{
+    const char *file = es->err_file[i], *fn = es->err_func[i];
+
+    if ((es->err_flags[i] & ERR_FLAG_DEBUG_BORROWED) == 0)
+        return;
+    err_set_debug(es, i, file, es->err_line[i], fn);
+}
+
 static ossl_inline void err_set_data(ERR_STATE *es, size_t i,
                                      void *data, size_t datasz, int flags)
 {
@@ -84,14 +128,11 @@ static ossl_inline void err_set_data(ERR_STATE *es, size_t i,
 static ossl_inline void err_clear(ERR_STATE *es, size_t i, int deall)
 {
     err_clear_data(es, i, (deall));
+    err_free_debug(es, i);
     es->err_marks[i] = 0;
     es->err_flags[i] = 0;
     es->err_buffer[i] = 0;
     es->err_line[i] = -1;
-    OPENSSL_free(es->err_file[i]);
-    es->err_file[i] = NULL;
-    OPENSSL_free(es->err_func[i]);
-    es->err_func[i] = NULL;
 }
 
 ERR_STATE *ossl_err_get_state_int(void);
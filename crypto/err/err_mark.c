@@ -10,6 +10,7 @@
 #define OSSL_FORCE_ERR_STATE
 
 #include <openssl/err.h>
+#include "internal/err.h"
 #include "err_local.h"
 
 int ERR_set_mark(void)
@@ -99,3 +100,70 @@ int ERR_clear_last_mark(void)
     return 1;
 }
 
+
+/*
+ * A speculative mark is a mark for probing code that expects to throw away
+ * whatever errors it gets.  Until the matching ossl_err_pop_speculative_mark()
+ * or ossl_err_clear_speculative_mark(), the file and function names of new
+ * errors are borrowed rather than copied, and the additional data buffers of
+ * the slots are kept for reuse, so that raising errors doesn't allocate once
+ * the error stack has warmed up.  Errors that survive the mark get their own
+ * copies of the names and are otherwise unchanged.
+ */
+int ossl_err_set_speculative_mark(void)
+{
+    ERR_STATE *es;
+
+    es = ossl_err_get_state_int();
+    if (es == NULL)
+        return 0;
+
+    es->err_speculative++;
+    if (es->bottom == es->top)
+        return 0;
+    es->err_marks[es->top]++;
+    return 1;
+}
+
+static void err_end_speculative(ERR_STATE *es)
+{
+    if (es->err_speculative > 0)
+        es->err_speculative--;
+}
+
+int ossl_err_pop_speculative_mark(void)
+{
+    ERR_STATE *es;
+
+    es = ossl_err_get_state_int();
+    if (es == NULL)
+        return 0;
+
+    err_end_speculative(es);
+    return ERR_pop_to_mark();
+}
+
+int ossl_err_clear_speculative_mark(void)
+{
+    ERR_STATE *es;
+    int top;
+
+    es = ossl_err_get_state_int();
+    if (es == NULL)
+        return 0;
+
+    err_end_speculative(es);
+    top = es->top;
+    while (es->bottom != top
+           && es->err_marks[top] == 0) {
+        /* An enclosing speculative region takes care of the survivors */
+        if (es->err_speculative == 0)
+            err_own_debug(es, top);
+        top = top > 0 ? top - 1 : ERR_NUM_ERRORS - 1;
+    }
+
+    if (es->bottom == top)
+        return 0;
+    es->err_marks[top]--;
+    return 1;
+}
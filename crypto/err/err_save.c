@@ -26,6 +26,7 @@ ERR_STATE *OSSL_ERR_STATE_new(void)
 void OSSL_ERR_STATE_save(ERR_STATE *es)
 {
     size_t i;
+    int speculative;
     ERR_STATE *thread_es;
 
     if (es == NULL)
@@ -40,7 +41,14 @@ void OSSL_ERR_STATE_save(ERR_STATE *es)
 
     memcpy(es, thread_es, sizeof(*es));
     /* Taking over the pointers, just clear the thread state. */
+    speculative = thread_es->err_speculative;
     memset(thread_es, 0, sizeof(*thread_es));
+    thread_es->err_speculative = speculative;
+
+    /* The saved state may outlive any speculative region it came from */
+    es->err_speculative = 0;
+    for (i = 0; i < ERR_NUM_ERRORS; i++)
+        err_own_debug(es, i);
 }
 
 void OSSL_ERR_STATE_save_to_mark(ERR_STATE *es)
@@ -93,6 +101,8 @@ void OSSL_ERR_STATE_save_to_mark(ERR_STATE *es)
         thread_es->err_file[j]       = NULL;
         thread_es->err_line[j]       = 0;
         thread_es->err_func[j]       = NULL;
+
+        err_own_debug(es, i);
     }
 
     if (i > 0) {
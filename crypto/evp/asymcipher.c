@@ -461,29 +461,44 @@ static void *evp_asym_cipher_from_algorithm(int name_id,
     return NULL;
 }
 
+static void evp_asym_cipher_free_int(void *vcipher)
+{
+    EVP_ASYM_CIPHER *cipher = vcipher;
+
+    OPENSSL_free(cipher->type_name);
+    ossl_provider_free(cipher->prov);
+    CRYPTO_FREE_REF(&cipher->refcnt);
+    OPENSSL_free(cipher);
+}
+
 void EVP_ASYM_CIPHER_free(EVP_ASYM_CIPHER *cipher)
 {
     int i;
 
-    if (cipher == NULL)
+    if (cipher == NULL || cipher->pinned)
         return;
     CRYPTO_DOWN_REF(&cipher->refcnt, &i);
     if (i > 0)
         return;
-    OPENSSL_free(cipher->type_name);
-    ossl_provider_free(cipher->prov);
-    CRYPTO_FREE_REF(&cipher->refcnt);
-    OPENSSL_free(cipher);
+    evp_asym_cipher_free_int(cipher);
 }
 
 int EVP_ASYM_CIPHER_up_ref(EVP_ASYM_CIPHER *cipher)
 {
     int ref = 0;
 
-    CRYPTO_UP_REF(&cipher->refcnt, &ref);
+    if (!cipher->pinned)
+        CRYPTO_UP_REF(&cipher->refcnt, &ref);
     return 1;
 }
 
+void evp_asym_cipher_pin(EVP_ASYM_CIPHER *cipher)
+{
+    if (ossl_provider_pin_method(cipher->prov, cipher,
+                                 evp_asym_cipher_free_int))
+        cipher->pinned = 1;
+}
+
 OSSL_PROVIDER *EVP_ASYM_CIPHER_get0_provider(const EVP_ASYM_CIPHER *cipher)
 {
     return cipher->prov;
@@ -1167,6 +1167,18 @@ EVP_MD *EVP_MD_fetch(OSSL_LIB_CTX *ctx, const char *algorithm,
     return md;
 }
 
+static void evp_md_free_pinned(void *md)
+{
+    evp_md_free_int(md);
+}
+
+void evp_md_pin(EVP_MD *md)
+{
+    if (md->origin == EVP_ORIG_DYNAMIC
+        && ossl_provider_pin_method(md->prov, md, evp_md_free_pinned))
+        md->origin = EVP_ORIG_PINNED;
+}
+
 int EVP_MD_up_ref(EVP_MD *md)
 {
     int ref = 0;
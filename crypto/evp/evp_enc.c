@@ -1912,6 +1912,19 @@ void evp_cipher_free_int(EVP_CIPHER *cipher)
     OPENSSL_free(cipher);
 }
 
+static void evp_cipher_free_pinned(void *cipher)
+{
+    evp_cipher_free_int(cipher);
+}
+
+void evp_cipher_pin(EVP_CIPHER *cipher)
+{
+    if (cipher->origin == EVP_ORIG_DYNAMIC
+        && ossl_provider_pin_method(cipher->prov, cipher,
+                                    evp_cipher_free_pinned))
+        cipher->origin = EVP_ORIG_PINNED;
+}
+
 void EVP_CIPHER_free(EVP_CIPHER *cipher)
 {
     int i;
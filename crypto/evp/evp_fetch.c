@@ -161,6 +161,43 @@ static void *get_evp_method_from_store(void *store, const OSSL_PROVIDER **prov,
     return method;
 }
 
+/*
+ * If the method's provider has been pinned, the method is handed over to
+ * the provider and is no longer reference counted from here on.
+ */
+static void pin_evp_method(int operation_id, void *method)
+{
+    switch (operation_id) {
+    case OSSL_OP_DIGEST:
+        evp_md_pin(method);
+        break;
+    case OSSL_OP_CIPHER:
+        evp_cipher_pin(method);
+        break;
+    case OSSL_OP_MAC:
+        evp_mac_pin(method);
+        break;
+    case OSSL_OP_KDF:
+        evp_kdf_pin(method);
+        break;
+    case OSSL_OP_KEYMGMT:
+        evp_keymgmt_pin(method);
+        break;
+    case OSSL_OP_KEYEXCH:
+        evp_keyexch_pin(method);
+        break;
+    case OSSL_OP_SIGNATURE:
+        evp_signature_pin(method);
+        break;
+    case OSSL_OP_ASYM_CIPHER:
+        evp_asym_cipher_pin(method);
+        break;
+    case OSSL_OP_KEM:
+        evp_kem_pin(method);
+        break;
+    }
+}
+
 static int put_evp_method_in_store(void *store, void *method,
                                    const OSSL_PROVIDER *prov,
                                    const char *names, const char *propdef,
@@ -190,9 +227,15 @@ static int put_evp_method_in_store(void *store, void *method,
         return 0;
 
     OSSL_TRACE1(QUERY, "put_evp_method_in_store: original store: %p\n", store);
-    if (store == NULL
-        && (store = get_evp_method_store(methdata->libctx)) == NULL)
-        return 0;
+    if (store == NULL) {
+        if ((store = get_evp_method_store(methdata->libctx)) == NULL)
+            return 0;
+        /*
+         * Only methods that go to the permanent store are pinned, the
+         * temporary store is flushed after every fetch.
+         */
+        pin_evp_method(methdata->operation_id, method);
+    }
 
     OSSL_TRACE5(QUERY,
                 "put_evp_method_in_store: "
@@ -102,6 +102,7 @@ struct evp_keymgmt_st {
     const char *description;
     OSSL_PROVIDER *prov;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     /* Constructor(s), destructor, information */
     OSSL_FUNC_keymgmt_new_fn *new;
@@ -145,6 +146,7 @@ struct evp_keyexch_st {
     const char *description;
     OSSL_PROVIDER *prov;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_keyexch_newctx_fn *newctx;
     OSSL_FUNC_keyexch_init_fn *init;
@@ -164,6 +166,7 @@ struct evp_signature_st {
     const char *description;
     OSSL_PROVIDER *prov;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_signature_newctx_fn *newctx;
     OSSL_FUNC_signature_sign_init_fn *sign_init;
@@ -207,6 +210,7 @@ struct evp_asym_cipher_st {
     const char *description;
     OSSL_PROVIDER *prov;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_asym_cipher_newctx_fn *newctx;
     OSSL_FUNC_asym_cipher_encrypt_init_fn *encrypt_init;
@@ -227,6 +231,7 @@ struct evp_kem_st {
     const char *description;
     OSSL_PROVIDER *prov;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_kem_newctx_fn *newctx;
     OSSL_FUNC_kem_encapsulate_init_fn *encapsulate_init;
@@ -375,6 +380,17 @@ void evp_pkey_ctx_free_old_ops(EVP_PKEY_CTX *ctx);
 void evp_cipher_free_int(EVP_CIPHER *md);
 void evp_md_free_int(EVP_MD *md);
 
+/* Hand ownership of a freshly stored method to its provider, if pinned */
+void evp_md_pin(EVP_MD *md);
+void evp_cipher_pin(EVP_CIPHER *cipher);
+void evp_mac_pin(EVP_MAC *mac);
+void evp_kdf_pin(EVP_KDF *kdf);
+void evp_keymgmt_pin(EVP_KEYMGMT *keymgmt);
+void evp_keyexch_pin(EVP_KEYEXCH *exchange);
+void evp_signature_pin(EVP_SIGNATURE *signature);
+void evp_asym_cipher_pin(EVP_ASYM_CIPHER *cipher);
+void evp_kem_pin(EVP_KEM *kem);
+
 /* OSSL_PROVIDER * is only used to get the library context */
 int evp_is_a(OSSL_PROVIDER *prov, int number,
              const char *legacy_name, const char *name);
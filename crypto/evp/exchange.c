@@ -149,29 +149,44 @@ static void *evp_keyexch_from_algorithm(int name_id,
     return NULL;
 }
 
+static void evp_keyexch_free_int(void *vexchange)
+{
+    EVP_KEYEXCH *exchange = vexchange;
+
+    OPENSSL_free(exchange->type_name);
+    ossl_provider_free(exchange->prov);
+    CRYPTO_FREE_REF(&exchange->refcnt);
+    OPENSSL_free(exchange);
+}
+
 void EVP_KEYEXCH_free(EVP_KEYEXCH *exchange)
 {
     int i;
 
-    if (exchange == NULL)
+    if (exchange == NULL || exchange->pinned)
         return;
     CRYPTO_DOWN_REF(&exchange->refcnt, &i);
     if (i > 0)
         return;
-    OPENSSL_free(exchange->type_name);
-    ossl_provider_free(exchange->prov);
-    CRYPTO_FREE_REF(&exchange->refcnt);
-    OPENSSL_free(exchange);
+    evp_keyexch_free_int(exchange);
 }
 
 int EVP_KEYEXCH_up_ref(EVP_KEYEXCH *exchange)
 {
     int ref = 0;
 
-    CRYPTO_UP_REF(&exchange->refcnt, &ref);
+    if (!exchange->pinned)
+        CRYPTO_UP_REF(&exchange->refcnt, &ref);
     return 1;
 }
 
+void evp_keyexch_pin(EVP_KEYEXCH *exchange)
+{
+    if (ossl_provider_pin_method(exchange->prov, exchange,
+                                 evp_keyexch_free_int))
+        exchange->pinned = 1;
+}
+
 OSSL_PROVIDER *EVP_KEYEXCH_get0_provider(const EVP_KEYEXCH *exchange)
 {
     return exchange->prov;
@@ -22,25 +22,39 @@ static int evp_kdf_up_ref(void *vkdf)
     EVP_KDF *kdf = (EVP_KDF *)vkdf;
     int ref = 0;
 
-    CRYPTO_UP_REF(&kdf->refcnt, &ref);
+    if (!kdf->pinned)
+        CRYPTO_UP_REF(&kdf->refcnt, &ref);
     return 1;
 }
 
+static void evp_kdf_free_int(void *vkdf)
+{
+    EVP_KDF *kdf = vkdf;
+
+    OPENSSL_free(kdf->type_name);
+    ossl_provider_free(kdf->prov);
+    CRYPTO_FREE_REF(&kdf->refcnt);
+    OPENSSL_free(kdf);
+}
+
 static void evp_kdf_free(void *vkdf)
 {
     EVP_KDF *kdf = (EVP_KDF *)vkdf;
     int ref = 0;
 
-    if (kdf == NULL)
+    if (kdf == NULL || kdf->pinned)
         return;
 
     CRYPTO_DOWN_REF(&kdf->refcnt, &ref);
     if (ref > 0)
         return;
-    OPENSSL_free(kdf->type_name);
-    ossl_provider_free(kdf->prov);
-    CRYPTO_FREE_REF(&kdf->refcnt);
-    OPENSSL_free(kdf);
+    evp_kdf_free_int(kdf);
+}
+
+void evp_kdf_pin(EVP_KDF *kdf)
+{
+    if (ossl_provider_pin_method(kdf->prov, kdf, evp_kdf_free_int))
+        kdf->pinned = 1;
 }
 
 static void *evp_kdf_new(void)
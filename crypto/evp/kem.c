@@ -428,30 +428,44 @@ static void *evp_kem_from_algorithm(int name_id, const OSSL_ALGORITHM *algodef,
     return NULL;
 }
 
+static void evp_kem_free_int(void *vkem)
+{
+    EVP_KEM *kem = vkem;
+
+    OPENSSL_free(kem->type_name);
+    ossl_provider_free(kem->prov);
+    CRYPTO_FREE_REF(&kem->refcnt);
+    OPENSSL_free(kem);
+}
+
 void EVP_KEM_free(EVP_KEM *kem)
 {
     int i;
 
-    if (kem == NULL)
+    if (kem == NULL || kem->pinned)
         return;
 
     CRYPTO_DOWN_REF(&kem->refcnt, &i);
     if (i > 0)
         return;
-    OPENSSL_free(kem->type_name);
-    ossl_provider_free(kem->prov);
-    CRYPTO_FREE_REF(&kem->refcnt);
-    OPENSSL_free(kem);
+    evp_kem_free_int(kem);
 }
 
 int EVP_KEM_up_ref(EVP_KEM *kem)
 {
     int ref = 0;
 
-    CRYPTO_UP_REF(&kem->refcnt, &ref);
+    if (!kem->pinned)
+        CRYPTO_UP_REF(&kem->refcnt, &ref);
     return 1;
 }
 
+void evp_kem_pin(EVP_KEM *kem)
+{
+    if (ossl_provider_pin_method(kem->prov, kem, evp_kem_free_int))
+        kem->pinned = 1;
+}
+
 OSSL_PROVIDER *EVP_KEM_get0_provider(const EVP_KEM *kem)
 {
     return kem->prov;
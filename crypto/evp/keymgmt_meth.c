@@ -295,24 +295,38 @@ int EVP_KEYMGMT_up_ref(EVP_KEYMGMT *keymgmt)
 {
     int ref = 0;
 
-    CRYPTO_UP_REF(&keymgmt->refcnt, &ref);
+    if (!keymgmt->pinned)
+        CRYPTO_UP_REF(&keymgmt->refcnt, &ref);
     return 1;
 }
 
+static void evp_keymgmt_free_int(void *vkeymgmt)
+{
+    EVP_KEYMGMT *keymgmt = vkeymgmt;
+
+    OPENSSL_free(keymgmt->type_name);
+    ossl_provider_free(keymgmt->prov);
+    CRYPTO_FREE_REF(&keymgmt->refcnt);
+    OPENSSL_free(keymgmt);
+}
+
 void EVP_KEYMGMT_free(EVP_KEYMGMT *keymgmt)
 {
     int ref = 0;
 
-    if (keymgmt == NULL)
+    if (keymgmt == NULL || keymgmt->pinned)
         return;
 
     CRYPTO_DOWN_REF(&keymgmt->refcnt, &ref);
     if (ref > 0)
         return;
-    OPENSSL_free(keymgmt->type_name);
-    ossl_provider_free(keymgmt->prov);
-    CRYPTO_FREE_REF(&keymgmt->refcnt);
-    OPENSSL_free(keymgmt);
+    evp_keymgmt_free_int(keymgmt);
+}
+
+void evp_keymgmt_pin(EVP_KEYMGMT *keymgmt)
+{
+    if (ossl_provider_pin_method(keymgmt->prov, keymgmt, evp_keymgmt_free_int))
+        keymgmt->pinned = 1;
 }
 
 const OSSL_PROVIDER *EVP_KEYMGMT_get0_provider(const EVP_KEYMGMT *keymgmt)
@@ -21,25 +21,39 @@ static int evp_mac_up_ref(void *vmac)
     EVP_MAC *mac = vmac;
     int ref = 0;
 
-    CRYPTO_UP_REF(&mac->refcnt, &ref);
+    if (!mac->pinned)
+        CRYPTO_UP_REF(&mac->refcnt, &ref);
     return 1;
 }
 
+static void evp_mac_free_int(void *vmac)
+{
+    EVP_MAC *mac = vmac;
+
+    OPENSSL_free(mac->type_name);
+    ossl_provider_free(mac->prov);
+    CRYPTO_FREE_REF(&mac->refcnt);
+    OPENSSL_free(mac);
+}
+
 static void evp_mac_free(void *vmac)
 {
     EVP_MAC *mac = vmac;
     int ref = 0;
 
-    if (mac == NULL)
+    if (mac == NULL || mac->pinned)
         return;
 
     CRYPTO_DOWN_REF(&mac->refcnt, &ref);
     if (ref > 0)
         return;
-    OPENSSL_free(mac->type_name);
-    ossl_provider_free(mac->prov);
-    CRYPTO_FREE_REF(&mac->refcnt);
-    OPENSSL_free(mac);
+    evp_mac_free_int(mac);
+}
+
+void evp_mac_pin(EVP_MAC *mac)
+{
+    if (ossl_provider_pin_method(mac->prov, mac, evp_mac_free_int))
+        mac->pinned = 1;
 }
 
 static void *evp_mac_new(void)
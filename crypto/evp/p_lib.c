@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include "internal/cryptlib.h"
 #include "internal/refcount.h"
+#include "internal/err.h"
 #include "internal/namemap.h"
 #include <openssl/bn.h>
 #include <openssl/err.h>
@@ -1294,9 +1295,9 @@ static int legacy_asn1_ctrl_to_param(EVP_PKEY *pkey, int op,
                 OSSL_NAMEMAP *namemap;
                 int nid = NID_undef;
 
-                (void)ERR_set_mark();
+                (void)ossl_err_set_speculative_mark();
                 md = EVP_MD_fetch(libctx, mdname, NULL);
-                (void)ERR_pop_to_mark();
+                (void)ossl_err_pop_speculative_mark();
                 namemap = ossl_namemap_stored(libctx);
 
                 /*
@@ -1374,10 +1375,10 @@ int EVP_PKEY_digestsign_supports_digest(EVP_PKEY *pkey, OSSL_LIB_CTX *libctx,
     if ((ctx = EVP_MD_CTX_new()) == NULL)
         return -1;
 
-    ERR_set_mark();
+    ossl_err_set_speculative_mark();
     rv = EVP_DigestSignInit_ex(ctx, NULL, name, libctx,
                                propq, pkey, NULL);
-    ERR_pop_to_mark();
+    ossl_err_pop_speculative_mark();
 
     EVP_MD_CTX_free(ctx);
     return rv;
@@ -1621,7 +1622,7 @@ static void find_ameth(const char *name, void *data)
      * The error messages from pkey_set_type() are uninteresting here,
      * and misleading.
      */
-    ERR_set_mark();
+    ossl_err_set_speculative_mark();
 
     if (pkey_set_type(NULL, NULL, EVP_PKEY_NONE, name, strlen(name),
                       NULL)) {
@@ -1631,7 +1632,7 @@ static void find_ameth(const char *name, void *data)
             str[1] = name;
     }
 
-    ERR_pop_to_mark();
+    ossl_err_pop_speculative_mark();
 }
 #endif
 
@@ -381,29 +381,44 @@ static void *evp_signature_from_algorithm(int name_id,
     return NULL;
 }
 
+static void evp_signature_free_int(void *vsignature)
+{
+    EVP_SIGNATURE *signature = vsignature;
+
+    OPENSSL_free(signature->type_name);
+    ossl_provider_free(signature->prov);
+    CRYPTO_FREE_REF(&signature->refcnt);
+    OPENSSL_free(signature);
+}
+
 void EVP_SIGNATURE_free(EVP_SIGNATURE *signature)
 {
     int i;
 
-    if (signature == NULL)
+    if (signature == NULL || signature->pinned)
         return;
     CRYPTO_DOWN_REF(&signature->refcnt, &i);
     if (i > 0)
         return;
-    OPENSSL_free(signature->type_name);
-    ossl_provider_free(signature->prov);
-    CRYPTO_FREE_REF(&signature->refcnt);
-    OPENSSL_free(signature);
+    evp_signature_free_int(signature);
 }
 
 int EVP_SIGNATURE_up_ref(EVP_SIGNATURE *signature)
 {
     int ref = 0;
 
-    CRYPTO_UP_REF(&signature->refcnt, &ref);
+    if (!signature->pinned)
+        CRYPTO_UP_REF(&signature->refcnt, &ref);
     return 1;
 }
 
+void evp_signature_pin(EVP_SIGNATURE *signature)
+{
+    if (ossl_provider_pin_method(signature->prov, signature,
+                                 evp_signature_free_int))
+        signature->pinned = 1;
+}
+
 OSSL_PROVIDER *EVP_SIGNATURE_get0_provider(const EVP_SIGNATURE *signature)
 {
     return signature->prov;
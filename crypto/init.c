@@ -24,6 +24,7 @@
 #include "internal/err.h"
 #include "crypto/err.h"
 #include "crypto/objects.h"
+#include "internal/namemap.h"
 #include <stdlib.h>
 #include <assert.h>
 #include "internal/thread_once.h"
@@ -33,6 +34,7 @@
 #include <openssl/cmp_util.h> /* for OSSL_CMP_log_close() */
 #include <openssl/trace.h>
 #include "crypto/ctype.h"
+#include "internal/tsan_assist.h"
 
 static int stopped = 0;
 static uint64_t optsdone = 0;
@@ -50,12 +52,94 @@ static CRYPTO_RWLOCK *optsdone_lock = NULL;
 static CRYPTO_RWLOCK *init_lock = NULL;
 static CRYPTO_THREAD_LOCAL in_init_config_local;
 
+/*
+ * Timings of the initialisation phases, see OPENSSL_get_init_phase().
+ * Slots are claimed with an atomic counter and published through |done|,
+ * so recording needs no lock and works before ossl_init_base() has run.
+ */
+#define INIT_PHASE_MAX 32
+
+static struct {
+    char name[48];
+    uint64_t usec;
+    int mallocs;
+    TSAN_QUALIFIER int done;
+} init_phases[INIT_PHASE_MAX];
+static TSAN_QUALIFIER int init_phase_count = 0;
+
+static int init_malloc_count(void)
+{
+#ifndef OPENSSL_NO_CRYPTO_MDEBUG
+    int mcount = 0;
+
+    CRYPTO_get_alloc_counts(&mcount, NULL, NULL);
+    return mcount;
+#else
+    return -1;
+#endif
+}
+
+void ossl_init_phase_start(OSSL_INIT_PHASE *phase, const char *name,
+                           const char *detail)
+{
+    phase->name = name;
+    phase->detail = detail;
+    phase->mallocs = init_malloc_count();
+    phase->start = ossl_time_now();
+}
+
+void ossl_init_phase_end(OSSL_INIT_PHASE *phase)
+{
+    uint64_t usec = ossl_time2us(ossl_time_subtract(ossl_time_now(),
+                                                    phase->start));
+    int mallocs = phase->mallocs < 0 ? -1
+                                     : init_malloc_count() - phase->mallocs;
+    int i;
+
+    OSSL_TRACE_BEGIN(INIT_PHASE) {
+        BIO_printf(trc_out, "%s%s%s: %llu us, %d allocations\n", phase->name,
+                   phase->detail != NULL ? " " : "",
+                   phase->detail != NULL ? phase->detail : "",
+                   (unsigned long long)usec, mallocs);
+    } OSSL_TRACE_END(INIT_PHASE);
+
+    if (tsan_load(&init_phase_count) >= INIT_PHASE_MAX
+        || (i = tsan_counter(&init_phase_count)) >= INIT_PHASE_MAX)
+        return;
+    if (phase->detail != NULL)
+        BIO_snprintf(init_phases[i].name, sizeof(init_phases[i].name), "%s %s",
+                     phase->name, phase->detail);
+    else
+        OPENSSL_strlcpy(init_phases[i].name, phase->name,
+                        sizeof(init_phases[i].name));
+    init_phases[i].usec = usec;
+    init_phases[i].mallocs = mallocs;
+    tsan_store(&init_phases[i].done, 1);
+}
+
+int OPENSSL_get_init_phase(size_t idx, const char **name, uint64_t *usec,
+                           int *mallocs)
+{
+    if (idx >= INIT_PHASE_MAX || !tsan_load(&init_phases[idx].done))
+        return 0;
+    if (name != NULL)
+        *name = init_phases[idx].name;
+    if (usec != NULL)
+        *usec = init_phases[idx].usec;
+    if (mallocs != NULL)
+        *mallocs = init_phases[idx].mallocs;
+    return 1;
+}
+
 static CRYPTO_ONCE base = CRYPTO_ONCE_STATIC_INIT;
 static int base_inited = 0;
 DEFINE_RUN_ONCE_STATIC(ossl_init_base)
 {
+    OSSL_INIT_PHASE phase;
+
     /* no need to init trace */
 
+    ossl_init_phase_start(&phase, "base", NULL);
     OSSL_TRACE(INIT, "ossl_init_base: setting up stop handlers\n");
 #ifndef OPENSSL_NO_CRYPTO_MDEBUG
     ossl_malloc_setup_failures();
@@ -74,6 +158,7 @@ DEFINE_RUN_ONCE_STATIC(ossl_init_base)
         goto err;
 
     base_inited = 1;
+    ossl_init_phase_end(&phase);
     return 1;
 
 err:
@@ -188,13 +273,16 @@ DEFINE_RUN_ONCE_STATIC(ossl_init_load_crypto_strings)
      * pulling in all the error strings during static linking
      */
 #if !defined(OPENSSL_NO_ERR) && !defined(OPENSSL_NO_AUTOERRINIT)
+    OSSL_INIT_PHASE phase;
     void *err;
 
     if (!err_shelve_state(&err))
         return 0;
 
+    ossl_init_phase_start(&phase, "error strings", NULL);
     OSSL_TRACE(INIT, "ossl_err_load_crypto_strings()\n");
     ret = ossl_err_load_crypto_strings();
+    ossl_init_phase_end(&phase);
 
     err_unshelve_state(err);
 #endif
@@ -216,8 +304,12 @@ DEFINE_RUN_ONCE_STATIC(ossl_init_add_all_ciphers)
      * pulling in all the ciphers during static linking
      */
 #ifndef OPENSSL_NO_AUTOALGINIT
+    OSSL_INIT_PHASE phase;
+
+    ossl_init_phase_start(&phase, "legacy ciphers", NULL);
     OSSL_TRACE(INIT, "openssl_add_all_ciphers_int()\n");
     openssl_add_all_ciphers_int();
+    ossl_init_phase_end(&phase);
 #endif
     return 1;
 }
@@ -237,8 +329,12 @@ DEFINE_RUN_ONCE_STATIC(ossl_init_add_all_digests)
      * pulling in all the ciphers during static linking
      */
 #ifndef OPENSSL_NO_AUTOALGINIT
+    OSSL_INIT_PHASE phase;
+
+    ossl_init_phase_start(&phase, "legacy digests", NULL);
     OSSL_TRACE(INIT, "openssl_add_all_digests()\n");
     openssl_add_all_digests_int();
+    ossl_init_phase_end(&phase);
 #endif
     return 1;
 }
@@ -255,15 +351,23 @@ static int config_inited = 0;
 static const OPENSSL_INIT_SETTINGS *conf_settings = NULL;
 DEFINE_RUN_ONCE_STATIC(ossl_init_config)
 {
-    int ret = ossl_config_int(NULL);
+    OSSL_INIT_PHASE phase;
+    int ret;
 
+    ossl_init_phase_start(&phase, "config", NULL);
+    ret = ossl_config_int(NULL);
+    ossl_init_phase_end(&phase);
     config_inited = 1;
     return ret;
 }
 DEFINE_RUN_ONCE_STATIC_ALT(ossl_init_config_settings, ossl_init_config)
 {
-    int ret = ossl_config_int(conf_settings);
+    OSSL_INIT_PHASE phase;
+    int ret;
 
+    ossl_init_phase_start(&phase, "config", NULL);
+    ret = ossl_config_int(conf_settings);
+    ossl_init_phase_end(&phase);
     config_inited = 1;
     return ret;
 }
@@ -279,10 +383,14 @@ static CRYPTO_ONCE async = CRYPTO_ONCE_STATIC_INIT;
 static int async_inited = 0;
 DEFINE_RUN_ONCE_STATIC(ossl_init_async)
 {
+    OSSL_INIT_PHASE phase;
+
+    ossl_init_phase_start(&phase, "async", NULL);
     OSSL_TRACE(INIT, "async_init()\n");
     if (!async_init())
         return 0;
     async_inited = 1;
+    ossl_init_phase_end(&phase);
     return 1;
 }
 
@@ -444,6 +552,9 @@ void OPENSSL_cleanup(void)
     OSSL_TRACE(INIT, "OPENSSL_cleanup: bio_cleanup()\n");
     bio_cleanup();
 
+    OSSL_TRACE(INIT, "OPENSSL_cleanup: ossl_namemap_cleanup_int()\n");
+    ossl_namemap_cleanup_int();
+
     OSSL_TRACE(INIT, "OPENSSL_cleanup: evp_cleanup_int()\n");
     evp_cleanup_int();
 
@@ -52,9 +52,14 @@ static unsigned int real_shift(void)
 
 OSSL_PARAM *OSSL_PARAM_locate(OSSL_PARAM *p, const char *key)
 {
+    /*
+     * Most callers look for a handful of names in short arrays whose keys
+     * differ early, so reject on the first character before paying for the
+     * full string comparison.
+     */
     if (p != NULL && key != NULL)
         for (; p->key != NULL; p++)
-            if (strcmp(key, p->key) == 0)
+            if (*key == *p->key && strcmp(key, p->key) == 0)
                 return p;
     return NULL;
 }
@@ -76,6 +76,11 @@ int OSSL_PROVIDER_unload(OSSL_PROVIDER *prov)
     return 1;
 }
 
+int OSSL_PROVIDER_pin(OSSL_PROVIDER *prov)
+{
+    return ossl_provider_pin(prov);
+}
+
 const OSSL_PARAM *OSSL_PROVIDER_gettable_params(const OSSL_PROVIDER *prov)
 {
     return ossl_provider_gettable_params(prov);
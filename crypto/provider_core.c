@@ -139,14 +139,30 @@ DEFINE_STACK_OF(OSSL_PROVIDER_CHILD_CB)
 
 struct provider_store_st;        /* Forward declaration */
 
+/*
+ * Methods created from a pinned provider aren't reference counted.  Instead,
+ * they are recorded with the provider and destroyed together with the
+ * provider store.
+ */
+typedef struct pinned_method_st PINNED_METHOD;
+struct pinned_method_st {
+    void *method;
+    void (*destruct)(void *);
+    PINNED_METHOD *next;
+};
+
 struct ossl_provider_st {
     /* Flag bits */
     unsigned int flag_initialized:1;
     unsigned int flag_activated:1;
+    unsigned int flag_pinned:1;
 
     /* Getting and setting the flags require synchronization */
     CRYPTO_RWLOCK *flag_lock;
 
+    /* Protected by flag_lock, only used when flag_pinned is set */
+    PINNED_METHOD *pinned_methods;
+
     /* OpenSSL library side data */
     CRYPTO_REF_COUNT refcnt;
     CRYPTO_RWLOCK *activatecnt_lock; /* For the activatecnt counter */
@@ -284,14 +300,34 @@ void ossl_provider_info_clear(OSSL_PROVIDER_INFO *info)
     sk_INFOPAIR_pop_free(info->parameters, infopair_free);
 }
 
+static void provider_free_pinned_methods(OSSL_PROVIDER *prov)
+{
+    PINNED_METHOD *pm;
+
+    while ((pm = prov->pinned_methods) != NULL) {
+        prov->pinned_methods = pm->next;
+        pm->destruct(pm->method);
+        OPENSSL_free(pm);
+    }
+}
+
 void ossl_provider_store_free(void *vstore)
 {
     struct provider_store_st *store = vstore;
     size_t i;
+    int j;
 
     if (store == NULL)
         return;
     store->freeing = 1;
+    /*
+     * The method stores are gone by now, so nothing can refer to the pinned
+     * methods any more.  They hold references to their providers, so they
+     * must be destroyed before the providers are.
+     */
+    for (j = 0; j < sk_OSSL_PROVIDER_num(store->providers); j++)
+        provider_free_pinned_methods(sk_OSSL_PROVIDER_value(store->providers,
+                                                            j));
     OPENSSL_free(store->default_path);
     sk_OSSL_PROVIDER_pop_free(store->providers, provider_deactivate_free);
 #ifndef FIPS_MODULE
@@ -1265,8 +1301,13 @@ static int provider_activate(OSSL_PROVIDER *prov, int lock, int upcalls)
     * any locks because we've not shared it with other threads.
     */
     if (store == NULL) {
+        OSSL_INIT_PHASE phase;
+
         lock = 0;
-        if (!provider_init(prov))
+        ossl_init_phase_start(&phase, "provider", prov->name);
+        ret = provider_init(prov);
+        ossl_init_phase_end(&phase);
+        if (!ret)
             return -1;
     }
 
@@ -1711,6 +1752,40 @@ OSSL_LIB_CTX *ossl_provider_libctx(const OSSL_PROVIDER *prov)
     return prov != NULL ? prov->libctx : NULL;
 }
 
+int ossl_provider_pin(OSSL_PROVIDER *prov)
+{
+    if (prov == NULL || prov->store == NULL) {
+        ERR_raise(ERR_LIB_CRYPTO, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+    if (!CRYPTO_THREAD_write_lock(prov->flag_lock))
+        return 0;
+    prov->flag_pinned = 1;
+    CRYPTO_THREAD_unlock(prov->flag_lock);
+    return 1;
+}
+
+int ossl_provider_pin_method(OSSL_PROVIDER *prov, void *method,
+                             void (*destruct)(void *))
+{
+    PINNED_METHOD *pm;
+    int ret = 0;
+
+    if (prov == NULL || prov->store == NULL)
+        return 0;
+    if (!CRYPTO_THREAD_write_lock(prov->flag_lock))
+        return 0;
+    if (prov->flag_pinned && (pm = OPENSSL_malloc(sizeof(*pm))) != NULL) {
+        pm->method = method;
+        pm->destruct = destruct;
+        pm->next = prov->pinned_methods;
+        prov->pinned_methods = pm;
+        ret = 1;
+    }
+    CRYPTO_THREAD_unlock(prov->flag_lock);
+    return ret;
+}
+
 /**
  * @brief Tears down the given provider.
  *
@@ -19,6 +19,7 @@
 #include <openssl/decoder.h>
 #include <openssl/store.h>
 #include "internal/provider.h"
+#include "internal/err.h"
 #include "internal/passphrase.h"
 #include "crypto/evp.h"
 #include "crypto/x509.h"
@@ -126,33 +127,33 @@ int ossl_store_handle_load_result(const OSSL_PARAM params[], void *arg)
      * The helper functions return 0 on actual errors, otherwise 1, even if
      * they didn't fill out |*v|.
      */
-    ERR_set_mark();
+    ossl_err_set_speculative_mark();
     if (*v == NULL && !try_name(&helper_data, v))
         goto err;
-    ERR_pop_to_mark();
-    ERR_set_mark();
+    ossl_err_pop_speculative_mark();
+    ossl_err_set_speculative_mark();
     if (*v == NULL && !try_key(&helper_data, v, ctx, provider, libctx, propq))
         goto err;
-    ERR_pop_to_mark();
-    ERR_set_mark();
+    ossl_err_pop_speculative_mark();
+    ossl_err_set_speculative_mark();
     if (*v == NULL && !try_cert(&helper_data, v, libctx, propq))
         goto err;
-    ERR_pop_to_mark();
-    ERR_set_mark();
+    ossl_err_pop_speculative_mark();
+    ossl_err_set_speculative_mark();
     if (*v == NULL && !try_crl(&helper_data, v, libctx, propq))
         goto err;
-    ERR_pop_to_mark();
-    ERR_set_mark();
+    ossl_err_pop_speculative_mark();
+    ossl_err_set_speculative_mark();
     if (*v == NULL && !try_pkcs12(&helper_data, v, ctx, libctx, propq))
         goto err;
-    ERR_pop_to_mark();
+    ossl_err_pop_speculative_mark();
 
     if (*v == NULL)
         ERR_raise(ERR_LIB_OSSL_STORE, ERR_R_UNSUPPORTED);
 
     return (*v != NULL);
  err:
-    ERR_clear_last_mark();
+    ossl_err_clear_speculative_mark();
     return 0;
 }
 
@@ -198,7 +199,7 @@ static EVP_PKEY *try_key_ref(struct extracted_param_data_st *data,
         return 0;
 
     keymgmt = EVP_KEYMGMT_fetch(libctx, data->data_type, propq);
-    ERR_set_mark();
+    ossl_err_set_speculative_mark();
     while (keymgmt != NULL && keydata == NULL && try_fallback-- > 0) {
         /*
          * There are two possible cases
@@ -240,16 +241,16 @@ static EVP_PKEY *try_key_ref(struct extracted_param_data_st *data,
             keymgmt = evp_keymgmt_fetch_from_prov((OSSL_PROVIDER *)provider,
                                                   data->data_type, propq);
             if (keymgmt != NULL) {
-                ERR_pop_to_mark();
-                ERR_set_mark();
+                ossl_err_pop_speculative_mark();
+                ossl_err_set_speculative_mark();
             }
         }
     }
     if (keydata != NULL) {
-        ERR_pop_to_mark();
+        ossl_err_pop_speculative_mark();
         pk = evp_keymgmt_util_make_pkey(keymgmt, keydata);
     } else {
-        ERR_clear_last_mark();
+        ossl_err_clear_speculative_mark();
     }
     EVP_KEYMGMT_free(keymgmt);
 
@@ -13,6 +13,7 @@
 
 # include <openssl/core.h>
 # include "internal/cryptlib.h"
+# include "internal/time.h"
 
 /* This file is not scanned by mkdef.pl, whereas cryptlib.h is */
 
@@ -30,6 +31,27 @@ void ossl_ctx_thread_stop(OSSL_LIB_CTX *ctx);
  */
 # define OPENSSL_INIT_BASE_ONLY              0x00040000L
 
+/*
+ * Timing of one-off initialisation work, reported through the INIT_PHASE
+ * trace category and OPENSSL_get_init_phase().  |name| and |detail| must
+ * stay valid until ossl_init_phase_end() is called.
+ */
+typedef struct ossl_init_phase_st {
+    const char *name;
+    const char *detail;
+    OSSL_TIME start;
+    int mallocs;
+} OSSL_INIT_PHASE;
+
+# ifndef FIPS_MODULE
+void ossl_init_phase_start(OSSL_INIT_PHASE *phase, const char *name,
+                           const char *detail);
+void ossl_init_phase_end(OSSL_INIT_PHASE *phase);
+# else
+#  define ossl_init_phase_start(phase, name, detail) ((void)(phase))
+#  define ossl_init_phase_end(phase) ((void)(phase))
+# endif
+
 void ossl_trace_cleanup(void);
 void ossl_malloc_setup_failures(void);
 
@@ -213,6 +213,7 @@ struct evp_mac_st {
     const char *description;
 
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_mac_newctx_fn *newctx;
     OSSL_FUNC_mac_dupctx_fn *dupctx;
@@ -234,6 +235,7 @@ struct evp_kdf_st {
     char *type_name;
     const char *description;
     CRYPTO_REF_COUNT refcnt;
+    int pinned;                 /* See ossl_provider_pin_method() */
 
     OSSL_FUNC_kdf_newctx_fn *newctx;
     OSSL_FUNC_kdf_dupctx_fn *dupctx;
@@ -251,6 +253,8 @@ struct evp_kdf_st {
 #define EVP_ORIG_DYNAMIC    0
 #define EVP_ORIG_GLOBAL     1
 #define EVP_ORIG_METH       2
+/* Provided, but owned by a pinned provider and not reference counted */
+#define EVP_ORIG_PINNED     3
 
 struct evp_md_st {
     /* nid */
@@ -44,6 +44,8 @@ int bread_conv(BIO *bio, char *data, size_t datal, size_t *read);
 # define BIO_CTRL_SET_KTLS_TX_SEND_CTRL_MSG     74
 # define BIO_CTRL_CLEAR_KTLS_TX_CTRL_MSG        75
 # define BIO_CTRL_SET_KTLS_TX_ZEROCOPY_SENDFILE 90
+# define BIO_CTRL_DGRAM_SET_GRO                 94
+# define BIO_CTRL_DGRAM_SET_ECN                 95
 
 /*
  * This is used with socket BIOs:
@@ -81,6 +83,35 @@ int bread_conv(BIO *bio, char *data, size_t datal, size_t *read);
 # define BIO_set_ktls_tx_zerocopy_sendfile(b) \
      BIO_ctrl(b, BIO_CTRL_SET_KTLS_TX_ZEROCOPY_SENDFILE, 0, NULL)
 
+/*
+ * UDP GRO support for datagram socket BIOs. Once enabled, a message returned
+ * by BIO_recvmmsg() may hold several datagrams received from the same peer,
+ * all of the segment size stored in the message flags except the last, which
+ * may be shorter. The segment size is zero if the message holds a single
+ * datagram. Receive buffers must be able to hold BIO_DGRAM_GRO_MAX_LEN bytes,
+ * or the datagrams are truncated.
+ */
+# define BIO_DGRAM_GRO_MAX_LEN          65535
+# define BIO_MSG_GRO_SEG_SHIFT          32
+# define BIO_MSG_GRO_SEG_LEN(flags)     \
+    ((size_t)(((flags) >> BIO_MSG_GRO_SEG_SHIFT) & 0xffff))
+
+# define BIO_dgram_set_gro(b, enable)   \
+     (int)BIO_ctrl(b, BIO_CTRL_DGRAM_SET_GRO, (enable), NULL)
+
+/*
+ * ECN support for datagram socket BIOs. Once enabled, the ECN codepoint in the
+ * low bits of the flags of a message passed to BIO_sendmmsg() is set in the IP
+ * header of the datagram sent, and the flags of a message returned by
+ * BIO_recvmmsg() hold the ECN codepoint of the datagram received. The codepoint
+ * is 0 (Not-ECT), 1 (ECT(1)), 2 (ECT(0)) or 3 (CE), as in the IP header.
+ */
+# define BIO_MSG_ECN_MASK               0x3
+# define BIO_MSG_ECN(flags)             ((uint32_t)((flags) & BIO_MSG_ECN_MASK))
+
+# define BIO_dgram_set_ecn(b, enable)   \
+     (int)BIO_ctrl(b, BIO_CTRL_DGRAM_SET_ECN, (enable), NULL)
+
 /* Functions to allow the core to offer the CORE_BIO type to providers */
 OSSL_CORE_BIO *ossl_core_bio_new_from_bio(BIO *bio);
 OSSL_CORE_BIO *ossl_core_bio_new_file(const char *filename, const char *mode);
@@ -13,4 +13,8 @@
 
 void err_free_strings_int(void);
 
+int ossl_err_set_speculative_mark(void);
+int ossl_err_pop_speculative_mark(void);
+int ossl_err_clear_speculative_mark(void);
+
 #endif
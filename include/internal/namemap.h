@@ -16,6 +16,7 @@ OSSL_NAMEMAP *ossl_namemap_stored(OSSL_LIB_CTX *libctx);
 OSSL_NAMEMAP *ossl_namemap_new(OSSL_LIB_CTX *libctx);
 void ossl_namemap_free(OSSL_NAMEMAP *namemap);
 int ossl_namemap_empty(OSSL_NAMEMAP *namemap);
+void ossl_namemap_cleanup_int(void);
 
 int ossl_namemap_add_name(OSSL_NAMEMAP *namemap, int number, const char *name);
 
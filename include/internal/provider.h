@@ -40,6 +40,17 @@ void ossl_provider_free(OSSL_PROVIDER *prov);
 int ossl_provider_set_module_path(OSSL_PROVIDER *prov, const char *module_path);
 
 int ossl_provider_is_child(const OSSL_PROVIDER *prov);
+
+/*
+ * Pinning: a pinned provider stays alive for the lifetime of its library
+ * context, and the methods created from it from then on are not reference
+ * counted.  ossl_provider_pin_method() returns 1 if |method| was handed over
+ * to the provider store, which will call |destruct| on it when the library
+ * context is freed, or 0 if the method should be reference counted as usual.
+ */
+int ossl_provider_pin(OSSL_PROVIDER *prov);
+int ossl_provider_pin_method(OSSL_PROVIDER *prov, void *method,
+                             void (*destruct)(void *));
 int ossl_provider_set_child(OSSL_PROVIDER *prov, const OSSL_CORE_HANDLE *handle);
 const OSSL_CORE_HANDLE *ossl_provider_get_parent(OSSL_PROVIDER *prov);
 int ossl_provider_up_ref_parent(OSSL_PROVIDER *prov, int activate);
@@ -54,6 +54,16 @@ int ossl_qlog_set_sink_file(QLOG *qlog, FILE *file, int close_flag);
 #  endif
 int ossl_qlog_set_sink_filename(QLOG *qlog, const char *filename);
 
+/*
+ * Output formats. The binary format buffers events in a ring of ring_size bytes
+ * (0 for the default) and can be converted to JSON-SEQ with
+ * ossl_qlog_bin_to_json(). The format must be set before the first event.
+ */
+#  define QLOG_FORMAT_JSON_SEQ  0
+#  define QLOG_FORMAT_BINARY    1
+
+int ossl_qlog_set_format(QLOG *qlog, uint32_t format, size_t ring_size);
+
 /* Operations */
 int ossl_qlog_flush(QLOG *qlog);
 
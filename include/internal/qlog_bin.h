@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_QLOG_BIN_H
+# define OSSL_QLOG_BIN_H
+
+# include <openssl/bio.h>
+# include "internal/time.h"
+
+/*
+ * Binary qlog Encoder
+ * ===================
+ *
+ * A compact binary encoding of qlog output, used where the cost of generating
+ * JSON for every event is too high (e.g. always-on telemetry). It records the
+ * same sequence of operations that would otherwise be passed to the JSON
+ * encoder, with key names and event names interned, so that the binary log can
+ * later be converted to the exact JSON-SEQ output qlog would have produced
+ * using ossl_qlog_bin_to_json().
+ *
+ * Events are held in a bounded in-memory ring buffer. If an event does not fit,
+ * the oldest events are discarded to make room for it. The buffered events are
+ * written to the sink when ossl_qlog_bin_flush() is called.
+ *
+ * The encoding is unstable and may change between OpenSSL versions.
+ */
+typedef struct qlog_bin_enc_st QLOG_BIN_ENC;
+
+/* Default size of the event ring buffer in bytes. */
+# define QLOG_BIN_DEFAULT_RING_SIZE     65536
+
+/* Creates a binary encoder with an event ring of ring_size bytes. */
+QLOG_BIN_ENC *ossl_qlog_bin_new(size_t ring_size);
+
+/* Frees the encoder. Buffered events which have not been flushed are lost. */
+void ossl_qlog_bin_free(QLOG_BIN_ENC *enc);
+
+/*
+ * Sets the sink BIO. The encoder does not take ownership of the BIO. The next
+ * flush to the new sink begins a new, self-contained binary qlog.
+ */
+void ossl_qlog_bin_set0_sink(QLOG_BIN_ENC *enc, BIO *bio);
+
+/*
+ * Writes all buffered data to the sink and empties the ring. Returns 1 on
+ * success. The output is a stream: each flush appends to the output of the
+ * previous flush.
+ */
+int ossl_qlog_bin_flush(QLOG_BIN_ENC *enc);
+
+/* Returns the number of events discarded because the ring was full. */
+uint64_t ossl_qlog_bin_get_num_dropped(const QLOG_BIN_ENC *enc);
+
+/*
+ * Records
+ * -------
+ *
+ * Every encoding operation must occur between a call to one of the begin
+ * functions and the corresponding end function.
+ *
+ * A header record contains a single top-level value which is retained outside
+ * of the ring, so that it is always written out before the first event.
+ *
+ * An event record contains the members of the "data" object of a qlog event.
+ * The event name and time are supplied separately, and the time of the event
+ * may be changed up until the event ends.
+ */
+void ossl_qlog_bin_header_begin(QLOG_BIN_ENC *enc);
+void ossl_qlog_bin_header_end(QLOG_BIN_ENC *enc);
+
+void ossl_qlog_bin_event_begin(QLOG_BIN_ENC *enc, const char *name);
+void ossl_qlog_bin_event_end(QLOG_BIN_ENC *enc, OSSL_TIME event_time);
+
+/* Value operations, corresponding to the equivalent ossl_json_* calls. */
+void ossl_qlog_bin_object_begin(QLOG_BIN_ENC *enc);
+void ossl_qlog_bin_object_end(QLOG_BIN_ENC *enc);
+void ossl_qlog_bin_array_begin(QLOG_BIN_ENC *enc);
+void ossl_qlog_bin_array_end(QLOG_BIN_ENC *enc);
+void ossl_qlog_bin_key(QLOG_BIN_ENC *enc, const char *key);
+void ossl_qlog_bin_bool(QLOG_BIN_ENC *enc, int value);
+void ossl_qlog_bin_u64(QLOG_BIN_ENC *enc, uint64_t value);
+void ossl_qlog_bin_i64(QLOG_BIN_ENC *enc, int64_t value);
+void ossl_qlog_bin_str_len(QLOG_BIN_ENC *enc, const char *str, size_t str_len);
+void ossl_qlog_bin_str_hex(QLOG_BIN_ENC *enc, const void *data,
+                           size_t data_len);
+
+/*
+ * Reads a binary qlog from in and writes the equivalent JSON-SEQ qlog to out.
+ * If num_dropped is not NULL, *num_dropped is set to the number of events which
+ * the writer discarded. Returns 1 on success and 0 if the input is malformed or
+ * an I/O error occurs.
+ */
+int ossl_qlog_bin_to_json(BIO *in, BIO *out, uint64_t *num_dropped);
+
+#endif
@@ -54,6 +54,13 @@ void ossl_ackm_set_rx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME rx_max_ack_delay)
  */
 void ossl_ackm_set_tx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME tx_max_ack_delay);
 
+/*
+ * Changes the congestion controller the ACKM reports to. This may only be
+ * called while no packets are in flight.
+ */
+void ossl_ackm_set_cc(OSSL_ACKM *ackm, const OSSL_CC_METHOD *cc_method,
+                      OSSL_CC_DATA *cc_data);
+
 typedef struct ossl_ackm_tx_pkt_st OSSL_ACKM_TX_PKT;
 struct ossl_ackm_tx_pkt_st {
     /* The packet number of the transmitted packet. */
@@ -104,6 +111,12 @@ struct ossl_ackm_tx_pkt_st {
     /* 1 if the packet is an MTU probe. */
     unsigned int is_mtu_probe :1;
 
+    /*
+     * One of the OSSL_ACKM_ECN_* values. This is the ECN codepoint the packet
+     * was sent with.
+     */
+    unsigned int ecn :2;
+
     /* Callback called if frames in this packet are lost. arg is cb_arg. */
     void (*on_lost)(void *arg);
     /* Callback called if frames in this packet are acked. arg is cb_arg. */
@@ -131,6 +144,7 @@ struct ossl_ackm_tx_pkt_st {
 int ossl_ackm_on_tx_packet(OSSL_ACKM *ackm, OSSL_ACKM_TX_PKT *pkt);
 int ossl_ackm_on_rx_datagram(OSSL_ACKM *ackm, size_t num_bytes);
 
+/* ECN codepoints. These have the same values as in the IP header. */
 #  define OSSL_ACKM_ECN_NONE      0
 #  define OSSL_ACKM_ECN_ECT1      1
 #  define OSSL_ACKM_ECN_ECT0      2
@@ -157,10 +171,23 @@ typedef struct ossl_ackm_rx_pkt_st {
      * the received packet. If unknown, use OSSL_ACKM_ECN_NONE.
      */
     unsigned int ecn :2;
+
+    /* 1 if the packet contained an IMMEDIATE_ACK frame. */
+    unsigned int is_immediate_ack :1;
 } OSSL_ACKM_RX_PKT;
 
 int ossl_ackm_on_rx_packet(OSSL_ACKM *ackm, const OSSL_ACKM_RX_PKT *pkt);
 
+/*
+ * Processes an ACK_FREQUENCY frame received from the peer, changing how often
+ * we acknowledge ACK-eliciting packets in the Application PN space. Frames
+ * with a sequence number lower than one already processed are ignored. The
+ * caller is responsible for validating the requested maximum ACK delay against
+ * the minimum ACK delay we advertised.
+ */
+void ossl_ackm_on_rx_ack_frequency(OSSL_ACKM *ackm,
+                                   const OSSL_QUIC_FRAME_ACK_FREQUENCY *f);
+
 int ossl_ackm_on_rx_ack_frame(OSSL_ACKM *ackm, const OSSL_QUIC_FRAME_ACK *ack,
                               int pkt_space, OSSL_TIME rx_time);
 
@@ -291,6 +318,37 @@ OSSL_TIME ossl_ackm_get_pto_duration(OSSL_ACKM *ackm);
 /* Returns the largest acked PN in the given PN space. */
 QUIC_PN ossl_ackm_get_largest_acked(OSSL_ACKM *ackm, int pkt_space);
 
+/*
+ * ECN validation (RFC 9000 s. 13.4.2). The ACKM checks the ECN counts in each
+ * ACK frame which newly acknowledges the largest acknowledged PN against the
+ * packets it acknowledges which were sent with an ECT codepoint. Its user
+ * decides from these statistics whether to keep sending ECT-marked packets.
+ */
+typedef struct ossl_ackm_ecn_stats_st {
+    /* Number of packets sent with an ECT codepoint. */
+    uint64_t    num_sent;
+
+    /* Number of those packets which have been acknowledged. */
+    uint64_t    num_acked;
+
+    /*
+     * Number of those packets which have been acknowledged by ACK frames with
+     * valid ECN counts.
+     */
+    uint64_t    num_validated;
+
+    /*
+     * Number of those packets which have been declared lost or discarded
+     * without being acknowledged.
+     */
+    uint64_t    num_lost;
+
+    /* 1 if an ACK frame has failed ECN validation. */
+    int         failed;
+} OSSL_ACKM_ECN_STATS;
+
+void ossl_ackm_get_ecn_stats(OSSL_ACKM *ackm, OSSL_ACKM_ECN_STATS *stats);
+
 # endif
 
 #endif
@@ -37,11 +37,22 @@ typedef struct ossl_cc_ecn_info_st {
      * sent.
      */
     OSSL_TIME   largest_acked_time;
+
+    /* The increase in the ECN-CE count reported by the peer. */
+    uint64_t    num_ce;
 } OSSL_CC_ECN_INFO;
 
 /* Parameter (read-write): Maximum datagram payload length in bytes. */
 #define OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN        "max_dgram_payload_len"
 
+/*
+ * Parameter (read-write): 1 if the congestion controller should respond to
+ * ECN-CE marks in proportion to their extent (as for L4S, RFC 9331) rather
+ * than as it would to loss. Ignored by congestion controllers which do not
+ * support it.
+ */
+#define OSSL_CC_OPTION_ECN_SCALABLE                 "ecn_scalable"
+
 /* Diagnostic (read-only): current congestion window size in bytes. */
 #define OSSL_CC_OPTION_CUR_CWND_SIZE                "cur_cwnd_size"
 
@@ -148,6 +159,22 @@ struct ossl_cc_method_st {
      */
     OSSL_TIME (*get_wakeup_deadline)(OSSL_CC_DATA *ccdata);
 
+    /*
+     * Returns the rate in bytes per second at which packets should be paced
+     * onto the network, given the current smoothed RTT. Returns 0 if the
+     * congestion controller does not want packets to be paced.
+     */
+    uint64_t (*get_pacing_rate)(OSSL_CC_DATA *ccdata, OSSL_TIME srtt);
+
+    /*
+     * Returns the number of ACK-eliciting packets the peer should be allowed to
+     * receive before it must send an ACK, for use with the ACK frequency
+     * extension. 1 corresponds to the RFC 9000 default of acknowledging every
+     * second packet; larger values reduce ACK overhead at the expense of a
+     * coarser ACK clock.
+     */
+    uint64_t (*get_ack_eliciting_threshold)(OSSL_CC_DATA *ccdata);
+
     /*
      * The On Data Sent event. num_bytes should be the size of the packet in
      * bytes (or the aggregate size of multiple packets which have just been
@@ -212,6 +239,52 @@ struct ossl_cc_method_st {
 
 extern const OSSL_CC_METHOD ossl_cc_dummy_method;
 extern const OSSL_CC_METHOD ossl_cc_newreno_method;
+extern const OSSL_CC_METHOD ossl_cc_cubic_method;
+extern const OSSL_CC_METHOD ossl_cc_bbr_method;
+
+/*
+ * Diagnostic output locations common to all of our congestion controllers,
+ * for use by OSSL_CC_METHOD implementations.
+ */
+typedef struct ossl_cc_diag_st {
+    size_t      *p_max_dgram_payload_len;
+    uint64_t    *p_cur_cwnd_size;
+    uint64_t    *p_min_cwnd_size;
+    uint64_t    *p_cur_bytes_in_flight;
+    uint32_t    *p_cur_state;
+} OSSL_CC_DIAG;
+
+/*
+ * Implements bind_diagnostics and unbind_diagnostics for the parameters in
+ * OSSL_CC_DIAG. Returns 1 on success and 0 on failure.
+ */
+int ossl_cc_diag_bind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+int ossl_cc_diag_unbind(OSSL_CC_DIAG *diag, OSSL_PARAM *params);
+
+/* Writes the given values to the bound output locations, if any. */
+void ossl_cc_diag_update(const OSSL_CC_DIAG *diag, size_t max_dgram_size,
+                         uint64_t cwnd, uint64_t min_cwnd,
+                         uint64_t bytes_in_flight, uint32_t state);
+
+/*
+ * Computes a pacing rate in bytes per second for a window-based congestion
+ * controller from its congestion window and the smoothed RTT. The window is
+ * scaled by 2 in slow start and by 5/4 otherwise so that the pacer never
+ * becomes the limiting factor (RFC 9002 s. 7.7). Returns 0 if srtt is not
+ * yet known.
+ */
+uint64_t ossl_cc_window_pacing_rate(uint64_t cwnd, OSSL_TIME srtt,
+                                    int in_slow_start);
+
+/*
+ * Computes an ACK-eliciting threshold for a window-based congestion controller
+ * so that about four ACKs are received per congestion window, but at least one
+ * for every ten datagrams. In slow start, window growth depends on a prompt ACK
+ * clock, so the RFC 9000 default of 1 is used.
+ */
+uint64_t ossl_cc_window_ack_eliciting_threshold(uint64_t cwnd,
+                                                size_t max_dgram_size,
+                                                int in_slow_start);
 
 # endif
 
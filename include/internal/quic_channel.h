@@ -125,8 +125,31 @@ typedef struct quic_channel_args_st {
 
     /* Title to use for the qlog session, or NULL. */
     const char      *qlog_title;
+
+    /* Congestion controller to use, or NULL to use NewReno. */
+    const OSSL_CC_METHOD *cc_method;
+
+    /* ECN mode to use (QUIC_ECN_MODE_*). */
+    uint32_t        ecn_mode;
 } QUIC_CHANNEL_ARGS;
 
+/*
+ * ECN modes. In the classic mode, packets are sent with ECT(0) and CE marks are
+ * treated like loss. In the scalable mode (L4S, RFC 9331), packets are sent
+ * with ECT(1) and the congestion controller responds in proportion to the
+ * extent of marking, if it supports this.
+ */
+#  define QUIC_ECN_MODE_OFF             0
+#  define QUIC_ECN_MODE_CLASSIC         1
+#  define QUIC_ECN_MODE_SCALABLE        2
+
+/* ECN validation states (RFC 9000 s. A.4). */
+#  define QUIC_ECN_STATE_DISABLED       0
+#  define QUIC_ECN_STATE_TESTING        1
+#  define QUIC_ECN_STATE_UNKNOWN        2
+#  define QUIC_ECN_STATE_CAPABLE        3
+#  define QUIC_ECN_STATE_FAILED         4
+
 /* Represents the cause for a connection's termination. */
 typedef struct quic_terminate_cause_st {
     /*
@@ -270,11 +293,24 @@ void ossl_quic_channel_on_remote_conn_close(QUIC_CHANNEL *ch,
 void ossl_quic_channel_on_new_conn_id(QUIC_CHANNEL *ch,
                                       OSSL_QUIC_FRAME_NEW_CONN_ID *f);
 
+void ossl_quic_channel_on_new_token(QUIC_CHANNEL *ch,
+                                    const unsigned char *token,
+                                    size_t token_len);
+
 /* Temporarily exposed during QUIC_PORT transition. */
 int ossl_quic_channel_on_new_conn(QUIC_CHANNEL *ch, const BIO_ADDR *peer,
                                   const QUIC_CONN_ID *peer_scid,
                                   const QUIC_CONN_ID *peer_dcid);
 
+/*
+ * Called on a server when the client's address has been validated (RFC 9000 s.
+ * 8.1), lifting the anti-amplification limit.
+ */
+void ossl_quic_channel_on_addr_validated(QUIC_CHANNEL *ch);
+
+/* Returns 1 if the peer's address has been validated. */
+int ossl_quic_channel_is_addr_validated(const QUIC_CHANNEL *ch);
+
 /* For use by QUIC_PORT. You should not need to call this directly. */
 void ossl_quic_channel_subtick(QUIC_CHANNEL *ch, QUIC_TICK_RESULT *r,
                                uint32_t flags);
@@ -282,6 +318,14 @@ void ossl_quic_channel_subtick(QUIC_CHANNEL *ch, QUIC_TICK_RESULT *r,
 /* For use by QUIC_PORT only. */
 void ossl_quic_channel_raise_net_error(QUIC_CHANNEL *ch);
 
+/*
+ * Ensures the channel is ticked on the next tick of its port. The port only
+ * ticks channels which are due, so this must be called whenever the channel
+ * has been used other than from its own tick (e.g. by the application) before
+ * the reactor is next ticked.
+ */
+void ossl_quic_channel_schedule_tick(QUIC_CHANNEL *ch);
+
 /* For use by QUIC_PORT only. */
 void ossl_quic_channel_on_stateless_reset(QUIC_CHANNEL *ch);
 
@@ -445,6 +489,39 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_peer_request(const QUIC_CHANNEL
 /* Get the idle timeout actually negotiated. */
 uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch);
 
+/*
+ * Replaces the congestion controller. This is only possible until the first
+ * packet has been sent. Returns 1 on success.
+ */
+int ossl_quic_channel_set_cc_method(QUIC_CHANNEL *ch,
+                                    const OSSL_CC_METHOD *cc_method);
+const OSSL_CC_METHOD *ossl_quic_channel_get_cc_method(const QUIC_CHANNEL *ch);
+
+/*
+ * Sets the ECN mode (QUIC_ECN_MODE_*). This is only possible until the first
+ * packet has been sent. Returns 1 on success.
+ */
+int ossl_quic_channel_set_ecn_mode(QUIC_CHANNEL *ch, uint32_t ecn_mode);
+uint32_t ossl_quic_channel_get_ecn_mode(const QUIC_CHANNEL *ch);
+
+/*
+ * Returns the ECN validation state of the path (QUIC_ECN_STATE_*). ECN-marked
+ * packets are only sent in the TESTING and CAPABLE states.
+ */
+uint32_t ossl_quic_channel_get_ecn_state(const QUIC_CHANNEL *ch);
+
+/*
+ * Enables or disables the sending of 0-RTT data if the session being resumed
+ * permits it (client only). Must be called before the channel is started.
+ */
+void ossl_quic_channel_set_early_data_enabled(QUIC_CHANNEL *ch, int enabled);
+
+/*
+ * Returns 1 if the handshake is in progress and application data may be sent
+ * in 0-RTT packets.
+ */
+int ossl_quic_channel_can_send_early_data(const QUIC_CHANNEL *ch);
+
 # endif
 
 #endif
@@ -81,6 +81,13 @@
  * list to a pending list and vice versa). The buffer into which datagrams are
  * received immediately follows this URXE header structure and is part of the
  * same allocation.
+ *
+ * If the network BIO supports UDP GRO, the demuxer instead receives up to 64KB
+ * of datagrams from the same peer into a single large URXE. These are then
+ * split into several URXEs without copying: the first datagram stays in the
+ * large URXE, and each of the others is issued in a URXE whose data points into
+ * the buffer of the large URXE. The large URXE is only returned to the free
+ * list once all of these have been released.
  */
 
 /* Maximum number of packets we allow to exist in one datagram. */
@@ -90,15 +97,25 @@ struct quic_urxe_st {
     OSSL_LIST_MEMBER(urxe, QUIC_URXE);
 
     /*
-     * The URXE data starts after this structure so we don't need a pointer.
-     * data_len stores the current length (i.e., the length of the received
-     * datagram) and alloc_len stores the allocation length. The URXE will be
-     * reallocated if we need a larger allocation than is available, though this
-     * should not be common as we will have a good idea of worst-case MTUs up
-     * front.
+     * The URXE data starts after this structure unless data is non-NULL, so we
+     * usually don't need a pointer. data_len stores the current length (i.e.,
+     * the length of the received datagram) and alloc_len stores the allocation
+     * length. The URXE will be reallocated if we need a larger allocation than
+     * is available, though this should not be common as we will have a good
+     * idea of worst-case MTUs up front.
      */
     size_t          data_len, alloc_len;
 
+    /*
+     * For a datagram split from a GRO receive, data points into the buffer of
+     * data_owner, which holds the first datagram of the receive. data_refs is
+     * the number of such URXEs referring to the buffer of this URXE which have
+     * not been released yet. Used by the demuxer only.
+     */
+    unsigned char  *data;
+    QUIC_URXE      *data_owner;
+    size_t          data_refs;
+
     /*
      * Bitfields per packet. processed indicates the packet has been processed
      * and must not be processed again, hpr_removed indicates header protection
@@ -125,6 +142,12 @@ struct quic_urxe_st {
      */
     OSSL_TIME       time;
 
+    /*
+     * ECN codepoint the datagram was received with (one of the OSSL_ACKM_ECN_*
+     * values), or 0 (Not-ECT) if not known.
+     */
+    unsigned char   ecn;
+
     /*
      * Used by the QRX to mark whether a datagram has been deferred. Used by the
      * QRX only; not used by the demuxer.
@@ -142,7 +165,7 @@ struct quic_urxe_st {
 static ossl_unused ossl_inline unsigned char *
 ossl_quic_urxe_data(const QUIC_URXE *e)
 {
-    return (unsigned char *)&e[1];
+    return e->data != NULL ? e->data : (unsigned char *)&e[1];
 }
 
 static ossl_unused ossl_inline unsigned char *
@@ -208,7 +231,7 @@ void ossl_quic_demux_free(QUIC_DEMUX *demux);
 
 /*
  * Changes the BIO which the demuxer reads from. This also sets the MTU if the
- * BIO supports querying the MTU.
+ * BIO supports querying the MTU, and enables UDP GRO if the BIO supports it.
  */
 void ossl_quic_demux_set_bio(QUIC_DEMUX *demux, BIO *net_bio);
 
@@ -111,6 +111,23 @@ void ossl_quic_lcidm_free(QUIC_LCIDM *lcidm);
 /* Gets the local CID length this LCIDM was configured to use. */
 size_t ossl_quic_lcidm_get_lcid_len(const QUIC_LCIDM *lcidm);
 
+/*
+ * Sets a shard ID between 0 and QUIC_LCID_MAX_SHARD, which is encoded in the
+ * first byte of all LCIDs generated from now on. This allows a server running
+ * several ports on the same UDP address to route a packet to the port which
+ * issued its DCID. The remaining bytes of an LCID are still random. A shard ID
+ * of -1 disables this. Fails if the LCIDM uses zero-length LCIDs.
+ */
+# define QUIC_LCID_MAX_SHARD    255
+int ossl_quic_lcidm_set_shard(QUIC_LCIDM *lcidm, int shard_id);
+
+/* Gets the shard ID encoded in a non-empty LCID. */
+static ossl_unused ossl_inline int
+ossl_quic_lcid_get_shard(const QUIC_CONN_ID *lcid)
+{
+    return lcid->id[0];
+}
+
 /*
  * Determines the number of active LCIDs (i.e,. LCIDs which can be used for
  * reception) currently associated with the given opaque pointer.
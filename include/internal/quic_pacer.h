@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_QUIC_PACER_H
+# define OSSL_QUIC_PACER_H
+
+# include <openssl/ssl.h>
+# include "internal/time.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * QUIC Pacer
+ * ==========
+ *
+ * A token bucket which spreads the transmission of packets over time at a given
+ * rate (RFC 9002 s. 7.7), rather than sending everything the congestion window
+ * allows in one burst. Tokens (bytes) accumulate at the pacing rate up to a
+ * maximum burst size, and a packet may be sent whenever the bucket is not
+ * empty. Sending a packet may overdraw the bucket, in which case the next
+ * packet has to wait until the debt has been paid off.
+ *
+ * A rate of 0 disables pacing.
+ */
+typedef struct quic_pacer_st QUIC_PACER;
+
+struct quic_pacer_st {
+    uint64_t    rate;           /* Bytes per second, or 0 */
+    uint64_t    burst;          /* Bucket size in bytes */
+    int64_t     tokens;         /* Bytes we may send now; negative if in debt */
+    OSSL_TIME   last_update;
+};
+
+/* Initialises a pacer with pacing disabled. */
+void ossl_quic_pacer_init(QUIC_PACER *pacer);
+
+/*
+ * Sets the pacing rate in bytes per second (0 to disable pacing) and the
+ * maximum burst size in bytes. Tokens accumulated at the previous rate up to
+ * now are retained.
+ */
+void ossl_quic_pacer_set_rate(QUIC_PACER *pacer, uint64_t rate, uint64_t burst,
+                              OSSL_TIME now);
+
+/* Returns 1 if the pacer permits a packet to be sent at time now. */
+int ossl_quic_pacer_can_send(QUIC_PACER *pacer, OSSL_TIME now);
+
+/* Informs the pacer that num_bytes have been sent. */
+void ossl_quic_pacer_on_sent(QUIC_PACER *pacer, uint64_t num_bytes);
+
+/*
+ * Returns the time at which the pacer will next permit a packet to be sent.
+ * This is ossl_time_zero() if a packet may be sent immediately.
+ */
+OSSL_TIME ossl_quic_pacer_get_deadline(const QUIC_PACER *pacer);
+
+# endif
+
+#endif
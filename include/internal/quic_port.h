@@ -28,8 +28,10 @@
  * QUIC_PORT.
  *
  * A QUIC port is responsible for managing a set of channels which all use the
- * same UDP socket, and (in future) for automatically creating new channels when
- * incoming connections are received.
+ * same UDP socket, and for automatically creating new channels when incoming
+ * connections are received, if this has been enabled using
+ * ossl_quic_port_set_allow_incoming(). Such channels are held on an incoming
+ * queue until they are popped using ossl_quic_port_pop_incoming().
  *
  * In order to retain compatibility with QUIC_TSERVER, it also supports a point
  * of legacy compatibility where a caller can create an incoming (server role)
@@ -54,6 +56,15 @@ typedef struct quic_port_args_st {
      * for a single connection, so a zero-length local CID can be used.
      */
     int             is_multi_conn;
+
+    /*
+     * Optional callback invoked when a new channel has been created for an
+     * incoming connection, before it is placed on the incoming queue. If the
+     * callback returns 0, the channel is freed and the connection attempt is
+     * ignored.
+     */
+    int             (*new_incoming_cb)(QUIC_CHANNEL *ch, void *arg);
+    void            *new_incoming_cb_arg;
 } QUIC_PORT_ARGS;
 
 /* Only QUIC_ENGINE should use this function. */
@@ -76,6 +87,52 @@ QUIC_CHANNEL *ossl_quic_port_create_outgoing(QUIC_PORT *port, SSL *tls);
  */
 QUIC_CHANNEL *ossl_quic_port_create_incoming(QUIC_PORT *port, SSL *tls);
 
+/*
+ * Sets whether new channels are created automatically for incoming connection
+ * attempts. Enabling this makes the port act as a server.
+ */
+void ossl_quic_port_set_allow_incoming(QUIC_PORT *port, int allow_incoming);
+
+/*
+ * Pops the oldest channel from the incoming queue, or returns NULL if the queue
+ * is empty. The caller becomes responsible for freeing the channel.
+ */
+QUIC_CHANNEL *ossl_quic_port_pop_incoming(QUIC_PORT *port);
+
+/* Returns 1 if there is at least one channel on the incoming queue. */
+int ossl_quic_port_have_incoming(QUIC_PORT *port);
+
+/* Returns the number of channels on the incoming queue. */
+size_t ossl_quic_port_get_num_incoming_channels(const QUIC_PORT *port);
+
+/*
+ * Makes the port a member of a shard group (see internal/quic_shard.h). The
+ * port allocates a shard ID in the group and encodes it in every LCID it issues
+ * from now on, and the port takes a reference to the group. Datagrams for an
+ * unknown short DCID carrying the shard ID of another member are forwarded to
+ * that member instead of being dropped. This must be called before any
+ * channels are created on the port, and at most once.
+ */
+int ossl_quic_port_join_shard_group(QUIC_PORT *port, QUIC_SHARD_GROUP *grp);
+
+/* Returns the shard group of the port, or NULL if it is not a member. */
+QUIC_SHARD_GROUP *ossl_quic_port_get0_shard_group(const QUIC_PORT *port);
+
+/* Returns the shard ID of the port, or -1 if it is not in a shard group. */
+int ossl_quic_port_get_shard_id(const QUIC_PORT *port);
+
+/*
+ * Sets the congestion controller used by channels created on the port from
+ * now on. NULL selects the default.
+ */
+void ossl_quic_port_set_cc_method(QUIC_PORT *port,
+                                  const OSSL_CC_METHOD *cc_method);
+const OSSL_CC_METHOD *ossl_quic_port_get_cc_method(const QUIC_PORT *port);
+
+/* Sets the ECN mode (QUIC_ECN_MODE_*) used by channels created from now on. */
+void ossl_quic_port_set_ecn_mode(QUIC_PORT *port, uint32_t ecn_mode);
+uint32_t ossl_quic_port_get_ecn_mode(const QUIC_PORT *port);
+
 /*
  * Queries and Accessors
  * =====================
@@ -108,6 +165,14 @@ CRYPTO_MUTEX *ossl_quic_port_get0_mutex(QUIC_PORT *port);
 /* Gets the current time. */
 OSSL_TIME ossl_quic_port_get_time(QUIC_PORT *port);
 
+/*
+ * Generates an address validation token for the client at peer, to be sent in
+ * a NEW_TOKEN frame. QUIC_TOKEN_LEN bytes are written to buf. Tokens are only
+ * accepted by the port which issued them.
+ */
+int ossl_quic_port_generate_token(QUIC_PORT *port, const BIO_ADDR *peer,
+                                  unsigned char *buf);
+
 int ossl_quic_port_get_rx_short_dcid_len(const QUIC_PORT *port);
 int ossl_quic_port_get_tx_init_dcid_len(const QUIC_PORT *port);
 
@@ -124,6 +189,13 @@ void ossl_quic_port_restore_err_state(const QUIC_PORT *port);
 void ossl_quic_port_subtick(QUIC_PORT *port, QUIC_TICK_RESULT *r,
                             uint32_t flags);
 
+/*
+ * For use by QUIC_CHANNEL only. Ensures the channel is ticked on the next tick
+ * of the port, or removes the channel from the port's tick schedule.
+ */
+void ossl_quic_port_schedule_channel(QUIC_PORT *port, QUIC_CHANNEL *ch);
+void ossl_quic_port_unschedule_channel(QUIC_PORT *port, QUIC_CHANNEL *ch);
+
 /*
  * Events
  * ======
@@ -37,6 +37,9 @@ typedef struct quic_srtm_st QUIC_SRTM;
 typedef struct quic_lcidm_st QUIC_LCIDM;
 typedef struct quic_urxe_st QUIC_URXE;
 typedef struct quic_engine_st QUIC_ENGINE;
+typedef struct quic_shard_group_st QUIC_SHARD_GROUP;
+typedef struct quic_token_key_st QUIC_TOKEN_KEY;
+typedef struct quic_token_store_st QUIC_TOKEN_STORE;
 
 # endif
 
@@ -46,6 +46,12 @@ typedef struct ossl_qrx_args_st {
 
     /* Initial key phase. For debugging use only; always 0 in real use. */
     unsigned char   init_key_phase_bit;
+
+    /*
+     * Whether 0-RTT packets may be received. Only a server may receive them;
+     * a client QRX discards them without further processing.
+     */
+    unsigned char   allow_0rtt;
 } OSSL_QRX_ARGS;
 
 /* Instantiates a new QRX. */
@@ -217,6 +223,12 @@ struct ossl_qrx_pkt_st {
      */
     OSSL_TIME           time;
 
+    /*
+     * ECN codepoint of the datagram which contained this packet, as one of the
+     * OSSL_ACKM_ECN_* values.
+     */
+    uint32_t            ecn;
+
     /* The QRX which was used to receive the packet. */
     OSSL_QRX            *qrx;
 
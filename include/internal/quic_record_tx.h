@@ -186,6 +186,14 @@ struct ossl_qtx_pkt_st {
 
     /* Packet flags. Zero or more OSSL_QTX_PKT_FLAG_* values. */
     uint32_t                    flags;
+
+    /*
+     * ECN codepoint to send the packet with, as one of the OSSL_ACKM_ECN_*
+     * values. A datagram is sent with the codepoint of its packets, so packets
+     * with different codepoints are never coalesced. The codepoint is only
+     * applied if ossl_qtx_is_ecn_supported() returns 1.
+     */
+    uint32_t                    ecn;
 };
 
 /*
@@ -307,6 +315,12 @@ size_t ossl_qtx_get_unflushed_pkt_count(OSSL_QTX *qtx);
  */
 void ossl_qtx_set_bio(OSSL_QTX *qtx, BIO *bio);
 
+/*
+ * Returns 1 if the BIO being used by the QTX sets the ECN codepoint of the
+ * datagrams it sends.
+ */
+int ossl_qtx_is_ecn_supported(OSSL_QTX *qtx);
+
 /* Changes the MDPL. */
 int ossl_qtx_set_mdpl(OSSL_QTX *qtx, size_t mdpl);
 
@@ -12,6 +12,7 @@
 
 #include "internal/common.h"
 #include "internal/uint_set.h"
+#include "internal/uint_tree.h"
 #include "internal/quic_record_rx.h"
 
 /*
@@ -23,7 +24,7 @@
  * the ranges in the list.
  *
  * Operations:
- *   Insert frame (optimized insertion at the beginning and at the end).
+ *   Insert frame (optimized insertion at the end, O(log n) elsewhere).
  *   Iterated peek into the frame(s) from the beginning.
  *   Dropping frames from the beginning up to an offset (exclusive).
  *
@@ -41,6 +42,8 @@ typedef struct stream_frame_st STREAM_FRAME;
 
 typedef struct sframe_list_st {
     STREAM_FRAME  *head, *tail;
+    /* Index of the frames by range.start. */
+    UINT_TREE index;
     /* Is the tail frame final. */
     unsigned int fin;
     /* Number of stream frames in the list. */
@@ -123,6 +126,22 @@ int ossl_sframe_list_lock_head(SFRAME_LIST *fl, UINT_RANGE *range,
  */
 int ossl_sframe_list_is_head_locked(SFRAME_LIST *fl);
 
+/*
+ * Removes the head frame of fl if it is readable and its data is still held
+ * in the packet it was received in, transferring the reference to that packet
+ * to the caller.
+ * range is set to encompass the not yet read part of the head frame and
+ * data to the corresponding data, which remains valid until the caller
+ * releases *pkt. fin is set to 1 if the head frame is also the tail frame.
+ * The data is not cleansed even if cleansing is enabled; this is then the
+ * responsibility of the caller.
+ * Returns 1 on success, 0 if there is no readable data, the head frame is
+ * locked, or its data has been moved to side storage.
+ */
+int ossl_sframe_list_take_head(SFRAME_LIST *fl, UINT_RANGE *range,
+                               const unsigned char **data,
+                               OSSL_QRX_PKT **pkt, int *fin);
+
 /*
  * Callback function type to write stream frame data to some
  * side storage before the packet containing the frame data
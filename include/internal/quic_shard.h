@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_INTERNAL_QUIC_SHARD_H
+# define OSSL_INTERNAL_QUIC_SHARD_H
+# pragma once
+
+# include <openssl/bio.h>
+# include "internal/quic_predef.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * QUIC Shard Group
+ * ================
+ *
+ * A shard group links together several QUIC_PORTs which receive datagrams for
+ * the same UDP address, typically one per thread on sockets bound with
+ * SO_REUSEPORT. The kernel distributes incoming datagrams between such sockets
+ * by hashing the 4-tuple, so a datagram can arrive at a port other than the
+ * one which owns the connection after the peer rebinds or migrates.
+ *
+ * Each port joining a group is assigned a shard ID, which its LCIDM encodes in
+ * every LCID it issues (see ossl_quic_lcidm_set_shard()). A port receiving a
+ * datagram for an unknown DCID can then use the shard ID to forward a copy of
+ * the datagram into the mailbox of the owning port. The owning port drains its
+ * mailbox into its demuxer at the start of each tick.
+ *
+ * All functions may be called concurrently from different threads. The
+ * callback passed to ossl_quic_shard_group_drain() is called without any lock
+ * held.
+ */
+
+/* Creates a new empty shard group with a reference count of 1. */
+QUIC_SHARD_GROUP *ossl_quic_shard_group_new(void);
+
+/* Increments the reference count of a shard group. */
+int ossl_quic_shard_group_up_ref(QUIC_SHARD_GROUP *grp);
+
+/*
+ * Decrements the reference count of a shard group, freeing it and any queued
+ * datagrams if it reaches zero. grp may be NULL.
+ */
+void ossl_quic_shard_group_free(QUIC_SHARD_GROUP *grp);
+
+/*
+ * Allocates a shard ID in the group. Returns the shard ID, or -1 if all shard
+ * IDs are in use.
+ */
+int ossl_quic_shard_group_join(QUIC_SHARD_GROUP *grp);
+
+/*
+ * Releases a shard ID previously allocated with ossl_quic_shard_group_join().
+ * Any datagrams queued for it are discarded.
+ */
+void ossl_quic_shard_group_leave(QUIC_SHARD_GROUP *grp, int shard_id);
+
+/*
+ * Copies a datagram into the mailbox of the given shard. peer and local may be
+ * NULL. Returns 1 on success, or 0 if the shard ID is not in use, its mailbox
+ * is full or allocation fails; the datagram should be dropped in this case.
+ */
+int ossl_quic_shard_group_forward(QUIC_SHARD_GROUP *grp, int shard_id,
+                                  const unsigned char *data, size_t data_len,
+                                  const BIO_ADDR *peer, const BIO_ADDR *local);
+
+/*
+ * Removes all datagrams from the mailbox of the given shard and calls cb for
+ * each of them in the order they were forwarded. Returns the number of
+ * datagrams drained.
+ */
+typedef void (ossl_quic_shard_dgram_cb)(const unsigned char *data,
+                                        size_t data_len,
+                                        const BIO_ADDR *peer,
+                                        const BIO_ADDR *local,
+                                        void *arg);
+
+size_t ossl_quic_shard_group_drain(QUIC_SHARD_GROUP *grp, int shard_id,
+                                   ossl_quic_shard_dgram_cb *cb, void *arg);
+
+# endif
+
+#endif
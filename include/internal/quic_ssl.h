@@ -28,9 +28,16 @@ __owur int ossl_quic_accept(SSL *s);
 __owur int ossl_quic_connect(SSL *s);
 __owur int ossl_quic_read(SSL *s, void *buf, size_t len, size_t *readbytes);
 __owur int ossl_quic_peek(SSL *s, void *buf, size_t len, size_t *readbytes);
+__owur int ossl_quic_read_buffer(SSL *s, const unsigned char **buf,
+                                 size_t *buf_len);
+int ossl_quic_release_read_buffer(SSL *s, const unsigned char *buf);
 __owur int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
                                  uint64_t flags, size_t *written);
 __owur int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written);
+__owur int ossl_quic_write_buffer(SSL *s, const void *buf, size_t len,
+                                  uint64_t flags,
+                                  SSL_buffer_release_cb_fn release_cb,
+                                  void *release_arg);
 __owur long ossl_quic_ctrl(SSL *s, int cmd, long larg, void *parg);
 __owur long ossl_quic_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg);
 __owur long ossl_quic_callback_ctrl(SSL *s, int cmd, void (*fp) (void));
@@ -45,6 +52,7 @@ int ossl_quic_renegotiate_check(SSL *ssl, int initok);
 
 typedef struct quic_conn_st QUIC_CONNECTION;
 typedef struct quic_xso_st QUIC_XSO;
+typedef struct quic_listener_st QUIC_LISTENER;
 
 int ossl_quic_do_handshake(SSL *s);
 void ossl_quic_set_connect_state(SSL *s);
@@ -73,6 +81,7 @@ BIO *ossl_quic_conn_get_net_rbio(const SSL *s);
 BIO *ossl_quic_conn_get_net_wbio(const SSL *s);
 __owur int ossl_quic_conn_set_initial_peer_addr(SSL *s,
                                                 const BIO_ADDR *peer_addr);
+__owur int ossl_quic_set_early_data_enabled(SSL *s, int enabled);
 __owur SSL *ossl_quic_conn_stream_new(SSL *s, uint64_t flags);
 __owur SSL *ossl_quic_get0_connection(SSL *s);
 __owur int ossl_quic_get_stream_type(SSL *s);
@@ -85,6 +94,12 @@ __owur int ossl_quic_set_incoming_stream_policy(SSL *s, int policy,
                                                 uint64_t aec);
 __owur SSL *ossl_quic_accept_stream(SSL *s, uint64_t flags);
 __owur size_t ossl_quic_get_accept_stream_queue_len(SSL *s);
+__owur SSL *ossl_quic_new_listener(SSL_CTX *ctx, uint64_t flags);
+__owur SSL *ossl_quic_new_listener_shard(SSL *ssl, uint64_t flags);
+__owur int ossl_quic_listen(SSL *ssl);
+__owur SSL *ossl_quic_accept_connection(SSL *ssl, uint64_t flags);
+__owur size_t ossl_quic_get_accept_connection_queue_len(SSL *ssl);
+__owur SSL *ossl_quic_get0_listener(SSL *s);
 __owur int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
                                     uint64_t *value);
 __owur int ossl_quic_set_value_uint(SSL *s, uint32_t class_, uint32_t id,
@@ -145,6 +160,9 @@ int ossl_quic_set_diag_title(SSL_CTX *ctx, const char *title);
 /* APIs used by the polling infrastructure */
 int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
                                uint64_t *revents);
+int ossl_quic_conn_poll_wait_info(SSL *ssl, int *rfd, int *want_r,
+                                  int *wfd, int *want_w,
+                                  OSSL_TIME *deadline, int *can_poll);
 
 # endif
 
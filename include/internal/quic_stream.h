@@ -90,8 +90,10 @@ void ossl_quic_sstream_free(QUIC_SSTREAM *qss);
  * which have been written.
  *
  * The stream data may be split across up to two IOVs due to internal ring
- * buffer organisation. The sum of the lengths of the IOVs and the value written
- * to hdr->len will always match. If the caller decides to send less than
+ * buffer organisation, and across further IOVs if it spans data appended by
+ * reference. No more than *num_iov IOVs are used; hdr->len is reduced if the
+ * data would need more. The sum of the lengths of the IOVs and the value
+ * written to hdr->len will always match. If the caller decides to send less than
  * hdr->len of stream data, it must adjust the IOVs accordingly. This may be
  * done by updating hdr->len and then calling the utility function
  * ossl_quic_sstream_adjust_iov().
@@ -115,8 +117,7 @@ void ossl_quic_sstream_free(QUIC_SSTREAM *qss);
  * available stream frames and batch their calls to ossl_quic_sstream_mark_transmitted at
  * a later time.
  *
- * On success, this function will never write *num_iov with a value other than
- * 0, 1 or 2. A *num_iov value of 0 can only occurs when hdr->is_fin is set (for
+ * A *num_iov value of 0 can only occurs when hdr->is_fin is set (for
  * example, when a stream is closed after all existing data has been sent, and
  * without sending any more data); otherwise the function returns 0 as there is
  * nothing useful to report.
@@ -241,6 +242,24 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
                              size_t buf_len,
                              size_t *consumed);
 
+/*
+ * (Front end use.) Appends user data to the stream by reference. The data is
+ * not copied; the caller must keep buf valid and unmodified until release_cb is
+ * called, which happens once all of the data has been acknowledged, or when the
+ * QUIC_SSTREAM is freed, whichever happens first. release_cb may be NULL.
+ *
+ * The whole buffer is always appended; ossl_quic_sstream_get_buffer_avail() is
+ * not affected, as no internal buffer space is used.
+ *
+ * Returns 1 on success, in which case release_cb will be called exactly once,
+ * or 0 on failure, in which case it will not be called.
+ */
+int ossl_quic_sstream_append_ref(QUIC_SSTREAM *qss,
+                                 const unsigned char *buf,
+                                 size_t buf_len,
+                                 SSL_buffer_release_cb_fn release_cb,
+                                 void *release_arg);
+
 /*
  * Marks a stream as finished. ossl_quic_sstream_append() may not be called anymore
  * after calling this.
@@ -399,6 +418,26 @@ int ossl_quic_rstream_get_record(QUIC_RSTREAM *qrs,
  */
 int ossl_quic_rstream_release_record(QUIC_RSTREAM *qrs, size_t read_len);
 
+/*
+ * Removes the first contiguous chunk of readable data from the stream without
+ * copying it. *data and *data_len are set to the chunk, which points into the
+ * decrypted packet it was received in. *pkt is set to that packet and the
+ * caller takes over a reference to it, which it must release using
+ * ossl_qrx_pkt_release() once it no longer needs *data. *pkt may be NULL if
+ * the data was queued without a packet.
+ * If no data is available, *data_len is set to 0. `fin` is set to 1 if the
+ * end of the stream is reached after the returned chunk, 0 otherwise.
+ * If cleansing is enabled, the caller is responsible for cleansing *data
+ * before releasing *pkt.
+ * Returns 1 on success, 0 on error. It is an error to call this function
+ * while a record returned by ossl_quic_rstream_get_record() has not been
+ * released, or if the data at the head of the stream has been moved to the
+ * ring buffer.
+ */
+int ossl_quic_rstream_read_ref(QUIC_RSTREAM *qrs,
+                               const unsigned char **data, size_t *data_len,
+                               OSSL_QRX_PKT **pkt, int *fin);
+
 /*
  * Moves received frame data from decrypted packets to ring buffer.
  * This should be called when there are too many decrypted packets allocated.
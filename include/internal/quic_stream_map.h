@@ -163,6 +163,16 @@ struct quic_stream_st {
     /* 1 iff this QUIC_STREAM is on the active queue (invariant). */
     unsigned int    active : 1;
 
+    /*
+     * Scheduling priority (RFC 9218 s. 4). Streams with a lower urgency value
+     * are served first. Among streams of the same urgency, non-incremental
+     * streams are served one at a time in stream ID order, followed by
+     * incremental streams, which share the available bandwidth round-robin.
+     * Changed only via ossl_quic_stream_map_set_priority().
+     */
+    unsigned int    urgency     : 3;
+    unsigned int    incremental : 1;
+
     /*
      * This is a copy of the QUIC connection as_server value, indicating
      * whether we are locally operating as a server or not. Having this
@@ -546,17 +556,26 @@ static ossl_inline ossl_unused int ossl_quic_stream_recv_pending(const QUIC_STRE
  *
  *   - maps stream IDs to QUIC_STREAM objects;
  *   - tracks which streams are 'active' (currently have data for transmission);
- *   - allows iteration over the active streams only.
+ *   - allows iteration over the active streams only, in priority order.
  *
+ * Active streams are kept on one queue for each combination of urgency and
+ * incremental flag, ordered by urgency and with the non-incremental queue of
+ * each urgency first. Non-incremental queues are kept sorted by stream ID.
  */
+#define QUIC_STREAM_URGENCY_NUM         8
+#define QUIC_STREAM_URGENCY_DEFAULT     3
+#define QUIC_STREAM_ACTIVE_QUEUES       (QUIC_STREAM_URGENCY_NUM * 2)
+
 struct quic_stream_map_st {
     LHASH_OF(QUIC_STREAM)   *map;
-    QUIC_STREAM_LIST_NODE   active_list;
+    QUIC_STREAM_LIST_NODE   active_list[QUIC_STREAM_ACTIVE_QUEUES];
     QUIC_STREAM_LIST_NODE   accept_list;
     QUIC_STREAM_LIST_NODE   ready_for_gc_list;
     size_t                  rr_stepping, rr_counter;
     size_t                  num_accept_bidi, num_accept_uni, num_shutdown_flush;
-    QUIC_STREAM             *rr_cur;
+    /* Current RR position of each incremental queue. */
+    QUIC_STREAM             *rr_cur[QUIC_STREAM_ACTIVE_QUEUES];
+    int                     rr_pending;
     uint64_t                (*get_stream_limit_cb)(int uni, void *arg);
     void                    *get_stream_limit_cb_arg;
     QUIC_RXFC               *max_streams_bidi_rxfc;
@@ -642,6 +661,18 @@ void ossl_quic_stream_map_update_state(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s);
  */
 void ossl_quic_stream_map_set_rr_stepping(QUIC_STREAM_MAP *qsm, size_t stepping);
 
+/*
+ * Sets the scheduling priority of a stream. urgency must be less than
+ * QUIC_STREAM_URGENCY_NUM. New streams have an urgency of
+ * QUIC_STREAM_URGENCY_DEFAULT and are incremental, so that streams of equal
+ * priority share bandwidth round-robin unless configured otherwise.
+ *
+ * Calling this function invalidates any iterator currently pointing at the
+ * given stream object.
+ */
+int ossl_quic_stream_map_set_priority(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s,
+                                      unsigned int urgency, int incremental);
+
 /*
  * Returns 1 if the stream ordinal given is allowed by the current stream count
  * flow control limit, assuming a locally initiated stream of a type described
@@ -877,23 +908,28 @@ int ossl_quic_stream_map_is_shutdown_flush_finished(QUIC_STREAM_MAP *qsm);
  * QUIC Stream Iterator
  * ====================
  *
- * Allows the current set of active streams to be walked using a RR-based
- * algorithm. Each time ossl_quic_stream_iter_init is called, the RR algorithm
- * is stepped. The RR algorithm rotates the iteration order such that the next
- * active stream is returned first after n calls to ossl_quic_stream_iter_init,
- * where n is the stepping value configured via
- * ossl_quic_stream_map_set_rr_stepping.
+ * Allows the current set of active streams to be walked in priority order (see
+ * QUIC_STREAM_MAP above). Within each queue of incremental streams, a RR-based
+ * algorithm is used. Each time ossl_quic_stream_iter_init is called, the RR
+ * algorithm is stepped. The RR algorithm rotates the iteration order such that
+ * the next active stream of each incremental queue is returned first after n
+ * calls to ossl_quic_stream_iter_init, where n is the stepping value
+ * configured via ossl_quic_stream_map_set_rr_stepping.
  *
- * Suppose there are three active streams and the configured stepping is n:
+ * Suppose there are three active incremental streams of the same urgency and
+ * the configured stepping is n:
  *
  *   Iteration 0n:  [Stream 1] [Stream 2] [Stream 3]
  *   Iteration 1n:  [Stream 2] [Stream 3] [Stream 1]
  *   Iteration 2n:  [Stream 3] [Stream 1] [Stream 2]
  *
+ * Non-incremental streams are always returned in stream ID order, so that each
+ * is sent in full before the next is started.
  */
 typedef struct quic_stream_iter_st {
     QUIC_STREAM_MAP     *qsm;
     QUIC_STREAM         *first_stream, *stream;
+    size_t              queue;
 } QUIC_STREAM_ITER;
 
 /*
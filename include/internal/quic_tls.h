@@ -103,6 +103,29 @@ int ossl_quic_tls_get_error(QUIC_TLS *qtls,
 int ossl_quic_tls_is_cert_request(QUIC_TLS *qtls);
 int ossl_quic_tls_has_bad_max_early_data(QUIC_TLS *qtls);
 
+/*
+ * Client only. If enabled, early data is offered in the ClientHello if the
+ * session being resumed permits it. Must be called before the first tick.
+ */
+void ossl_quic_tls_set_early_data_enabled(QUIC_TLS *qtls, int enabled);
+
+/*
+ * Client only. Stores the transport parameters which must be remembered for
+ * 0-RTT (RFC 9000 s. 7.4.1) in the new session negotiated by the handshake.
+ * Does nothing if an existing session is being resumed.
+ */
+int ossl_quic_tls_set1_session_transport_params(QUIC_TLS *qtls,
+                                                const unsigned char *params,
+                                                size_t params_len);
+
+/*
+ * Retrieves the transport parameters stored in the session being resumed, if
+ * any. Returns 0 if there are none.
+ */
+int ossl_quic_tls_get0_session_transport_params(QUIC_TLS *qtls,
+                                                const unsigned char **params,
+                                                size_t *params_len);
+
 # endif
 
 #endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_INTERNAL_QUIC_TOKEN_H
+# define OSSL_INTERNAL_QUIC_TOKEN_H
+# pragma once
+
+# include <openssl/bio.h>
+# include "internal/time.h"
+# include "internal/quic_predef.h"
+
+# ifndef OPENSSL_NO_QUIC
+
+/*
+ * QUIC Address Validation Tokens
+ * ==============================
+ *
+ * A server issues tokens to clients in NEW_TOKEN frames (RFC 9000 s. 8.1.3).
+ * A client which presents such a token in the Initial packet of a later
+ * connection proves that it can receive packets at its address, so the server
+ * can consider the address validated without a round trip.
+ *
+ * Tokens are authenticated and encrypted with a key private to the server, and
+ * are bound to the IP address (but not the port) of the client and to the time
+ * of issue. They are opaque to the client.
+ */
+
+/* Length in bytes of the tokens we issue. */
+#  define QUIC_TOKEN_LEN                37
+
+/* Lifetime of the tokens we issue. */
+#  define QUIC_TOKEN_LIFETIME           ossl_seconds2time(24 * 60 * 60)
+
+/*
+ * Creates a token key with a freshly generated secret. Tokens issued under one
+ * key can only be validated using the same key.
+ */
+QUIC_TOKEN_KEY *ossl_quic_token_key_new(OSSL_LIB_CTX *libctx,
+                                        const char *propq);
+
+/* Frees the token key. No-op if key is NULL. */
+void ossl_quic_token_key_free(QUIC_TOKEN_KEY *key);
+
+/*
+ * Generates a token for the client at peer, writing QUIC_TOKEN_LEN bytes to
+ * buf. now is the time of issue. Returns 1 on success.
+ */
+int ossl_quic_token_generate(QUIC_TOKEN_KEY *key, const BIO_ADDR *peer,
+                             OSSL_TIME now, unsigned char *buf);
+
+/*
+ * Returns 1 if token is a token issued under key to a client at the address of
+ * peer within QUIC_TOKEN_LIFETIME of now.
+ */
+int ossl_quic_token_validate(QUIC_TOKEN_KEY *key, const BIO_ADDR *peer,
+                             OSSL_TIME now, const unsigned char *token,
+                             size_t token_len);
+
+/*
+ * QUIC Client Token Store
+ * =======================
+ *
+ * Holds the tokens a client has received in NEW_TOKEN frames, keyed by an
+ * identifier of the server which issued them, so that they can be used by
+ * subsequent connections to the same server. Only the most recent token from a
+ * server is kept, and a token is removed when it is used, as RFC 9000 s. 8.1.3
+ * advises clients not to reuse tokens. The number of servers for which tokens
+ * are held is bounded; the least recently updated are forgotten first.
+ *
+ * The store is thread-safe.
+ */
+#  define QUIC_TOKEN_STORE_MAX_SERVERS  64
+
+QUIC_TOKEN_STORE *ossl_quic_token_store_new(void);
+
+/* Frees the store. No-op if store is NULL. */
+void ossl_quic_token_store_free(QUIC_TOKEN_STORE *store);
+
+/*
+ * Stores a copy of a token received from the server identified by server_id,
+ * replacing any token stored for it before. Returns 1 on success.
+ */
+int ossl_quic_token_store_add(QUIC_TOKEN_STORE *store, const char *server_id,
+                              const unsigned char *token, size_t token_len);
+
+/*
+ * Removes the token stored for the server identified by server_id, if any, and
+ * returns it in *token and *token_len. The caller must free *token using
+ * OPENSSL_free(). Returns 0 if no token is stored for the server.
+ */
+int ossl_quic_token_store_take(QUIC_TOKEN_STORE *store, const char *server_id,
+                               unsigned char **token, size_t *token_len);
+
+# endif
+#endif
@@ -19,6 +19,8 @@
 # include "internal/quic_stream.h"
 # include "internal/quic_stream_map.h"
 # include "internal/quic_fc.h"
+# include "internal/quic_statm.h"
+# include "internal/quic_pacer.h"
 # include "internal/bio_addr.h"
 # include "internal/time.h"
 # include "internal/qlog.h"
@@ -48,6 +50,7 @@ typedef struct ossl_quic_tx_packetiser_args_st {
     QUIC_RXFC       *max_streams_uni_rxfc;
     const OSSL_CC_METHOD *cc_method; /* QUIC Congestion Controller */
     OSSL_CC_DATA    *cc_data;   /* QUIC Congestion Controller Instance */
+    OSSL_STATM      *statm;     /* Optional; enables pacing if non-NULL */
     OSSL_TIME       (*now)(void *arg);  /* Callback to get current time. */
     void            *now_arg;
     QLOG            *(*get_qlog_cb)(void *arg); /* Optional QLOG retrieval func */
@@ -78,6 +81,23 @@ void ossl_quic_tx_packetiser_free(OSSL_QUIC_TX_PACKETISER *txp);
 void ossl_quic_tx_packetiser_record_received_closing_bytes(
         OSSL_QUIC_TX_PACKETISER *txp, size_t n);
 
+/*
+ * Sets whether the peer's address has been validated (RFC 9000 s. 8). Until it
+ * has, the TXP limits the number of bytes it sends to three times the number
+ * of bytes recorded as received using
+ * ossl_quic_tx_packetiser_record_received_bytes(). The address is considered
+ * validated by default.
+ */
+void ossl_quic_tx_packetiser_set_addr_validated(OSSL_QUIC_TX_PACKETISER *txp,
+                                                int validated);
+
+/*
+ * Records the size of a datagram received from the peer for the purposes of
+ * the anti-amplification limit. Has no effect once the address is validated.
+ */
+void ossl_quic_tx_packetiser_record_received_bytes(OSSL_QUIC_TX_PACKETISER *txp,
+                                                   size_t n);
+
 /*
  * Generates a datagram by polling the various ELs to determine if they want to
  * generate any frames, and generating a datagram which coalesces packets for
@@ -146,6 +166,13 @@ void ossl_quic_tx_packetiser_set_qlog_cb(OSSL_QUIC_TX_PACKETISER *txp,
                                          QLOG *(*get_qlog_cb)(void *arg),
                                          void *get_qlog_cb_arg);
 
+/*
+ * Change the congestion controller in use after instantiation.
+ */
+void ossl_quic_tx_packetiser_set_cc(OSSL_QUIC_TX_PACKETISER *txp,
+                                    const OSSL_CC_METHOD *cc_method,
+                                    OSSL_CC_DATA *cc_data);
+
 /*
  * Inform the TX packetiser that an EL has been discarded. Idempotent.
  *
@@ -169,6 +196,22 @@ void ossl_quic_tx_packetiser_notify_handshake_complete(OSSL_QUIC_TX_PACKETISER *
 /* Asks the TXP to generate a HANDSHAKE_DONE frame in the next 1-RTT packet. */
 void ossl_quic_tx_packetiser_schedule_handshake_done(OSSL_QUIC_TX_PACKETISER *txp);
 
+/*
+ * Informs the TXP that the peer supports the ACK frequency extension. Once the
+ * handshake is complete, the TXP sends ACK_FREQUENCY frames requesting the
+ * given maximum ACK delay and an ACK-eliciting threshold determined by the
+ * congestion controller, and sends IMMEDIATE_ACK frames in 1-RTT probes.
+ */
+void ossl_quic_tx_packetiser_set_ack_frequency(OSSL_QUIC_TX_PACKETISER *txp,
+                                               uint64_t max_ack_delay_us);
+
+/*
+ * Sets the ECN codepoint (one of the OSSL_ACKM_ECN_* values) with which
+ * subsequently generated packets are sent. The default is not to mark packets.
+ */
+void ossl_quic_tx_packetiser_set_ecn(OSSL_QUIC_TX_PACKETISER *txp,
+                                     uint32_t ecn);
+
 /* Asks the TXP to ensure the next packet in the given PN space is ACK-eliciting. */
 void ossl_quic_tx_packetiser_schedule_ack_eliciting(OSSL_QUIC_TX_PACKETISER *txp,
                                                     uint32_t pn_space);
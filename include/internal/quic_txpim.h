@@ -43,6 +43,7 @@ typedef struct quic_txpim_pkt_st {
     unsigned int        had_max_streams_uni_frame   : 1;
     unsigned int        had_ack_frame               : 1;
     unsigned int        had_conn_close              : 1;
+    unsigned int        had_ack_frequency_frame     : 1;
 
     /* Private data follows. */
 } QUIC_TXPIM_PKT;
@@ -101,6 +101,13 @@ int ossl_quic_gen_rand_conn_id(OSSL_LIB_CTX *libctx, size_t len,
 
 #  define QUIC_DEFAULT_MAX_ACK_DELAY  25
 
+/*
+ * Minimum ACK delay (in microseconds) we advertise for the ACK frequency
+ * extension, and the largest value a peer may advertise.
+ */
+#  define QUIC_MIN_ACK_DELAY_US       1000
+#  define QUIC_MAX_MIN_ACK_DELAY_US   (((uint64_t)1) << 24)
+
 #  define QUIC_MIN_ACTIVE_CONN_ID_LIMIT   2
 
 /* Arbitrary choice of default idle timeout (not an RFC value). */
@@ -42,6 +42,10 @@
 #  define OSSL_QUIC_FRAME_TYPE_CONN_CLOSE_APP         0x1D
 #  define OSSL_QUIC_FRAME_TYPE_HANDSHAKE_DONE         0x1E
 
+/* ACK Frequency extension (draft-ietf-quic-ack-frequency) */
+#  define OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK          0x1F
+#  define OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY          0xAF
+
 #  define OSSL_QUIC_FRAME_FLAG_STREAM_FIN         0x01
 #  define OSSL_QUIC_FRAME_FLAG_STREAM_LEN         0x02
 #  define OSSL_QUIC_FRAME_FLAG_STREAM_OFF         0x04
@@ -122,6 +126,7 @@ ossl_quic_frame_type_is_ack_eliciting(uint64_t frame_type)
 #  define QUIC_TPARAM_ACTIVE_CONN_ID_LIMIT                0x0E
 #  define QUIC_TPARAM_INITIAL_SCID                        0x0F
 #  define QUIC_TPARAM_RETRY_SCID                          0x10
+#  define QUIC_TPARAM_MIN_ACK_DELAY                       0xFF04DE1B
 
 /*
  * QUIC Frame Logical Representations
@@ -214,6 +219,14 @@ typedef struct ossl_quic_frame_new_conn_id_st {
     QUIC_STATELESS_RESET_TOKEN  stateless_reset;
 } OSSL_QUIC_FRAME_NEW_CONN_ID;
 
+/* QUIC Frame: ACK_FREQUENCY */
+typedef struct ossl_quic_frame_ack_frequency_st {
+    uint64_t    seq_num;
+    uint64_t    ack_eliciting_threshold;
+    uint64_t    max_ack_delay_us;       /* Requested Max Ack Delay */
+    uint64_t    reordering_threshold;
+} OSSL_QUIC_FRAME_ACK_FREQUENCY;
+
 /* QUIC Frame: CONNECTION_CLOSE */
 typedef struct ossl_quic_frame_conn_close_st {
     unsigned int    is_app : 1; /* 0: transport error, 1: app error */
@@ -440,6 +453,19 @@ int ossl_quic_wire_encode_frame_conn_close(WPACKET *pkt,
  */
 int ossl_quic_wire_encode_frame_handshake_done(WPACKET *pkt);
 
+/*
+ * Encodes a QUIC ACK_FREQUENCY frame to the packet writer, given a logical
+ * representation of the ACK_FREQUENCY frame.
+ */
+int ossl_quic_wire_encode_frame_ack_frequency(WPACKET *pkt,
+                                              const OSSL_QUIC_FRAME_ACK_FREQUENCY *f);
+
+/*
+ * Encodes a QUIC IMMEDIATE_ACK frame to the packet writer. This frame type
+ * takes no arguments.
+ */
+int ossl_quic_wire_encode_frame_immediate_ack(WPACKET *pkt);
+
 /*
  * Encodes a QUIC transport parameter TLV with the given ID into the WPACKET.
  * The payload is an arbitrary buffer.
@@ -726,6 +752,18 @@ int ossl_quic_wire_decode_frame_ping(PACKET *pkt);
  */
 int ossl_quic_wire_decode_frame_handshake_done(PACKET *pkt);
 
+/*
+ * Decodes a QUIC ACK_FREQUENCY frame. The logical representation of the frame
+ * is written to *f.
+ */
+int ossl_quic_wire_decode_frame_ack_frequency(PACKET *pkt,
+                                              OSSL_QUIC_FRAME_ACK_FREQUENCY *f);
+
+/*
+ * Decodes an IMMEDIATE_ACK frame. The frame has no arguments.
+ */
+int ossl_quic_wire_decode_frame_immediate_ack(PACKET *pkt);
+
 /*
  * Peeks at the ID of the next QUIC transport parameter TLV in the stream.
  * The ID is written to *id.
@@ -11,6 +11,7 @@
 
 #include "openssl/params.h"
 #include "internal/list.h"
+#include "internal/uint_tree.h"
 
 /*
  * uint64_t Integer Sets
@@ -19,8 +20,10 @@
  * Utilities for managing a logical set of unsigned 64-bit integers. The
  * structure tracks each contiguous range of integers using one allocation and
  * is thus optimised for cases where integers tend to appear consecutively.
- * Queries are optimised under the assumption that they will generally be made
- * on integers near the end of the set.
+ * Insertion, removal and queries are O(log n) in the number of ranges.
+ *
+ * The ranges can be iterated in ascending order using the ranges list, which
+ * must not be modified other than via the functions below.
  *
  * Discussion of implementation details can be found in uint_set.c.
  */
@@ -31,12 +34,16 @@ typedef struct uint_range_st {
 typedef struct uint_set_item_st UINT_SET_ITEM;
 struct uint_set_item_st {
     OSSL_LIST_MEMBER(uint_set, UINT_SET_ITEM);
+    UINT_TREE_NODE              node;   /* keyed by range.start */
     UINT_RANGE                  range;
 };
 
 DEFINE_LIST_OF(uint_set, UINT_SET_ITEM);
 
-typedef OSSL_LIST(uint_set) UINT_SET;
+typedef struct uint_set_st {
+    OSSL_LIST(uint_set)         ranges;
+    UINT_TREE                   index;
+} UINT_SET;
 
 void ossl_uint_set_init(UINT_SET *s);
 void ossl_uint_set_destroy(UINT_SET *s);
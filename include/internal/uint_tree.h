@@ -0,0 +1,55 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+#ifndef OSSL_UINT_TREE_H
+# define OSSL_UINT_TREE_H
+
+# include <openssl/e_os2.h>
+
+/*
+ * uint64_t Keyed Search Trees
+ * ===========================
+ *
+ * An intrusive balanced (AVL) binary search tree of nodes keyed by unsigned
+ * 64-bit integers. The caller embeds a UINT_TREE_NODE in its own structure and
+ * owns the memory for it. Insertion, removal and lookup are O(log n).
+ *
+ * This is used as an index alongside a sorted linked list of non-overlapping
+ * ranges keyed by their start, so that the range containing or preceding a
+ * given value can be found without walking the list.
+ *
+ * Keys must be unique. The key of a node which is in a tree may be changed in
+ * place provided that this does not change the order of that node relative to
+ * the other nodes in the tree.
+ */
+typedef struct uint_tree_node_st UINT_TREE_NODE;
+struct uint_tree_node_st {
+    UINT_TREE_NODE  *parent, *left, *right;
+    uint64_t        key;
+    int             height;
+};
+
+typedef struct uint_tree_st {
+    UINT_TREE_NODE  *root;
+} UINT_TREE;
+
+void ossl_uint_tree_init(UINT_TREE *t);
+
+/* Inserts a node whose key field has been set. The key must not be in t. */
+void ossl_uint_tree_insert(UINT_TREE *t, UINT_TREE_NODE *n);
+
+/* Removes a node which is in t. */
+void ossl_uint_tree_remove(UINT_TREE *t, UINT_TREE_NODE *n);
+
+/*
+ * Returns the node with the greatest key less than or equal to key, or NULL if
+ * there is no such node.
+ */
+UINT_TREE_NODE *ossl_uint_tree_find_le(const UINT_TREE *t, uint64_t key);
+
+#endif
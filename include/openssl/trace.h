@@ -58,7 +58,8 @@ extern "C" {
 # define OSSL_TRACE_CATEGORY_HTTP               18
 # define OSSL_TRACE_CATEGORY_PROVIDER           19
 # define OSSL_TRACE_CATEGORY_QUERY              20
-# define OSSL_TRACE_CATEGORY_NUM                21
+# define OSSL_TRACE_CATEGORY_INIT_PHASE         21
+# define OSSL_TRACE_CATEGORY_NUM                22
 /* KEEP THIS LIST IN SYNC with trace_categories[] in crypto/trace.c */
 
 /* Returns the trace category number for the given |name| */
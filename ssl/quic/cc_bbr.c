@@ -0,0 +1,690 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include "internal/quic_cc.h"
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * BBR Congestion Controller
+ * =========================
+ *
+ * This is a model-based congestion controller after BBR (version 1). Rather
+ * than reacting to loss, it estimates the bottleneck bandwidth (the maximum
+ * delivery rate seen over the last few round trips) and the round-trip
+ * propagation delay (the minimum RTT seen over the last ten seconds), and
+ * keeps the amount of data in flight at a small multiple of their product.
+ *
+ * The controller moves through the following states:
+ *
+ *   STARTUP    Grow the window exponentially until the bandwidth estimate
+ *              stops growing by at least 25% for three round trips.
+ *   DRAIN      Drain the queue built up during STARTUP.
+ *   PROBE_BW   Steady state. Cycle the gain to periodically probe for more
+ *              bandwidth and then drain any queue this created.
+ *   PROBE_RTT  If the minimum RTT has not been refreshed for ten seconds,
+ *              briefly reduce the window to let queues drain so that it can
+ *              be measured again.
+ *
+ * As the congestion controller interface does not carry per-packet delivery
+ * state, the delivery rate is sampled as the number of bytes acknowledged
+ * over an interval of at least one minimum RTT, and a round trip ends when a
+ * packet sent after the start of the round is acknowledged. The pacing rate
+ * derived from the model is reported via get_pacing_rate and enforced by the
+ * TX packetiser's pacer.
+ *
+ * Gains are in units of 1/256.
+ */
+#define BBR_UNIT                256
+
+#define BBR_HIGH_GAIN           739     /* 2/ln(2) */
+#define BBR_DRAIN_GAIN          88      /* 1/BBR_HIGH_GAIN */
+#define BBR_CWND_GAIN           512
+
+#define BBR_BW_WINDOW           10      /* Rounds in bandwidth filter */
+#define BBR_MIN_RTT_WINDOW_MS   10000
+#define BBR_PROBE_RTT_TIME_MS   200
+#define BBR_FULL_BW_COUNT       3
+#define BBR_FULL_BW_NUM         5       /* Growth of 25% ... */
+#define BBR_FULL_BW_DEN         4       /* ... is still growing */
+#define BBR_MIN_PIPE_CWND       4       /* In datagrams */
+#define BBR_CWND_QUANTA         3       /* In datagrams */
+
+#define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
+
+enum {
+    BBR_STATE_STARTUP,
+    BBR_STATE_DRAIN,
+    BBR_STATE_PROBE_BW,
+    BBR_STATE_PROBE_RTT
+};
+
+static const uint32_t bbr_pacing_gain_cycle[] = {
+    BBR_UNIT * 5 / 4, BBR_UNIT * 3 / 4,
+    BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT
+};
+
+#define BBR_CYCLE_LEN \
+    (sizeof(bbr_pacing_gain_cycle) / sizeof(bbr_pacing_gain_cycle[0]))
+
+typedef struct ossl_cc_bbr_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' which depend on the maximum datagram size. */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd;
+    int         state;
+    uint32_t    pacing_gain, cwnd_gain;
+    uint64_t    pacing_rate;            /* Bytes per second */
+
+    /* Bottleneck bandwidth model (bytes per second). */
+    uint64_t    bw_samples[BBR_BW_WINDOW];
+    uint64_t    btl_bw;
+
+    /* Propagation delay model. */
+    OSSL_TIME   min_rtt, min_rtt_stamp;
+
+    /* Delivery rate sampling. */
+    uint64_t    delivered;
+    uint64_t    interval_delivered;
+    uint64_t    interval_max_inflight;
+    OSSL_TIME   interval_start;
+
+    /* Round trip counting. */
+    uint64_t    round_count;
+    OSSL_TIME   next_round_time;
+
+    /* STARTUP exit. */
+    uint64_t    full_bw;
+    int         full_bw_count, filled_pipe;
+
+    /* PROBE_BW. */
+    size_t      cycle_index;
+    OSSL_TIME   cycle_stamp;
+
+    /* PROBE_RTT. */
+    OSSL_TIME   probe_rtt_done;
+    uint64_t    prior_cwnd;
+
+    /* Unflushed state during multiple on-loss calls. */
+    int         processing_loss; /* 1 if not flushed */
+    OSSL_TIME   tx_time_of_last_loss;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_BBR;
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *bbr,
+                                   size_t max_dgram_size);
+static void bbr_update_diag(OSSL_CC_BBR *bbr);
+
+static void bbr_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *bbr_new(OSSL_TIME (*now_cb)(void *arg),
+                             void *now_cb_arg)
+{
+    OSSL_CC_BBR *bbr;
+
+    if ((bbr = OPENSSL_zalloc(sizeof(*bbr))) == NULL)
+        return NULL;
+
+    bbr->now_cb         = now_cb;
+    bbr->now_cb_arg     = now_cb_arg;
+
+    bbr_set_max_dgram_size(bbr, QUIC_MIN_INITIAL_DGRAM_LEN);
+    bbr_reset((OSSL_CC_DATA *)bbr);
+
+    return (OSSL_CC_DATA *)bbr;
+}
+
+static void bbr_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void bbr_set_max_dgram_size(OSSL_CC_BBR *bbr,
+                                   size_t max_dgram_size)
+{
+    size_t max_init_wnd;
+    int is_reduced = (max_dgram_size < bbr->max_dgram_size);
+
+    bbr->max_dgram_size = max_dgram_size;
+
+    max_init_wnd = 2 * max_dgram_size;
+    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
+        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
+
+    bbr->k_init_wnd = 10 * max_dgram_size;
+    if (bbr->k_init_wnd > max_init_wnd)
+        bbr->k_init_wnd = max_init_wnd;
+
+    bbr->k_min_wnd = BBR_MIN_PIPE_CWND * max_dgram_size;
+
+    if (is_reduced)
+        bbr->cong_wnd = bbr->k_init_wnd;
+
+    bbr_update_diag(bbr);
+}
+
+static void bbr_enter_startup(OSSL_CC_BBR *bbr)
+{
+    bbr->state          = BBR_STATE_STARTUP;
+    bbr->pacing_gain    = BBR_HIGH_GAIN;
+    bbr->cwnd_gain      = BBR_HIGH_GAIN;
+}
+
+static void bbr_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->cong_wnd               = bbr->k_init_wnd;
+    bbr->bytes_in_flight        = 0;
+    bbr->pacing_rate            = 0;
+
+    memset(bbr->bw_samples, 0, sizeof(bbr->bw_samples));
+    bbr->btl_bw                 = 0;
+    bbr->min_rtt                = ossl_time_infinite();
+    bbr->min_rtt_stamp          = ossl_time_zero();
+
+    bbr->delivered              = 0;
+    bbr->interval_delivered     = 0;
+    bbr->interval_max_inflight  = 0;
+    bbr->interval_start         = ossl_time_zero();
+
+    bbr->round_count            = 0;
+    bbr->next_round_time        = ossl_time_zero();
+
+    bbr->full_bw                = 0;
+    bbr->full_bw_count          = 0;
+    bbr->filled_pipe            = 0;
+
+    bbr->cycle_index            = 0;
+    bbr->cycle_stamp            = ossl_time_zero();
+
+    bbr->probe_rtt_done         = ossl_time_zero();
+    bbr->prior_cwnd             = 0;
+
+    bbr->processing_loss        = 0;
+    bbr->tx_time_of_last_loss   = ossl_time_zero();
+
+    bbr_enter_startup(bbr);
+}
+
+static int bbr_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    const OSSL_PARAM *p;
+    size_t value;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN);
+    if (p != NULL) {
+        if (!OSSL_PARAM_get_size_t(p, &value))
+            return 0;
+        if (value < QUIC_MIN_INITIAL_DGRAM_LEN)
+            return 0;
+
+        bbr_set_max_dgram_size(bbr, value);
+    }
+
+    return 1;
+}
+
+static int bbr_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (!ossl_cc_diag_bind(&bbr->diag, params))
+        return 0;
+
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    return ossl_cc_diag_unbind(&bbr->diag, params);
+}
+
+static void bbr_update_diag(OSSL_CC_BBR *bbr)
+{
+    static const uint32_t states[] = { 'S', 'D', 'B', 'T' };
+
+    ossl_cc_diag_update(&bbr->diag, bbr->max_dgram_size, bbr->cong_wnd,
+                        bbr->k_min_wnd, bbr->bytes_in_flight,
+                        states[bbr->state]);
+}
+
+/* Returns gain * BtlBw * RTprop in bytes, or 0 if there is no model yet. */
+static uint64_t bbr_bdp(OSSL_CC_BBR *bbr, uint32_t gain)
+{
+    uint64_t bdp;
+    int err = 0;
+
+    if (bbr->btl_bw == 0 || ossl_time_is_infinite(bbr->min_rtt))
+        return 0;
+
+    bdp = safe_muldiv_u64(bbr->btl_bw, ossl_time2us(bbr->min_rtt),
+                          1000 * 1000, &err);
+    bdp = safe_muldiv_u64(bdp, gain, BBR_UNIT, &err);
+    return err ? UINT64_MAX : bdp;
+}
+
+static uint64_t bbr_target_cwnd(OSSL_CC_BBR *bbr, uint32_t gain)
+{
+    uint64_t bdp = bbr_bdp(bbr, gain);
+    int err = 0;
+
+    if (bdp == 0)
+        return bbr->k_init_wnd;
+
+    bdp = safe_add_u64(bdp, BBR_CWND_QUANTA * bbr->max_dgram_size, &err);
+    if (err)
+        return UINT64_MAX;
+
+    return bdp < bbr->k_min_wnd ? bbr->k_min_wnd : bdp;
+}
+
+static void bbr_update_btl_bw(OSSL_CC_BBR *bbr, uint64_t sample,
+                              int app_limited)
+{
+    size_t i;
+
+    /* Application-limited samples only count if they show more bandwidth. */
+    if (app_limited && sample <= bbr->btl_bw)
+        return;
+
+    i = bbr->round_count % BBR_BW_WINDOW;
+    if (sample > bbr->bw_samples[i])
+        bbr->bw_samples[i] = sample;
+
+    bbr->btl_bw = 0;
+    for (i = 0; i < BBR_BW_WINDOW; ++i)
+        if (bbr->bw_samples[i] > bbr->btl_bw)
+            bbr->btl_bw = bbr->bw_samples[i];
+}
+
+static void bbr_on_new_round(OSSL_CC_BBR *bbr)
+{
+    ++bbr->round_count;
+    bbr->bw_samples[bbr->round_count % BBR_BW_WINDOW] = 0;
+
+    /* Check whether the bandwidth estimate has stopped growing. */
+    if (bbr->filled_pipe || bbr->btl_bw == 0)
+        return;
+
+    if (bbr->btl_bw >= bbr->full_bw / BBR_FULL_BW_DEN * BBR_FULL_BW_NUM) {
+        bbr->full_bw        = bbr->btl_bw;
+        bbr->full_bw_count  = 0;
+        return;
+    }
+
+    if (++bbr->full_bw_count >= BBR_FULL_BW_COUNT)
+        bbr->filled_pipe = 1;
+}
+
+static void bbr_enter_probe_bw(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    bbr->state          = BBR_STATE_PROBE_BW;
+    bbr->cwnd_gain      = BBR_CWND_GAIN;
+    /* Do not start by draining, there is nothing to drain. */
+    bbr->cycle_index    = 2;
+    bbr->cycle_stamp    = now;
+    bbr->pacing_gain    = bbr_pacing_gain_cycle[bbr->cycle_index];
+}
+
+static void bbr_advance_cycle(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    int full_length;
+
+    full_length = ossl_time_compare(ossl_time_subtract(now, bbr->cycle_stamp),
+                                    bbr->min_rtt) > 0;
+
+    if (bbr->pacing_gain > BBR_UNIT) {
+        /* Probe until the extra data is in flight. */
+        if (!full_length
+            || bbr->bytes_in_flight < bbr_bdp(bbr, bbr->pacing_gain))
+            return;
+    } else if (bbr->pacing_gain < BBR_UNIT) {
+        /* Drain until the queue is gone. */
+        if (!full_length && bbr->bytes_in_flight > bbr_bdp(bbr, BBR_UNIT))
+            return;
+    } else if (!full_length) {
+        return;
+    }
+
+    bbr->cycle_index    = (bbr->cycle_index + 1) % BBR_CYCLE_LEN;
+    bbr->cycle_stamp    = now;
+    bbr->pacing_gain    = bbr_pacing_gain_cycle[bbr->cycle_index];
+}
+
+static void bbr_update_min_rtt(OSSL_CC_BBR *bbr, OSSL_TIME now, OSSL_TIME rtt)
+{
+    int expired;
+
+    expired = !ossl_time_is_infinite(bbr->min_rtt)
+        && ossl_time_compare(now,
+                             ossl_time_add(bbr->min_rtt_stamp,
+                                           ossl_ms2time(BBR_MIN_RTT_WINDOW_MS)))
+           > 0;
+
+    if (ossl_time_compare(rtt, bbr->min_rtt) <= 0 || expired) {
+        bbr->min_rtt        = rtt;
+        bbr->min_rtt_stamp  = now;
+    }
+
+    if (expired && bbr->state != BBR_STATE_PROBE_RTT) {
+        bbr->state          = BBR_STATE_PROBE_RTT;
+        bbr->pacing_gain    = BBR_UNIT;
+        bbr->cwnd_gain      = BBR_UNIT;
+        bbr->prior_cwnd     = bbr->cong_wnd;
+        bbr->probe_rtt_done = ossl_time_zero();
+    }
+}
+
+static void bbr_handle_probe_rtt(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    if (ossl_time_is_zero(bbr->probe_rtt_done)) {
+        /* Wait for the window reduction to take effect. */
+        if (bbr->bytes_in_flight <= bbr->k_min_wnd)
+            bbr->probe_rtt_done
+                = ossl_time_add(now, ossl_ms2time(BBR_PROBE_RTT_TIME_MS));
+        return;
+    }
+
+    if (ossl_time_compare(now, bbr->probe_rtt_done) < 0)
+        return;
+
+    bbr->min_rtt_stamp = now;
+    if (bbr->cong_wnd < bbr->prior_cwnd)
+        bbr->cong_wnd = bbr->prior_cwnd;
+
+    if (bbr->filled_pipe)
+        bbr_enter_probe_bw(bbr, now);
+    else
+        bbr_enter_startup(bbr);
+}
+
+static void bbr_update_model(OSSL_CC_BBR *bbr, OSSL_TIME now,
+                             const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_TIME rtt, elapsed, min_interval;
+    uint64_t sample;
+    int err = 0;
+
+    rtt = ossl_time_subtract(now, info->tx_time);
+    bbr_update_min_rtt(bbr, now, rtt);
+
+    /* A round trip ends when a packet sent after it started is acked. */
+    if (ossl_time_compare(info->tx_time, bbr->next_round_time) >= 0) {
+        bbr->next_round_time = now;
+        bbr_on_new_round(bbr);
+    }
+
+    bbr->delivered += info->tx_size;
+    if (ossl_time_is_zero(bbr->interval_start)) {
+        bbr->interval_start         = now;
+        bbr->interval_delivered     = bbr->delivered;
+        bbr->interval_max_inflight  = bbr->bytes_in_flight + info->tx_size;
+        return;
+    }
+
+    /* Take a delivery rate sample once per minimum RTT. */
+    elapsed         = ossl_time_subtract(now, bbr->interval_start);
+    min_interval    = ossl_time_max(bbr->min_rtt, ossl_ms2time(1));
+    if (ossl_time_compare(elapsed, min_interval) < 0)
+        return;
+
+    sample = safe_muldiv_u64(bbr->delivered - bbr->interval_delivered,
+                             1000 * 1000, ossl_time2us(elapsed), &err);
+    if (!err)
+        bbr_update_btl_bw(bbr, sample,
+                          bbr->interval_max_inflight
+                          + BBR_CWND_QUANTA * bbr->max_dgram_size
+                          < bbr->cong_wnd);
+
+    bbr->interval_start         = now;
+    bbr->interval_delivered     = bbr->delivered;
+    bbr->interval_max_inflight  = bbr->bytes_in_flight;
+}
+
+static void bbr_update_state(OSSL_CC_BBR *bbr, OSSL_TIME now)
+{
+    switch (bbr->state) {
+    case BBR_STATE_STARTUP:
+        if (bbr->filled_pipe) {
+            bbr->state          = BBR_STATE_DRAIN;
+            bbr->pacing_gain    = BBR_DRAIN_GAIN;
+            bbr->cwnd_gain      = BBR_HIGH_GAIN;
+        }
+        break;
+
+    case BBR_STATE_DRAIN:
+        if (bbr->bytes_in_flight <= bbr_target_cwnd(bbr, BBR_UNIT))
+            bbr_enter_probe_bw(bbr, now);
+        break;
+
+    case BBR_STATE_PROBE_BW:
+        bbr_advance_cycle(bbr, now);
+        break;
+
+    case BBR_STATE_PROBE_RTT:
+        bbr_handle_probe_rtt(bbr, now);
+        break;
+    }
+}
+
+static void bbr_update_cwnd(OSSL_CC_BBR *bbr, uint64_t acked)
+{
+    uint64_t target = bbr_target_cwnd(bbr, bbr->cwnd_gain);
+
+    if (bbr->filled_pipe) {
+        bbr->cong_wnd += acked;
+        if (bbr->cong_wnd > target)
+            bbr->cong_wnd = target;
+    } else if (bbr->cong_wnd < target || bbr->delivered < bbr->k_init_wnd) {
+        bbr->cong_wnd += acked;
+    }
+
+    if (bbr->cong_wnd < bbr->k_min_wnd)
+        bbr->cong_wnd = bbr->k_min_wnd;
+
+    if (bbr->state == BBR_STATE_PROBE_RTT && bbr->cong_wnd > bbr->k_min_wnd)
+        bbr->cong_wnd = bbr->k_min_wnd;
+}
+
+static void bbr_update_pacing_rate(OSSL_CC_BBR *bbr)
+{
+    uint64_t rate;
+    int err = 0;
+
+    if (bbr->btl_bw == 0)
+        return;
+
+    rate = safe_muldiv_u64(bbr->btl_bw, bbr->pacing_gain, BBR_UNIT, &err);
+
+    /* Do not lower the pacing rate before the pipe has been filled. */
+    if (!err && (bbr->filled_pipe || rate > bbr->pacing_rate))
+        bbr->pacing_rate = rate;
+}
+
+static uint64_t bbr_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (bbr->bytes_in_flight >= bbr->cong_wnd)
+        return 0;
+
+    return bbr->cong_wnd - bbr->bytes_in_flight;
+}
+
+static OSSL_TIME bbr_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    if (bbr_get_tx_allowance(cc) > 0) {
+        /* We have TX allowance now so wakeup immediately */
+        return ossl_time_zero();
+    } else {
+        /*
+         * The window only changes in response to acknowledgements, so there
+         * is no need to wake up.
+         */
+        return ossl_time_infinite();
+    }
+}
+
+static uint64_t bbr_get_pacing_rate(OSSL_CC_DATA *cc, OSSL_TIME srtt)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    uint64_t srtt_us, rate;
+    int err = 0;
+
+    if (bbr->pacing_rate != 0)
+        return bbr->pacing_rate;
+
+    /*
+     * Until the first bandwidth sample arrives, pace the initial window at the
+     * startup gain over the smoothed RTT.
+     */
+    srtt_us = ossl_time2us(srtt);
+    if (srtt_us == 0 || ossl_time_is_infinite(srtt))
+        return 0;
+
+    rate = safe_muldiv_u64(bbr->cong_wnd, 1000000, srtt_us, &err);
+    if (!err)
+        rate = safe_muldiv_u64(rate, BBR_HIGH_GAIN, BBR_UNIT, &err);
+
+    return err ? UINT64_MAX : rate;
+}
+
+static uint64_t bbr_get_ack_eliciting_threshold(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    /* Bandwidth samples need a prompt ACK clock until the pipe is full. */
+    return ossl_cc_window_ack_eliciting_threshold(bbr->cong_wnd,
+                                                  bbr->max_dgram_size,
+                                                  bbr->state
+                                                  == BBR_STATE_STARTUP);
+}
+
+static int bbr_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->bytes_in_flight += num_bytes;
+    if (bbr->bytes_in_flight > bbr->interval_max_inflight)
+        bbr->interval_max_inflight = bbr->bytes_in_flight;
+
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_acked(OSSL_CC_DATA *cc,
+                             const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+    OSSL_TIME now = bbr->now_cb(bbr->now_cb_arg);
+
+    bbr->bytes_in_flight -= info->tx_size;
+
+    bbr_update_model(bbr, now, info);
+    bbr_update_state(bbr, now);
+    bbr_update_cwnd(bbr, info->tx_size);
+    bbr_update_pacing_rate(bbr);
+
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_lost(OSSL_CC_DATA *cc,
+                            const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (info->tx_size > bbr->bytes_in_flight)
+        return 0;
+
+    /*
+     * Loss is not taken as a congestion signal, as it is not necessarily a
+     * sign that the path is overloaded. Only persistent congestion, in which
+     * case the model is evidently wrong, is acted upon.
+     */
+    bbr->bytes_in_flight -= info->tx_size;
+    bbr->processing_loss = 1;
+    bbr->tx_time_of_last_loss
+        = ossl_time_max(bbr->tx_time_of_last_loss, info->tx_time);
+
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    if (!bbr->processing_loss)
+        return 1;
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        bbr->cong_wnd = bbr->k_min_wnd;
+
+        /* Start over with the bandwidth estimate. */
+        memset(bbr->bw_samples, 0, sizeof(bbr->bw_samples));
+        bbr->btl_bw = 0;
+    }
+
+    bbr->processing_loss = 0;
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_data_invalidated(OSSL_CC_DATA *cc,
+                                   uint64_t num_bytes)
+{
+    OSSL_CC_BBR *bbr = (OSSL_CC_BBR *)cc;
+
+    bbr->bytes_in_flight -= num_bytes;
+    bbr_update_diag(bbr);
+    return 1;
+}
+
+static int bbr_on_ecn(OSSL_CC_DATA *cc,
+                      const OSSL_CC_ECN_INFO *info)
+{
+    /* As for isolated loss, ECN marks do not affect the model. */
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_bbr_method = {
+    bbr_new,
+    bbr_free,
+    bbr_reset,
+    bbr_set_input_params,
+    bbr_bind_diagnostic,
+    bbr_unbind_diagnostic,
+    bbr_get_tx_allowance,
+    bbr_get_wakeup_deadline,
+    bbr_get_pacing_rate,
+    bbr_get_ack_eliciting_threshold,
+    bbr_on_data_sent,
+    bbr_on_data_acked,
+    bbr_on_data_lost,
+    bbr_on_data_lost_finished,
+    bbr_on_data_invalidated,
+    bbr_on_ecn,
+};
@@ -0,0 +1,590 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_cc.h"
+#include "internal/quic_types.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+/*
+ * CUBIC Congestion Controller
+ * ===========================
+ *
+ * This is an implementation of CUBIC as specified in RFC 9438. Slow start, loss
+ * detection and the recovery period work as for NewReno (RFC 9002 s. 7). In
+ * congestion avoidance the window follows the cubic function
+ *
+ *   W_cubic(t) = C * (t - K)^3 + W_max
+ *
+ * where t is the time since the start of the current congestion avoidance
+ * stage, so that the window grows quickly while far below the window at which
+ * the last congestion event happened (W_max), levels off around W_max and then
+ * probes for more bandwidth. As the growth depends on time rather than on the
+ * number of round trips, paths with a large bandwidth-delay product are filled
+ * much faster than with NewReno. In the Reno-friendly region the window grows
+ * at least as fast as a NewReno flow would (RFC 9438 s. 4.3).
+ *
+ * All arithmetic is done in integers. Windows are in bytes and times in
+ * milliseconds. The RTT used to look ahead by one round trip is estimated from
+ * the acknowledgements we are given, as the RTT estimator of the ACKM is not
+ * available to us.
+ */
+typedef struct ossl_cc_cubic_st {
+    /* Dependencies. */
+    OSSL_TIME   (*now_cb)(void *arg);
+    void        *now_cb_arg;
+
+    /* 'Constants' which depend on the maximum datagram size. */
+    uint64_t    k_init_wnd, k_min_wnd;
+
+    /* State. */
+    size_t      max_dgram_size;
+    uint64_t    bytes_in_flight, cong_wnd, slow_start_thresh;
+    OSSL_TIME   cong_recovery_start_time;
+
+    /* CUBIC state (RFC 9438 s. 4.1.2). */
+    uint64_t    w_max;          /* Window before the last reduction */
+    uint64_t    w_last_max;     /* W_max before fast convergence */
+    uint64_t    w_est;          /* Reno-friendly window estimate */
+    uint64_t    k;              /* Time until W_max is reached again (ms) */
+    OSSL_TIME   epoch_start;    /* Start of the congestion avoidance stage */
+    uint64_t    cubic_acked;    /* Bytes acked towards the next cwnd step */
+    uint64_t    est_acked;      /* Bytes acked towards the next w_est step */
+    OSSL_TIME   srtt;           /* Smoothed RTT of acknowledged packets */
+
+    /* Unflushed state during multiple on-loss calls. */
+    int         processing_loss; /* 1 if not flushed */
+    OSSL_TIME   tx_time_of_last_loss;
+
+    /* Diagnostic state. */
+    int         in_congestion_recovery;
+
+    /* Diagnostic output locations. */
+    OSSL_CC_DIAG diag;
+} OSSL_CC_CUBIC;
+
+#define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
+
+/* C = 0.4 (RFC 9438 s. 5.1) */
+#define CUBIC_C_NUM             4
+#define CUBIC_C_DEN             10
+
+/* beta_cubic = 0.7 (RFC 9438 s. 5.1) */
+#define CUBIC_BETA_NUM          7
+#define CUBIC_BETA_DEN          10
+
+/* alpha_cubic = 3 * (1 - beta_cubic) / (1 + beta_cubic) (RFC 9438 s. 4.3) */
+#define CUBIC_ALPHA_NUM         9
+#define CUBIC_ALPHA_DEN         17
+
+/*
+ * Bound on |t - K| used when evaluating W_cubic(t), so that the computation
+ * cannot overflow. The window has long reached any plausible size by then.
+ */
+#define CUBIC_MAX_DELTA_MS      100000
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *cu,
+                                     size_t max_dgram_size);
+static void cubic_update_diag(OSSL_CC_CUBIC *cu);
+
+static void cubic_reset(OSSL_CC_DATA *cc);
+
+static OSSL_CC_DATA *cubic_new(OSSL_TIME (*now_cb)(void *arg),
+                               void *now_cb_arg)
+{
+    OSSL_CC_CUBIC *cu;
+
+    if ((cu = OPENSSL_zalloc(sizeof(*cu))) == NULL)
+        return NULL;
+
+    cu->now_cb          = now_cb;
+    cu->now_cb_arg      = now_cb_arg;
+
+    cubic_set_max_dgram_size(cu, QUIC_MIN_INITIAL_DGRAM_LEN);
+    cubic_reset((OSSL_CC_DATA *)cu);
+
+    return (OSSL_CC_DATA *)cu;
+}
+
+static void cubic_free(OSSL_CC_DATA *cc)
+{
+    OPENSSL_free(cc);
+}
+
+static void cubic_set_max_dgram_size(OSSL_CC_CUBIC *cu,
+                                     size_t max_dgram_size)
+{
+    size_t max_init_wnd;
+    int is_reduced = (max_dgram_size < cu->max_dgram_size);
+
+    cu->max_dgram_size = max_dgram_size;
+
+    max_init_wnd = 2 * max_dgram_size;
+    if (max_init_wnd < MIN_MAX_INIT_WND_SIZE)
+        max_init_wnd = MIN_MAX_INIT_WND_SIZE;
+
+    cu->k_init_wnd = 10 * max_dgram_size;
+    if (cu->k_init_wnd > max_init_wnd)
+        cu->k_init_wnd = max_init_wnd;
+
+    cu->k_min_wnd = 2 * max_dgram_size;
+
+    if (is_reduced) {
+        cu->cong_wnd    = cu->k_init_wnd;
+        cu->epoch_start = ossl_time_zero();
+    }
+
+    cubic_update_diag(cu);
+}
+
+static void cubic_reset(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->cong_wnd                    = cu->k_init_wnd;
+    cu->bytes_in_flight             = 0;
+    cu->slow_start_thresh           = UINT64_MAX;
+    cu->cong_recovery_start_time    = ossl_time_zero();
+
+    cu->w_max                       = 0;
+    cu->w_last_max                  = 0;
+    cu->w_est                       = 0;
+    cu->k                           = 0;
+    cu->epoch_start                 = ossl_time_zero();
+    cu->cubic_acked                 = 0;
+    cu->est_acked                   = 0;
+    cu->srtt                        = ossl_time_zero();
+
+    cu->processing_loss         = 0;
+    cu->tx_time_of_last_loss    = ossl_time_zero();
+    cu->in_congestion_recovery  = 0;
+}
+
+static int cubic_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+    const OSSL_PARAM *p;
+    size_t value;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN);
+    if (p != NULL) {
+        if (!OSSL_PARAM_get_size_t(p, &value))
+            return 0;
+        if (value < QUIC_MIN_INITIAL_DGRAM_LEN)
+            return 0;
+
+        cubic_set_max_dgram_size(cu, value);
+    }
+
+    return 1;
+}
+
+static int cubic_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    if (!ossl_cc_diag_bind(&cu->diag, params))
+        return 0;
+
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    return ossl_cc_diag_unbind(&cu->diag, params);
+}
+
+static void cubic_update_diag(OSSL_CC_CUBIC *cu)
+{
+    uint32_t state;
+
+    if (cu->in_congestion_recovery)
+        state = 'R';
+    else if (cu->cong_wnd < cu->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
+
+    ossl_cc_diag_update(&cu->diag, cu->max_dgram_size, cu->cong_wnd,
+                        cu->k_min_wnd, cu->bytes_in_flight, state);
+}
+
+/* Integer cube root, rounded down (Hacker's Delight, 2nd ed., s. 11-2). */
+static uint64_t cubic_cbrt(uint64_t x)
+{
+    uint64_t y = 0, b;
+    int s;
+
+    for (s = 63; s >= 0; s -= 3) {
+        y += y;
+        b = 3 * y * (y + 1) + 1;
+        if ((x >> s) >= b) {
+            x -= b << s;
+            ++y;
+        }
+    }
+
+    return y;
+}
+
+/* Evaluates W_cubic(t) in bytes, where t is in milliseconds. */
+static uint64_t cubic_w_cubic(OSSL_CC_CUBIC *cu, uint64_t t)
+{
+    uint64_t d, delta;
+    int err = 0;
+
+    d = (t >= cu->k) ? t - cu->k : cu->k - t;
+    if (d > CUBIC_MAX_DELTA_MS)
+        d = CUBIC_MAX_DELTA_MS;
+
+    /* C * (t - K)^3 in segments, with t and K in seconds, converted to bytes. */
+    delta = safe_muldiv_u64(d * d * d, CUBIC_C_NUM * cu->max_dgram_size,
+                            (uint64_t)CUBIC_C_DEN * 1000 * 1000 * 1000, &err);
+    if (err)
+        delta = UINT64_MAX;
+
+    if (t >= cu->k)
+        return safe_add_u64(cu->w_max, delta, &err);
+
+    return delta >= cu->w_max ? 0 : cu->w_max - delta;
+}
+
+/* Starts a congestion avoidance stage (RFC 9438 s. 4.2). */
+static void cubic_start_epoch(OSSL_CC_CUBIC *cu, OSSL_TIME now)
+{
+    uint64_t k3;
+    int err = 0;
+
+    cu->epoch_start = now;
+    cu->cubic_acked = 0;
+    cu->est_acked   = 0;
+    cu->w_est       = cu->cong_wnd;
+
+    if (cu->cong_wnd < cu->w_max) {
+        /* K = cbrt((W_max - cwnd_epoch) / C) with windows in segments. */
+        k3 = safe_muldiv_u64(cu->w_max - cu->cong_wnd,
+                             (uint64_t)CUBIC_C_DEN * 1000 * 1000 * 1000,
+                             CUBIC_C_NUM * cu->max_dgram_size, &err);
+        if (err)
+            k3 = UINT64_MAX;
+
+        cu->k = cubic_cbrt(k3);
+    } else {
+        /* We left slow start without a congestion event. */
+        cu->k       = 0;
+        cu->w_max   = cu->cong_wnd;
+    }
+}
+
+static int cubic_in_cong_recovery(OSSL_CC_CUBIC *cu, OSSL_TIME tx_time)
+{
+    return ossl_time_compare(tx_time, cu->cong_recovery_start_time) <= 0;
+}
+
+static void cubic_cong(OSSL_CC_CUBIC *cu, OSSL_TIME tx_time)
+{
+    int err = 0;
+
+    /* No reaction if already in a recovery period. */
+    if (cubic_in_cong_recovery(cu, tx_time))
+        return;
+
+    /* Start a new recovery period. */
+    cu->in_congestion_recovery = 1;
+    cu->cong_recovery_start_time = cu->now_cb(cu->now_cb_arg);
+
+    /*
+     * Fast convergence (RFC 9438 s. 4.7): if the window did not get back to
+     * W_max since the last congestion event, another flow is likely to have
+     * joined, so release some bandwidth for it.
+     */
+    if (cu->cong_wnd < cu->w_last_max) {
+        cu->w_last_max  = cu->cong_wnd;
+        cu->w_max       = safe_muldiv_u64(cu->cong_wnd,
+                                          CUBIC_BETA_DEN + CUBIC_BETA_NUM,
+                                          2 * CUBIC_BETA_DEN, &err);
+    } else {
+        cu->w_last_max  = cu->cong_wnd;
+        cu->w_max       = cu->cong_wnd;
+    }
+
+    /* slow_start_thresh = cong_wnd * beta_cubic */
+    cu->slow_start_thresh
+        = safe_muldiv_u64(cu->cong_wnd, CUBIC_BETA_NUM, CUBIC_BETA_DEN, &err);
+
+    if (err)
+        cu->slow_start_thresh = UINT64_MAX;
+
+    cu->cong_wnd = cu->slow_start_thresh;
+    if (cu->cong_wnd < cu->k_min_wnd)
+        cu->cong_wnd = cu->k_min_wnd;
+
+    cu->epoch_start = ossl_time_zero();
+}
+
+static void cubic_flush(OSSL_CC_CUBIC *cu, uint32_t flags)
+{
+    if (!cu->processing_loss)
+        return;
+
+    cubic_cong(cu, cu->tx_time_of_last_loss);
+
+    if ((flags & OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION) != 0) {
+        cu->cong_wnd                    = cu->k_min_wnd;
+        cu->cong_recovery_start_time    = ossl_time_zero();
+        cu->epoch_start                 = ossl_time_zero();
+    }
+
+    cu->processing_loss = 0;
+    cubic_update_diag(cu);
+}
+
+static uint64_t cubic_get_tx_allowance(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    if (cu->bytes_in_flight >= cu->cong_wnd)
+        return 0;
+
+    return cu->cong_wnd - cu->bytes_in_flight;
+}
+
+static OSSL_TIME cubic_get_wakeup_deadline(OSSL_CC_DATA *cc)
+{
+    if (cubic_get_tx_allowance(cc) > 0) {
+        /* We have TX allowance now so wakeup immediately */
+        return ossl_time_zero();
+    } else {
+        /*
+         * Although the window is a function of time, it only changes in
+         * response to acknowledgements.
+         */
+        return ossl_time_infinite();
+    }
+}
+
+static uint64_t cubic_get_pacing_rate(OSSL_CC_DATA *cc, OSSL_TIME srtt)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    return ossl_cc_window_pacing_rate(cu->cong_wnd, srtt,
+                                      cu->cong_wnd < cu->slow_start_thresh);
+}
+
+static uint64_t cubic_get_ack_eliciting_threshold(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    return ossl_cc_window_ack_eliciting_threshold(cu->cong_wnd,
+                                                  cu->max_dgram_size,
+                                                  cu->cong_wnd
+                                                  < cu->slow_start_thresh);
+}
+
+static int cubic_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->bytes_in_flight += num_bytes;
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_is_cong_limited(OSSL_CC_CUBIC *cu)
+{
+    uint64_t wnd_rem;
+
+    /* We are congestion-limited if we are already at the congestion window. */
+    if (cu->bytes_in_flight >= cu->cong_wnd)
+        return 1;
+
+    wnd_rem = cu->cong_wnd - cu->bytes_in_flight;
+
+    /*
+     * Consider ourselves congestion-limited if less than three datagrams' worth
+     * of congestion window remains to be spent, or if we are in slow start and
+     * have consumed half of our window.
+     */
+    return (cu->cong_wnd < cu->slow_start_thresh && wnd_rem <= cu->cong_wnd / 2)
+           || wnd_rem <= 3 * cu->max_dgram_size;
+}
+
+/* Congestion avoidance (RFC 9438 s. 4.2 to 4.5). */
+static void cubic_on_ack_avoidance(OSSL_CC_CUBIC *cu, OSSL_TIME now,
+                                   uint64_t acked)
+{
+    uint64_t t, target, w_cubic, step;
+    int err = 0;
+
+    if (ossl_time_is_zero(cu->epoch_start))
+        cubic_start_epoch(cu, now);
+
+    t = ossl_time2ms(ossl_time_subtract(now, cu->epoch_start));
+
+    /*
+     * Reno-friendly region: W_est grows by alpha_cubic segments per window of
+     * acknowledged data, or by one segment once W_max has been reached.
+     */
+    cu->est_acked += acked;
+    step = cu->w_est >= cu->w_max
+        ? cu->cong_wnd
+        : safe_muldiv_u64(cu->cong_wnd, CUBIC_ALPHA_DEN, CUBIC_ALPHA_NUM, &err);
+    if (!err && cu->est_acked >= step) {
+        cu->est_acked -= step;
+        cu->w_est     += cu->max_dgram_size;
+    }
+
+    w_cubic = cubic_w_cubic(cu, t);
+    if (w_cubic < cu->w_est) {
+        cu->cong_wnd    = cu->w_est;
+        cu->cubic_acked = 0;
+        return;
+    }
+
+    /* Concave and convex regions: aim for W_cubic one RTT from now. */
+    target = cubic_w_cubic(cu, t + ossl_time2ms(cu->srtt));
+    if (target < cu->cong_wnd)
+        target = cu->cong_wnd;
+    else if (target > cu->cong_wnd + cu->cong_wnd / 2)
+        target = cu->cong_wnd + cu->cong_wnd / 2;
+
+    /* cwnd += (target - cwnd) / cwnd for each segment acknowledged. */
+    cu->cubic_acked += acked;
+    step = safe_muldiv_u64(target - cu->cong_wnd, cu->cubic_acked,
+                           cu->cong_wnd, &err);
+    if (!err && step > 0) {
+        cu->cong_wnd    += step;
+        cu->cubic_acked = 0;
+    }
+}
+
+static int cubic_on_data_acked(OSSL_CC_DATA *cc,
+                               const OSSL_CC_ACK_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+    OSSL_TIME now = cu->now_cb(cu->now_cb_arg), rtt;
+
+    /*
+     * Packet has been acked. Firstly, remove it from the aggregate count of
+     * bytes in flight.
+     */
+    cu->bytes_in_flight -= info->tx_size;
+
+    /* Update our RTT estimate, weighted as per RFC 9002 s. 5.3. */
+    rtt = ossl_time_subtract(now, info->tx_time);
+    if (ossl_time_is_zero(cu->srtt))
+        cu->srtt = rtt;
+    else
+        cu->srtt = ossl_time_divide(ossl_time_add(ossl_time_multiply(cu->srtt, 7),
+                                                  rtt), 8);
+
+    /*
+     * As for NewReno, only grow the window if we are actually making use of
+     * it (RFC 9438 s. 4.8).
+     */
+    if (!cubic_is_cong_limited(cu))
+        goto out;
+
+    if (cubic_in_cong_recovery(cu, info->tx_time)) {
+        /* Congestion recovery, do nothing. */
+    } else if (cu->cong_wnd < cu->slow_start_thresh) {
+        /* Slow start. */
+        cu->cong_wnd += info->tx_size;
+        cu->in_congestion_recovery = 0;
+    } else {
+        cubic_on_ack_avoidance(cu, now, info->tx_size);
+        cu->in_congestion_recovery = 0;
+    }
+
+out:
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_data_lost(OSSL_CC_DATA *cc,
+                              const OSSL_CC_LOSS_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    if (info->tx_size > cu->bytes_in_flight)
+        return 0;
+
+    cu->bytes_in_flight -= info->tx_size;
+
+    if (!cu->processing_loss) {
+        if (ossl_time_compare(info->tx_time, cu->tx_time_of_last_loss) <= 0)
+            /*
+             * After triggering congestion due to a lost packet at time t, don't
+             * trigger congestion again due to any subsequently detected lost
+             * packet at a time s < t.
+             */
+            goto out;
+
+        cu->processing_loss = 1;
+    }
+
+    cu->tx_time_of_last_loss
+        = ossl_time_max(cu->tx_time_of_last_loss, info->tx_time);
+
+out:
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_data_lost_finished(OSSL_CC_DATA *cc, uint32_t flags)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cubic_flush(cu, flags);
+    return 1;
+}
+
+static int cubic_on_data_invalidated(OSSL_CC_DATA *cc,
+                                     uint64_t num_bytes)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->bytes_in_flight -= num_bytes;
+    cubic_update_diag(cu);
+    return 1;
+}
+
+static int cubic_on_ecn(OSSL_CC_DATA *cc,
+                        const OSSL_CC_ECN_INFO *info)
+{
+    OSSL_CC_CUBIC *cu = (OSSL_CC_CUBIC *)cc;
+
+    cu->processing_loss         = 1;
+    cu->tx_time_of_last_loss    = info->largest_acked_time;
+    cubic_flush(cu, 0);
+    return 1;
+}
+
+const OSSL_CC_METHOD ossl_cc_cubic_method = {
+    cubic_new,
+    cubic_free,
+    cubic_reset,
+    cubic_set_input_params,
+    cubic_bind_diagnostic,
+    cubic_unbind_diagnostic,
+    cubic_get_tx_allowance,
+    cubic_get_wakeup_deadline,
+    cubic_get_pacing_rate,
+    cubic_get_ack_eliciting_threshold,
+    cubic_on_data_sent,
+    cubic_on_data_acked,
+    cubic_on_data_lost,
+    cubic_on_data_lost_finished,
+    cubic_on_data_invalidated,
+    cubic_on_ecn,
+};
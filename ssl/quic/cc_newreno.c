@@ -23,19 +23,28 @@ typedef struct ossl_cc_newreno_st {
     int         processing_loss; /* 1 if not flushed */
     OSSL_TIME   tx_time_of_last_loss;
 
+    /*
+     * Scalable ECN response state. The fraction of packets which are CE-marked
+     * is estimated over windows of about one RTT, and alpha is a moving average
+     * of that fraction in units of 1/ECN_ALPHA_ONE.
+     */
+    int         ecn_scalable;
+    uint32_t    ecn_alpha;
+    uint64_t    ecn_wnd_acked, ecn_wnd_ce;
+    OSSL_TIME   ecn_wnd_start;
+
     /* Diagnostic state. */
     int         in_congestion_recovery;
 
     /* Diagnostic output locations. */
-    size_t      *p_diag_max_dgram_payload_len;
-    uint64_t    *p_diag_cur_cwnd_size;
-    uint64_t    *p_diag_min_cwnd_size;
-    uint64_t    *p_diag_cur_bytes_in_flight;
-    uint32_t    *p_diag_cur_state;
+    OSSL_CC_DIAG diag;
 } OSSL_CC_NEWRENO;
 
 #define MIN_MAX_INIT_WND_SIZE    14720  /* RFC 9002 s. 7.2 */
 
+#define ECN_ALPHA_ONE            1024
+#define ECN_ALPHA_GAIN_SHIFT     4      /* g = 1/16, as for DCTCP */
+
 /* TODO(QUIC FUTURE): Pacing support. */
 
 static void newreno_set_max_dgram_size(OSSL_CC_NEWRENO *nr,
@@ -107,6 +116,11 @@ static void newreno_reset(OSSL_CC_DATA *cc)
     nr->processing_loss         = 0;
     nr->tx_time_of_last_loss    = ossl_time_zero();
     nr->in_congestion_recovery  = 0;
+
+    nr->ecn_alpha               = ECN_ALPHA_ONE;
+    nr->ecn_wnd_acked           = 0;
+    nr->ecn_wnd_ce              = 0;
+    nr->ecn_wnd_start           = ossl_time_zero();
 }
 
 static int newreno_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
@@ -125,115 +139,50 @@ static int newreno_set_input_params(OSSL_CC_DATA *cc, const OSSL_PARAM *params)
         newreno_set_max_dgram_size(nr, value);
     }
 
-    return 1;
-}
-
-static int bind_diag(OSSL_PARAM *params, const char *param_name, size_t len,
-                     void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
-
-    *pp = NULL;
+    p = OSSL_PARAM_locate_const(params, OSSL_CC_OPTION_ECN_SCALABLE);
+    if (p != NULL) {
+        int scalable;
 
-    if (p == NULL)
-        return 1;
+        if (!OSSL_PARAM_get_int(p, &scalable))
+            return 0;
 
-    if (p->data_type != OSSL_PARAM_UNSIGNED_INTEGER
-        || p->data_size != len)
-        return 0;
+        nr->ecn_scalable = (scalable != 0);
+    }
 
-    *pp = p->data;
     return 1;
 }
 
 static int newreno_bind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
-    size_t *new_p_max_dgram_payload_len;
-    uint64_t *new_p_cur_cwnd_size;
-    uint64_t *new_p_min_cwnd_size;
-    uint64_t *new_p_cur_bytes_in_flight;
-    uint32_t *new_p_cur_state;
-
-    if (!bind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                   sizeof(size_t), (void **)&new_p_max_dgram_payload_len)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_cur_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                      sizeof(uint64_t), (void **)&new_p_min_cwnd_size)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                      sizeof(uint64_t), (void **)&new_p_cur_bytes_in_flight)
-        || !bind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                      sizeof(uint32_t), (void **)&new_p_cur_state))
-        return 0;
 
-    if (new_p_max_dgram_payload_len != NULL)
-        nr->p_diag_max_dgram_payload_len = new_p_max_dgram_payload_len;
-
-    if (new_p_cur_cwnd_size != NULL)
-        nr->p_diag_cur_cwnd_size = new_p_cur_cwnd_size;
-
-    if (new_p_min_cwnd_size != NULL)
-        nr->p_diag_min_cwnd_size = new_p_min_cwnd_size;
-
-    if (new_p_cur_bytes_in_flight != NULL)
-        nr->p_diag_cur_bytes_in_flight = new_p_cur_bytes_in_flight;
-
-    if (new_p_cur_state != NULL)
-        nr->p_diag_cur_state = new_p_cur_state;
+    if (!ossl_cc_diag_bind(&nr->diag, params))
+        return 0;
 
     newreno_update_diag(nr);
     return 1;
 }
 
-static void unbind_diag(OSSL_PARAM *params, const char *param_name,
-                        void **pp)
-{
-    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, param_name);
-
-    if (p != NULL)
-        *pp = NULL;
-}
-
 static int newreno_unbind_diagnostic(OSSL_CC_DATA *cc, OSSL_PARAM *params)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
 
-    unbind_diag(params, OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
-                (void **)&nr->p_diag_max_dgram_payload_len);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_CWND_SIZE,
-                (void **)&nr->p_diag_cur_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_MIN_CWND_SIZE,
-                (void **)&nr->p_diag_min_cwnd_size);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_BYTES_IN_FLIGHT,
-                (void **)&nr->p_diag_cur_bytes_in_flight);
-    unbind_diag(params, OSSL_CC_OPTION_CUR_STATE,
-                (void **)&nr->p_diag_cur_state);
-    return 1;
+    return ossl_cc_diag_unbind(&nr->diag, params);
 }
 
 static void newreno_update_diag(OSSL_CC_NEWRENO *nr)
 {
-    if (nr->p_diag_max_dgram_payload_len != NULL)
-        *nr->p_diag_max_dgram_payload_len = nr->max_dgram_size;
-
-    if (nr->p_diag_cur_cwnd_size != NULL)
-        *nr->p_diag_cur_cwnd_size = nr->cong_wnd;
-
-    if (nr->p_diag_min_cwnd_size != NULL)
-        *nr->p_diag_min_cwnd_size = nr->k_min_wnd;
+    uint32_t state;
 
-    if (nr->p_diag_cur_bytes_in_flight != NULL)
-        *nr->p_diag_cur_bytes_in_flight = nr->bytes_in_flight;
+    if (nr->in_congestion_recovery)
+        state = 'R';
+    else if (nr->cong_wnd < nr->slow_start_thresh)
+        state = 'S';
+    else
+        state = 'A';
 
-    if (nr->p_diag_cur_state != NULL) {
-        if (nr->in_congestion_recovery)
-            *nr->p_diag_cur_state = 'R';
-        else if (nr->cong_wnd < nr->slow_start_thresh)
-            *nr->p_diag_cur_state = 'S';
-        else
-            *nr->p_diag_cur_state = 'A';
-    }
+    ossl_cc_diag_update(&nr->diag, nr->max_dgram_size, nr->cong_wnd,
+                        nr->k_min_wnd, nr->bytes_in_flight, state);
 }
 
 static int newreno_in_cong_recovery(OSSL_CC_NEWRENO *nr, OSSL_TIME tx_time)
@@ -308,6 +257,24 @@ static OSSL_TIME newreno_get_wakeup_deadline(OSSL_CC_DATA *cc)
     }
 }
 
+static uint64_t newreno_get_pacing_rate(OSSL_CC_DATA *cc, OSSL_TIME srtt)
+{
+    OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
+
+    return ossl_cc_window_pacing_rate(nr->cong_wnd, srtt,
+                                      nr->cong_wnd < nr->slow_start_thresh);
+}
+
+static uint64_t newreno_get_ack_eliciting_threshold(OSSL_CC_DATA *cc)
+{
+    OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
+
+    return ossl_cc_window_ack_eliciting_threshold(nr->cong_wnd,
+                                                  nr->max_dgram_size,
+                                                  nr->cong_wnd
+                                                  < nr->slow_start_thresh);
+}
+
 static int newreno_on_data_sent(OSSL_CC_DATA *cc, uint64_t num_bytes)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
@@ -336,6 +303,32 @@ static int newreno_is_cong_limited(OSSL_CC_NEWRENO *nr)
            || wnd_rem <= 3 * nr->max_dgram_size;
 }
 
+/*
+ * Ends the current alpha estimation window once a packet sent after it began
+ * is acknowledged, i.e. after about one RTT.
+ */
+static void newreno_update_ecn_alpha(OSSL_CC_NEWRENO *nr, OSSL_TIME tx_time)
+{
+    uint64_t frac;
+
+    ++nr->ecn_wnd_acked;
+    if (ossl_time_compare(tx_time, nr->ecn_wnd_start) <= 0)
+        return;
+
+    frac = nr->ecn_wnd_ce >= nr->ecn_wnd_acked
+        ? ECN_ALPHA_ONE
+        : nr->ecn_wnd_ce * ECN_ALPHA_ONE / nr->ecn_wnd_acked;
+
+    /* alpha = (1 - g) * alpha + g * frac */
+    nr->ecn_alpha = (uint32_t)(nr->ecn_alpha
+                               - (nr->ecn_alpha >> ECN_ALPHA_GAIN_SHIFT)
+                               + (frac >> ECN_ALPHA_GAIN_SHIFT));
+
+    nr->ecn_wnd_acked = 0;
+    nr->ecn_wnd_ce    = 0;
+    nr->ecn_wnd_start = nr->now_cb(nr->now_cb_arg);
+}
+
 static int newreno_on_data_acked(OSSL_CC_DATA *cc,
                                  const OSSL_CC_ACK_INFO *info)
 {
@@ -347,6 +340,9 @@ static int newreno_on_data_acked(OSSL_CC_DATA *cc,
      */
     nr->bytes_in_flight -= info->tx_size;
 
+    if (nr->ecn_scalable)
+        newreno_update_ecn_alpha(nr, info->tx_time);
+
     /*
      * We use acknowledgement of data as a signal that we are not at channel
      * capacity and that it may be reasonable to increase the congestion window.
@@ -459,11 +455,41 @@ static int newreno_on_ecn(OSSL_CC_DATA *cc,
                           const OSSL_CC_ECN_INFO *info)
 {
     OSSL_CC_NEWRENO *nr = (OSSL_CC_NEWRENO *)cc;
+    uint64_t reduction;
+    int err = 0;
+
+    if (!nr->ecn_scalable) {
+        nr->processing_loss         = 1;
+        nr->bytes_acked             = 0;
+        nr->tx_time_of_last_loss    = info->largest_acked_time;
+        newreno_flush(nr, 0);
+        return 1;
+    }
 
-    nr->processing_loss         = 1;
-    nr->bytes_acked             = 0;
-    nr->tx_time_of_last_loss    = info->largest_acked_time;
-    newreno_flush(nr, 0);
+    /*
+     * Scalable response (RFC 9331 s. 4.3): reduce the window by alpha / 2 at
+     * most once per RTT, so that the reduction is in proportion to the extent
+     * of marking rather than the halving used for loss.
+     */
+    nr->ecn_wnd_ce += info->num_ce;
+
+    if (newreno_in_cong_recovery(nr, info->largest_acked_time))
+        return 1;
+
+    nr->in_congestion_recovery   = 1;
+    nr->cong_recovery_start_time = nr->now_cb(nr->now_cb_arg);
+    nr->bytes_acked              = 0;
+
+    reduction = safe_muldiv_u64(nr->cong_wnd, nr->ecn_alpha,
+                                2 * ECN_ALPHA_ONE, &err);
+    if (err)
+        reduction = nr->cong_wnd / 2;
+
+    nr->cong_wnd = nr->cong_wnd > nr->k_min_wnd + reduction
+        ? nr->cong_wnd - reduction : nr->k_min_wnd;
+    nr->slow_start_thresh = nr->cong_wnd;
+
+    newreno_update_diag(nr);
     return 1;
 }
 
@@ -476,6 +502,8 @@ const OSSL_CC_METHOD ossl_cc_newreno_method = {
     newreno_unbind_diagnostic,
     newreno_get_tx_allowance,
     newreno_get_wakeup_deadline,
+    newreno_get_pacing_rate,
+    newreno_get_ack_eliciting_threshold,
     newreno_on_data_sent,
     newreno_on_data_acked,
     newreno_on_data_lost,
@@ -8,6 +8,7 @@
  */
 
 #include "internal/qlog.h"
+#include "internal/qlog_bin.h"
 #include "internal/json_enc.h"
 #include "internal/common.h"
 #include "internal/cryptlib.h"
@@ -40,9 +41,105 @@ struct qlog_st {
     const char      *event_cat, *event_name, *event_combined_name;
     OSSL_TIME       event_time, prev_event_time;
     OSSL_JSON_ENC   json;
+    QLOG_BIN_ENC    *bin;       /* Non-NULL if using the binary format */
     int             header_done, first_event_done;
 };
 
+/*
+ * Output
+ * ======
+ *
+ * All output goes through these functions, which write to either the JSON
+ * encoder or the binary encoder.
+ */
+static void qw_object_begin(QLOG *qlog)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_object_begin(qlog->bin);
+    else
+        ossl_json_object_begin(&qlog->json);
+}
+
+static void qw_object_end(QLOG *qlog)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_object_end(qlog->bin);
+    else
+        ossl_json_object_end(&qlog->json);
+}
+
+static void qw_array_begin(QLOG *qlog)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_array_begin(qlog->bin);
+    else
+        ossl_json_array_begin(&qlog->json);
+}
+
+static void qw_array_end(QLOG *qlog)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_array_end(qlog->bin);
+    else
+        ossl_json_array_end(&qlog->json);
+}
+
+static void qw_key(QLOG *qlog, const char *key)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_key(qlog->bin, key);
+    else
+        ossl_json_key(&qlog->json, key);
+}
+
+static void qw_bool(QLOG *qlog, int value)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_bool(qlog->bin, value);
+    else
+        ossl_json_bool(&qlog->json, value);
+}
+
+static void qw_u64(QLOG *qlog, uint64_t value)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_u64(qlog->bin, value);
+    else
+        ossl_json_u64(&qlog->json, value);
+}
+
+static void qw_i64(QLOG *qlog, int64_t value)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_i64(qlog->bin, value);
+    else
+        ossl_json_i64(&qlog->json, value);
+}
+
+static void qw_str_len(QLOG *qlog, const char *str, size_t str_len)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_str_len(qlog->bin, str, str_len);
+    else
+        ossl_json_str_len(&qlog->json, str, str_len);
+}
+
+static void qw_str(QLOG *qlog, const char *str)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_str_len(qlog->bin, str, strlen(str));
+    else
+        ossl_json_str(&qlog->json, str);
+}
+
+static void qw_str_hex(QLOG *qlog, const void *data, size_t data_len)
+{
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_str_hex(qlog->bin, data, data_len);
+    else
+        ossl_json_str_hex(&qlog->json, data, data_len);
+}
+
 static OSSL_TIME default_now(void *arg)
 {
     return ossl_time_now();
@@ -102,13 +199,53 @@ err:
     return NULL;
 }
 
+/* Parses a positive integer from an environment variable. */
+static int env_get_size(const char *name, size_t *value)
+{
+    const char *s = ossl_safe_getenv(name);
+    char *end;
+    unsigned long v;
+
+    if (s == NULL || s[0] == '\0')
+        return 0;
+
+    v = strtoul(s, &end, 10);
+    if (*end != '\0' || v == 0)
+        return 0;
+
+    *value = (size_t)v;
+    return 1;
+}
+
+/*
+ * Decides whether to log a connection when logging one in every rate
+ * connections. The decision is based on the ODCID, which is chosen randomly by
+ * the client, so that both endpoints make the same decision about a given
+ * connection.
+ */
+static int qlog_sampled(const QUIC_CONN_ID *odcid, size_t rate)
+{
+    uint32_t h = 2166136261U; /* FNV-1a */
+    size_t i;
+
+    if (rate <= 1)
+        return 1;
+
+    for (i = 0; i < odcid->id_len; ++i)
+        h = (h ^ odcid->id[i]) * 16777619U;
+
+    return h % rate == 0;
+}
+
 QLOG *ossl_qlog_new_from_env(const QLOG_TRACE_INFO *info)
 {
     QLOG *qlog = NULL;
     const char *qlogdir = ossl_safe_getenv("QLOGDIR");
     const char *qfilter = ossl_safe_getenv("OSSL_QFILTER");
+    const char *qformat = ossl_safe_getenv("OSSL_QLOG_FORMAT");
     char qlogdir_sep, *filename = NULL;
-    size_t i, l, strl;
+    size_t i, l, strl, rate, ring_size = QLOG_BIN_DEFAULT_RING_SIZE;
+    int binary = 0;
 
     if (info == NULL || qlogdir == NULL)
         return NULL;
@@ -117,9 +254,21 @@ QLOG *ossl_qlog_new_from_env(const QLOG_TRACE_INFO *info)
     if (l == 0)
         return NULL;
 
+    if (env_get_size("OSSL_QLOG_SAMPLE", &rate)
+        && !qlog_sampled(&info->odcid, rate))
+        return NULL;
+
+    if (qformat != NULL && strcmp(qformat, "binary") == 0) {
+        binary = 1;
+        env_get_size("OSSL_QLOG_RING_SIZE", &ring_size);
+    }
+
     qlogdir_sep = ossl_determine_dirsep(qlogdir);
 
-    /* dir; [sep]; ODCID; _; strlen("client" / "server"); strlen(".sqlog"); NUL */
+    /*
+     * dir; [sep]; ODCID; _; strlen("client" / "server");
+     * strlen(".sqlog" / ".bqlog"); NUL
+     */
     strl = l + 1 + info->odcid.id_len * 2 + 1 + 6 + 6 + 1;
     filename = OPENSSL_malloc(strl);
     if (filename == NULL)
@@ -132,13 +281,18 @@ QLOG *ossl_qlog_new_from_env(const QLOG_TRACE_INFO *info)
     for (i = 0; i < info->odcid.id_len; ++i)
         l += BIO_snprintf(filename + l, strl - l, "%02x", info->odcid.id[i]);
 
-    l += BIO_snprintf(filename + l, strl - l, "_%s.sqlog",
-                      info->is_server ? "server" : "client");
+    l += BIO_snprintf(filename + l, strl - l, "_%s.%s",
+                      info->is_server ? "server" : "client",
+                      binary ? "bqlog" : "sqlog");
 
     qlog = ossl_qlog_new(info);
     if (qlog == NULL)
         goto err;
 
+    if (binary
+        && !ossl_qlog_set_format(qlog, QLOG_FORMAT_BINARY, ring_size))
+        goto err;
+
     if (!ossl_qlog_set_sink_filename(qlog, filename))
         goto err;
 
@@ -162,6 +316,11 @@ void ossl_qlog_free(QLOG *qlog)
     if (qlog == NULL)
         return;
 
+    if (qlog->bin != NULL) {
+        ossl_qlog_flush(qlog); /* best effort */
+        ossl_qlog_bin_free(qlog->bin);
+    }
+
     ossl_json_flush_cleanup(&qlog->json);
     BIO_free_all(qlog->bio);
     OPENSSL_free((char *)qlog->info.title);
@@ -184,6 +343,37 @@ int ossl_qlog_set_sink_bio(QLOG *qlog, BIO *bio)
     BIO_free_all(qlog->bio);
     qlog->bio = bio;
     ossl_json_set0_sink(&qlog->json, bio);
+    if (qlog->bin != NULL)
+        ossl_qlog_bin_set0_sink(qlog->bin, bio);
+    return 1;
+}
+
+int ossl_qlog_set_format(QLOG *qlog, uint32_t format, size_t ring_size)
+{
+    QLOG_BIN_ENC *bin = NULL;
+
+    /* The format cannot be changed once output has begun. */
+    if (qlog == NULL || qlog->header_done)
+        return 0;
+
+    switch (format) {
+    case QLOG_FORMAT_JSON_SEQ:
+        break;
+    case QLOG_FORMAT_BINARY:
+        if (ring_size == 0)
+            ring_size = QLOG_BIN_DEFAULT_RING_SIZE;
+
+        if ((bin = ossl_qlog_bin_new(ring_size)) == NULL)
+            return 0;
+
+        ossl_qlog_bin_set0_sink(bin, qlog->bio);
+        break;
+    default:
+        return 0;
+    }
+
+    ossl_qlog_bin_free(qlog->bin);
+    qlog->bin = bin;
     return 1;
 }
 
@@ -238,6 +428,9 @@ int ossl_qlog_flush(QLOG *qlog)
     if (qlog == NULL)
         return 1;
 
+    if (qlog->bin != NULL)
+        return qlog->bio == NULL || ossl_qlog_bin_flush(qlog->bin);
+
     return ossl_json_flush(&qlog->json);
 }
 
@@ -268,8 +461,8 @@ static void write_str_once(QLOG *qlog, const char *key, char **p)
     if (*p == NULL)
         return;
 
-    ossl_json_key(&qlog->json, key);
-    ossl_json_str(&qlog->json, *p);
+    qw_key(qlog, key);
+    qw_str(qlog, *p);
 
     OPENSSL_free(*p);
     *p = NULL;
@@ -280,57 +473,57 @@ static void qlog_event_seq_header(QLOG *qlog)
     if (qlog->header_done)
         return;
 
-    ossl_json_object_begin(&qlog->json);
+    qw_object_begin(qlog);
     {
-        ossl_json_key(&qlog->json, "qlog_version");
-        ossl_json_str(&qlog->json, "0.3");
+        qw_key(qlog, "qlog_version");
+        qw_str(qlog, "0.3");
 
-        ossl_json_key(&qlog->json, "qlog_format");
-        ossl_json_str(&qlog->json, "JSON-SEQ");
+        qw_key(qlog, "qlog_format");
+        qw_str(qlog, "JSON-SEQ");
 
         write_str_once(qlog, "title", (char **)&qlog->info.title);
         write_str_once(qlog, "description", (char **)&qlog->info.description);
 
-        ossl_json_key(&qlog->json, "trace");
-        ossl_json_object_begin(&qlog->json);
+        qw_key(qlog, "trace");
+        qw_object_begin(qlog);
         {
-            ossl_json_key(&qlog->json, "common_fields");
-            ossl_json_object_begin(&qlog->json);
+            qw_key(qlog, "common_fields");
+            qw_object_begin(qlog);
             {
-                ossl_json_key(&qlog->json, "time_format");
-                ossl_json_str(&qlog->json, "delta");
+                qw_key(qlog, "time_format");
+                qw_str(qlog, "delta");
 
-                ossl_json_key(&qlog->json, "protocol_type");
-                ossl_json_array_begin(&qlog->json);
+                qw_key(qlog, "protocol_type");
+                qw_array_begin(qlog);
                 {
-                    ossl_json_str(&qlog->json, "QUIC");
+                    qw_str(qlog, "QUIC");
                 } /* protocol_type */
-                ossl_json_array_end(&qlog->json);
+                qw_array_end(qlog);
 
                 write_str_once(qlog, "group_id", (char **)&qlog->info.group_id);
 
-                ossl_json_key(&qlog->json, "system_info");
-                ossl_json_object_begin(&qlog->json);
+                qw_key(qlog, "system_info");
+                qw_object_begin(qlog);
                 {
                     if (qlog->info.override_process_id != 0) {
-                        ossl_json_key(&qlog->json, "process_id");
-                        ossl_json_u64(&qlog->json, qlog->info.override_process_id);
+                        qw_key(qlog, "process_id");
+                        qw_u64(qlog, qlog->info.override_process_id);
                     } else {
 #if defined(OPENSSL_SYS_UNIX)
-                        ossl_json_key(&qlog->json, "process_id");
-                        ossl_json_u64(&qlog->json, (uint64_t)getpid());
+                        qw_key(qlog, "process_id");
+                        qw_u64(qlog, (uint64_t)getpid());
 #elif defined(OPENSSL_SYS_WINDOWS)
-                        ossl_json_key(&qlog->json, "process_id");
-                        ossl_json_u64(&qlog->json, (uint64_t)GetCurrentProcessId());
+                        qw_key(qlog, "process_id");
+                        qw_u64(qlog, (uint64_t)GetCurrentProcessId());
 #endif
                     }
                 } /* system_info */
-                ossl_json_object_end(&qlog->json);
+                qw_object_end(qlog);
             } /* common_fields */
-            ossl_json_object_end(&qlog->json);
+            qw_object_end(qlog);
 
-            ossl_json_key(&qlog->json, "vantage_point");
-            ossl_json_object_begin(&qlog->json);
+            qw_key(qlog, "vantage_point");
+            qw_object_begin(qlog);
             {
                 char buf[128];
                 const char *p = buf;
@@ -343,24 +536,39 @@ static void qlog_event_seq_header(QLOG *qlog)
                                  OpenSSL_version(OPENSSL_PLATFORM) + 10);
                 }
 
-                ossl_json_key(&qlog->json, "type");
-                ossl_json_str(&qlog->json,
+                qw_key(qlog, "type");
+                qw_str(qlog,
                               qlog->info.is_server ? "server" : "client");
 
-                ossl_json_key(&qlog->json, "name");
-                ossl_json_str(&qlog->json, p);
+                qw_key(qlog, "name");
+                qw_str(qlog, p);
             } /* vantage_point */
-            ossl_json_object_end(&qlog->json);
+            qw_object_end(qlog);
         } /* trace */
-        ossl_json_object_end(&qlog->json);
+        qw_object_end(qlog);
     }
-    ossl_json_object_end(&qlog->json);
+    qw_object_end(qlog);
 
     qlog->header_done = 1;
 }
 
 static void qlog_event_prologue(QLOG *qlog)
 {
+    if (qlog->bin != NULL) {
+        /*
+         * The binary encoder keeps the header aside from its event ring and
+         * handles the event framing itself.
+         */
+        if (!qlog->header_done) {
+            ossl_qlog_bin_header_begin(qlog->bin);
+            qlog_event_seq_header(qlog);
+            ossl_qlog_bin_header_end(qlog->bin);
+        }
+
+        ossl_qlog_bin_event_begin(qlog->bin, qlog->event_combined_name);
+        return;
+    }
+
     qlog_event_seq_header(qlog);
 
     ossl_json_object_begin(&qlog->json);
@@ -374,6 +582,12 @@ static void qlog_event_prologue(QLOG *qlog)
 
 static void qlog_event_epilogue(QLOG *qlog)
 {
+    if (qlog->bin != NULL) {
+        /* Delta times are computed when the binary qlog is converted. */
+        ossl_qlog_bin_event_end(qlog->bin, qlog->event_time);
+        return;
+    }
+
     ossl_json_object_end(&qlog->json);
 
     ossl_json_key(&qlog->json, "time");
@@ -431,27 +645,27 @@ void ossl_qlog_event_end(QLOG *qlog)
 void ossl_qlog_group_begin(QLOG *qlog, const char *name)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_object_begin(&qlog->json);
+    qw_object_begin(qlog);
 }
 
 void ossl_qlog_group_end(QLOG *qlog)
 {
-    ossl_json_object_end(&qlog->json);
+    qw_object_end(qlog);
 }
 
 void ossl_qlog_array_begin(QLOG *qlog, const char *name)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_array_begin(&qlog->json);
+    qw_array_begin(qlog);
 }
 
 void ossl_qlog_array_end(QLOG *qlog)
 {
-    ossl_json_array_end(&qlog->json);
+    qw_array_end(qlog);
 }
 
 void ossl_qlog_override_time(QLOG *qlog, OSSL_TIME event_time)
@@ -462,51 +676,51 @@ void ossl_qlog_override_time(QLOG *qlog, OSSL_TIME event_time)
 void ossl_qlog_str(QLOG *qlog, const char *name, const char *value)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_str(&qlog->json, value);
+    qw_str(qlog, value);
 }
 
 void ossl_qlog_str_len(QLOG *qlog, const char *name,
                        const char *value, size_t value_len)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_str_len(&qlog->json, value, value_len);
+    qw_str_len(qlog, value, value_len);
 }
 
 void ossl_qlog_u64(QLOG *qlog, const char *name, uint64_t value)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_u64(&qlog->json, value);
+    qw_u64(qlog, value);
 }
 
 void ossl_qlog_i64(QLOG *qlog, const char *name, int64_t value)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_i64(&qlog->json, value);
+    qw_i64(qlog, value);
 }
 
 void ossl_qlog_bool(QLOG *qlog, const char *name, int value)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_bool(&qlog->json, value);
+    qw_bool(qlog, value);
 }
 
 void ossl_qlog_bin(QLOG *qlog, const char *name,
                    const void *value, size_t value_len)
 {
     if (name != NULL)
-        ossl_json_key(&qlog->json, name);
+        qw_key(qlog, name);
 
-    ossl_json_str_hex(&qlog->json, value, value_len);
+    qw_str_hex(qlog, value, value_len);
 }
 
 /*
@@ -0,0 +1,821 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/lhash.h>
+#include <openssl/buffer.h>
+#include "internal/qlog_bin.h"
+#include "internal/json_enc.h"
+#include "internal/packet.h"
+#include "internal/common.h"
+
+/*
+ * Binary qlog Format
+ * ==================
+ *
+ * A binary qlog consists of a 5-byte preamble (the magic "OQLB" followed by a
+ * version byte) and a sequence of records. Each record is a varint length
+ * followed by that many bytes, the first of which is the record type:
+ *
+ *   STR:     Defines the next string ID (starting from 0) as the remaining
+ *            bytes of the record. Used for key names and event names.
+ *
+ *   HEADER:  A sequence of value tokens encoding one top-level value, which
+ *            is the JSON-SEQ header of the qlog.
+ *
+ *   EVENT:   The string ID of the event name as a varint, value tokens
+ *            encoding the members of the event's "data" object, and the event
+ *            time as 8 bytes of big-endian OSSL_TIME ticks.
+ *
+ *   DROPPED: The total number of events discarded by the writer so far, as a
+ *            varint.
+ *
+ * Value tokens are a single byte, followed by a varint string ID for keys, a
+ * varint for integers (zigzag encoded for signed integers), and a varint
+ * length and that many bytes for strings. Varints are LEB128 encoded.
+ *
+ * Times are absolute, and the conversion to the delta times used by the
+ * JSON-SEQ output happens on decoding, so that events can be discarded from
+ * the ring without affecting the times of later events.
+ *
+ * Within the ring, each record is preceded by its length as a 4-byte
+ * big-endian integer instead of a varint, so that the oldest record can be
+ * located and discarded cheaply.
+ */
+#define QLOG_BIN_MAGIC          "OQLB"
+#define QLOG_BIN_MAGIC_LEN      4
+#define QLOG_BIN_VERSION        1
+
+#define REC_STR                 1
+#define REC_HEADER              2
+#define REC_EVENT               3
+#define REC_DROPPED             4
+
+#define TOK_OBJECT_BEGIN        1
+#define TOK_OBJECT_END          2
+#define TOK_ARRAY_BEGIN         3
+#define TOK_ARRAY_END           4
+#define TOK_KEY                 5
+#define TOK_FALSE               6
+#define TOK_TRUE                7
+#define TOK_U64                 8
+#define TOK_I64                 9
+#define TOK_STR                 10
+#define TOK_HEX                 11
+
+#define RING_LEN_BYTES          4
+
+typedef struct qlog_bin_str_st {
+    char        *s;
+    uint64_t    id;
+} QLOG_BIN_STR;
+
+DEFINE_LHASH_OF_EX(QLOG_BIN_STR);
+
+struct qlog_bin_enc_st {
+    BIO                     *bio;
+
+    /* The record currently being encoded. */
+    unsigned char           *rec;
+    size_t                  rec_len, rec_alloc;
+    int                     rec_error;
+
+    /* The most recent header record. */
+    unsigned char           *hdr;
+    size_t                  hdr_len;
+
+    /* Ring of ring_len bytes of event records, starting at ring_start. */
+    unsigned char           *ring;
+    size_t                  ring_size, ring_start, ring_len;
+
+    /* Interned strings, in order of ID. */
+    LHASH_OF(QLOG_BIN_STR)  *strs;
+    QLOG_BIN_STR            **str_list;
+    size_t                  num_strs, str_list_alloc, num_strs_written;
+
+    uint64_t                num_dropped, num_dropped_written;
+    unsigned int            preamble_written    : 1;
+    unsigned int            hdr_written         : 1;
+};
+
+static unsigned long str_hash(const QLOG_BIN_STR *a)
+{
+    return OPENSSL_LH_strhash(a->s);
+}
+
+static int str_cmp(const QLOG_BIN_STR *a, const QLOG_BIN_STR *b)
+{
+    return strcmp(a->s, b->s);
+}
+
+QLOG_BIN_ENC *ossl_qlog_bin_new(size_t ring_size)
+{
+    QLOG_BIN_ENC *enc;
+
+    if (ring_size <= RING_LEN_BYTES)
+        return NULL;
+
+    if ((enc = OPENSSL_zalloc(sizeof(*enc))) == NULL)
+        return NULL;
+
+    if ((enc->strs = lh_QLOG_BIN_STR_new(str_hash, str_cmp)) == NULL) {
+        OPENSSL_free(enc);
+        return NULL;
+    }
+
+    /* The ring itself is only allocated once an event is logged. */
+    enc->ring_size = ring_size;
+    return enc;
+}
+
+void ossl_qlog_bin_free(QLOG_BIN_ENC *enc)
+{
+    size_t i;
+
+    if (enc == NULL)
+        return;
+
+    for (i = 0; i < enc->num_strs; ++i) {
+        OPENSSL_free(enc->str_list[i]->s);
+        OPENSSL_free(enc->str_list[i]);
+    }
+
+    lh_QLOG_BIN_STR_free(enc->strs);
+    OPENSSL_free(enc->str_list);
+    OPENSSL_free(enc->rec);
+    OPENSSL_free(enc->hdr);
+    OPENSSL_free(enc->ring);
+    OPENSSL_free(enc);
+}
+
+void ossl_qlog_bin_set0_sink(QLOG_BIN_ENC *enc, BIO *bio)
+{
+    /* Output to a new sink must be readable on its own. */
+    enc->bio                 = bio;
+    enc->preamble_written    = 0;
+    enc->hdr_written         = 0;
+    enc->num_strs_written    = 0;
+    enc->num_dropped_written = 0;
+}
+
+uint64_t ossl_qlog_bin_get_num_dropped(const QLOG_BIN_ENC *enc)
+{
+    return enc->num_dropped;
+}
+
+/*
+ * Encoding
+ * ========
+ */
+static void rec_put(QLOG_BIN_ENC *enc, const void *data, size_t data_len)
+{
+    unsigned char *p;
+    size_t alloc;
+
+    if (enc->rec_error)
+        return;
+
+    if (enc->rec_alloc - enc->rec_len < data_len) {
+        alloc = enc->rec_alloc == 0 ? 256 : enc->rec_alloc;
+        while (alloc - enc->rec_len < data_len)
+            alloc *= 2;
+
+        if ((p = OPENSSL_realloc(enc->rec, alloc)) == NULL) {
+            enc->rec_error = 1;
+            return;
+        }
+
+        enc->rec        = p;
+        enc->rec_alloc  = alloc;
+    }
+
+    memcpy(enc->rec + enc->rec_len, data, data_len);
+    enc->rec_len += data_len;
+}
+
+static void rec_put_byte(QLOG_BIN_ENC *enc, unsigned char b)
+{
+    rec_put(enc, &b, 1);
+}
+
+static size_t encode_varint(unsigned char *buf, uint64_t v)
+{
+    size_t i = 0;
+
+    do {
+        buf[i] = (unsigned char)(v & 0x7f);
+        v >>= 7;
+        if (v != 0)
+            buf[i] |= 0x80;
+        ++i;
+    } while (v != 0);
+
+    return i;
+}
+
+static void rec_put_varint(QLOG_BIN_ENC *enc, uint64_t v)
+{
+    unsigned char buf[10];
+
+    rec_put(enc, buf, encode_varint(buf, v));
+}
+
+static void rec_begin(QLOG_BIN_ENC *enc, unsigned char rec_type)
+{
+    enc->rec_len    = 0;
+    enc->rec_error  = 0;
+    rec_put_byte(enc, rec_type);
+}
+
+/* Returns the ID of a string, defining it if it has not been seen before. */
+static int intern(QLOG_BIN_ENC *enc, const char *s, uint64_t *id)
+{
+    QLOG_BIN_STR tmpl, *e, **list;
+    size_t alloc;
+
+    tmpl.s = (char *)s;
+    if ((e = lh_QLOG_BIN_STR_retrieve(enc->strs, &tmpl)) != NULL) {
+        *id = e->id;
+        return 1;
+    }
+
+    if (enc->num_strs == enc->str_list_alloc) {
+        alloc = enc->str_list_alloc == 0 ? 32 : enc->str_list_alloc * 2;
+        list = OPENSSL_realloc(enc->str_list, alloc * sizeof(*list));
+        if (list == NULL)
+            return 0;
+
+        enc->str_list       = list;
+        enc->str_list_alloc = alloc;
+    }
+
+    if ((e = OPENSSL_malloc(sizeof(*e))) == NULL)
+        return 0;
+
+    if ((e->s = OPENSSL_strdup(s)) == NULL) {
+        OPENSSL_free(e);
+        return 0;
+    }
+
+    e->id = enc->num_strs;
+    lh_QLOG_BIN_STR_insert(enc->strs, e);
+    if (lh_QLOG_BIN_STR_error(enc->strs)) {
+        OPENSSL_free(e->s);
+        OPENSSL_free(e);
+        return 0;
+    }
+
+    enc->str_list[enc->num_strs++] = e;
+    *id = e->id;
+    return 1;
+}
+
+static void rec_put_str_id(QLOG_BIN_ENC *enc, const char *s)
+{
+    uint64_t id;
+
+    if (!intern(enc, s, &id)) {
+        enc->rec_error = 1;
+        return;
+    }
+
+    rec_put_varint(enc, id);
+}
+
+void ossl_qlog_bin_header_begin(QLOG_BIN_ENC *enc)
+{
+    rec_begin(enc, REC_HEADER);
+}
+
+void ossl_qlog_bin_header_end(QLOG_BIN_ENC *enc)
+{
+    unsigned char *hdr;
+
+    if (enc->rec_error
+        || (hdr = OPENSSL_memdup(enc->rec, enc->rec_len)) == NULL)
+        return;
+
+    OPENSSL_free(enc->hdr);
+    enc->hdr            = hdr;
+    enc->hdr_len        = enc->rec_len;
+    enc->hdr_written    = 0;
+}
+
+void ossl_qlog_bin_event_begin(QLOG_BIN_ENC *enc, const char *name)
+{
+    rec_begin(enc, REC_EVENT);
+    rec_put_str_id(enc, name);
+}
+
+static void ring_write(QLOG_BIN_ENC *enc, size_t off, const unsigned char *data,
+                       size_t data_len)
+{
+    size_t pos = (enc->ring_start + off) % enc->ring_size;
+    size_t n = enc->ring_size - pos;
+
+    if (n > data_len)
+        n = data_len;
+
+    memcpy(enc->ring + pos, data, n);
+    memcpy(enc->ring, data + n, data_len - n);
+}
+
+static void ring_read(const QLOG_BIN_ENC *enc, size_t off, unsigned char *data,
+                      size_t data_len)
+{
+    size_t pos = (enc->ring_start + off) % enc->ring_size;
+    size_t n = enc->ring_size - pos;
+
+    if (n > data_len)
+        n = data_len;
+
+    memcpy(data, enc->ring + pos, n);
+    memcpy(data + n, enc->ring, data_len - n);
+}
+
+static size_t ring_get_rec_len(const QLOG_BIN_ENC *enc, size_t off)
+{
+    unsigned char b[RING_LEN_BYTES];
+
+    ring_read(enc, off, b, sizeof(b));
+    return ((size_t)b[0] << 24) | ((size_t)b[1] << 16)
+        | ((size_t)b[2] << 8) | (size_t)b[3];
+}
+
+/* Discards the oldest record in the ring. */
+static void ring_pop(QLOG_BIN_ENC *enc)
+{
+    size_t n = RING_LEN_BYTES + ring_get_rec_len(enc, 0);
+
+    enc->ring_start = (enc->ring_start + n) % enc->ring_size;
+    enc->ring_len  -= n;
+    ++enc->num_dropped;
+}
+
+void ossl_qlog_bin_event_end(QLOG_BIN_ENC *enc, OSSL_TIME event_time)
+{
+    uint64_t t = ossl_time2ticks(event_time);
+    unsigned char b[8];
+    size_t i, need;
+
+    for (i = 0; i < sizeof(b); ++i)
+        b[i] = (unsigned char)(t >> (56 - 8 * i));
+
+    rec_put(enc, b, sizeof(b));
+
+    need = RING_LEN_BYTES + enc->rec_len;
+    if (enc->rec_error || enc->rec_len > 0xffffffff
+        || need > enc->ring_size) {
+        ++enc->num_dropped;
+        return;
+    }
+
+    if (enc->ring == NULL
+        && (enc->ring = OPENSSL_malloc(enc->ring_size)) == NULL) {
+        ++enc->num_dropped;
+        return;
+    }
+
+    while (enc->ring_size - enc->ring_len < need)
+        ring_pop(enc);
+
+    b[0] = (unsigned char)(enc->rec_len >> 24);
+    b[1] = (unsigned char)(enc->rec_len >> 16);
+    b[2] = (unsigned char)(enc->rec_len >> 8);
+    b[3] = (unsigned char)enc->rec_len;
+    ring_write(enc, enc->ring_len, b, RING_LEN_BYTES);
+    ring_write(enc, enc->ring_len + RING_LEN_BYTES, enc->rec, enc->rec_len);
+    enc->ring_len += need;
+}
+
+void ossl_qlog_bin_object_begin(QLOG_BIN_ENC *enc)
+{
+    rec_put_byte(enc, TOK_OBJECT_BEGIN);
+}
+
+void ossl_qlog_bin_object_end(QLOG_BIN_ENC *enc)
+{
+    rec_put_byte(enc, TOK_OBJECT_END);
+}
+
+void ossl_qlog_bin_array_begin(QLOG_BIN_ENC *enc)
+{
+    rec_put_byte(enc, TOK_ARRAY_BEGIN);
+}
+
+void ossl_qlog_bin_array_end(QLOG_BIN_ENC *enc)
+{
+    rec_put_byte(enc, TOK_ARRAY_END);
+}
+
+void ossl_qlog_bin_key(QLOG_BIN_ENC *enc, const char *key)
+{
+    rec_put_byte(enc, TOK_KEY);
+    rec_put_str_id(enc, key);
+}
+
+void ossl_qlog_bin_bool(QLOG_BIN_ENC *enc, int value)
+{
+    rec_put_byte(enc, value ? TOK_TRUE : TOK_FALSE);
+}
+
+void ossl_qlog_bin_u64(QLOG_BIN_ENC *enc, uint64_t value)
+{
+    rec_put_byte(enc, TOK_U64);
+    rec_put_varint(enc, value);
+}
+
+void ossl_qlog_bin_i64(QLOG_BIN_ENC *enc, int64_t value)
+{
+    uint64_t u = (uint64_t)value;
+
+    rec_put_byte(enc, TOK_I64);
+    rec_put_varint(enc, value < 0 ? ((~u) << 1) | 1 : u << 1);
+}
+
+void ossl_qlog_bin_str_len(QLOG_BIN_ENC *enc, const char *str, size_t str_len)
+{
+    rec_put_byte(enc, TOK_STR);
+    rec_put_varint(enc, str_len);
+    rec_put(enc, str, str_len);
+}
+
+void ossl_qlog_bin_str_hex(QLOG_BIN_ENC *enc, const void *data,
+                           size_t data_len)
+{
+    rec_put_byte(enc, TOK_HEX);
+    rec_put_varint(enc, data_len);
+    rec_put(enc, data, data_len);
+}
+
+/*
+ * Output
+ * ======
+ */
+static int write_all(BIO *bio, const void *data, size_t data_len)
+{
+    size_t written;
+
+    return data_len == 0
+        || (BIO_write_ex(bio, data, data_len, &written)
+            && written == data_len);
+}
+
+static int write_rec_len(BIO *bio, size_t rec_len)
+{
+    unsigned char buf[10];
+
+    return write_all(bio, buf, encode_varint(buf, rec_len));
+}
+
+static int write_rec(BIO *bio, unsigned char rec_type,
+                     const void *data, size_t data_len)
+{
+    return write_rec_len(bio, 1 + data_len)
+        && write_all(bio, &rec_type, 1)
+        && write_all(bio, data, data_len);
+}
+
+int ossl_qlog_bin_flush(QLOG_BIN_ENC *enc)
+{
+    static const unsigned char preamble[] = {
+        'O', 'Q', 'L', 'B', QLOG_BIN_VERSION
+    };
+    unsigned char buf[10];
+    QLOG_BIN_STR *s;
+    size_t n, pos, len;
+
+    if (enc->bio == NULL)
+        return 0;
+
+    if (!enc->preamble_written) {
+        if (!write_all(enc->bio, preamble, sizeof(preamble)))
+            return 0;
+
+        enc->preamble_written = 1;
+    }
+
+    for (; enc->num_strs_written < enc->num_strs; ++enc->num_strs_written) {
+        s = enc->str_list[enc->num_strs_written];
+        if (!write_rec(enc->bio, REC_STR, s->s, strlen(s->s)))
+            return 0;
+    }
+
+    if (enc->hdr != NULL && !enc->hdr_written) {
+        if (!write_rec_len(enc->bio, enc->hdr_len)
+            || !write_all(enc->bio, enc->hdr, enc->hdr_len))
+            return 0;
+
+        enc->hdr_written = 1;
+    }
+
+    if (enc->num_dropped != enc->num_dropped_written) {
+        if (!write_rec(enc->bio, REC_DROPPED, buf,
+                       encode_varint(buf, enc->num_dropped)))
+            return 0;
+
+        enc->num_dropped_written = enc->num_dropped;
+    }
+
+    while (enc->ring_len > 0) {
+        len = ring_get_rec_len(enc, 0);
+        pos = (enc->ring_start + RING_LEN_BYTES) % enc->ring_size;
+        n   = enc->ring_size - pos;
+        if (n > len)
+            n = len;
+
+        if (!write_rec_len(enc->bio, len)
+            || !write_all(enc->bio, enc->ring + pos, n)
+            || !write_all(enc->bio, enc->ring, len - n))
+            return 0;
+
+        enc->ring_start = (pos + len) % enc->ring_size;
+        enc->ring_len  -= RING_LEN_BYTES + len;
+    }
+
+    enc->ring_start = 0;
+    return BIO_flush(enc->bio) > 0;
+}
+
+/*
+ * Decoding
+ * ========
+ */
+struct qlog_bin_dec {
+    OSSL_JSON_ENC   json;
+    char            **strs;
+    size_t          num_strs, strs_alloc;
+    OSSL_TIME       prev_time;
+    int             first_event_done;
+};
+
+static int get_varint(PACKET *pkt, uint64_t *v)
+{
+    unsigned int b, shift = 0;
+
+    *v = 0;
+    do {
+        if (shift > 63 || !PACKET_get_1(pkt, &b))
+            return 0;
+
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        shift += 7;
+    } while ((b & 0x80) != 0);
+
+    return 1;
+}
+
+static int get_str_id(struct qlog_bin_dec *dec, PACKET *pkt, const char **s)
+{
+    uint64_t id;
+
+    if (!get_varint(pkt, &id) || id >= dec->num_strs)
+        return 0;
+
+    *s = dec->strs[id];
+    return 1;
+}
+
+static int get_bytes(PACKET *pkt, const unsigned char **data, size_t *data_len)
+{
+    uint64_t len;
+
+    if (!get_varint(pkt, &len) || len > PACKET_remaining(pkt))
+        return 0;
+
+    *data_len = (size_t)len;
+    return PACKET_get_bytes(pkt, data, *data_len);
+}
+
+/* Replays a sequence of value tokens into the JSON encoder. */
+static int replay_tokens(struct qlog_bin_dec *dec, PACKET *pkt)
+{
+    unsigned int tok;
+    uint64_t v;
+    const char *s;
+    const unsigned char *data;
+    size_t data_len, depth = 0;
+
+    while (PACKET_get_1(pkt, &tok)) {
+        switch (tok) {
+        case TOK_OBJECT_BEGIN:
+            ossl_json_object_begin(&dec->json);
+            ++depth;
+            break;
+        case TOK_OBJECT_END:
+            if (depth-- == 0)
+                return 0;
+            ossl_json_object_end(&dec->json);
+            break;
+        case TOK_ARRAY_BEGIN:
+            ossl_json_array_begin(&dec->json);
+            ++depth;
+            break;
+        case TOK_ARRAY_END:
+            if (depth-- == 0)
+                return 0;
+            ossl_json_array_end(&dec->json);
+            break;
+        case TOK_KEY:
+            if (!get_str_id(dec, pkt, &s))
+                return 0;
+            ossl_json_key(&dec->json, s);
+            break;
+        case TOK_FALSE:
+        case TOK_TRUE:
+            ossl_json_bool(&dec->json, tok == TOK_TRUE);
+            break;
+        case TOK_U64:
+            if (!get_varint(pkt, &v))
+                return 0;
+            ossl_json_u64(&dec->json, v);
+            break;
+        case TOK_I64:
+            if (!get_varint(pkt, &v))
+                return 0;
+            ossl_json_i64(&dec->json,
+                          (v & 1) != 0 ? (int64_t)~(v >> 1) : (int64_t)(v >> 1));
+            break;
+        case TOK_STR:
+            if (!get_bytes(pkt, &data, &data_len))
+                return 0;
+            ossl_json_str_len(&dec->json, (const char *)data, data_len);
+            break;
+        case TOK_HEX:
+            if (!get_bytes(pkt, &data, &data_len))
+                return 0;
+            ossl_json_str_hex(&dec->json, data, data_len);
+            break;
+        default:
+            return 0;
+        }
+
+        if (ossl_json_in_error(&dec->json))
+            return 0;
+    }
+
+    return depth == 0;
+}
+
+static int decode_str(struct qlog_bin_dec *dec, PACKET *pkt)
+{
+    char **strs;
+    size_t alloc;
+
+    if (dec->num_strs == dec->strs_alloc) {
+        alloc = dec->strs_alloc == 0 ? 32 : dec->strs_alloc * 2;
+        if ((strs = OPENSSL_realloc(dec->strs, alloc * sizeof(*strs))) == NULL)
+            return 0;
+
+        dec->strs       = strs;
+        dec->strs_alloc = alloc;
+    }
+
+    if ((dec->strs[dec->num_strs] = OPENSSL_strndup((const char *)PACKET_data(pkt),
+                                                    PACKET_remaining(pkt))) == NULL)
+        return 0;
+
+    ++dec->num_strs;
+    return 1;
+}
+
+static int decode_event(struct qlog_bin_dec *dec, PACKET *pkt)
+{
+    PACKET tokens;
+    const char *name;
+    uint64_t t;
+    OSSL_TIME event_time;
+
+    if (!get_str_id(dec, pkt, &name)
+        || PACKET_remaining(pkt) < 8
+        || !PACKET_get_sub_packet(pkt, &tokens, PACKET_remaining(pkt) - 8)
+        || !PACKET_get_net_8(pkt, &t))
+        return 0;
+
+    ossl_json_object_begin(&dec->json);
+    ossl_json_key(&dec->json, "name");
+    ossl_json_str(&dec->json, name);
+    ossl_json_key(&dec->json, "data");
+    ossl_json_object_begin(&dec->json);
+
+    if (!replay_tokens(dec, &tokens))
+        return 0;
+
+    ossl_json_object_end(&dec->json);
+
+    /* Same as the JSON-SEQ output of qlog. */
+    event_time = ossl_ticks2time(t);
+    ossl_json_key(&dec->json, "time");
+    if (!dec->first_event_done) {
+        ossl_json_u64(&dec->json, ossl_time2ms(event_time));
+        dec->first_event_done = 1;
+    } else {
+        ossl_json_u64(&dec->json,
+                      ossl_time2ms(ossl_time_subtract(event_time,
+                                                      dec->prev_time)));
+    }
+    dec->prev_time = event_time;
+
+    ossl_json_object_end(&dec->json);
+    return 1;
+}
+
+static int read_all(BIO *in, BUF_MEM *buf)
+{
+    size_t readbytes;
+
+    for (;;) {
+        if (!BUF_MEM_grow(buf, buf->length + 4096))
+            return 0;
+
+        if (!BIO_read_ex(in, buf->data + buf->length - 4096, 4096,
+                         &readbytes)) {
+            buf->length -= 4096;
+            return BIO_eof(in) ? 1 : 0;
+        }
+
+        buf->length -= 4096 - readbytes;
+    }
+}
+
+int ossl_qlog_bin_to_json(BIO *in, BIO *out, uint64_t *num_dropped)
+{
+    struct qlog_bin_dec dec = {0};
+    BUF_MEM *buf;
+    PACKET pkt, rec;
+    const unsigned char *magic;
+    unsigned int version, rec_type;
+    uint64_t rec_len, dropped = 0;
+    size_t i;
+    int ok = 0;
+
+    if ((buf = BUF_MEM_new()) == NULL)
+        return 0;
+
+    if (!ossl_json_init(&dec.json, out,
+                        OSSL_JSON_FLAG_IJSON | OSSL_JSON_FLAG_SEQ)) {
+        BUF_MEM_free(buf);
+        return 0;
+    }
+
+    if (!read_all(in, buf)
+        || !PACKET_buf_init(&pkt, (unsigned char *)buf->data, buf->length)
+        || !PACKET_get_bytes(&pkt, &magic, QLOG_BIN_MAGIC_LEN)
+        || memcmp(magic, QLOG_BIN_MAGIC, QLOG_BIN_MAGIC_LEN) != 0
+        || !PACKET_get_1(&pkt, &version)
+        || version != QLOG_BIN_VERSION)
+        goto err;
+
+    while (PACKET_remaining(&pkt) > 0) {
+        if (!get_varint(&pkt, &rec_len)
+            || rec_len > PACKET_remaining(&pkt)
+            || !PACKET_get_sub_packet(&pkt, &rec, (size_t)rec_len)
+            || !PACKET_get_1(&rec, &rec_type))
+            goto err;
+
+        switch (rec_type) {
+        case REC_STR:
+            if (!decode_str(&dec, &rec))
+                goto err;
+            break;
+        case REC_HEADER:
+            if (!replay_tokens(&dec, &rec))
+                goto err;
+            break;
+        case REC_EVENT:
+            if (!decode_event(&dec, &rec))
+                goto err;
+            break;
+        case REC_DROPPED:
+            if (!get_varint(&rec, &dropped))
+                goto err;
+            break;
+        default:
+            goto err;
+        }
+
+        if (ossl_json_in_error(&dec.json))
+            goto err;
+    }
+
+    if (num_dropped != NULL)
+        *num_dropped = dropped;
+
+    ok = 1;
+err:
+    if (!ossl_json_flush_cleanup(&dec.json))
+        ok = 0;
+
+    for (i = 0; i < dec.num_strs; ++i)
+        OPENSSL_free(dec.strs[i]);
+
+    OPENSSL_free(dec.strs);
+    BUF_MEM_free(buf);
+    return ok;
+}
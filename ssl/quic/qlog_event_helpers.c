@@ -408,6 +408,28 @@ static int log_frame_actual(QLOG *qlog_instance, PACKET *pkt,
             QLOG_STR("frame_type", "handshake_done");
         }
         break;
+    case OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY:
+        {
+            OSSL_QUIC_FRAME_ACK_FREQUENCY f;
+
+            if (!ossl_quic_wire_decode_frame_ack_frequency(pkt, &f))
+                goto unknown;
+
+            QLOG_STR("frame_type", "ack_frequency");
+            QLOG_U64("sequence_number", f.seq_num);
+            QLOG_U64("ack_eliciting_threshold", f.ack_eliciting_threshold);
+            QLOG_U64("request_max_ack_delay", f.max_ack_delay_us);
+            QLOG_U64("reordering_threshold", f.reordering_threshold);
+        }
+        break;
+    case OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK:
+        {
+            if (!ossl_quic_wire_decode_frame_immediate_ack(pkt))
+                goto unknown;
+
+            QLOG_STR("frame_type", "immediate_ack");
+        }
+        break;
     case OSSL_QUIC_FRAME_TYPE_NEW_CONN_ID:
         {
             OSSL_QUIC_FRAME_NEW_CONN_ID f;
@@ -420,8 +420,8 @@ static void rx_pkt_history_trim_range_count(struct rx_pkt_history_st *h)
 {
     QUIC_PN highest = QUIC_PN_INVALID;
 
-    while (ossl_list_uint_set_num(&h->set) > MAX_RX_ACK_RANGES) {
-        UINT_RANGE r = ossl_list_uint_set_head(&h->set)->range;
+    while (ossl_list_uint_set_num(&h->set.ranges) > MAX_RX_ACK_RANGES) {
+        UINT_RANGE r = ossl_list_uint_set_head(&h->set.ranges)->range;
 
         highest = (highest == QUIC_PN_INVALID)
             ? r.end : ossl_quic_pn_max(highest, r.end);
@@ -491,6 +491,13 @@ static int rx_pkt_history_bump_watermark(struct rx_pkt_history_st *h,
 /* Default maximum amount of time to leave an ACK-eliciting packet un-ACK'd. */
 #define DEFAULT_TX_MAX_ACK_DELAY       ossl_ms2time(QUIC_DEFAULT_MAX_ACK_DELAY)
 
+/*
+ * Default ACK frequency parameters (RFC 9000 s. 13.2.2 behaviour): ACK every
+ * second ACK-eliciting packet, and immediately on any reordering.
+ */
+#define DEFAULT_ACK_ELICITING_THRESHOLD 1
+#define DEFAULT_REORDERING_THRESHOLD    1
+
 struct ossl_ackm_st {
     /* Our list of transmitted packets. Corresponds to RFC 9002 sent_packets. */
     struct tx_pkt_history_st tx_history[QUIC_PN_SPACE_NUM];
@@ -530,9 +537,17 @@ struct ossl_ackm_st {
      */
     uint64_t        ack_eliciting_bytes_in_flight[QUIC_PN_SPACE_NUM];
 
-    /* Count of ECN-CE events. */
+    /* ECN counts most recently reported by the peer. */
+    uint64_t        peer_ect0[QUIC_PN_SPACE_NUM];
+    uint64_t        peer_ect1[QUIC_PN_SPACE_NUM];
     uint64_t        peer_ecnce[QUIC_PN_SPACE_NUM];
 
+    /* Number of packets sent with ECT(0) and ECT(1) respectively. */
+    uint64_t        tx_ect0, tx_ect1;
+
+    /* ECN validation state. */
+    OSSL_ACKM_ECN_STATS ecn_stats;
+
     /* Set to 1 when the handshake is confirmed. */
     char            handshake_confirmed;
 
@@ -596,6 +611,18 @@ struct ossl_ackm_st {
      */
     OSSL_TIME       tx_max_ack_delay;
 
+    /*
+     * ACK frequency parameters for the Application PN space, as last requested
+     * by the peer using an ACK_FREQUENCY frame (draft-ietf-quic-ack-frequency).
+     * We send an ACK once more than rx_ack_eliciting_threshold ACK-eliciting
+     * packets have been received, and immediately on reordering as governed by
+     * rx_reordering_threshold. rx_ack_freq_next_seq_num is the lowest sequence
+     * number of an ACK_FREQUENCY frame we will still process.
+     */
+    uint64_t        rx_ack_eliciting_threshold;
+    uint64_t        rx_reordering_threshold;
+    uint64_t        rx_ack_freq_next_seq_num;
+
     /* Callbacks for deadline updates. */
     void (*loss_detection_deadline_cb)(OSSL_TIME deadline, void *arg);
     void *loss_detection_deadline_cb_arg;
@@ -952,6 +979,9 @@ static void ackm_on_pkts_lost(OSSL_ACKM *ackm, int pkt_space,
             if (p->pkt_num > largest_pn_lost)
                 largest_pn_lost = p->pkt_num;
 
+            if (p->ecn != OSSL_ACKM_ECN_NONE)
+                ++ackm->ecn_stats.num_lost;
+
             if (!pseudo) {
                 /*
                  * If this is pseudo-loss (e.g. during connection retry) we do not
@@ -1049,6 +1079,9 @@ OSSL_ACKM *ossl_ackm_new(OSSL_TIME (*now)(void *arg),
     ackm->rx_max_ack_delay = ossl_ms2time(QUIC_DEFAULT_MAX_ACK_DELAY);
     ackm->tx_max_ack_delay = DEFAULT_TX_MAX_ACK_DELAY;
 
+    ackm->rx_ack_eliciting_threshold    = DEFAULT_ACK_ELICITING_THRESHOLD;
+    ackm->rx_reordering_threshold       = DEFAULT_REORDERING_THRESHOLD;
+
     return ackm;
 
 err:
@@ -1109,6 +1142,14 @@ int ossl_ackm_on_tx_packet(OSSL_ACKM *ackm, OSSL_ACKM_TX_PKT *pkt)
         ackm->cc_method->on_data_sent(ackm->cc_data, pkt->num_bytes);
     }
 
+    if (pkt->ecn != OSSL_ACKM_ECN_NONE) {
+        ++ackm->ecn_stats.num_sent;
+        if (pkt->ecn == OSSL_ACKM_ECN_ECT0)
+            ++ackm->tx_ect0;
+        else if (pkt->ecn == OSSL_ACKM_ECN_ECT1)
+            ++ackm->tx_ect1;
+    }
+
     return 1;
 }
 
@@ -1118,28 +1159,91 @@ int ossl_ackm_on_rx_datagram(OSSL_ACKM *ackm, size_t num_bytes)
     return 1;
 }
 
+/*
+ * Validates the ECN counts of an ACK frame against the newly acknowledged
+ * packets (RFC 9000 s. 13.4.2.1). Returns 0 if validation fails.
+ */
+static int ackm_validate_ecn(OSSL_ACKM *ackm, const OSSL_QUIC_FRAME_ACK *ack,
+                             int pkt_space, uint64_t num_ect0,
+                             uint64_t num_ect1)
+{
+    uint64_t d_ect0, d_ect1, d_ecnce;
+
+    if (!ack->ecn_present)
+        return num_ect0 + num_ect1 == 0;
+
+    /* The counts reported by the peer must never decrease. */
+    if (ack->ect0 < ackm->peer_ect0[pkt_space]
+        || ack->ect1 < ackm->peer_ect1[pkt_space]
+        || ack->ecnce < ackm->peer_ecnce[pkt_space])
+        return 0;
+
+    d_ect0  = ack->ect0 - ackm->peer_ect0[pkt_space];
+    d_ect1  = ack->ect1 - ackm->peer_ect1[pkt_space];
+    d_ecnce = ack->ecnce - ackm->peer_ecnce[pkt_space];
+
+    /*
+     * Every newly acknowledged packet sent with an ECT codepoint must be
+     * counted, either with that codepoint or as CE.
+     */
+    if (d_ect0 + d_ecnce < num_ect0 || d_ect1 + d_ecnce < num_ect1
+        || d_ect0 + d_ect1 + d_ecnce < num_ect0 + num_ect1)
+        return 0;
+
+    /* A codepoint we have never sent indicates that the path remarks it. */
+    if ((d_ect0 > 0 && ackm->tx_ect0 == 0)
+        || (d_ect1 > 0 && ackm->tx_ect1 == 0))
+        return 0;
+
+    return 1;
+}
+
 static void ackm_process_ecn(OSSL_ACKM *ackm, const OSSL_QUIC_FRAME_ACK *ack,
-                             int pkt_space)
+                             int pkt_space, const OSSL_ACKM_TX_PKT *na_pkts)
 {
-    struct tx_pkt_history_st *h;
-    OSSL_ACKM_TX_PKT *pkt;
+    const OSSL_ACKM_TX_PKT *p;
     OSSL_CC_ECN_INFO ecn_info = {0};
+    uint64_t num_ect0 = 0, num_ect1 = 0;
+
+    for (p = na_pkts; p != NULL; p = p->anext)
+        if (p->ecn == OSSL_ACKM_ECN_ECT0)
+            ++num_ect0;
+        else if (p->ecn == OSSL_ACKM_ECN_ECT1)
+            ++num_ect1;
+
+    ackm->ecn_stats.num_acked += num_ect0 + num_ect1;
+
+    /*
+     * Only validate ACK frames which newly acknowledge the largest acknowledged
+     * PN, as the counts in reordered ACK frames may be stale. The first newly
+     * acknowledged packet is always the one with the largest PN.
+     */
+    if (na_pkts->pkt_num != ack->ack_ranges[0].end)
+        return;
+
+    if (!ackm_validate_ecn(ackm, ack, pkt_space, num_ect0, num_ect1)) {
+        ackm->ecn_stats.failed = 1;
+        return;
+    }
+
+    ackm->ecn_stats.num_validated += num_ect0 + num_ect1;
+
+    if (!ack->ecn_present)
+        return;
 
     /*
      * If the ECN-CE counter reported by the peer has increased, this could
      * be a new congestion event.
      */
     if (ack->ecnce > ackm->peer_ecnce[pkt_space]) {
-        ackm->peer_ecnce[pkt_space] = ack->ecnce;
-
-        h = get_tx_history(ackm, pkt_space);
-        pkt = tx_pkt_history_by_pkt_num(h, ack->ack_ranges[0].end);
-        if (pkt == NULL)
-            return;
-
-        ecn_info.largest_acked_time = pkt->time;
+        ecn_info.largest_acked_time = na_pkts->time;
+        ecn_info.num_ce = ack->ecnce - ackm->peer_ecnce[pkt_space];
         ackm->cc_method->on_ecn(ackm->cc_data, &ecn_info);
     }
+
+    ackm->peer_ect0[pkt_space]  = ack->ect0;
+    ackm->peer_ect1[pkt_space]  = ack->ect1;
+    ackm->peer_ecnce[pkt_space] = ack->ecnce;
 }
 
 int ossl_ackm_on_rx_ack_frame(OSSL_ACKM *ackm, const OSSL_QUIC_FRAME_ACK *ack,
@@ -1198,14 +1302,14 @@ int ossl_ackm_on_rx_ack_frame(OSSL_ACKM *ackm, const OSSL_QUIC_FRAME_ACK *ack,
     }
 
     /*
-     * Process ECN information if present.
+     * Process ECN information, if present, and validate it.
      *
      * We deliberately do most ECN processing in the ACKM rather than the
      * congestion controller to avoid having to give the congestion controller
      * access to ACKM internal state.
      */
-    if (ack->ecn_present)
-        ackm_process_ecn(ackm, ack, pkt_space);
+    if (!ackm->ecn_stats.failed)
+        ackm_process_ecn(ackm, ack, pkt_space, na_pkts);
 
     /* Handle inferred loss. */
     lost_pkts = ackm_detect_and_remove_lost_pkts(ackm, pkt_space);
@@ -1244,6 +1348,9 @@ int ossl_ackm_on_pkt_space_discarded(OSSL_ACKM *ackm, int pkt_space)
             num_bytes_invalidated += pkt->num_bytes;
         }
 
+        if (pkt->ecn != OSSL_ACKM_ECN_NONE)
+            ++ackm->ecn_stats.num_lost;
+
         pkt->on_discarded(pkt->cb_arg); /* may free pkt */
     }
 
@@ -1358,8 +1465,12 @@ int ossl_ackm_get_largest_unacked(OSSL_ACKM *ackm, int pkt_space, QUIC_PN *pn)
     return 0;
 }
 
-/* Number of ACK-eliciting packets RX'd before we always emit an ACK. */
-#define PKTS_BEFORE_ACK     2
+/*
+ * Number of ACK-eliciting packets RX'd before we always emit an ACK in the
+ * Initial and Handshake PN spaces, and in the Application PN space unless the
+ * peer requests otherwise.
+ */
+#define PKTS_BEFORE_ACK     (DEFAULT_ACK_ELICITING_THRESHOLD + 1)
 
 /*
  * Return 1 if emission of an ACK frame is currently desired.
@@ -1413,6 +1524,35 @@ static int ackm_is_missing(OSSL_ACKM *ackm, int pkt_space, QUIC_PN pkt_num)
         && !ack_contains(&ackm->ack[pkt_space], pkt_num);
 }
 
+/*
+ * Returns 1 iff the largest PN which is missing and which we have not yet
+ * reported as missing is at least threshold less than the largest PN
+ * received (draft-ietf-quic-ack-frequency s. 6.2).
+ */
+static int ackm_reordering_exceeded(OSSL_ACKM *ackm, int pkt_space,
+                                    uint64_t threshold)
+{
+    struct rx_pkt_history_st *h = get_rx_history(ackm, pkt_space);
+    QUIC_PN largest_missing;
+
+    if (ackm->ack[pkt_space].num_ack_ranges == 0
+        || ossl_list_uint_set_is_empty(&h->set.ranges))
+        return 0;
+
+    /*
+     * PNs below the start of the highest range in our RX history are either
+     * received or missing; the highest missing PN is just below this range.
+     * If it is not above the highest PN we have reported, we have reported it
+     * as missing already.
+     */
+    largest_missing = ossl_list_uint_set_tail(&h->set.ranges)->range.start;
+    if (largest_missing <= ackm->ack[pkt_space].ack_ranges[0].end + 1)
+        return 0;
+
+    --largest_missing;
+    return ackm->rx_largest_pn[pkt_space] - largest_missing >= threshold;
+}
+
 /*
  * Returns 1 iff our RX of a PN newly establishes the implication of missing
  * packets.
@@ -1423,7 +1563,7 @@ static int ackm_has_newly_missing(OSSL_ACKM *ackm, int pkt_space)
 
     h = get_rx_history(ackm, pkt_space);
 
-    if (ossl_list_uint_set_is_empty(&h->set))
+    if (ossl_list_uint_set_is_empty(&h->set.ranges))
         return 0;
 
     /*
@@ -1439,9 +1579,9 @@ static int ackm_has_newly_missing(OSSL_ACKM *ackm, int pkt_space)
      * the PNs we have ACK'd previously and the PN we have just received.
      */
     return ackm->ack[pkt_space].num_ack_ranges > 0
-        && ossl_list_uint_set_tail(&h->set)->range.start
-           == ossl_list_uint_set_tail(&h->set)->range.end
-        && ossl_list_uint_set_tail(&h->set)->range.start
+        && ossl_list_uint_set_tail(&h->set.ranges)->range.start
+           == ossl_list_uint_set_tail(&h->set.ranges)->range.end
+        && ossl_list_uint_set_tail(&h->set.ranges)->range.start
             > ackm->ack[pkt_space].ack_ranges[0].end + 1;
 }
 
@@ -1469,6 +1609,9 @@ static void ackm_on_rx_ack_eliciting(OSSL_ACKM *ackm,
                                      int was_missing)
 {
     OSSL_TIME tx_max_ack_delay;
+    uint64_t pkts_before_ack = PKTS_BEFORE_ACK;
+    uint64_t reordering_threshold = DEFAULT_REORDERING_THRESHOLD;
+    int reordered;
 
     if (ackm->rx_ack_desired[pkt_space])
         /* ACK generation already requested so nothing to do. */
@@ -1476,11 +1619,24 @@ static void ackm_on_rx_ack_eliciting(OSSL_ACKM *ackm,
 
     ++ackm->rx_ack_eliciting_pkts_since_last_ack[pkt_space];
 
+    if (pkt_space == QUIC_PN_SPACE_APP) {
+        pkts_before_ack      = ackm->rx_ack_eliciting_threshold + 1;
+        reordering_threshold = ackm->rx_reordering_threshold;
+    }
+
+    if (reordering_threshold == 0)
+        /* The peer does not want immediate ACKs for reordered packets. */
+        reordered = 0;
+    else if (reordering_threshold == 1)
+        reordered = was_missing || ackm_has_newly_missing(ackm, pkt_space);
+    else
+        reordered = was_missing
+            || ackm_reordering_exceeded(ackm, pkt_space, reordering_threshold);
+
     if (!ackm->rx_ack_generated[pkt_space]
-            || was_missing
+            || reordered
             || ackm->rx_ack_eliciting_pkts_since_last_ack[pkt_space]
-                >= PKTS_BEFORE_ACK
-            || ackm_has_newly_missing(ackm, pkt_space)) {
+                >= pkts_before_ack) {
         /*
          * Either:
          *
@@ -1497,8 +1653,9 @@ static void ackm_on_rx_ack_eliciting(OSSL_ACKM *ackm,
          *     of an ACK frame, or
          *
          *   - The PN we just received and added to our PN RX history
-         *     newly implies one or more missing PNs, in which case we should
-         *     inform the peer by sending an ACK frame immediately.
+         *     newly implies one or more missing PNs (or, if the peer has
+         *     set a reordering threshold, enough of them), in which case we
+         *     should inform the peer by sending an ACK frame immediately.
          *
          * We do not test the ACK flush deadline here because it is tested
          * separately in ossl_ackm_is_ack_desired.
@@ -1569,7 +1726,9 @@ int ossl_ackm_on_rx_packet(OSSL_ACKM *ackm, const OSSL_ACKM_RX_PKT *pkt)
      * We may not emit an ACK frame yet if we have not yet received a threshold
      * number of packets.
      */
-    if (pkt->is_ack_eliciting)
+    if (pkt->is_immediate_ack)
+        ackm_queue_ack(ackm, pkt->pkt_space);
+    else if (pkt->is_ack_eliciting)
         ackm_on_rx_ack_eliciting(ackm, pkt->time, pkt->pkt_space, was_missing);
 
     /* Update the ECN counters according to which ECN signal we got, if any. */
@@ -1601,7 +1760,7 @@ static void ackm_fill_rx_ack_ranges(OSSL_ACKM *ackm, int pkt_space,
      * Copy out ranges from the PN set, starting at the end, until we reach our
      * maximum number of ranges.
      */
-    for (x = ossl_list_uint_set_tail(&h->set);
+    for (x = ossl_list_uint_set_tail(&h->set.ranges);
          x != NULL && i < OSSL_NELEM(ackm->ack_ranges);
          x = ossl_list_uint_set_prev(x), ++i) {
         ackm->ack_ranges[pkt_space][i].start = x->range.start;
@@ -1642,6 +1801,23 @@ const OSSL_QUIC_FRAME_ACK *ossl_ackm_get_ack_frame(OSSL_ACKM *ackm,
 }
 
 
+void ossl_ackm_on_rx_ack_frequency(OSSL_ACKM *ackm,
+                                   const OSSL_QUIC_FRAME_ACK_FREQUENCY *f)
+{
+    /*
+     * Values are decoded from variable-length integers so cannot overflow the
+     * additions here or in ackm_on_rx_ack_eliciting().
+     */
+    if (f->seq_num < ackm->rx_ack_freq_next_seq_num)
+        /* Stale or reordered frame. */
+        return;
+
+    ackm->rx_ack_freq_next_seq_num      = f->seq_num + 1;
+    ackm->rx_ack_eliciting_threshold    = f->ack_eliciting_threshold;
+    ackm->rx_reordering_threshold       = f->reordering_threshold;
+    ackm->tx_max_ack_delay              = ossl_us2time(f->max_ack_delay_us);
+}
+
 OSSL_TIME ossl_ackm_get_ack_deadline(OSSL_ACKM *ackm, int pkt_space)
 {
     if (ackm->rx_ack_desired[pkt_space])
@@ -1714,6 +1890,11 @@ QUIC_PN ossl_ackm_get_largest_acked(OSSL_ACKM *ackm, int pkt_space)
     return ackm->largest_acked_pkt[pkt_space];
 }
 
+void ossl_ackm_get_ecn_stats(OSSL_ACKM *ackm, OSSL_ACKM_ECN_STATS *stats)
+{
+    *stats = ackm->ecn_stats;
+}
+
 void ossl_ackm_set_rx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME rx_max_ack_delay)
 {
     ackm->rx_max_ack_delay = rx_max_ack_delay;
@@ -1723,3 +1904,10 @@ void ossl_ackm_set_tx_max_ack_delay(OSSL_ACKM *ackm, OSSL_TIME tx_max_ack_delay)
 {
     ackm->tx_max_ack_delay = tx_max_ack_delay;
 }
+
+void ossl_ackm_set_cc(OSSL_ACKM *ackm, const OSSL_CC_METHOD *cc_method,
+                      OSSL_CC_DATA *cc_data)
+{
+    ackm->cc_method = cc_method;
+    ackm->cc_data   = cc_data;
+}
@@ -14,6 +14,7 @@
 #include "internal/quic_rx_depack.h"
 #include "internal/quic_lcidm.h"
 #include "internal/quic_srtm.h"
+#include "internal/quic_token.h"
 #include "internal/qlog_event_helpers.h"
 #include "../ssl_local.h"
 #include "quic_channel_local.h"
@@ -50,6 +51,7 @@
 #define DEFAULT_MAX_ACK_DELAY   QUIC_DEFAULT_MAX_ACK_DELAY
 
 DEFINE_LIST_OF_IMPL(ch, QUIC_CHANNEL);
+DEFINE_LIST_OF_IMPL(incoming_ch, QUIC_CHANNEL);
 
 static void ch_save_err_state(QUIC_CHANNEL *ch);
 static int ch_rx(QUIC_CHANNEL *ch, int channel_only);
@@ -66,8 +68,12 @@ static int ch_generate_transport_params(QUIC_CHANNEL *ch);
 static int ch_on_transport_params(const unsigned char *params,
                                   size_t params_len,
                                   void *arg);
+static int ch_apply_remembered_transport_params(QUIC_CHANNEL *ch);
+static int ch_remember_transport_params(QUIC_CHANNEL *ch);
 static int ch_on_handshake_alert(void *arg, unsigned char alert_code);
 static int ch_on_handshake_complete(void *arg);
+static int ch_enqueue_new_token(QUIC_CHANNEL *ch);
+static void ch_use_stored_token(QUIC_CHANNEL *ch);
 static int ch_on_handshake_yield_secret(uint32_t enc_level, int direction,
                                         uint32_t suite_id, EVP_MD *md,
                                         const unsigned char *secret,
@@ -88,6 +94,7 @@ static int ch_retry(QUIC_CHANNEL *ch,
                     size_t retry_token_len,
                     const QUIC_CONN_ID *retry_scid);
 static void ch_update_idle(QUIC_CHANNEL *ch);
+static void ch_update_ecn_cc(QUIC_CHANNEL *ch);
 static int ch_discard_el(QUIC_CHANNEL *ch,
                          uint32_t enc_level);
 static void ch_on_idle_timeout(QUIC_CHANNEL *ch);
@@ -180,8 +187,13 @@ static int ch_init(QUIC_CHANNEL *ch)
                                        &ch->init_dcid))
         goto err;
 
-    /* We plug in a network write BIO to the QTX later when we get one. */
+    /*
+     * Use the network write BIO of the port if it already has one (as is the
+     * case for channels created for incoming connections); otherwise we plug
+     * one in later when we get one.
+     */
     qtx_args.libctx             = ch->port->engine->libctx;
+    qtx_args.bio                = ch->port->net_wbio;
     qtx_args.get_qlog_cb        = ch_get_qlog_cb;
     qtx_args.get_qlog_cb_arg    = ch;
     qtx_args.mdpl               = QUIC_MIN_INITIAL_DGRAM_LEN;
@@ -239,10 +251,15 @@ static int ch_init(QUIC_CHANNEL *ch)
         goto err;
 
     ch->have_statm = 1;
-    ch->cc_method = &ossl_cc_newreno_method;
+    if (ch->cc_method == NULL)
+        ch->cc_method = &ossl_cc_newreno_method;
     if ((ch->cc_data = ch->cc_method->new(get_time, ch)) == NULL)
         goto err;
 
+    ch->ecn_state = ch->ecn_mode != QUIC_ECN_MODE_OFF
+        ? QUIC_ECN_STATE_TESTING : QUIC_ECN_STATE_DISABLED;
+    ch_update_ecn_cc(ch);
+
     if ((ch->ackm = ossl_ackm_new(get_time, ch, &ch->statm,
                                   ch->cc_method, ch->cc_data)) == NULL)
         goto err;
@@ -273,6 +290,7 @@ static int ch_init(QUIC_CHANNEL *ch)
     txp_args.max_streams_uni_rxfc   = &ch->max_streams_uni_rxfc;
     txp_args.cc_method              = ch->cc_method;
     txp_args.cc_data                = ch->cc_data;
+    txp_args.statm                  = &ch->statm;
     txp_args.now                    = get_time;
     txp_args.now_arg                = ch;
     txp_args.get_qlog_cb            = ch_get_qlog_cb;
@@ -296,6 +314,7 @@ static int ch_init(QUIC_CHANNEL *ch)
     qrx_args.demux              = ch->port->demux;
     qrx_args.short_conn_id_len  = rx_short_dcid_len;
     qrx_args.max_deferred       = 32;
+    qrx_args.allow_0rtt         = ch->is_server;
 
     if ((ch->qrx = ossl_qrx_new(&qrx_args)) == NULL)
         goto err;
@@ -338,12 +357,15 @@ static int ch_init(QUIC_CHANNEL *ch)
         goto err;
 
     ch->tx_max_ack_delay        = DEFAULT_MAX_ACK_DELAY;
+    ch->tx_min_ack_delay        = QUIC_MIN_ACK_DELAY_US;
     ch->rx_max_ack_delay        = QUIC_DEFAULT_MAX_ACK_DELAY;
     ch->rx_ack_delay_exp        = QUIC_DEFAULT_ACK_DELAY_EXP;
     ch->rx_active_conn_id_limit = QUIC_MIN_ACTIVE_CONN_ID_LIMIT;
     ch->tx_enc_level            = QUIC_ENC_LEVEL_INITIAL;
     ch->rx_enc_level            = QUIC_ENC_LEVEL_INITIAL;
     ch->txku_threshold_override = UINT64_MAX;
+    ch->addr_validated          = 1;
+    ch->amp_last_dgram_id       = UINT64_MAX;
 
     ch->max_idle_timeout_local_req  = QUIC_DEFAULT_IDLE_TIMEOUT;
     ch->max_idle_timeout_remote_req = 0;
@@ -355,6 +377,7 @@ static int ch_init(QUIC_CHANNEL *ch)
     ch_update_idle(ch);
     ossl_list_ch_insert_tail(&ch->port->channel_list, ch);
     ch->on_port_list = 1;
+    ossl_quic_port_schedule_channel(ch->port, ch);
     return 1;
 
 err:
@@ -403,10 +426,16 @@ static void ch_cleanup(QUIC_CHANNEL *ch)
     OPENSSL_free(ch->ack_range_scratch);
 
     if (ch->on_port_list) {
+        ossl_quic_port_unschedule_channel(ch->port, ch);
         ossl_list_ch_remove(&ch->port->channel_list, ch);
         ch->on_port_list = 0;
     }
 
+    if (ch->on_incoming_list) {
+        ossl_list_incoming_ch_remove(&ch->port->incoming_list, ch);
+        ch->on_incoming_list = 0;
+    }
+
 #ifndef OPENSSL_NO_QLOG
     if (ch->qlog != NULL)
         ossl_qlog_flush(ch->qlog); /* best effort */
@@ -428,6 +457,8 @@ QUIC_CHANNEL *ossl_quic_channel_new(const QUIC_CHANNEL_ARGS *args)
     ch->tls         = args->tls;
     ch->lcidm       = args->lcidm;
     ch->srtm        = args->srtm;
+    ch->cc_method   = args->cc_method;
+    ch->ecn_mode    = args->ecn_mode;
 #ifndef OPENSSL_NO_QLOG
     ch->use_qlog    = args->use_qlog;
 
@@ -946,6 +977,39 @@ static int ch_on_crypto_release_record(size_t bytes_read, void *arg)
     return ossl_quic_rstream_release_record(rstream, bytes_read);
 }
 
+/*
+ * The 0-RTT keys are used alongside those of the current crypto stream EL
+ * rather than replacing them, so they do not change tx_enc_level or
+ * rx_enc_level. Only a client sends and only a server receives 0-RTT packets.
+ */
+static int ch_on_0rtt_secret(QUIC_CHANNEL *ch, int direction,
+                             uint32_t suite_id, EVP_MD *md,
+                             const unsigned char *secret, size_t secret_len)
+{
+    if (direction == ch->is_server
+        || (ch->el_discarded & (1U << QUIC_ENC_LEVEL_0RTT)) != 0)
+        return 0;
+
+    if (direction) {
+        /*
+         * RFC 9000 s. 7.4.1: While sending 0-RTT data we must abide by the
+         * transport parameters the server sent in the previous connection.
+         */
+        if (!ch_apply_remembered_transport_params(ch))
+            return 0;
+
+        return ossl_qtx_provide_secret(ch->qtx, QUIC_ENC_LEVEL_0RTT,
+                                       suite_id, md, secret, secret_len);
+    }
+
+    if (!ossl_qrx_provide_secret(ch->qrx, QUIC_ENC_LEVEL_0RTT,
+                                 suite_id, md, secret, secret_len))
+        return 0;
+
+    ch->have_new_rx_secret = 1;
+    return 1;
+}
+
 static int ch_on_handshake_yield_secret(uint32_t enc_level, int direction,
                                         uint32_t suite_id, EVP_MD *md,
                                         const unsigned char *secret,
@@ -955,6 +1019,10 @@ static int ch_on_handshake_yield_secret(uint32_t enc_level, int direction,
     QUIC_CHANNEL *ch = arg;
     uint32_t i;
 
+    if (enc_level == QUIC_ENC_LEVEL_0RTT)
+        return ch_on_0rtt_secret(ch, direction, suite_id, md,
+                                 secret, secret_len);
+
     if (enc_level < QUIC_ENC_LEVEL_HANDSHAKE || enc_level >= QUIC_ENC_LEVEL_NUM)
         /* Invalid EL. */
         return 0;
@@ -1009,6 +1077,41 @@ static int ch_on_handshake_yield_secret(uint32_t enc_level, int direction,
     return 1;
 }
 
+/*
+ * Called when the handshake completes to finish off any use of 0-RTT. We stop
+ * sending 0-RTT packets once we have 1-RTT keys (RFC 9001 s. 4.6.1). If the
+ * server rejected our early data, everything sent in 0-RTT packets must be
+ * sent again in 1-RTT packets, so we declare those packets lost. No 1-RTT
+ * packet can have been sent yet, so every unacknowledged packet in the
+ * Application PN space is a 0-RTT packet.
+ */
+static int ch_on_0rtt_handshake_complete(QUIC_CHANNEL *ch)
+{
+    QUIC_PN pn;
+
+    if (ch->is_server) {
+        /*
+         * If we accepted early data we keep the 0-RTT keys until the first
+         * 1-RTT packet arrives to deal with reordering.
+         */
+        if (SSL_get_early_data_status(ch->tls) != SSL_EARLY_DATA_ACCEPTED)
+            ch_discard_el(ch, QUIC_ENC_LEVEL_0RTT);
+
+        return 1;
+    }
+
+    if (!ossl_qtx_is_enc_level_provisioned(ch->qtx, QUIC_ENC_LEVEL_0RTT))
+        return 1;
+
+    if (SSL_get_early_data_status(ch->tls) == SSL_EARLY_DATA_REJECTED)
+        while (ossl_ackm_get_largest_unacked(ch->ackm, QUIC_PN_SPACE_APP, &pn))
+            if (!ossl_ackm_mark_packet_pseudo_lost(ch->ackm, QUIC_PN_SPACE_APP,
+                                                   pn))
+                return 0;
+
+    return ch_discard_el(ch, QUIC_ENC_LEVEL_0RTT);
+}
+
 static int ch_on_handshake_complete(void *arg)
 {
     QUIC_CHANNEL *ch = arg;
@@ -1034,6 +1137,9 @@ static int ch_on_handshake_complete(void *arg)
     OPENSSL_free(ch->local_transport_params);
     ch->local_transport_params = NULL;
 
+    if (!ch_on_0rtt_handshake_complete(ch))
+        return 0;
+
     /* Tell the QRX it can now process 1-RTT packets. */
     ossl_qrx_allow_1rtt_processing(ch->qrx);
 
@@ -1049,6 +1155,12 @@ static int ch_on_handshake_complete(void *arg)
         ossl_quic_channel_on_handshake_confirmed(ch);
 
         ossl_quic_tx_packetiser_schedule_handshake_done(ch->txp);
+
+        /*
+         * Give the client a token so that it can skip address validation
+         * when it next connects to us.
+         */
+        ch_enqueue_new_token(ch); /* best effort */
     }
 
     ch_record_state_transition(ch, ch->state);
@@ -1177,6 +1289,7 @@ static int ch_on_transport_params(const unsigned char *params,
     int got_preferred_addr = 0;
     int got_ack_delay_exp = 0;
     int got_max_ack_delay = 0;
+    int got_min_ack_delay = 0;
     int got_max_udp_payload_size = 0;
     int got_max_idle_timeout = 0;
     int got_active_conn_id_limit = 0;
@@ -1396,6 +1509,23 @@ static int ch_on_transport_params(const unsigned char *params,
             got_max_ack_delay = 1;
             break;
 
+        case QUIC_TPARAM_MIN_ACK_DELAY:
+            if (got_min_ack_delay) {
+                /* must not appear more than once */
+                reason = TP_REASON_DUP("MIN_ACK_DELAY");
+                goto malformed;
+            }
+
+            if (!ossl_quic_wire_decode_transport_param_int(&pkt, &id, &v)
+                || v >= QUIC_MAX_MIN_ACK_DELAY_US) {
+                reason = TP_REASON_MALFORMED("MIN_ACK_DELAY");
+                goto malformed;
+            }
+
+            ch->rx_min_ack_delay = v;
+            got_min_ack_delay = 1;
+            break;
+
         case QUIC_TPARAM_INITIAL_MAX_STREAMS_BIDI:
             if (got_initial_max_streams_bidi) {
                 /* must not appear more than once */
@@ -1409,8 +1539,9 @@ static int ch_on_transport_params(const unsigned char *params,
                 goto malformed;
             }
 
-            assert(ch->max_local_streams_bidi == 0);
-            ch->max_local_streams_bidi = v;
+            /* May already have been set from remembered TPs for 0-RTT. */
+            if (v > ch->max_local_streams_bidi)
+                ch->max_local_streams_bidi = v;
             got_initial_max_streams_bidi = 1;
             break;
 
@@ -1427,8 +1558,8 @@ static int ch_on_transport_params(const unsigned char *params,
                 goto malformed;
             }
 
-            assert(ch->max_local_streams_uni == 0);
-            ch->max_local_streams_uni = v;
+            if (v > ch->max_local_streams_uni)
+                ch->max_local_streams_uni = v;
             got_initial_max_streams_uni = 1;
             break;
 
@@ -1612,6 +1743,26 @@ static int ch_on_transport_params(const unsigned char *params,
         }
     }
 
+    if (got_min_ack_delay) {
+        /*
+         * draft-ietf-quic-ack-frequency s. 3: min_ack_delay must not exceed
+         * max_ack_delay.
+         */
+        if (ch->rx_min_ack_delay > ch->rx_max_ack_delay * 1000) {
+            reason = TP_REASON_MALFORMED("MIN_ACK_DELAY");
+            goto malformed;
+        }
+
+        /*
+         * The peer supports the ACK frequency extension. Request the same
+         * maximum ACK delay as the peer already uses so that our loss
+         * detection timings are unaffected, and let the congestion controller
+         * decide the ACK-eliciting threshold.
+         */
+        ossl_quic_tx_packetiser_set_ack_frequency(ch->txp,
+                                                  ch->rx_max_ack_delay * 1000);
+    }
+
     ch->got_remote_transport_params = 1;
 
 #ifndef OPENSSL_NO_QLOG
@@ -1649,6 +1800,8 @@ static int ch_on_transport_params(const unsigned char *params,
             QLOG_U64("ack_delay_exponent", ch->rx_ack_delay_exp);
         if (got_max_ack_delay)
             QLOG_U64("max_ack_delay", ch->rx_max_ack_delay);
+        if (got_min_ack_delay)
+            QLOG_U64("min_ack_delay", ch->rx_min_ack_delay);
         if (got_max_udp_payload_size)
             QLOG_U64("max_udp_payload_size", ch->rx_max_udp_payload_size);
         if (got_max_idle_timeout)
@@ -1688,6 +1841,13 @@ static int ch_on_transport_params(const unsigned char *params,
         return 0;
     }
 
+    /* If we are a client, remember the TPs we may need for 0-RTT later. */
+    if (!ch->is_server && !ch_remember_transport_params(ch)) {
+        ossl_quic_channel_raise_protocol_error(ch, OSSL_QUIC_ERR_INTERNAL_ERROR, 0,
+                                               "internal error (remember TPs)");
+        return 0;
+    }
+
     return 1;
 
 malformed:
@@ -1696,6 +1856,153 @@ malformed:
     return 0;
 }
 
+/*
+ * RFC 9000 s. 7.4.1: A client which sends 0-RTT data must remember the
+ * server's flow control and stream limits and the active_connection_id_limit,
+ * and abide by them until it receives the server's new transport parameters.
+ * We encode that subset of the parameters just received and store it in the
+ * session so that it is available when the session is resumed.
+ */
+static int ch_remember_transport_params(QUIC_CHANNEL *ch)
+{
+    int ok = 0;
+    BUF_MEM *buf_mem = NULL;
+    WPACKET wpkt;
+    int wpkt_valid = 0;
+    size_t buf_len = 0;
+
+    if ((buf_mem = BUF_MEM_new()) == NULL)
+        goto err;
+
+    if (!WPACKET_init(&wpkt, buf_mem))
+        goto err;
+
+    wpkt_valid = 1;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_DATA,
+                                                   ossl_quic_txfc_get_cwm(&ch->conn_txfc)))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_BIDI_LOCAL,
+                                                   ch->rx_init_max_stream_data_bidi_remote))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_BIDI_REMOTE,
+                                                   ch->rx_init_max_stream_data_bidi_local))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_UNI,
+                                                   ch->rx_init_max_stream_data_uni))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_STREAMS_BIDI,
+                                                   ch->max_local_streams_bidi))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_STREAMS_UNI,
+                                                   ch->max_local_streams_uni))
+        goto err;
+
+    if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_ACTIVE_CONN_ID_LIMIT,
+                                                   ch->rx_active_conn_id_limit))
+        goto err;
+
+    if (!WPACKET_finish(&wpkt))
+        goto err;
+
+    wpkt_valid = 0;
+
+    if (!WPACKET_get_total_written(&wpkt, &buf_len))
+        goto err;
+
+    if (!ossl_quic_tls_set1_session_transport_params(ch->qtls,
+                                                     (unsigned char *)buf_mem->data,
+                                                     buf_len))
+        goto err;
+
+    ok = 1;
+err:
+    if (wpkt_valid)
+        WPACKET_cleanup(&wpkt);
+    BUF_MEM_free(buf_mem);
+    return ok;
+}
+
+/*
+ * Applies the transport parameters remembered by ch_remember_transport_params
+ * in a previous connection. The values were validated when they were first
+ * received so we only need to check the encoding here.
+ */
+static int ch_apply_remembered_transport_params(QUIC_CHANNEL *ch)
+{
+    PACKET pkt;
+    const unsigned char *params;
+    size_t params_len;
+    uint64_t id, v;
+
+    if (ch->got_remote_transport_params || ch->got_remembered_transport_params)
+        return 1;
+
+    if (!ossl_quic_tls_get0_session_transport_params(ch->qtls, &params,
+                                                     &params_len)
+        || !PACKET_buf_init(&pkt, params, params_len))
+        return 0;
+
+    while (PACKET_remaining(&pkt) > 0) {
+        if (!ossl_quic_wire_decode_transport_param_int(&pkt, &id, &v))
+            return 0;
+
+        switch (id) {
+        case QUIC_TPARAM_INITIAL_MAX_DATA:
+            ossl_quic_txfc_bump_cwm(&ch->conn_txfc, v);
+            break;
+
+        case QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_BIDI_LOCAL:
+            ch->rx_init_max_stream_data_bidi_remote = v;
+            break;
+
+        case QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_BIDI_REMOTE:
+            ch->rx_init_max_stream_data_bidi_local = v;
+            ossl_quic_stream_map_visit(&ch->qsm, txfc_bump_cwm_bidi, &v);
+            break;
+
+        case QUIC_TPARAM_INITIAL_MAX_STREAM_DATA_UNI:
+            ch->rx_init_max_stream_data_uni = v;
+            ossl_quic_stream_map_visit(&ch->qsm, txfc_bump_cwm_uni, &v);
+            break;
+
+        case QUIC_TPARAM_INITIAL_MAX_STREAMS_BIDI:
+            if (v > (((uint64_t)1) << 60))
+                return 0;
+
+            ch->max_local_streams_bidi = v;
+            break;
+
+        case QUIC_TPARAM_INITIAL_MAX_STREAMS_UNI:
+            if (v > (((uint64_t)1) << 60))
+                return 0;
+
+            ch->max_local_streams_uni = v;
+            break;
+
+        case QUIC_TPARAM_ACTIVE_CONN_ID_LIMIT:
+            if (v < QUIC_MIN_ACTIVE_CONN_ID_LIMIT)
+                return 0;
+
+            ch->rx_active_conn_id_limit = v;
+            break;
+
+        default:
+            /* Ignore anything we do not know about. */
+            break;
+        }
+    }
+
+    ch->got_remembered_transport_params = 1;
+    ossl_quic_stream_map_visit(&ch->qsm, do_update, ch);
+    return 1;
+}
+
 /*
  * Called when we want to generate transport parameters. This is called
  * immediately at instantiation time for a client and after we receive the
@@ -1756,6 +2063,15 @@ static int ch_generate_transport_params(QUIC_CHANNEL *ch)
                                                       ch->tx_max_ack_delay))
         goto err;
 
+    if (ch->tx_min_ack_delay > ch->tx_max_ack_delay * 1000)
+        /* Cannot advertise the ACK frequency extension. */
+        ch->tx_min_ack_delay = 0;
+
+    if (ch->tx_min_ack_delay != 0
+        && !ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_MIN_ACK_DELAY,
+                                                      ch->tx_min_ack_delay))
+        goto err;
+
     if (!ossl_quic_wire_encode_transport_param_int(&wpkt, QUIC_TPARAM_INITIAL_MAX_DATA,
                                                    ossl_quic_rxfc_get_cwm(&ch->conn_rxfc)))
         goto err;
@@ -1811,6 +2127,8 @@ static int ch_generate_transport_params(QUIC_CHANNEL *ch)
         QLOG_U64("max_udp_payload_size", QUIC_MIN_INITIAL_DGRAM_LEN);
         QLOG_U64("active_connection_id_limit", QUIC_MIN_ACTIVE_CONN_ID_LIMIT);
         QLOG_U64("max_ack_delay", ch->tx_max_ack_delay);
+        if (ch->tx_min_ack_delay != 0)
+            QLOG_U64("min_ack_delay", ch->tx_min_ack_delay);
         QLOG_U64("initial_max_data", ossl_quic_rxfc_get_cwm(&ch->conn_rxfc));
         QLOG_U64("initial_max_stream_data_bidi_local",
                  ch->tx_init_max_stream_data_bidi_local);
@@ -2058,6 +2376,14 @@ static int ch_rx(QUIC_CHANNEL *ch, int channel_only)
             ossl_quic_tx_packetiser_record_received_closing_bytes(
                     ch->txp, ch->qrx_pkt->hdr->len);
 
+        /* Track the amount of data received from an unvalidated address */
+        if (!ch->addr_validated
+            && ch->qrx_pkt->datagram_id != ch->amp_last_dgram_id) {
+            ch->amp_last_dgram_id = ch->qrx_pkt->datagram_id;
+            ossl_quic_tx_packetiser_record_received_bytes(
+                    ch->txp, ch->qrx_pkt->datagram_len);
+        }
+
         if (!handled_any) {
             ch_update_idle(ch);
             ch_update_ping_deadline(ch);
@@ -2263,22 +2589,37 @@ static void ch_rx_handle_packet(QUIC_CHANNEL *ch, int channel_only)
             return;
 
         /*
-         * TODO(QUIC 0RTT): Implement 0-RTT on the server side. We currently
-         * do not need to implement this as a client can only do 0-RTT if we
-         * have given it permission to in a previous session.
+         * The QRX only has 0-RTT keys if TLS decided to accept early data,
+         * so this packet carries early data we have agreed to process.
          */
+        ossl_quic_handle_frames(ch, ch->qrx_pkt); /* best effort */
         break;
 
     case QUIC_PKT_TYPE_INITIAL:
     case QUIC_PKT_TYPE_HANDSHAKE:
     case QUIC_PKT_TYPE_1RTT:
-        if (ch->is_server && ch->qrx_pkt->hdr->type == QUIC_PKT_TYPE_HANDSHAKE)
+        if (ch->is_server && ch->qrx_pkt->hdr->type == QUIC_PKT_TYPE_HANDSHAKE) {
             /*
              * We automatically drop INITIAL EL keys when first successfully
              * decrypting a HANDSHAKE packet, as per the RFC.
              */
             ch_discard_el(ch, QUIC_ENC_LEVEL_INITIAL);
 
+            /*
+             * RFC 9000 s. 8.1: "a server MUST consider an address to have
+             * been validated if it processes a Handshake packet from the
+             * client."
+             */
+            ossl_quic_channel_on_addr_validated(ch);
+        }
+
+        if (ch->is_server && ch->qrx_pkt->hdr->type == QUIC_PKT_TYPE_1RTT)
+            /*
+             * RFC 9001 s. 4.9.3: A server may discard 0-RTT keys as soon as
+             * it receives a 1-RTT packet.
+             */
+            ch_discard_el(ch, QUIC_ENC_LEVEL_0RTT);
+
         if (ch->rxku_in_progress
             && ch->qrx_pkt->hdr->type == QUIC_PKT_TYPE_1RTT
             && ch->qrx_pkt->pn >= ch->rxku_trigger_pn
@@ -2387,6 +2728,68 @@ static void ch_raise_version_neg_failure(QUIC_CHANNEL *ch)
 }
 
 /* Try to generate packets and if possible, flush them to the network. */
+/*
+ * Tells the congestion controller whether to use a scalable response to ECN-CE
+ * marks. Only NewReno supports this; other congestion controllers fall back to
+ * treating CE marks as they would loss, so the scalable mode is only used with
+ * NewReno.
+ */
+static int ch_ecn_is_scalable(const QUIC_CHANNEL *ch)
+{
+    return ch->ecn_mode == QUIC_ECN_MODE_SCALABLE
+        && ch->cc_method == &ossl_cc_newreno_method;
+}
+
+static void ch_update_ecn_cc(QUIC_CHANNEL *ch)
+{
+    OSSL_PARAM params[2];
+    int scalable = ch_ecn_is_scalable(ch);
+
+    params[0] = OSSL_PARAM_construct_int(OSSL_CC_OPTION_ECN_SCALABLE,
+                                         &scalable);
+    params[1] = OSSL_PARAM_construct_end();
+    ch->cc_method->set_input_params(ch->cc_data, params);
+}
+
+/*
+ * ECN validation (RFC 9000 s. 13.4.2, A.4). We mark the first packets we send
+ * and stop once enough have been sent to test the path. Marking resumes if the
+ * peer's ECN counts validate, and stops for the rest of the connection if they
+ * fail validation or if every marked packet is lost.
+ */
+#define ECN_NUM_TESTING_PKTS    10
+
+static void ch_update_ecn(QUIC_CHANNEL *ch)
+{
+    OSSL_ACKM_ECN_STATS stats;
+    uint32_t ecn = OSSL_ACKM_ECN_NONE;
+
+    if (ch->ecn_state == QUIC_ECN_STATE_DISABLED
+        || ch->ecn_state == QUIC_ECN_STATE_FAILED)
+        return;
+
+    ossl_ackm_get_ecn_stats(ch->ackm, &stats);
+
+    if (stats.failed)
+        ch->ecn_state = QUIC_ECN_STATE_FAILED;
+    else if (stats.num_validated > 0)
+        ch->ecn_state = QUIC_ECN_STATE_CAPABLE;
+    else if (ch->ecn_state == QUIC_ECN_STATE_TESTING
+             && stats.num_sent >= ECN_NUM_TESTING_PKTS)
+        ch->ecn_state = QUIC_ECN_STATE_UNKNOWN;
+    else if (ch->ecn_state == QUIC_ECN_STATE_UNKNOWN
+             && stats.num_lost >= stats.num_sent)
+        ch->ecn_state = QUIC_ECN_STATE_FAILED;
+
+    if ((ch->ecn_state == QUIC_ECN_STATE_TESTING
+         || ch->ecn_state == QUIC_ECN_STATE_CAPABLE)
+        && ossl_qtx_is_ecn_supported(ch->qtx))
+        /* ECT(1) identifies L4S traffic, so only use it if we can respond. */
+        ecn = ch_ecn_is_scalable(ch) ? OSSL_ACKM_ECN_ECT1 : OSSL_ACKM_ECN_ECT0;
+
+    ossl_quic_tx_packetiser_set_ecn(ch->txp, ecn);
+}
+
 static int ch_tx(QUIC_CHANNEL *ch)
 {
     QUIC_TXP_STATUS status;
@@ -2422,6 +2825,8 @@ static int ch_tx(QUIC_CHANNEL *ch)
     /* Do TXKU if we need to. */
     ch_maybe_trigger_spontaneous_txku(ch);
 
+    ch_update_ecn(ch);
+
     ch->rxku_pending_confirm_done = 0;
 
     /* Loop until we stop generating packets to send */
@@ -2606,6 +3011,9 @@ int ossl_quic_channel_start(QUIC_CHANNEL *ch)
         && !ch_generate_transport_params(ch))
         return 0;
 
+    /* Use an address validation token from an earlier connection, if any. */
+    ch_use_stored_token(ch);
+
     /* Change state. */
     ch_record_state_transition(ch, QUIC_CHANNEL_STATE_ACTIVE);
     ch->doing_proactive_ver_neg = 0; /* not currently supported */
@@ -2617,6 +3025,7 @@ int ossl_quic_channel_start(QUIC_CHANNEL *ch)
     if (!ch_tick_tls(ch, /*channel_only=*/0))
         return 0;
 
+    ossl_quic_channel_schedule_tick(ch);
     ossl_quic_reactor_tick(ossl_quic_port_get0_reactor(ch->port), 0); /* best effort */
     return 1;
 }
@@ -2642,6 +3051,60 @@ static void free_token(const unsigned char *buf, size_t buf_len, void *arg)
     OPENSSL_free((unsigned char *)buf);
 }
 
+/*
+ * Returns a string identifying the server a client channel is connecting to,
+ * which is used to look up address validation tokens the server has issued to
+ * us. RFC 9000 s. 8.1.3 requires that a token is only used with the server it
+ * was received from. The caller must free the string using OPENSSL_free().
+ */
+static char *ch_get_server_id(QUIC_CHANNEL *ch)
+{
+    const char *sni = SSL_get_servername(ch->tls, TLSEXT_NAMETYPE_host_name);
+    unsigned char addr[sizeof(ch->cur_peer_addr)];
+    size_t addr_len = 0, id_len;
+    char *addr_hex, *id;
+
+    if (!BIO_ADDR_rawaddress(&ch->cur_peer_addr, NULL, &addr_len)
+        || addr_len > sizeof(addr)
+        || !BIO_ADDR_rawaddress(&ch->cur_peer_addr, addr, &addr_len))
+        addr_len = 0;
+
+    if ((addr_hex = OPENSSL_buf2hexstr(addr, (long)addr_len)) == NULL)
+        return NULL;
+
+    if (sni == NULL)
+        sni = "";
+
+    /* SNI, address, port (up to five digits) and separators */
+    id_len = strlen(sni) + strlen(addr_hex) + 8;
+    if ((id = OPENSSL_malloc(id_len)) != NULL)
+        BIO_snprintf(id, id_len, "%s/%s/%u", sni, addr_hex,
+                     (unsigned int)BIO_ADDR_rawport(&ch->cur_peer_addr));
+
+    OPENSSL_free(addr_hex);
+    return id;
+}
+
+static void ch_use_stored_token(QUIC_CHANNEL *ch)
+{
+    QUIC_TOKEN_STORE *store = ch->port->channel_ctx->quic_token_store;
+    unsigned char *token;
+    size_t token_len;
+    char *server_id;
+
+    if (store == NULL || (server_id = ch_get_server_id(ch)) == NULL)
+        return;
+
+    if (ossl_quic_token_store_take(store, server_id, &token, &token_len)
+        && !ossl_quic_tx_packetiser_set_initial_token(ch->txp, token,
+                                                      token_len, free_token,
+                                                      NULL))
+        /* Too large for us to send; just connect without it. */
+        OPENSSL_free(token);
+
+    OPENSSL_free(server_id);
+}
+
 /* Called when a server asks us to do a retry. */
 static int ch_retry(QUIC_CHANNEL *ch,
                     const unsigned char *retry_token,
@@ -2871,6 +3334,16 @@ static void ch_start_terminating(QUIC_CHANNEL *ch,
 
         ossl_qlog_event_connectivity_connection_closed(ch_get_qlog(ch), tcause);
 
+        if (tcause->app || tcause->error_code == OSSL_QUIC_ERR_NO_ERROR)
+            /*
+             * This is an orderly close, so stop the TLS layer from treating
+             * the session as bad and removing it from the session cache when
+             * it is freed. Otherwise the stateful tickets we use to protect
+             * against 0-RTT replay could never be resumed.
+             */
+            SSL_set_shutdown(ch->tls,
+                             SSL_get_shutdown(ch->tls) | SSL_SENT_SHUTDOWN);
+
         if (!force_immediate) {
             ch_record_state_transition(ch, tcause->remote
                                            ? QUIC_CHANNEL_STATE_TERMINATING_DRAINING
@@ -2962,6 +3435,48 @@ static void free_frame_data(unsigned char *buf, size_t buf_len, void *arg)
     OPENSSL_free(buf);
 }
 
+/* Issues the client an address validation token in a NEW_TOKEN frame. */
+static int ch_enqueue_new_token(QUIC_CHANNEL *ch)
+{
+    BUF_MEM *buf_mem = NULL;
+    WPACKET wpkt;
+    unsigned char token[QUIC_TOKEN_LEN];
+    size_t l;
+
+    if (!ossl_quic_port_generate_token(ch->port, &ch->cur_peer_addr, token))
+        /* We cannot issue tokens for addresses of this kind. */
+        return 1;
+
+    if ((buf_mem = BUF_MEM_new()) == NULL)
+        goto err;
+
+    if (!WPACKET_init(&wpkt, buf_mem))
+        goto err;
+
+    if (!ossl_quic_wire_encode_frame_new_token(&wpkt, token, sizeof(token))) {
+        WPACKET_cleanup(&wpkt);
+        goto err;
+    }
+
+    WPACKET_finish(&wpkt);
+    if (!WPACKET_get_total_written(&wpkt, &l))
+        goto err;
+
+    if (ossl_quic_cfq_add_frame(ch->cfq, 1, QUIC_PN_SPACE_APP,
+                                OSSL_QUIC_FRAME_TYPE_NEW_TOKEN, 0,
+                                (unsigned char *)buf_mem->data, l,
+                                free_frame_data, NULL) == NULL)
+        goto err;
+
+    buf_mem->data = NULL;
+    BUF_MEM_free(buf_mem);
+    return 1;
+
+err:
+    BUF_MEM_free(buf_mem);
+    return 0;
+}
+
 static int ch_enqueue_retire_conn_id(QUIC_CHANNEL *ch, uint64_t seq_num)
 {
     BUF_MEM *buf_mem = NULL;
@@ -3125,9 +3640,16 @@ static void ch_save_err_state(QUIC_CHANNEL *ch)
     OSSL_ERR_STATE_save(ch->err_state);
 }
 
+void ossl_quic_channel_schedule_tick(QUIC_CHANNEL *ch)
+{
+    if (ch->on_port_list)
+        ossl_quic_port_schedule_channel(ch->port, ch);
+}
+
 void ossl_quic_channel_inject(QUIC_CHANNEL *ch, QUIC_URXE *e)
 {
     ossl_qrx_inject_urxe(ch->qrx, e);
+    ossl_quic_channel_schedule_tick(ch);
 }
 
 void ossl_quic_channel_on_stateless_reset(QUIC_CHANNEL *ch)
@@ -3137,6 +3659,7 @@ void ossl_quic_channel_on_stateless_reset(QUIC_CHANNEL *ch)
     tcause.error_code   = OSSL_QUIC_ERR_NO_ERROR;
     tcause.remote       = 1;
     ch_start_terminating(ch, &tcause, 0);
+    ossl_quic_channel_schedule_tick(ch);
 }
 
 void ossl_quic_channel_raise_net_error(QUIC_CHANNEL *ch)
@@ -3157,6 +3680,7 @@ void ossl_quic_channel_raise_net_error(QUIC_CHANNEL *ch)
      * send CONNECTION_CLOSE if we cannot communicate.
      */
     ch_start_terminating(ch, &tcause, 1);
+    ossl_quic_channel_schedule_tick(ch);
 }
 
 int ossl_quic_channel_net_error(QUIC_CHANNEL *ch)
@@ -3352,6 +3876,13 @@ int ossl_quic_channel_on_new_conn(QUIC_CHANNEL *ch, const BIO_ADDR *peer,
     if (!ossl_quic_tx_packetiser_set_peer(ch->txp, &ch->cur_peer_addr))
         return 0;
 
+    /*
+     * The peer address is not validated until the client proves it can
+     * receive packets we send to it (RFC 9000 s. 8.1).
+     */
+    ch->addr_validated = 0;
+    ossl_quic_tx_packetiser_set_addr_validated(ch->txp, 0);
+
     /* Inform TXP of desired CIDs. */
     if (!ossl_quic_tx_packetiser_set_cur_dcid(ch->txp, &ch->cur_remote_dcid))
         return 0;
@@ -3381,6 +3912,35 @@ int ossl_quic_channel_on_new_conn(QUIC_CHANNEL *ch, const BIO_ADDR *peer,
     return 1;
 }
 
+void ossl_quic_channel_on_addr_validated(QUIC_CHANNEL *ch)
+{
+    if (ch->addr_validated)
+        return;
+
+    ch->addr_validated = 1;
+    ossl_quic_tx_packetiser_set_addr_validated(ch->txp, 1);
+}
+
+int ossl_quic_channel_is_addr_validated(const QUIC_CHANNEL *ch)
+{
+    return ch->addr_validated;
+}
+
+void ossl_quic_channel_on_new_token(QUIC_CHANNEL *ch,
+                                    const unsigned char *token,
+                                    size_t token_len)
+{
+    QUIC_TOKEN_STORE *store = ch->port->channel_ctx->quic_token_store;
+    char *server_id;
+
+    if (ch->is_server || store == NULL
+        || (server_id = ch_get_server_id(ch)) == NULL)
+        return;
+
+    ossl_quic_token_store_add(store, server_id, token, token_len);
+    OPENSSL_free(server_id);
+}
+
 SSL *ossl_quic_channel_get0_ssl(QUIC_CHANNEL *ch)
 {
     return ch->tls;
@@ -3406,7 +3966,8 @@ static int ch_init_new_stream(QUIC_CHANNEL *ch, QUIC_STREAM *qs,
     if (!ossl_quic_txfc_init(&qs->txfc, &ch->conn_txfc))
         goto err;
 
-    if (ch->got_remote_transport_params) {
+    if (ch->got_remote_transport_params
+        || ch->got_remembered_transport_params) {
         /*
          * If we already got peer TPs we need to apply the initial CWM credit
          * now. If we didn't already get peer TPs this will be done
@@ -3702,3 +4263,69 @@ uint64_t ossl_quic_channel_get_max_idle_timeout_actual(const QUIC_CHANNEL *ch)
 {
     return ch->max_idle_timeout;
 }
+
+int ossl_quic_channel_set_cc_method(QUIC_CHANNEL *ch,
+                                    const OSSL_CC_METHOD *cc_method)
+{
+    OSSL_CC_DATA *cc_data;
+
+    if (ch->cc_method == cc_method)
+        return 1;
+
+    if (ch->have_sent_any_pkt)
+        return 0;
+
+    if ((cc_data = cc_method->new(get_time, ch)) == NULL)
+        return 0;
+
+    ch->cc_method->free(ch->cc_data);
+    ch->cc_method   = cc_method;
+    ch->cc_data     = cc_data;
+    ch_update_ecn_cc(ch);
+    ossl_ackm_set_cc(ch->ackm, cc_method, cc_data);
+    ossl_quic_tx_packetiser_set_cc(ch->txp, cc_method, cc_data);
+    return 1;
+}
+
+const OSSL_CC_METHOD *ossl_quic_channel_get_cc_method(const QUIC_CHANNEL *ch)
+{
+    return ch->cc_method;
+}
+
+int ossl_quic_channel_set_ecn_mode(QUIC_CHANNEL *ch, uint32_t ecn_mode)
+{
+    if (ch->ecn_mode == ecn_mode)
+        return 1;
+
+    if (ch->have_sent_any_pkt)
+        return 0;
+
+    ch->ecn_mode  = ecn_mode;
+    ch->ecn_state = ecn_mode != QUIC_ECN_MODE_OFF
+        ? QUIC_ECN_STATE_TESTING : QUIC_ECN_STATE_DISABLED;
+    ch_update_ecn_cc(ch);
+    return 1;
+}
+
+uint32_t ossl_quic_channel_get_ecn_mode(const QUIC_CHANNEL *ch)
+{
+    return ch->ecn_mode;
+}
+
+uint32_t ossl_quic_channel_get_ecn_state(const QUIC_CHANNEL *ch)
+{
+    return ch->ecn_state;
+}
+
+void ossl_quic_channel_set_early_data_enabled(QUIC_CHANNEL *ch, int enabled)
+{
+    ossl_quic_tls_set_early_data_enabled(ch->qtls, enabled);
+}
+
+int ossl_quic_channel_can_send_early_data(const QUIC_CHANNEL *ch)
+{
+    return !ch->is_server
+        && !ch->handshake_complete
+        && (ch->el_discarded & (1U << QUIC_ENC_LEVEL_0RTT)) == 0
+        && ossl_qtx_is_enc_level_provisioned(ch->qtx, QUIC_ENC_LEVEL_0RTT);
+}
@@ -36,6 +36,21 @@ struct quic_channel_st {
      */
     OSSL_LIST_MEMBER(ch, struct quic_channel_st);
 
+    /*
+     * Incoming channels which have not yet been accepted by the application
+     * are also kept on the incoming queue of the port.
+     */
+    OSSL_LIST_MEMBER(incoming_ch, struct quic_channel_st);
+
+    /*
+     * QUIC_PORT tick scheduling state. The channel is on at most one of the
+     * due and write-desired lists of the port (sched_state), or otherwise in
+     * its deadline queue if in_sched_pq is set.
+     */
+    OSSL_LIST_MEMBER(sched_ch, struct quic_channel_st);
+    size_t                          sched_pq_idx;
+    OSSL_TIME                       sched_deadline;
+
     /*
      * The associated TLS 1.3 connection data. Used to provide the handshake
      * layer; its 'network' side is plugged into the crypto stream for each EL
@@ -81,6 +96,20 @@ struct quic_channel_st {
     const OSSL_CC_METHOD            *cc_method;
     OSSL_ACKM                       *ackm;
 
+    /*
+     * ECN mode (QUIC_ECN_MODE_*) and the validation state of our path
+     * (QUIC_ECN_STATE_*). A channel only ever uses one path, so this is
+     * per-channel state.
+     */
+    uint32_t                        ecn_mode;
+    uint32_t                        ecn_state;
+
+    /*
+     * ID of the last datagram counted towards the anti-amplification limit,
+     * so that datagrams containing several packets are only counted once.
+     */
+    uint64_t                        amp_last_dgram_id;
+
     /* Record layers in the TX and RX directions. */
     OSSL_QTX                        *qtx;
     OSSL_QRX                        *qrx;
@@ -134,12 +163,14 @@ struct quic_channel_st {
     uint64_t                        tx_init_max_stream_data_bidi_remote;
     uint64_t                        tx_init_max_stream_data_uni;
     uint64_t                        tx_max_ack_delay; /* ms */
+    uint64_t                        tx_min_ack_delay; /* us, 0 if not sent */
 
     /* Transport parameter values received from server. */
     uint64_t                        rx_init_max_stream_data_bidi_local;
     uint64_t                        rx_init_max_stream_data_bidi_remote;
     uint64_t                        rx_init_max_stream_data_uni;
     uint64_t                        rx_max_ack_delay; /* ms */
+    uint64_t                        rx_min_ack_delay; /* us, 0 if not received */
     unsigned char                   rx_ack_delay_exp;
 
     /* Diagnostic counters for testing purposes only. May roll over. */
@@ -294,6 +325,11 @@ struct quic_channel_st {
     unsigned int                    got_remote_transport_params    : 1;
     /* We have generated our local transport parameters. */
     unsigned int                    got_local_transport_params     : 1;
+    /*
+     * We have applied the transport parameters remembered from a previous
+     * connection in order to send 0-RTT data (client only).
+     */
+    unsigned int                    got_remembered_transport_params : 1;
 
     /*
      * This monotonically transitions to 1 once the TLS state machine is
@@ -320,6 +356,14 @@ struct quic_channel_st {
      */
     unsigned int                    doing_retry             : 1;
 
+    /*
+     * Has the peer's address been validated (RFC 9000 s. 8)? Always set on the
+     * client. A server sets this once the client has presented a valid address
+     * validation token or sent a Handshake packet. Until then, the TXP applies
+     * the anti-amplification limit.
+     */
+    unsigned int                    addr_validated          : 1;
+
     /*
      * We don't store the current EL here; the TXP asks the QTX which ELs
      * are provisioned to determine which ELs to use.
@@ -434,6 +478,18 @@ struct quic_channel_st {
     /* Are we on the QUIC_PORT linked list of channels? */
     unsigned int                    on_port_list                        : 1;
 
+    /* Are we on the incoming queue of the QUIC_PORT? */
+    unsigned int                    on_incoming_list                    : 1;
+
+    /* QUIC_PORT tick scheduling state (QUIC_CHANNEL_SCHED_*). */
+    unsigned int                    sched_state                         : 2;
+
+    /* Are we in the deadline queue of the QUIC_PORT? */
+    unsigned int                    in_sched_pq                         : 1;
+
+    /* Did our last tick want to read from the network? */
+    unsigned int                    sched_net_read_desired              : 1;
+
     /* Has qlog been requested? */
     unsigned int                    use_qlog                            : 1;
 
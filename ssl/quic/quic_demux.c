@@ -10,15 +10,23 @@
 #include "internal/quic_demux.h"
 #include "internal/quic_wire_pkt.h"
 #include "internal/common.h"
+#include "internal/bio.h"
 #include <openssl/lhash.h>
 #include <openssl/err.h>
 
 #define URXE_DEMUX_STATE_FREE       0 /* on urx_free list */
 #define URXE_DEMUX_STATE_PENDING    1 /* on urx_pending list */
 #define URXE_DEMUX_STATE_ISSUED     2 /* on neither list */
+#define URXE_DEMUX_STATE_HELD       3 /* released, buffer still referenced */
 
 #define DEMUX_MAX_MSGS_PER_CALL    32
 
+/*
+ * With GRO, each message can hold up to 64KB of datagrams, so we use fewer of
+ * them.
+ */
+#define DEMUX_MAX_GRO_MSGS_PER_CALL 4
+
 #define DEMUX_DEFAULT_MTU        1500
 
 struct quic_demux_st {
@@ -64,10 +72,44 @@ struct quic_demux_st {
      */
     QUIC_URXE_LIST              urx_pending;
 
+    /*
+     * List of URXEs large enough to receive a GRO buffer into, which are not
+     * currently in use.
+     */
+    QUIC_URXE_LIST              urx_gro_free;
+
     /* Whether to use local address support. */
     char                        use_local_addr;
+
+    /* Whether the BIO may coalesce several datagrams into one message. */
+    char                        use_gro;
+
+    /* Whether the BIO reports the ECN codepoint of received datagrams. */
+    char                        use_ecn;
 };
 
+/*
+ * GRO is only used directly on a datagram socket BIO, as a filter BIO would not
+ * know that a message it passes on may hold several datagrams.
+ */
+static void demux_update_gro(QUIC_DEMUX *demux, BIO *net_bio)
+{
+    if (demux->use_gro && demux->net_bio != NULL)
+        (void)BIO_dgram_set_gro(demux->net_bio, 0);
+
+    demux->use_gro = net_bio != NULL
+        && BIO_method_type(net_bio) == BIO_TYPE_DGRAM
+        && BIO_dgram_set_gro(net_bio, 1) > 0;
+}
+
+static void demux_update_ecn(QUIC_DEMUX *demux, BIO *net_bio)
+{
+    if (demux->use_ecn && demux->net_bio != NULL)
+        (void)BIO_dgram_set_ecn(demux->net_bio, 0);
+
+    demux->use_ecn = net_bio != NULL && BIO_dgram_set_ecn(net_bio, 1) > 0;
+}
+
 QUIC_DEMUX *ossl_quic_demux_new(BIO *net_bio,
                                 size_t short_conn_id_len,
                                 OSSL_TIME (*now)(void *arg),
@@ -79,6 +121,8 @@ QUIC_DEMUX *ossl_quic_demux_new(BIO *net_bio,
     if (demux == NULL)
         return NULL;
 
+    demux_update_gro(demux, net_bio);
+    demux_update_ecn(demux, net_bio);
     demux->net_bio                  = net_bio;
     demux->short_conn_id_len        = short_conn_id_len;
     /* We update this if possible when we get a BIO. */
@@ -113,6 +157,7 @@ void ossl_quic_demux_free(QUIC_DEMUX *demux)
     /* Free all URXEs we are holding. */
     demux_free_urxl(&demux->urx_free);
     demux_free_urxl(&demux->urx_pending);
+    demux_free_urxl(&demux->urx_gro_free);
 
     OPENSSL_free(demux);
 }
@@ -121,6 +166,8 @@ void ossl_quic_demux_set_bio(QUIC_DEMUX *demux, BIO *net_bio)
 {
     unsigned int mtu;
 
+    demux_update_gro(demux, net_bio);
+    demux_update_ecn(demux, net_bio);
     demux->net_bio = net_bio;
 
     if (net_bio != NULL) {
@@ -166,10 +213,13 @@ static QUIC_URXE *demux_alloc_urxe(size_t alloc_len)
     ossl_list_urxe_init_elem(e);
     e->alloc_len   = alloc_len;
     e->data_len    = 0;
+    e->data        = NULL;
+    e->data_owner  = NULL;
+    e->data_refs   = 0;
     return e;
 }
 
-static QUIC_URXE *demux_resize_urxe(QUIC_DEMUX *demux, QUIC_URXE *e,
+static QUIC_URXE *demux_resize_urxe(QUIC_URXE_LIST *l, QUIC_URXE *e,
                                     size_t new_alloc_len)
 {
     QUIC_URXE *e2, *prev;
@@ -179,50 +229,125 @@ static QUIC_URXE *demux_resize_urxe(QUIC_DEMUX *demux, QUIC_URXE *e,
         return NULL;
 
     prev = ossl_list_urxe_prev(e);
-    ossl_list_urxe_remove(&demux->urx_free, e);
+    ossl_list_urxe_remove(l, e);
 
     e2 = OPENSSL_realloc(e, sizeof(QUIC_URXE) + new_alloc_len);
     if (e2 == NULL) {
         /* Failed to resize, abort. */
         if (prev == NULL)
-            ossl_list_urxe_insert_head(&demux->urx_free, e);
+            ossl_list_urxe_insert_head(l, e);
         else
-            ossl_list_urxe_insert_after(&demux->urx_free, prev, e);
+            ossl_list_urxe_insert_after(l, prev, e);
 
         return NULL;
     }
 
     if (prev == NULL)
-        ossl_list_urxe_insert_head(&demux->urx_free, e2);
+        ossl_list_urxe_insert_head(l, e2);
     else
-        ossl_list_urxe_insert_after(&demux->urx_free, prev, e2);
+        ossl_list_urxe_insert_after(l, prev, e2);
 
     e2->alloc_len = new_alloc_len;
     return e2;
 }
 
-static QUIC_URXE *demux_reserve_urxe(QUIC_DEMUX *demux, QUIC_URXE *e,
+static QUIC_URXE *demux_reserve_urxe(QUIC_URXE_LIST *l, QUIC_URXE *e,
                                      size_t alloc_len)
 {
-    return e->alloc_len < alloc_len ? demux_resize_urxe(demux, e, alloc_len) : e;
+    return e->alloc_len < alloc_len ? demux_resize_urxe(l, e, alloc_len) : e;
 }
 
-static int demux_ensure_free_urxe(QUIC_DEMUX *demux, size_t min_num_free)
+static int demux_ensure_free_urxe(QUIC_URXE_LIST *l, size_t min_num_free,
+                                  size_t alloc_len)
 {
     QUIC_URXE *e;
 
-    while (ossl_list_urxe_num(&demux->urx_free) < min_num_free) {
-        e = demux_alloc_urxe(demux->mtu);
+    while (ossl_list_urxe_num(l) < min_num_free) {
+        e = demux_alloc_urxe(alloc_len);
         if (e == NULL)
             return 0;
 
-        ossl_list_urxe_insert_tail(&demux->urx_free, e);
+        ossl_list_urxe_insert_tail(l, e);
         e->demux_state = URXE_DEMUX_STATE_FREE;
     }
 
     return 1;
 }
 
+/*
+ * Returns a URXE which is no longer in use to the appropriate free list. If
+ * the URXE holds a datagram split from a GRO receive, the buffer it refers to
+ * is returned as well once nothing else refers to it.
+ */
+static void demux_return_urxe(QUIC_DEMUX *demux, QUIC_URXE *e)
+{
+    QUIC_URXE *owner = e->data_owner;
+
+    if (owner != NULL) {
+        e->data         = NULL;
+        e->data_owner   = NULL;
+        ossl_list_urxe_insert_tail(&demux->urx_free, e);
+        e->demux_state  = URXE_DEMUX_STATE_FREE;
+
+        if (--owner->data_refs > 0
+            || owner->demux_state != URXE_DEMUX_STATE_HELD)
+            return;
+
+        e = owner;
+    } else if (e->data_refs > 0) {
+        /* Datagrams split from this URXE are still in use. */
+        e->demux_state = URXE_DEMUX_STATE_HELD;
+        return;
+    }
+
+    if (e->alloc_len >= BIO_DGRAM_GRO_MAX_LEN)
+        ossl_list_urxe_insert_tail(&demux->urx_gro_free, e);
+    else
+        ossl_list_urxe_insert_tail(&demux->urx_free, e);
+
+    e->demux_state = URXE_DEMUX_STATE_FREE;
+}
+
+/*
+ * Splits a pending URXE holding datagrams coalesced by GRO, all of seg_len
+ * bytes except the last, which may be shorter. The first datagram is left in e
+ * and the others are added to the pending list in URXEs referring to the buffer
+ * of e.
+ */
+static int demux_split_gro(QUIC_DEMUX *demux, QUIC_URXE *e, size_t seg_len)
+{
+    QUIC_URXE *s;
+    size_t off, len = e->data_len;
+
+    if (seg_len == 0 || seg_len >= len)
+        return 1;
+
+    /* These never receive data themselves, so need no buffer. */
+    if (!demux_ensure_free_urxe(&demux->urx_free, (len - 1) / seg_len, 0))
+        return 0;
+
+    e->data_len = seg_len;
+    for (off = seg_len; off < len; off += seg_len) {
+        s = ossl_list_urxe_head(&demux->urx_free);
+        ossl_list_urxe_remove(&demux->urx_free, s);
+
+        s->data         = ossl_quic_urxe_data(e) + off;
+        s->data_len     = len - off < seg_len ? len - off : seg_len;
+        s->data_owner   = e;
+        s->peer         = e->peer;
+        s->local        = e->local;
+        s->time         = e->time;
+        s->ecn          = e->ecn;
+        s->datagram_id  = demux->next_datagram_id++;
+        ++e->data_refs;
+
+        ossl_list_urxe_insert_tail(&demux->urx_pending, s);
+        s->demux_state  = URXE_DEMUX_STATE_PENDING;
+    }
+
+    return 1;
+}
+
 /*
  * Receive datagrams from network, placing them into URXEs.
  *
@@ -234,10 +359,23 @@ static int demux_ensure_free_urxe(QUIC_DEMUX *demux, size_t min_num_free)
 static int demux_recv(QUIC_DEMUX *demux)
 {
     BIO_MSG msg[DEMUX_MAX_MSGS_PER_CALL];
-    size_t rd, i;
-    QUIC_URXE *urxe = ossl_list_urxe_head(&demux->urx_free), *unext;
+    size_t rd, i, num_msg, alloc_len;
+    QUIC_URXE_LIST *free_list;
+    QUIC_URXE *urxe, *unext;
     OSSL_TIME now;
 
+    if (demux->use_gro) {
+        free_list = &demux->urx_gro_free;
+        num_msg   = DEMUX_MAX_GRO_MSGS_PER_CALL;
+        alloc_len = BIO_DGRAM_GRO_MAX_LEN;
+    } else {
+        free_list = &demux->urx_free;
+        num_msg   = DEMUX_MAX_MSGS_PER_CALL;
+        alloc_len = demux->mtu;
+    }
+
+    urxe = ossl_list_urxe_head(free_list);
+
     /* This should never be called when we have any pending URXE. */
     assert(ossl_list_urxe_head(&demux->urx_pending) == NULL);
     assert(urxe->demux_state == URXE_DEMUX_STATE_FREE);
@@ -252,8 +390,7 @@ static int demux_recv(QUIC_DEMUX *demux)
      * Opportunistically receive as many messages as possible in a single
      * syscall, determined by how many free URXEs are available.
      */
-    for (i = 0; i < (ossl_ssize_t)OSSL_NELEM(msg);
-            ++i, urxe = ossl_list_urxe_next(urxe)) {
+    for (i = 0; i < num_msg; ++i, urxe = ossl_list_urxe_next(urxe)) {
         if (urxe == NULL) {
             /* We need at least one URXE to receive into. */
             if (!ossl_assert(i > 0))
@@ -263,7 +400,7 @@ static int demux_recv(QUIC_DEMUX *demux)
         }
 
         /* Ensure the URXE is big enough. */
-        urxe = demux_reserve_urxe(demux, urxe, demux->mtu);
+        urxe = demux_reserve_urxe(free_list, urxe, alloc_len);
         if (urxe == NULL)
             /* Allocation error, fail. */
             return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
@@ -296,18 +433,24 @@ static int demux_recv(QUIC_DEMUX *demux)
     ERR_clear_last_mark();
     now = demux->now != NULL ? demux->now(demux->now_arg) : ossl_time_zero();
 
-    urxe = ossl_list_urxe_head(&demux->urx_free);
+    urxe = ossl_list_urxe_head(free_list);
     for (i = 0; i < rd; ++i, urxe = unext) {
         unext = ossl_list_urxe_next(urxe);
         /* Set URXE with actual length of received datagram. */
         urxe->data_len      = msg[i].data_len;
         /* Time we received datagram. */
         urxe->time          = now;
+        /* ECN codepoint the datagram was received with, if known. */
+        urxe->ecn           = demux->use_ecn ? BIO_MSG_ECN(msg[i].flags) : 0;
         urxe->datagram_id   = demux->next_datagram_id++;
         /* Move from free list to pending list. */
-        ossl_list_urxe_remove(&demux->urx_free, urxe);
+        ossl_list_urxe_remove(free_list, urxe);
         ossl_list_urxe_insert_tail(&demux->urx_pending, urxe);
         urxe->demux_state = URXE_DEMUX_STATE_PENDING;
+
+        if (demux->use_gro
+            && !demux_split_gro(demux, urxe, BIO_MSG_GRO_SEG_LEN(msg[i].flags)))
+            return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
     }
 
     return QUIC_DEMUX_PUMP_RES_OK;
@@ -353,8 +496,7 @@ static int demux_process_pending_urxe(QUIC_DEMUX *demux, QUIC_URXE *e)
                           dst_conn_id_ok ? &dst_conn_id : NULL);
     } else {
         /* Discard. */
-        ossl_list_urxe_insert_tail(&demux->urx_free, e);
-        e->demux_state = URXE_DEMUX_STATE_FREE;
+        demux_return_urxe(demux, e);
     }
 
     return 1; /* keep processing pending URXEs */
@@ -382,7 +524,13 @@ int ossl_quic_demux_pump(QUIC_DEMUX *demux)
     int ret;
 
     if (ossl_list_urxe_head(&demux->urx_pending) == NULL) {
-        ret = demux_ensure_free_urxe(demux, DEMUX_MAX_MSGS_PER_CALL);
+        if (demux->use_gro)
+            ret = demux_ensure_free_urxe(&demux->urx_gro_free,
+                                         DEMUX_MAX_GRO_MSGS_PER_CALL,
+                                         BIO_DGRAM_GRO_MAX_LEN);
+        else
+            ret = demux_ensure_free_urxe(&demux->urx_free,
+                                         DEMUX_MAX_MSGS_PER_CALL, demux->mtu);
         if (ret != 1)
             return QUIC_DEMUX_PUMP_RES_PERMANENT_FAIL;
 
@@ -412,7 +560,7 @@ int ossl_quic_demux_inject(QUIC_DEMUX *demux,
     int ret;
     QUIC_URXE *urxe;
 
-    ret = demux_ensure_free_urxe(demux, 1);
+    ret = demux_ensure_free_urxe(&demux->urx_free, 1, demux->mtu);
     if (ret != 1)
         return 0;
 
@@ -420,7 +568,7 @@ int ossl_quic_demux_inject(QUIC_DEMUX *demux,
 
     assert(urxe->demux_state == URXE_DEMUX_STATE_FREE);
 
-    urxe = demux_reserve_urxe(demux, urxe, buf_len);
+    urxe = demux_reserve_urxe(&demux->urx_free, urxe, buf_len);
     if (urxe == NULL)
         return 0;
 
@@ -439,6 +587,7 @@ int ossl_quic_demux_inject(QUIC_DEMUX *demux,
 
     urxe->time
         = demux->now != NULL ? demux->now(demux->now_arg) : ossl_time_zero();
+    urxe->ecn = 0;
 
     /* Move from free list to pending list. */
     ossl_list_urxe_remove(&demux->urx_free, urxe);
@@ -455,8 +604,7 @@ void ossl_quic_demux_release_urxe(QUIC_DEMUX *demux,
 {
     assert(ossl_list_urxe_prev(e) == NULL && ossl_list_urxe_next(e) == NULL);
     assert(e->demux_state == URXE_DEMUX_STATE_ISSUED);
-    ossl_list_urxe_insert_tail(&demux->urx_free, e);
-    e->demux_state = URXE_DEMUX_STATE_FREE;
+    demux_return_urxe(demux, e);
 }
 
 void ossl_quic_demux_reinject_urxe(QUIC_DEMUX *demux,
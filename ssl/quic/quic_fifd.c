@@ -216,6 +216,11 @@ static void on_lost(void *arg)
                           UINT64_MAX, pkt,
                           fifd->regen_frame_arg);
 
+    if (pkt->had_ack_frequency_frame)
+        fifd->regen_frame(OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY,
+                          UINT64_MAX, pkt,
+                          fifd->regen_frame_arg);
+
     if (pkt->had_ack_frame)
         /*
          * We always use the ACK_WITH_ECN frame type to represent the ACK frame
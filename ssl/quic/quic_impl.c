@@ -17,6 +17,8 @@
 #include "internal/quic_error.h"
 #include "internal/quic_engine.h"
 #include "internal/quic_port.h"
+#include "internal/quic_shard.h"
+#include "internal/quic_cc.h"
 #include "internal/time.h"
 
 typedef struct qctx_st QCTX;
@@ -24,12 +26,14 @@ typedef struct qctx_st QCTX;
 static void aon_write_finish(QUIC_XSO *xso);
 static int create_channel(QUIC_CONNECTION *qc);
 static QUIC_XSO *create_xso_from_stream(QUIC_CONNECTION *qc, QUIC_STREAM *qs);
+static void xso_free_read_buf(QUIC_XSO *xso, QUIC_READ_BUF *rb);
 static int qc_try_create_default_xso_for_write(QCTX *ctx);
 static int qc_wait_for_default_xso_for_read(QCTX *ctx, int peek);
 static void quic_lock(QUIC_CONNECTION *qc);
 static void quic_unlock(QUIC_CONNECTION *qc);
 static void quic_lock_for_io(QCTX *ctx);
 static int quic_do_handshake(QCTX *ctx);
+static int quic_do_handshake_ex(QCTX *ctx, int early_ok);
 static void qc_update_reject_policy(QUIC_CONNECTION *qc);
 static void qc_touch_default_xso(QUIC_CONNECTION *qc);
 static void qc_set_default_xso(QUIC_CONNECTION *qc, QUIC_XSO *xso, int touch);
@@ -42,12 +46,50 @@ static int qc_blocking_mode(const QUIC_CONNECTION *qc);
 static int xso_blocking_mode(const QUIC_XSO *xso);
 static void qctx_maybe_autotick(QCTX *ctx);
 static int qctx_should_autotick(QCTX *ctx);
+static void ql_lock(QUIC_LISTENER *ql);
+static void ql_unlock(QUIC_LISTENER *ql);
+static QUIC_REACTOR *ql_get_reactor(QUIC_LISTENER *ql);
+static void ql_free(QUIC_LISTENER *ql);
+static void ql_set0_net_bio(QUIC_LISTENER *ql, BIO *net_bio, int for_write);
+static int ql_set_blocking_mode(QUIC_LISTENER *ql, int blocking);
+static void ql_handle_events(QUIC_LISTENER *ql);
 
 /*
  * QUIC Front-End I/O API: Common Utilities
  * ========================================
  */
 
+struct block_pred_args {
+    QUIC_CHANNEL    *ch;
+    int             (*pred)(void *arg);
+    void            *pred_arg;
+};
+
+/*
+ * Predicates may give the channel more work to do (e.g. by appending data to a
+ * stream), so make sure the channel is ticked again.
+ */
+static int block_pred(void *arg)
+{
+    struct block_pred_args *args = arg;
+    int res = args->pred(args->pred_arg);
+
+    ossl_quic_channel_schedule_tick(args->ch);
+    return res;
+}
+
+/*
+ * Tick a connection's reactor on behalf of the application. The connection has
+ * usually just been given work to do within the current API call, so mark its
+ * channel as due first.
+ */
+QUIC_NEEDS_LOCK
+static void qc_tick(QUIC_CONNECTION *qc)
+{
+    ossl_quic_channel_schedule_tick(qc->ch);
+    ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(qc->ch), 0);
+}
+
 /*
  * Block until a predicate is met.
  *
@@ -60,6 +102,7 @@ static int block_until_pred(QUIC_CONNECTION *qc,
                             uint32_t flags)
 {
     QUIC_REACTOR *rtor;
+    struct block_pred_args args;
 
     assert(qc->ch != NULL);
 
@@ -69,8 +112,12 @@ static int block_until_pred(QUIC_CONNECTION *qc,
      */
     ossl_quic_engine_set_inhibit_tick(qc->engine, 0);
 
+    args.ch         = qc->ch;
+    args.pred       = pred;
+    args.pred_arg   = pred_arg;
+
     rtor = ossl_quic_channel_get_reactor(qc->ch);
-    return ossl_quic_reactor_block_until_pred(rtor, pred, pred_arg, flags,
+    return ossl_quic_reactor_block_until_pred(rtor, block_pred, &args, flags,
                                               qc->mutex);
 }
 
@@ -226,6 +273,10 @@ static int expect_quic(const SSL *s, QCTX *ctx)
         ctx->in_io      = 0;
         return 1;
 
+    case SSL_TYPE_QUIC_LISTENER:
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED,
+                                           "not supported on a listener");
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
     }
@@ -259,8 +310,11 @@ static int ossl_unused expect_quic_with_stream_lock(const SSL *s, int remote_ini
             goto err;
         }
 
-        /* If we haven't finished the handshake, try to advance it. */
-        if (quic_do_handshake(ctx) < 1)
+        /*
+         * If we haven't finished the handshake, try to advance it. A locally
+         * created stream may be used as soon as we can send 0-RTT data.
+         */
+        if (quic_do_handshake_ex(ctx, /*early_ok=*/remote_init == 0) < 1)
             /* ossl_quic_do_handshake raised error here */
             goto err;
 
@@ -313,6 +367,13 @@ static void quic_lock(QUIC_CONNECTION *qc)
 #if defined(OPENSSL_THREADS)
     ossl_crypto_mutex_lock(qc->mutex);
 #endif
+
+    /*
+     * The port only ticks channels which are due. Any API call may give the
+     * channel something to do, so make sure it is ticked.
+     */
+    if (qc->ch != NULL)
+        ossl_quic_channel_schedule_tick(qc->ch);
 }
 
 static void quic_lock_for_io(QCTX *ctx)
@@ -333,6 +394,10 @@ static void quic_lock_for_io(QCTX *ctx)
 QUIC_NEEDS_LOCK
 static void quic_unlock(QUIC_CONNECTION *qc)
 {
+    /* Covers changes made after any tick performed during the call. */
+    if (qc->ch != NULL)
+        ossl_quic_channel_schedule_tick(qc->ch);
+
 #if defined(OPENSSL_THREADS)
     ossl_crypto_mutex_unlock(qc->mutex);
 #endif
@@ -383,6 +448,13 @@ SSL *ossl_quic_new(SSL_CTX *ctx)
     SSL *ssl_base = NULL;
     SSL_CONNECTION *sc = NULL;
 
+    /* Server-side connections are only created by listeners. */
+    if (ctx->method == OSSL_QUIC_server_method()) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                    "use SSL_new_listener()");
+        return NULL;
+    }
+
     qc = OPENSSL_zalloc(sizeof(*qc));
     if (qc == NULL) {
         QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
@@ -469,8 +541,14 @@ QUIC_TAKES_LOCK
 void ossl_quic_free(SSL *s)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
     int is_default;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        ql_free((QUIC_LISTENER *)s);
+        return;
+    }
+
     /* We should never be called on anything but a QSO. */
     if (!expect_quic(s, &ctx))
         return;
@@ -501,6 +579,14 @@ void ossl_quic_free(SSL *s)
             ossl_quic_stream_map_stop_sending_recv_part(ossl_quic_channel_get_qsm(ctx.qc->ch),
                                                         ctx.xso->stream, 0);
 
+        /* Release any stream data still held by the application. */
+        while (ctx.xso->read_bufs != NULL) {
+            QUIC_READ_BUF *rb = ctx.xso->read_bufs;
+
+            ctx.xso->read_bufs = rb->next;
+            xso_free_read_buf(ctx.xso, rb);
+        }
+
         /* Update stream state. */
         ctx.xso->stream->deleted = 1;
         ossl_quic_stream_map_update_state(ossl_quic_channel_get_qsm(ctx.qc->ch),
@@ -549,6 +635,20 @@ void ossl_quic_free(SSL *s)
     SSL_free(ctx.qc->tls);
 
     ossl_quic_channel_free(ctx.qc->ch);
+    ctx.qc->ch = NULL;
+
+    /*
+     * A connection created by a listener uses the engine, port, network BIOs
+     * and mutex of the listener, and holds a reference to it once accepted.
+     */
+    ql = ctx.qc->listener;
+    if (ql != NULL) {
+        quic_unlock(ctx.qc);
+        if (ctx.qc->accepted)
+            SSL_free(&ql->ssl);
+        return;
+    }
+
     ossl_quic_port_free(ctx.qc->port);
     ossl_quic_engine_free(ctx.qc->engine);
 
@@ -854,6 +954,17 @@ static int csm_analyse_init_peer_addr(BIO *net_wbio, BIO_ADDR *peer)
     return 1;
 }
 
+/* Connections created by a listener use the network BIOs of the listener. */
+static BIO *qc_get_net_rbio(const QUIC_CONNECTION *qc)
+{
+    return qc->listener != NULL ? qc->listener->net_rbio : qc->net_rbio;
+}
+
+static BIO *qc_get_net_wbio(const QUIC_CONNECTION *qc)
+{
+    return qc->listener != NULL ? qc->listener->net_wbio : qc->net_wbio;
+}
+
 static int qc_can_support_blocking_cached(QUIC_CONNECTION *qc)
 {
     QUIC_REACTOR *rtor = ossl_quic_channel_get_reactor(qc->ch);
@@ -876,9 +987,21 @@ void ossl_quic_conn_set0_net_rbio(SSL *s, BIO *net_rbio)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        ql_set0_net_bio((QUIC_LISTENER *)s, net_rbio, /*for_write=*/0);
+        return;
+    }
+
     if (!expect_quic(s, &ctx))
         return;
 
+    if (ctx.qc->listener != NULL) {
+        /* The network BIOs belong to the listener. */
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    NULL);
+        return;
+    }
+
     if (ctx.qc->net_rbio == net_rbio)
         return;
 
@@ -903,9 +1026,21 @@ void ossl_quic_conn_set0_net_wbio(SSL *s, BIO *net_wbio)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        ql_set0_net_bio((QUIC_LISTENER *)s, net_wbio, /*for_write=*/1);
+        return;
+    }
+
     if (!expect_quic(s, &ctx))
         return;
 
+    if (ctx.qc->listener != NULL) {
+        /* The network BIOs belong to the listener. */
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    NULL);
+        return;
+    }
+
     if (ctx.qc->net_wbio == net_wbio)
         return;
 
@@ -930,26 +1065,35 @@ BIO *ossl_quic_conn_get_net_rbio(const SSL *s)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER)
+        return ((const QUIC_LISTENER *)s)->net_rbio;
+
     if (!expect_quic(s, &ctx))
         return NULL;
 
-    return ctx.qc->net_rbio;
+    return qc_get_net_rbio(ctx.qc);
 }
 
 BIO *ossl_quic_conn_get_net_wbio(const SSL *s)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER)
+        return ((const QUIC_LISTENER *)s)->net_wbio;
+
     if (!expect_quic(s, &ctx))
         return NULL;
 
-    return ctx.qc->net_wbio;
+    return qc_get_net_wbio(ctx.qc);
 }
 
 int ossl_quic_conn_get_blocking_mode(const SSL *s)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER)
+        return ((const QUIC_LISTENER *)s)->blocking;
+
     if (!expect_quic(s, &ctx))
         return 0;
 
@@ -965,6 +1109,9 @@ int ossl_quic_conn_set_blocking_mode(SSL *s, int blocking)
     int ret = 0;
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER)
+        return ql_set_blocking_mode((QUIC_LISTENER *)s, blocking);
+
     if (!expect_quic(s, &ctx))
         return 0;
 
@@ -1009,6 +1156,28 @@ out:
     return ret;
 }
 
+/* SSL_set_quic_early_data_enabled */
+int ossl_quic_set_early_data_enabled(SSL *s, int enabled)
+{
+    QCTX ctx;
+
+    if (!expect_quic_conn_only(s, &ctx))
+        return 0;
+
+    quic_lock(ctx.qc);
+
+    if (ctx.qc->as_server || ctx.qc->started) {
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED,
+                                    NULL);
+        quic_unlock(ctx.qc);
+        return 0;
+    }
+
+    ossl_quic_channel_set_early_data_enabled(ctx.qc->ch, enabled);
+    quic_unlock(ctx.qc);
+    return 1;
+}
+
 int ossl_quic_conn_set_initial_peer_addr(SSL *s,
                                          const BIO_ADDR *peer_addr)
 {
@@ -1061,12 +1230,17 @@ int ossl_quic_handle_events(SSL *s)
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        ql_handle_events((QUIC_LISTENER *)s);
+        return 1;
+    }
+
     if (!expect_quic(s, &ctx))
         return 0;
 
     quic_lock(ctx.qc);
     if (ctx.qc->started)
-        ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(ctx.qc->ch), 0);
+        qc_tick(ctx.qc);
     quic_unlock(ctx.qc);
     return 1;
 }
@@ -1082,8 +1256,29 @@ QUIC_TAKES_LOCK
 int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
 {
     QCTX ctx;
+    QUIC_LISTENER *ql;
     OSSL_TIME deadline = ossl_time_infinite();
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        ql = (QUIC_LISTENER *)s;
+
+        ql_lock(ql);
+        if (ql->listening)
+            deadline = ossl_quic_reactor_get_tick_deadline(ql_get_reactor(ql));
+        ql_unlock(ql);
+
+        if (ossl_time_is_infinite(deadline)) {
+            *is_infinite = 1;
+            tv->tv_sec  = 1000000;
+            tv->tv_usec = 0;
+        } else {
+            *tv = ossl_time_to_timeval(ossl_time_subtract(deadline,
+                                                          ossl_time_now()));
+            *is_infinite = 0;
+        }
+        return 1;
+    }
+
     if (!expect_quic(s, &ctx))
         return 0;
 
@@ -1116,31 +1311,27 @@ int ossl_quic_get_event_timeout(SSL *s, struct timeval *tv, int *is_infinite)
 /* SSL_get_rpoll_descriptor */
 int ossl_quic_get_rpoll_descriptor(SSL *s, BIO_POLL_DESCRIPTOR *desc)
 {
-    QCTX ctx;
-
-    if (!expect_quic(s, &ctx))
-        return 0;
+    BIO *net_bio;
 
-    if (desc == NULL || ctx.qc->net_rbio == NULL)
-        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+    net_bio = ossl_quic_conn_get_net_rbio(s);
+    if (desc == NULL || net_bio == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
                                        NULL);
 
-    return BIO_get_rpoll_descriptor(ctx.qc->net_rbio, desc);
+    return BIO_get_rpoll_descriptor(net_bio, desc);
 }
 
 /* SSL_get_wpoll_descriptor */
 int ossl_quic_get_wpoll_descriptor(SSL *s, BIO_POLL_DESCRIPTOR *desc)
 {
-    QCTX ctx;
-
-    if (!expect_quic(s, &ctx))
-        return 0;
+    BIO *net_bio;
 
-    if (desc == NULL || ctx.qc->net_wbio == NULL)
-        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+    net_bio = ossl_quic_conn_get_net_wbio(s);
+    if (desc == NULL || net_bio == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
                                        NULL);
 
-    return BIO_get_wpoll_descriptor(ctx.qc->net_wbio, desc);
+    return BIO_get_wpoll_descriptor(net_bio, desc);
 }
 
 /* SSL_net_read_desired */
@@ -1150,6 +1341,15 @@ int ossl_quic_get_net_read_desired(SSL *s)
     QCTX ctx;
     int ret;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        QUIC_LISTENER *ql = (QUIC_LISTENER *)s;
+
+        ql_lock(ql);
+        ret = ossl_quic_reactor_net_read_desired(ql_get_reactor(ql));
+        ql_unlock(ql);
+        return ret;
+    }
+
     if (!expect_quic(s, &ctx))
         return 0;
 
@@ -1166,6 +1366,15 @@ int ossl_quic_get_net_write_desired(SSL *s)
     int ret;
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        QUIC_LISTENER *ql = (QUIC_LISTENER *)s;
+
+        ql_lock(ql);
+        ret = ossl_quic_reactor_net_write_desired(ql_get_reactor(ql));
+        ql_unlock(ql);
+        return ret;
+    }
+
     if (!expect_quic(s, &ctx))
         return 0;
 
@@ -1454,8 +1663,19 @@ void ossl_quic_set_accept_state(SSL *s)
 /* SSL_do_handshake */
 struct quic_handshake_wait_args {
     QUIC_CONNECTION     *qc;
+    int                 early_ok;
 };
 
+/*
+ * Returns 1 if the handshake has progressed far enough for the caller. If
+ * early_ok is set, being able to send 0-RTT data is sufficient.
+ */
+static int quic_handshake_done(QUIC_CONNECTION *qc, int early_ok)
+{
+    return ossl_quic_channel_is_handshake_complete(qc->ch)
+        || (early_ok && ossl_quic_channel_can_send_early_data(qc->ch));
+}
+
 static int tls_wants_non_io_retry(QUIC_CONNECTION *qc)
 {
     int want = SSL_want(qc->tls);
@@ -1475,7 +1695,7 @@ static int quic_handshake_wait(void *arg)
     if (!quic_mutation_allowed(args->qc, /*req_active=*/1))
         return -1;
 
-    if (ossl_quic_channel_is_handshake_complete(args->qc->ch))
+    if (quic_handshake_done(args->qc, args->early_ok))
         return 1;
 
     if (tls_wants_non_io_retry(args->qc))
@@ -1573,11 +1793,21 @@ static int ensure_channel_started(QCTX *ctx)
 
 QUIC_NEEDS_LOCK
 static int quic_do_handshake(QCTX *ctx)
+{
+    return quic_do_handshake_ex(ctx, /*early_ok=*/0);
+}
+
+/*
+ * Like quic_do_handshake(), but if early_ok is set, also returns 1 once
+ * application data can be sent as 0-RTT data.
+ */
+QUIC_NEEDS_LOCK
+static int quic_do_handshake_ex(QCTX *ctx, int early_ok)
 {
     int ret;
     QUIC_CONNECTION *qc = ctx->qc;
 
-    if (ossl_quic_channel_is_handshake_complete(qc->ch))
+    if (quic_handshake_done(qc, early_ok))
         /* Handshake already completed. */
         return 1;
 
@@ -1589,7 +1819,7 @@ static int quic_do_handshake(QCTX *ctx)
         return -1; /* Non-protocol error */
     }
 
-    if (qc->net_rbio == NULL || qc->net_wbio == NULL) {
+    if (qc_get_net_rbio(qc) == NULL || qc_get_net_wbio(qc) == NULL) {
         /* Need read and write BIOs. */
         QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_BIO_NOT_SET, NULL);
         return -1; /* Non-protocol error */
@@ -1676,7 +1906,7 @@ static int quic_do_handshake(QCTX *ctx)
     if (!ensure_channel_started(ctx)) /* raises on failure */
         return -1; /* Non-protocol error */
 
-    if (ossl_quic_channel_is_handshake_complete(qc->ch))
+    if (quic_handshake_done(qc, early_ok))
         /* The handshake is now done. */
         return 1;
 
@@ -1684,7 +1914,7 @@ static int quic_do_handshake(QCTX *ctx)
         /* Try to advance the reactor. */
         qctx_maybe_autotick(ctx);
 
-        if (ossl_quic_channel_is_handshake_complete(qc->ch))
+        if (quic_handshake_done(qc, early_ok))
             /* The handshake is now done. */
             return 1;
 
@@ -1712,7 +1942,8 @@ static int quic_do_handshake(QCTX *ctx)
         /* In blocking mode, wait for the handshake to complete. */
         struct quic_handshake_wait_args args;
 
-        args.qc     = qc;
+        args.qc         = qc;
+        args.early_ok   = early_ok;
 
         ret = block_until_pred(qc, quic_handshake_wait, &args, 0);
         if (!quic_mutation_allowed(qc, /*req_active=*/1)) {
@@ -1728,7 +1959,7 @@ static int quic_do_handshake(QCTX *ctx)
             return -1;
         }
 
-        assert(ossl_quic_channel_is_handshake_complete(qc->ch));
+        assert(quic_handshake_done(qc, early_ok));
         return 1;
     }
 
@@ -2199,7 +2430,7 @@ static void quic_post_write(QUIC_XSO *xso, int did_append,
      * immediately, plus we should eventually consider Nagle's algorithm.
      */
     if (do_tick)
-        ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(xso->conn->ch), 0);
+        qc_tick(xso->conn);
 }
 
 struct quic_write_again_args {
@@ -2573,9 +2804,10 @@ int ossl_quic_write_flags(SSL *s, const void *buf, size_t len,
 
     /*
      * If we haven't finished the handshake, try to advance it.
-     * We don't accept writes until the handshake is completed.
+     * We don't accept writes until the handshake is completed, unless they
+     * can be sent as 0-RTT data.
      */
-    if (quic_do_handshake(&ctx) < 1) {
+    if (quic_do_handshake_ex(&ctx, /*early_ok=*/1) < 1) {
         ret = 0;
         goto out;
     }
@@ -2613,6 +2845,74 @@ int ossl_quic_write(SSL *s, const void *buf, size_t len, size_t *written)
     return ossl_quic_write_flags(s, buf, len, 0, written);
 }
 
+/*
+ * SSL_write_buffer
+ * ----------------
+ */
+QUIC_TAKES_LOCK
+int ossl_quic_write_buffer(SSL *s, const void *buf, size_t len,
+                           uint64_t flags,
+                           SSL_buffer_release_cb_fn release_cb,
+                           void *release_arg)
+{
+    int ret, err;
+    QCTX ctx;
+
+    if (buf == NULL || len == 0) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (!expect_quic_with_stream_lock(s, /*remote_init=*/0, /*io=*/1, &ctx))
+        return 0;
+
+    if ((flags & ~SSL_WRITE_FLAG_CONCLUDE) != 0) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, SSL_R_UNSUPPORTED_WRITE_FLAG, NULL);
+        goto out;
+    }
+
+    if (!quic_mutation_allowed(ctx.qc, /*req_active=*/0)) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, SSL_R_PROTOCOL_IS_SHUTDOWN, NULL);
+        goto out;
+    }
+
+    if (quic_do_handshake_ex(&ctx, /*early_ok=*/1) < 1) {
+        ret = 0;
+        goto out;
+    }
+
+    if (!quic_validate_for_write(ctx.xso, &err)) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, err, NULL);
+        goto out;
+    }
+
+    /*
+     * The data of an incomplete AON write has been partially appended, so it
+     * must be completed before anything else is appended.
+     */
+    if (ctx.xso->aon_write_in_progress) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, SSL_R_BAD_WRITE_RETRY, NULL);
+        goto out;
+    }
+
+    /*
+     * The buffer is not copied so there is no need to wait for buffer space or
+     * flow control credit; the TXP will send the data as credit permits.
+     */
+    if (!ossl_quic_sstream_append_ref(ctx.xso->stream->sstream, buf, len,
+                                      release_cb, release_arg)) {
+        ret = QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_INTERNAL_ERROR, NULL);
+        goto out;
+    }
+
+    quic_post_write(ctx.xso, 1, 1, flags, qctx_should_autotick(&ctx));
+    ret = 1;
+
+out:
+    quic_unlock(ctx.qc);
+    return ret;
+}
+
 /*
  * SSL_read
  * --------
@@ -2623,6 +2923,7 @@ struct quic_read_again_args {
     void            *buf;
     size_t          len;
     size_t          *bytes_read;
+    const unsigned char **ref;
     int             peek;
 };
 
@@ -2664,10 +2965,53 @@ static int quic_validate_for_read(QUIC_XSO *xso, int *err, int *eos)
     }
 }
 
+/*
+ * Takes the next chunk of stream data out of the stream without copying it and
+ * records it as held by the application until SSL_release_read_buffer().
+ */
+QUIC_NEEDS_LOCK
+static int xso_read_ref(QCTX *ctx, QUIC_STREAM *stream,
+                        const unsigned char **ref, size_t *bytes_read,
+                        int *is_fin)
+{
+    QUIC_READ_BUF *rb;
+
+    if ((rb = OPENSSL_malloc(sizeof(*rb))) == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_CRYPTO_LIB, NULL);
+
+    if (!ossl_quic_rstream_read_ref(stream->rstream, &rb->buf, &rb->buf_len,
+                                    &rb->pkt, is_fin)) {
+        OPENSSL_free(rb);
+        return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
+    }
+
+    *bytes_read = rb->buf_len;
+    if (rb->buf_len == 0) {
+        OPENSSL_free(rb);
+        return 1;
+    }
+
+    rb->next                = ctx->xso->read_bufs;
+    ctx->xso->read_bufs     = rb;
+    *ref                    = rb->buf;
+    return 1;
+}
+
+QUIC_NEEDS_LOCK
+static void xso_free_read_buf(QUIC_XSO *xso, QUIC_READ_BUF *rb)
+{
+    if ((xso->ssl_options & SSL_OP_CLEANSE_PLAINTEXT) != 0)
+        OPENSSL_cleanse((unsigned char *)rb->buf, rb->buf_len);
+
+    ossl_qrx_pkt_release(rb->pkt);
+    OPENSSL_free(rb);
+}
+
 QUIC_NEEDS_LOCK
 static int quic_read_actual(QCTX *ctx,
                             QUIC_STREAM *stream,
                             void *buf, size_t buf_len,
+                            const unsigned char **ref,
                             size_t *bytes_read,
                             int peek)
 {
@@ -2683,7 +3027,11 @@ static int quic_read_actual(QCTX *ctx,
         }
     }
 
-    if (peek) {
+    if (ref != NULL) {
+        if (!xso_read_ref(ctx, stream, ref, bytes_read, &is_fin))
+            return 0; /* xso_read_ref raised error here */
+
+    } else if (peek) {
         if (!ossl_quic_rstream_peek(stream->rstream, buf, buf_len,
                                     bytes_read, &is_fin))
             return QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
@@ -2742,7 +3090,7 @@ static int quic_read_again(void *arg)
     }
 
     if (!quic_read_actual(args->ctx, args->stream,
-                          args->buf, args->len, args->bytes_read,
+                          args->buf, args->len, args->ref, args->bytes_read,
                           args->peek))
         return -1;
 
@@ -2754,7 +3102,8 @@ static int quic_read_again(void *arg)
 }
 
 QUIC_TAKES_LOCK
-static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek)
+static int quic_read(SSL *s, void *buf, size_t len, const unsigned char **ref,
+                     size_t *bytes_read, int peek)
 {
     int ret, res;
     QCTX ctx;
@@ -2793,7 +3142,8 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         ctx.xso = ctx.qc->default_xso;
     }
 
-    if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, bytes_read, peek)) {
+    if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, ref, bytes_read,
+                              peek)) {
         ret = 0; /* quic_read_actual raised error here */
         goto out;
     }
@@ -2816,6 +3166,7 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         args.buf        = buf;
         args.len        = len;
         args.bytes_read = bytes_read;
+        args.ref        = ref;
         args.peek       = peek;
 
         res = block_until_pred(ctx.qc, quic_read_again, &args, 0);
@@ -2836,7 +3187,8 @@ static int quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read, int peek
         qctx_maybe_autotick(&ctx);
 
         /* Try the read again. */
-        if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, bytes_read, peek)) {
+        if (!quic_read_actual(&ctx, ctx.xso->stream, buf, len, ref, bytes_read,
+                              peek)) {
             ret = 0; /* quic_read_actual raised error here */
             goto out;
         }
@@ -2854,12 +3206,59 @@ out:
 
 int ossl_quic_read(SSL *s, void *buf, size_t len, size_t *bytes_read)
 {
-    return quic_read(s, buf, len, bytes_read, 0);
+    return quic_read(s, buf, len, NULL, bytes_read, 0);
 }
 
 int ossl_quic_peek(SSL *s, void *buf, size_t len, size_t *bytes_read)
 {
-    return quic_read(s, buf, len, bytes_read, 1);
+    return quic_read(s, buf, len, NULL, bytes_read, 1);
+}
+
+/*
+ * SSL_read_buffer
+ * ---------------
+ */
+int ossl_quic_read_buffer(SSL *s, const unsigned char **buf, size_t *buf_len)
+{
+    if (buf == NULL || buf_len == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    *buf = NULL;
+    return quic_read(s, NULL, 0, buf, buf_len, 0);
+}
+
+/*
+ * SSL_release_read_buffer
+ * -----------------------
+ */
+QUIC_TAKES_LOCK
+int ossl_quic_release_read_buffer(SSL *s, const unsigned char *buf)
+{
+    QCTX ctx;
+    QUIC_READ_BUF *rb, **prev;
+    int ret = 0;
+
+    if (!expect_quic_with_stream_lock(s, /*remote_init=*/-1, /*io=*/0, &ctx))
+        return 0;
+
+    for (prev = &ctx.xso->read_bufs; (rb = *prev) != NULL; prev = &rb->next)
+        if (rb->buf == buf)
+            break;
+
+    if (rb == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(&ctx, ERR_R_PASSED_INVALID_ARGUMENT, NULL);
+        goto out;
+    }
+
+    *prev = rb->next;
+    xso_free_read_buf(ctx.xso, rb);
+    ret = 1;
+
+out:
+    quic_unlock(ctx.qc);
+    return ret;
 }
 
 /*
@@ -3360,7 +3759,7 @@ static void qctx_maybe_autotick(QCTX *ctx)
     if (!qctx_should_autotick(ctx))
         return;
 
-    ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(ctx->qc->ch), 0);
+    qc_tick(ctx->qc);
 }
 
 QUIC_TAKES_LOCK
@@ -3447,36 +3846,290 @@ err:
     return ret;
 }
 
-QUIC_NEEDS_LOCK
-static int expect_quic_for_value(SSL *s, QCTX *ctx, uint32_t id)
+/* Congestion controllers, indexed by SSL_VALUE_QUIC_CC_*. */
+static const OSSL_CC_METHOD *const cc_methods[] = {
+    &ossl_cc_newreno_method,
+    &ossl_cc_cubic_method,
+    &ossl_cc_bbr_method
+};
+
+static uint64_t cc_method_to_value(const OSSL_CC_METHOD *cc_method)
 {
-    switch (id) {
-    case SSL_VALUE_EVENT_HANDLING_MODE:
-    case SSL_VALUE_STREAM_WRITE_BUF_SIZE:
-    case SSL_VALUE_STREAM_WRITE_BUF_USED:
-    case SSL_VALUE_STREAM_WRITE_BUF_AVAIL:
-        return expect_quic(s, ctx);
-    default:
-        return expect_quic_conn_only(s, ctx);
-    }
+    uint64_t i;
+
+    for (i = 0; i < OSSL_NELEM(cc_methods); ++i)
+        if (cc_methods[i] == cc_method)
+            return i;
+
+    return SSL_VALUE_QUIC_CC_NEWRENO;
 }
 
 QUIC_TAKES_LOCK
-int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
-                             uint64_t *value)
+static int qc_getset_congestion_control(QCTX *ctx, uint32_t class_,
+                                        uint64_t *p_value_out,
+                                        uint64_t *p_value_in)
 {
-    QCTX ctx;
-
-    if (!expect_quic_for_value(s, &ctx, id))
-        return 0;
+    int ret = 0;
+    uint64_t value_out = 0;
 
-    if (value == NULL)
-        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
-                                           ERR_R_PASSED_INVALID_ARGUMENT, NULL);
+    quic_lock(ctx->qc);
 
-    switch (id) {
-    case SSL_VALUE_QUIC_IDLE_TIMEOUT:
-        return qc_getset_idle_timeout(&ctx, class_, value, NULL);
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (p_value_in != NULL) {
+        if (*p_value_in >= OSSL_NELEM(cc_methods)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        /* This can only be changed before the connection starts sending. */
+        if (!ossl_quic_channel_set_cc_method(ctx->qc->ch,
+                                             cc_methods[*p_value_in])) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_FEATURE_NOT_RENEGOTIABLE,
+                                        NULL);
+            goto err;
+        }
+    }
+
+    value_out = cc_method_to_value(ossl_quic_channel_get_cc_method(ctx->qc->ch));
+
+    ret = 1;
+err:
+    quic_unlock(ctx->qc);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
+/*
+ * On a listener, the congestion controller is the default for connections
+ * accepted from now on.
+ */
+QUIC_TAKES_LOCK
+static int ql_getset_congestion_control(QUIC_LISTENER *ql, uint32_t class_,
+                                        uint64_t *p_value_out,
+                                        uint64_t *p_value_in)
+{
+    int ret = 0;
+    uint64_t value_out = 0;
+
+    ql_lock(ql);
+
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (p_value_in != NULL) {
+        if (*p_value_in >= OSSL_NELEM(cc_methods)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        ossl_quic_port_set_cc_method(ql->port, cc_methods[*p_value_in]);
+    }
+
+    value_out = cc_method_to_value(ossl_quic_port_get_cc_method(ql->port));
+
+    ret = 1;
+err:
+    ql_unlock(ql);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
+/* SSL_VALUE_QUIC_ECN_* values are the same as the QUIC_ECN_MODE_* values. */
+QUIC_TAKES_LOCK
+static int qc_getset_ecn(QCTX *ctx, uint32_t class_,
+                         uint64_t *p_value_out, uint64_t *p_value_in)
+{
+    int ret = 0;
+    uint64_t value_out = 0;
+
+    quic_lock(ctx->qc);
+
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (p_value_in != NULL) {
+        if (*p_value_in > SSL_VALUE_QUIC_ECN_SCALABLE) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        /* This can only be changed before the connection starts sending. */
+        if (!ossl_quic_channel_set_ecn_mode(ctx->qc->ch,
+                                            (uint32_t)*p_value_in)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_FEATURE_NOT_RENEGOTIABLE,
+                                        NULL);
+            goto err;
+        }
+    }
+
+    value_out = ossl_quic_channel_get_ecn_mode(ctx->qc->ch);
+
+    ret = 1;
+err:
+    quic_unlock(ctx->qc);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
+/* On a listener, the ECN mode is the default for connections accepted later. */
+QUIC_TAKES_LOCK
+static int ql_getset_ecn(QUIC_LISTENER *ql, uint32_t class_,
+                         uint64_t *p_value_out, uint64_t *p_value_in)
+{
+    int ret = 0;
+    uint64_t value_out = 0;
+
+    ql_lock(ql);
+
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (p_value_in != NULL) {
+        if (*p_value_in > SSL_VALUE_QUIC_ECN_SCALABLE) {
+            QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        ossl_quic_port_set_ecn_mode(ql->port, (uint32_t)*p_value_in);
+    }
+
+    value_out = ossl_quic_port_get_ecn_mode(ql->port);
+
+    ret = 1;
+err:
+    ql_unlock(ql);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
+QUIC_TAKES_LOCK
+static int qc_getset_stream_priority(QCTX *ctx, uint32_t class_,
+                                     uint64_t *p_value_out,
+                                     uint64_t *p_value_in,
+                                     int incremental)
+{
+    int ret = 0;
+    uint64_t value_out = 0;
+    QUIC_STREAM *qs;
+    unsigned int urgency;
+    int is_incremental;
+
+    quic_lock(ctx->qc);
+
+    if (class_ != SSL_VALUE_CLASS_GENERIC) {
+        QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_UNSUPPORTED_CONFIG_VALUE_CLASS,
+                                    NULL);
+        goto err;
+    }
+
+    if (ctx->xso == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(ctx, SSL_R_NO_STREAM, NULL);
+        goto err;
+    }
+
+    qs = ctx->xso->stream;
+
+    if (p_value_in != NULL) {
+        if (*p_value_in >= (incremental ? 2 : QUIC_STREAM_URGENCY_NUM)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_PASSED_INVALID_ARGUMENT,
+                                        NULL);
+            goto err;
+        }
+
+        urgency         = incremental ? qs->urgency : (unsigned int)*p_value_in;
+        is_incremental  = incremental ? (int)*p_value_in : qs->incremental;
+
+        if (!ossl_quic_stream_map_set_priority(ossl_quic_channel_get_qsm(ctx->qc->ch),
+                                               qs, urgency, is_incremental)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(ctx, ERR_R_INTERNAL_ERROR, NULL);
+            goto err;
+        }
+    }
+
+    value_out = incremental ? qs->incremental : qs->urgency;
+
+    ret = 1;
+err:
+    quic_unlock(ctx->qc);
+    if (ret && p_value_out != NULL)
+        *p_value_out = value_out;
+
+    return ret;
+}
+
+QUIC_NEEDS_LOCK
+static int expect_quic_for_value(SSL *s, QCTX *ctx, uint32_t id)
+{
+    switch (id) {
+    case SSL_VALUE_EVENT_HANDLING_MODE:
+    case SSL_VALUE_STREAM_WRITE_BUF_SIZE:
+    case SSL_VALUE_STREAM_WRITE_BUF_USED:
+    case SSL_VALUE_STREAM_WRITE_BUF_AVAIL:
+    case SSL_VALUE_QUIC_STREAM_URGENCY:
+    case SSL_VALUE_QUIC_STREAM_INCREMENTAL:
+        return expect_quic(s, ctx);
+    default:
+        return expect_quic_conn_only(s, ctx);
+    }
+}
+
+QUIC_TAKES_LOCK
+int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
+                             uint64_t *value)
+{
+    QCTX ctx;
+
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER
+        && (id == SSL_VALUE_QUIC_CONGESTION_CONTROL
+            || id == SSL_VALUE_QUIC_ECN)) {
+        if (value == NULL)
+            return QUIC_RAISE_NON_NORMAL_ERROR(NULL,
+                                               ERR_R_PASSED_INVALID_ARGUMENT,
+                                               NULL);
+
+        if (id == SSL_VALUE_QUIC_ECN)
+            return ql_getset_ecn((QUIC_LISTENER *)s, class_, value, NULL);
+
+        return ql_getset_congestion_control((QUIC_LISTENER *)s, class_,
+                                            value, NULL);
+    }
+
+    if (!expect_quic_for_value(s, &ctx, id))
+        return 0;
+
+    if (value == NULL)
+        return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
+                                           ERR_R_PASSED_INVALID_ARGUMENT, NULL);
+
+    switch (id) {
+    case SSL_VALUE_QUIC_IDLE_TIMEOUT:
+        return qc_getset_idle_timeout(&ctx, class_, value, NULL);
 
     case SSL_VALUE_QUIC_STREAM_BIDI_LOCAL_AVAIL:
         return qc_get_stream_avail(&ctx, class_, /*uni=*/0, /*remote=*/0, value);
@@ -3500,6 +4153,18 @@ int ossl_quic_get_value_uint(SSL *s, uint32_t class_, uint32_t id,
         return qc_get_stream_write_buf_stat(&ctx, class_, value,
                                             ossl_quic_sstream_get_buffer_avail);
 
+    case SSL_VALUE_QUIC_CONGESTION_CONTROL:
+        return qc_getset_congestion_control(&ctx, class_, value, NULL);
+    case SSL_VALUE_QUIC_ECN:
+        return qc_getset_ecn(&ctx, class_, value, NULL);
+
+    case SSL_VALUE_QUIC_STREAM_URGENCY:
+        return qc_getset_stream_priority(&ctx, class_, value, NULL,
+                                         /*incremental=*/0);
+    case SSL_VALUE_QUIC_STREAM_INCREMENTAL:
+        return qc_getset_stream_priority(&ctx, class_, value, NULL,
+                                         /*incremental=*/1);
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
                                            SSL_R_UNSUPPORTED_CONFIG_VALUE, NULL);
@@ -3514,6 +4179,14 @@ int ossl_quic_set_value_uint(SSL *s, uint32_t class_, uint32_t id,
 {
     QCTX ctx;
 
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER) {
+        if (id == SSL_VALUE_QUIC_CONGESTION_CONTROL)
+            return ql_getset_congestion_control((QUIC_LISTENER *)s, class_,
+                                                NULL, &value);
+        if (id == SSL_VALUE_QUIC_ECN)
+            return ql_getset_ecn((QUIC_LISTENER *)s, class_, NULL, &value);
+    }
+
     if (!expect_quic_for_value(s, &ctx, id))
         return 0;
 
@@ -3524,6 +4197,18 @@ int ossl_quic_set_value_uint(SSL *s, uint32_t class_, uint32_t id,
     case SSL_VALUE_EVENT_HANDLING_MODE:
         return qc_getset_event_handling(&ctx, class_, NULL, &value);
 
+    case SSL_VALUE_QUIC_CONGESTION_CONTROL:
+        return qc_getset_congestion_control(&ctx, class_, NULL, &value);
+    case SSL_VALUE_QUIC_ECN:
+        return qc_getset_ecn(&ctx, class_, NULL, &value);
+
+    case SSL_VALUE_QUIC_STREAM_URGENCY:
+        return qc_getset_stream_priority(&ctx, class_, NULL, &value,
+                                         /*incremental=*/0);
+    case SSL_VALUE_QUIC_STREAM_INCREMENTAL:
+        return qc_getset_stream_priority(&ctx, class_, NULL, &value,
+                                         /*incremental=*/1);
+
     default:
         return QUIC_RAISE_NON_NORMAL_ERROR(&ctx,
                                            SSL_R_UNSUPPORTED_CONFIG_VALUE, NULL);
@@ -3934,6 +4619,495 @@ int ossl_quic_get_key_update_type(const SSL *s)
     return SSL_KEY_UPDATE_NONE;
 }
 
+/*
+ * QUIC Front-End I/O API: Listeners
+ * =================================
+ *
+ *         SSL_new_listener             => ossl_quic_new_listener
+ *         SSL_new_listener_shard       => ossl_quic_new_listener_shard
+ *         SSL_listen                   => ossl_quic_listen
+ *         SSL_accept_connection        => ossl_quic_accept_connection
+ *         SSL_get_accept_connection_queue_len
+ *                                      => ossl_quic_get_accept_connection_queue_len
+ *         SSL_get0_listener            => ossl_quic_get0_listener
+ *
+ * A QUIC listener SSL object (QLSO) owns a QUIC_ENGINE and a QUIC_PORT. The
+ * port creates a channel for each incoming connection attempt, and we create
+ * the QCSO for it straight away so that it can act as the user SSL object of
+ * the handshake layer. Such QCSOs are held by the port on its incoming queue
+ * until they are handed to the application by SSL_accept_connection(). They
+ * share the engine, port, network BIOs and mutex of the listener.
+ */
+static int expect_quic_listener(const SSL *s, QUIC_LISTENER **ql)
+{
+    *ql = NULL;
+
+    if (s == NULL || s->type != SSL_TYPE_QUIC_LISTENER)
+        return QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                           NULL);
+
+    *ql = (QUIC_LISTENER *)s;
+    return 1;
+}
+
+static void ql_lock(QUIC_LISTENER *ql)
+{
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_lock(ql->mutex);
+#endif
+}
+
+QUIC_NEEDS_LOCK
+static void ql_unlock(QUIC_LISTENER *ql)
+{
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_unlock(ql->mutex);
+#endif
+}
+
+static QUIC_REACTOR *ql_get_reactor(QUIC_LISTENER *ql)
+{
+    return ossl_quic_engine_get0_reactor(ql->engine);
+}
+
+static int ql_can_support_blocking_cached(QUIC_LISTENER *ql)
+{
+    QUIC_REACTOR *rtor = ql_get_reactor(ql);
+
+    return ossl_quic_reactor_can_poll_r(rtor)
+        && ossl_quic_reactor_can_poll_w(rtor);
+}
+
+static void ql_update_blocking_mode(QUIC_LISTENER *ql)
+{
+    ql->blocking = ql->desires_blocking && ql_can_support_blocking_cached(ql);
+}
+
+/* Returns the QCSO created for a channel by ql_on_new_incoming(). */
+static QUIC_CONNECTION *ql_conn_from_channel(QUIC_CHANNEL *ch)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(ossl_quic_channel_get0_ssl(ch));
+
+    return (QUIC_CONNECTION *)sc->user_ssl;
+}
+
+/*
+ * Called by the port when it has created a channel for an incoming connection.
+ * A return value of 0 causes the port to drop the connection attempt.
+ */
+QUIC_NEEDS_LOCK
+static int ql_on_new_incoming(QUIC_CHANNEL *ch, void *arg)
+{
+    QUIC_LISTENER *ql = arg;
+    QUIC_CONNECTION *qc;
+    SSL_CONNECTION *sc;
+
+    if ((sc = SSL_CONNECTION_FROM_SSL(ossl_quic_channel_get0_ssl(ch))) == NULL)
+        return 0;
+
+    if ((qc = OPENSSL_zalloc(sizeof(*qc))) == NULL)
+        return 0;
+
+    if (!ossl_ssl_init(&qc->ssl, ql->ssl.ctx, ql->ssl.method,
+                       SSL_TYPE_QUIC_CONNECTION)) {
+        OPENSSL_free(qc);
+        return 0;
+    }
+
+    /* The handshake layer was created by the port; make us its user SSL. */
+    sc->user_ssl = &qc->ssl;
+
+    qc->tls                     = &sc->ssl;
+    qc->ch                      = ch;
+    qc->listener                = ql;
+    qc->engine                  = ql->engine;
+    qc->port                    = ql->port;
+    qc->mutex                   = ql->mutex;
+    qc->started                 = 1;
+    qc->as_server               = 1;
+    qc->as_server_state         = 1;
+    qc->default_stream_mode     = SSL_DEFAULT_STREAM_MODE_AUTO_BIDI;
+    qc->default_ssl_mode        = qc->ssl.ctx->mode;
+    qc->default_ssl_options     = qc->ssl.ctx->options & OSSL_QUIC_PERMITTED_OPTIONS;
+    qc->desires_blocking        = ql->desires_blocking;
+    qc->incoming_stream_policy  = SSL_INCOMING_STREAM_POLICY_AUTO;
+    qc->last_error              = SSL_ERROR_NONE;
+
+    ossl_quic_channel_set_msg_callback(ch, qc->ssl.ctx->msg_callback,
+                                       &qc->ssl);
+    ossl_quic_channel_set_msg_callback_arg(ch, qc->ssl.ctx->msg_callback_arg);
+
+    qc_update_reject_policy(qc);
+    qc_update_blocking_mode(qc);
+    return 1;
+}
+
+static QUIC_LISTENER *ql_new(SSL_CTX *ctx)
+{
+    QUIC_LISTENER *ql = NULL;
+    QUIC_ENGINE_ARGS engine_args = {0};
+    QUIC_PORT_ARGS port_args = {0};
+
+    ql = OPENSSL_zalloc(sizeof(*ql));
+    if (ql == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        return NULL;
+    }
+
+#if defined(OPENSSL_THREADS)
+    if ((ql->mutex = ossl_crypto_mutex_new()) == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        OPENSSL_free(ql);
+        return NULL;
+    }
+#endif
+
+    if (!ossl_ssl_init(&ql->ssl, ctx, ctx->method, SSL_TYPE_QUIC_LISTENER)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+#if defined(OPENSSL_THREADS)
+        ossl_crypto_mutex_free(&ql->mutex);
+#endif
+        OPENSSL_free(ql);
+        return NULL;
+    }
+
+    ql->desires_blocking = 1;
+
+    engine_args.libctx  = ctx->libctx;
+    engine_args.propq   = ctx->propq;
+    engine_args.mutex   = ql->mutex;
+    if ((ql->engine = ossl_quic_engine_new(&engine_args)) == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        goto err;
+    }
+
+    port_args.channel_ctx           = ctx;
+    port_args.is_multi_conn         = 1;
+    port_args.new_incoming_cb       = ql_on_new_incoming;
+    port_args.new_incoming_cb_arg   = ql;
+    if ((ql->port = ossl_quic_engine_create_port(ql->engine, &port_args)) == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_INTERNAL_ERROR, NULL);
+        goto err;
+    }
+
+    return ql;
+
+err:
+    SSL_free(&ql->ssl);
+    return NULL;
+}
+
+/* SSL_new_listener */
+SSL *ossl_quic_new_listener(SSL_CTX *ctx, uint64_t flags)
+{
+    QUIC_LISTENER *ql;
+
+    if (ctx->method != OSSL_QUIC_server_method()) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                    "a QUIC server method is required");
+        return NULL;
+    }
+
+    if (flags != 0) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED, NULL);
+        return NULL;
+    }
+
+    if ((ql = ql_new(ctx)) == NULL)
+        return NULL;
+
+    return &ql->ssl;
+}
+
+/*
+ * SSL_new_listener_shard
+ * ----------------------
+ *
+ * The listeners of a shard group each have their own engine, port and mutex,
+ * so that they can be driven by different threads. The group itself is
+ * created when the first shard is added to a listener.
+ */
+QUIC_TAKES_LOCK
+static QUIC_SHARD_GROUP *ql_get_shard_group(QUIC_LISTENER *ql)
+{
+    QUIC_SHARD_GROUP *grp;
+
+    ql_lock(ql);
+
+    if ((grp = ossl_quic_port_get0_shard_group(ql->port)) != NULL) {
+        if (!ossl_quic_shard_group_up_ref(grp)) {
+            QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+            grp = NULL;
+        }
+        goto out;
+    }
+
+    if ((grp = ossl_quic_shard_group_new()) == NULL) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_CRYPTO_LIB, NULL);
+        goto out;
+    }
+
+    if (!ossl_quic_port_join_shard_group(ql->port, grp)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_PASSED_INVALID_ARGUMENT,
+                                    "listener already has connections");
+        ossl_quic_shard_group_free(grp);
+        grp = NULL;
+    }
+
+out:
+    ql_unlock(ql);
+    return grp;
+}
+
+SSL *ossl_quic_new_listener_shard(SSL *ssl, uint64_t flags)
+{
+    QUIC_LISTENER *ql, *new_ql;
+    QUIC_SHARD_GROUP *grp;
+
+    if (!expect_quic_listener(ssl, &ql))
+        return NULL;
+
+    if (flags != 0) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED, NULL);
+        return NULL;
+    }
+
+    if ((grp = ql_get_shard_group(ql)) == NULL)
+        return NULL;
+
+    if ((new_ql = ql_new(ql->ssl.ctx)) == NULL) {
+        ossl_quic_shard_group_free(grp);
+        return NULL;
+    }
+
+    if (!ossl_quic_port_join_shard_group(new_ql->port, grp)) {
+        QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED,
+                                    "too many listeners in shard group");
+        ossl_quic_shard_group_free(grp);
+        SSL_free(&new_ql->ssl);
+        return NULL;
+    }
+
+    /* The port holds its own reference to the group. */
+    ossl_quic_shard_group_free(grp);
+    return &new_ql->ssl;
+}
+
+/* Called from ossl_quic_free() once the last reference is gone. */
+static void ql_free(QUIC_LISTENER *ql)
+{
+    QUIC_CHANNEL *ch;
+
+    /*
+     * Every QCSO we have handed out holds a reference to us, so only the
+     * connections nobody has accepted yet remain.
+     */
+    if (ql->port != NULL)
+        while ((ch = ossl_quic_port_pop_incoming(ql->port)) != NULL)
+            SSL_free(&ql_conn_from_channel(ch)->ssl);
+
+    ossl_quic_port_free(ql->port);
+    ossl_quic_engine_free(ql->engine);
+
+    BIO_free_all(ql->net_rbio);
+    BIO_free_all(ql->net_wbio);
+
+#if defined(OPENSSL_THREADS)
+    ossl_crypto_mutex_free(&ql->mutex);
+#endif
+}
+
+static void ql_set0_net_bio(QUIC_LISTENER *ql, BIO *net_bio, int for_write)
+{
+    BIO **pbio = for_write ? &ql->net_wbio : &ql->net_rbio;
+    int ok;
+
+    ql_lock(ql);
+
+    if (*pbio == net_bio)
+        goto out;
+
+    ok = for_write ? ossl_quic_port_set_net_wbio(ql->port, net_bio)
+                   : ossl_quic_port_set_net_rbio(ql->port, net_bio);
+    if (!ok)
+        goto out;
+
+    BIO_free_all(*pbio);
+    *pbio = net_bio;
+
+    if (net_bio != NULL)
+        BIO_set_nbio(net_bio, 1); /* best effort autoconfig */
+
+    ossl_quic_port_update_poll_descriptors(ql->port); /* best effort */
+    ql_update_blocking_mode(ql);
+
+out:
+    ql_unlock(ql);
+}
+
+QUIC_TAKES_LOCK
+static int ql_set_blocking_mode(QUIC_LISTENER *ql, int blocking)
+{
+    int ret = 1;
+
+    ql_lock(ql);
+
+    if (blocking) {
+        ossl_quic_port_update_poll_descriptors(ql->port);
+
+        /* Cannot enable blocking mode if we do not have pollable FDs. */
+        if (!ql_can_support_blocking_cached(ql))
+            ret = QUIC_RAISE_NON_NORMAL_ERROR(NULL, ERR_R_UNSUPPORTED, NULL);
+    }
+
+    if (ret)
+        ql->desires_blocking = (blocking != 0);
+
+    ql_update_blocking_mode(ql);
+    ql_unlock(ql);
+    return ret;
+}
+
+QUIC_TAKES_LOCK
+static void ql_handle_events(QUIC_LISTENER *ql)
+{
+    ql_lock(ql);
+    if (ql->listening)
+        ossl_quic_reactor_tick(ql_get_reactor(ql), 0);
+    ql_unlock(ql);
+}
+
+/* SSL_listen */
+QUIC_TAKES_LOCK
+int ossl_quic_listen(SSL *ssl)
+{
+    QUIC_LISTENER *ql;
+    int ret = 1;
+
+    if (!expect_quic_listener(ssl, &ql))
+        return 0;
+
+    ql_lock(ql);
+
+    if (!ql->listening) {
+        if (ql->net_rbio == NULL || ql->net_wbio == NULL) {
+            ret = QUIC_RAISE_NON_NORMAL_ERROR(NULL, SSL_R_BIO_NOT_SET, NULL);
+            goto out;
+        }
+
+        ossl_quic_port_set_allow_incoming(ql->port, 1);
+        ql->listening = 1;
+    }
+
+out:
+    ql_unlock(ql);
+    return ret;
+}
+
+/*
+ * SSL_accept_connection
+ * ---------------------
+ */
+QUIC_NEEDS_LOCK
+static int wait_for_incoming_conn(void *arg)
+{
+    QUIC_LISTENER *ql = arg;
+
+    if (!ossl_quic_port_is_running(ql->port)) {
+        /* If the port fails while blocking, stop. */
+        ossl_quic_port_restore_err_state(ql->port);
+        return -1;
+    }
+
+    return ossl_quic_port_have_incoming(ql->port);
+}
+
+QUIC_TAKES_LOCK
+SSL *ossl_quic_accept_connection(SSL *ssl, uint64_t flags)
+{
+    QUIC_LISTENER *ql;
+    QUIC_CHANNEL *ch;
+    QUIC_CONNECTION *qc;
+    SSL *new_s = NULL;
+    int ret;
+
+    if (!expect_quic_listener(ssl, &ql))
+        return NULL;
+
+    /* Calling this function implicitly starts listening. */
+    if (!ossl_quic_listen(ssl))
+        return NULL;
+
+    ql_lock(ql);
+
+    if (!ossl_quic_port_have_incoming(ql->port)) {
+        if (ql->blocking && (flags & SSL_ACCEPT_CONNECTION_NO_BLOCK) == 0) {
+            ossl_quic_engine_set_inhibit_tick(ql->engine, 0);
+            ret = ossl_quic_reactor_block_until_pred(ql_get_reactor(ql),
+                                                     wait_for_incoming_conn, ql,
+                                                     0, ql->mutex);
+            if (ret < 1)
+                goto out;
+        } else {
+            /* Make progress on any pending connections. */
+            ossl_quic_reactor_tick(ql_get_reactor(ql), 0);
+        }
+    }
+
+    if ((ch = ossl_quic_port_pop_incoming(ql->port)) == NULL)
+        goto out;
+
+    /* The connection now holds a reference to the listener. */
+    qc = ql_conn_from_channel(ch);
+    if (!SSL_up_ref(&ql->ssl)) {
+        SSL_free(&qc->ssl);
+        goto out;
+    }
+
+    qc->accepted = 1;
+    new_s = &qc->ssl;
+
+out:
+    ql_unlock(ql);
+    return new_s;
+}
+
+/*
+ * SSL_get_accept_connection_queue_len
+ * -----------------------------------
+ */
+QUIC_TAKES_LOCK
+size_t ossl_quic_get_accept_connection_queue_len(SSL *ssl)
+{
+    QUIC_LISTENER *ql;
+    size_t v;
+
+    if (!expect_quic_listener(ssl, &ql))
+        return 0;
+
+    ql_lock(ql);
+    v = ossl_quic_port_get_num_incoming_channels(ql->port);
+    ql_unlock(ql);
+    return v;
+}
+
+/*
+ * SSL_get0_listener
+ * -----------------
+ */
+SSL *ossl_quic_get0_listener(SSL *s)
+{
+    QCTX ctx;
+
+    if (s != NULL && s->type == SSL_TYPE_QUIC_LISTENER)
+        return s;
+
+    if (!expect_quic(s, &ctx))
+        return NULL;
+
+    return ctx.qc->listener != NULL ? &ctx.qc->listener->ssl : NULL;
+}
+
 /*
  * QUIC Front-End I/O API: SSL_CTX Management
  * ==========================================
@@ -4138,7 +5312,7 @@ int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
     }
 
     if (do_tick)
-        ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(ctx.qc->ch), 0);
+        qc_tick(ctx.qc);
 
     if (ctx.xso != NULL) {
         /* SSL object has a stream component. */
@@ -4192,6 +5366,68 @@ int ossl_quic_conn_poll_events(SSL *ssl, uint64_t events, int do_tick,
     return 1;
 }
 
+/*
+ * Reports what SSL_poll() needs to block on a QUIC connection or stream SSL
+ * object: the FDs used by the reactor serving it, whether the reactor wants to
+ * read or write them, and the (real) time by which it must next be ticked. *rfd
+ * and *wfd are set to -1 if there is nothing to wait on. *can_poll is set to 0
+ * if the reactor's network BIOs do not expose pollable FDs.
+ */
+QUIC_TAKES_LOCK
+int ossl_quic_conn_poll_wait_info(SSL *ssl, int *rfd, int *want_r,
+                                  int *wfd, int *want_w,
+                                  OSSL_TIME *deadline, int *can_poll)
+{
+    QCTX ctx;
+    QUIC_REACTOR *rtor;
+    const BIO_POLL_DESCRIPTOR *d;
+    OSSL_TIME now;
+
+    if (!expect_quic(ssl, &ctx))
+        return 0;
+
+    *rfd        = -1;
+    *wfd        = -1;
+    *want_r     = 0;
+    *want_w     = 0;
+    *deadline   = ossl_time_infinite();
+    *can_poll   = 1;
+
+    quic_lock(ctx.qc);
+
+    if (!ctx.qc->started)
+        goto end;
+
+    rtor = ossl_quic_channel_get_reactor(ctx.qc->ch);
+    if (!ossl_quic_reactor_can_poll_r(rtor)
+        || !ossl_quic_reactor_can_poll_w(rtor)) {
+        *can_poll = 0;
+    } else {
+        d = ossl_quic_reactor_get_poll_r(rtor);
+        if (d->type == BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD)
+            *rfd = d->value.fd;
+
+        d = ossl_quic_reactor_get_poll_w(rtor);
+        if (d->type == BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD)
+            *wfd = d->value.fd;
+
+        *want_r = ossl_quic_reactor_net_read_desired(rtor);
+        *want_w = ossl_quic_reactor_net_write_desired(rtor);
+    }
+
+    *deadline = ossl_quic_reactor_get_tick_deadline(rtor);
+    if (!ossl_time_is_infinite(*deadline)) {
+        /* The channel may run on a custom clock; convert to real time. */
+        now = get_time(ctx.qc);
+        *deadline = ossl_time_add(ossl_time_now(),
+                                  ossl_time_subtract(*deadline, now));
+    }
+
+ end:
+    quic_unlock(ctx.qc);
+    return 1;
+}
+
 /*
  * Internal Testing APIs
  * =====================
@@ -58,6 +58,7 @@ struct quic_lcidm_st {
     LHASH_OF(QUIC_LCID)         *lcids; /* (QUIC_CONN_ID) -> (QUIC_LCID *)  */
     LHASH_OF(QUIC_LCIDM_CONN)   *conns; /* (void *opaque) -> (QUIC_LCIDM_CONN *) */
     size_t                      lcid_len; /* Length in bytes for all LCIDs */
+    int                         shard_id; /* Encoded in LCIDs if not -1 */
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
     QUIC_CONN_ID                next_lcid;
 #endif
@@ -113,6 +114,7 @@ QUIC_LCIDM *ossl_quic_lcidm_new(OSSL_LIB_CTX *libctx, size_t lcid_len)
 
     lcidm->libctx   = libctx;
     lcidm->lcid_len = lcid_len;
+    lcidm->shard_id = -1;
     return lcidm;
 
 err:
@@ -287,6 +289,15 @@ size_t ossl_quic_lcidm_get_num_active_lcid(const QUIC_LCIDM *lcidm,
     return conn->num_active_lcid;
 }
 
+int ossl_quic_lcidm_set_shard(QUIC_LCIDM *lcidm, int shard_id)
+{
+    if (shard_id < -1 || shard_id > QUIC_LCID_MAX_SHARD || lcidm->lcid_len == 0)
+        return 0;
+
+    lcidm->shard_id = shard_id;
+    return 1;
+}
+
 static int lcidm_generate_cid(QUIC_LCIDM *lcidm,
                               QUIC_CONN_ID *cid)
 {
@@ -299,11 +310,15 @@ static int lcidm_generate_cid(QUIC_LCIDM *lcidm,
     for (i = lcidm->lcid_len - 1; i >= 0; --i)
         if (++lcidm->next_lcid.id[i] != 0)
             break;
-
-    return 1;
 #else
-    return ossl_quic_gen_rand_conn_id(lcidm->libctx, lcidm->lcid_len, cid);
+    if (!ossl_quic_gen_rand_conn_id(lcidm->libctx, lcidm->lcid_len, cid))
+        return 0;
 #endif
+
+    if (lcidm->shard_id >= 0 && cid->id_len > 0)
+        cid->id[0] = (unsigned char)lcidm->shard_id;
+
+    return 1;
 }
 
 static int lcidm_generate(QUIC_LCIDM *lcidm,
@@ -31,6 +31,17 @@
  * for QSSO objects, wrapping the QUIC-native QUIC_STREAM object and tracking
  * state required by the libssl API personality.
  */
+/* Stream data handed out to the application by SSL_read_buffer(). */
+typedef struct quic_read_buf_st QUIC_READ_BUF;
+
+struct quic_read_buf_st {
+    QUIC_READ_BUF                   *next;
+    const unsigned char             *buf;
+    size_t                          buf_len;
+    /* The decrypted packet holding buf, referenced until buf is released. */
+    OSSL_QRX_PKT                    *pkt;
+};
+
 struct quic_xso_st {
     /* SSL object common header. */
     struct ssl_st                   ssl;
@@ -105,6 +116,12 @@ struct quic_xso_st {
      */
     size_t                          aon_buf_pos;
 
+    /*
+     * Stream data returned by SSL_read_buffer() which the application has not
+     * yet released with SSL_release_read_buffer().
+     */
+    QUIC_READ_BUF                   *read_bufs;
+
     /* SSL_set_mode */
     uint32_t                        ssl_mode;
 
@@ -177,6 +194,13 @@ struct quic_conn_st {
     OSSL_TIME                       (*override_now_cb)(void *arg);
     void                            *override_now_cb_arg;
 
+    /*
+     * The listener this connection was accepted from, or NULL. Connections
+     * created by a listener share its engine, port and mutex, and hold a
+     * reference to the listener once they have been accepted.
+     */
+    QUIC_LISTENER                   *listener;
+
     /* Number of XSOs allocated. Includes the default XSO, if any. */
     size_t                          num_xso;
 
@@ -224,6 +248,9 @@ struct quic_conn_st {
     /* Event handling mode. One of SSL_QUIC_VALUE_EVENT_HANDLING. */
     unsigned int                    event_handling_mode     : 2;
 
+    /* Has this connection been returned by SSL_accept_connection()? */
+    unsigned int                    accepted                : 1;
+
     /* Default stream type. Defaults to SSL_DEFAULT_STREAM_MODE_AUTO_BIDI. */
     uint32_t                        default_stream_mode;
 
@@ -245,6 +272,40 @@ struct quic_conn_st {
     int                             last_error;
 };
 
+/*
+ * QUIC listener SSL object (QLSO) type. This implements the API personality
+ * layer for QUIC listeners, wrapping a QUIC_PORT which owns the network BIOs
+ * shared by all connections accepted through the listener.
+ */
+struct quic_listener_st {
+    /* SSL object common header. Must come first. */
+    struct ssl_st                   ssl;
+
+    /* The QUIC engine representing the QUIC event domain. */
+    QUIC_ENGINE                     *engine;
+
+    /* The QUIC port which incoming connections are received on. */
+    QUIC_PORT                       *port;
+
+    /*
+     * The mutex used to synchronise access to the engine. We own this; it is
+     * also used by every connection accepted through the listener.
+     */
+    CRYPTO_MUTEX                    *mutex;
+
+    /* The network read and write BIOs. */
+    BIO                             *net_rbio, *net_wbio;
+
+    /* Has SSL_listen() been called? */
+    unsigned int                    listening               : 1;
+
+    /* Does SSL_accept_connection() block? */
+    unsigned int                    blocking                : 1;
+
+    /* Does the application want blocking mode? */
+    unsigned int                    desires_blocking        : 1;
+};
+
 /* Internal calls to the QUIC CSM which come from various places. */
 int ossl_quic_conn_on_handshake_confirmed(QUIC_CONNECTION *qc);
 
@@ -268,7 +329,8 @@ int ossl_quic_trace(int write_p, int version, int content_type,
 #  define OSSL_QUIC_ANY_VERSION 0xFFFFF
 #  define IS_QUIC_METHOD(m) \
     ((m) == OSSL_QUIC_client_method() || \
-     (m) == OSSL_QUIC_client_thread_method())
+     (m) == OSSL_QUIC_client_thread_method() || \
+     (m) == OSSL_QUIC_server_method())
 #  define IS_QUIC_CTX(ctx)          IS_QUIC_METHOD((ctx)->method)
 
 #  define QUIC_CONNECTION_FROM_SSL_int(ssl, c)   \
@@ -292,13 +354,21 @@ int ossl_quic_trace(int write_p, int version, int content_type,
          ? (c SSL_CONNECTION *)((c QUIC_CONNECTION *)(ssl))->tls \
          : NULL))
 
+#  define QUIC_LISTENER_FROM_SSL_int(ssl, c)   \
+     ((ssl) == NULL ? NULL                     \
+      : ((ssl)->type == SSL_TYPE_QUIC_LISTENER \
+         ? (c QUIC_LISTENER *)(ssl)            \
+         : NULL))
+
 #  define IS_QUIC(ssl) ((ssl) != NULL                                   \
                         && ((ssl)->type == SSL_TYPE_QUIC_CONNECTION     \
-                            || (ssl)->type == SSL_TYPE_QUIC_XSO))
+                            || (ssl)->type == SSL_TYPE_QUIC_XSO         \
+                            || (ssl)->type == SSL_TYPE_QUIC_LISTENER))
 # else
 #  define QUIC_CONNECTION_FROM_SSL_int(ssl, c) NULL
 #  define QUIC_XSO_FROM_SSL_int(ssl, c) NULL
 #  define SSL_CONNECTION_FROM_QUIC_SSL_int(ssl, c) NULL
+#  define QUIC_LISTENER_FROM_SSL_int(ssl, c) NULL
 #  define IS_QUIC(ssl) 0
 #  define IS_QUIC_CTX(ctx) 0
 #  define IS_QUIC_METHOD(m) 0
@@ -312,6 +382,10 @@ int ossl_quic_trace(int write_p, int version, int content_type,
     QUIC_XSO_FROM_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
 # define QUIC_XSO_FROM_CONST_SSL(ssl) \
     QUIC_XSO_FROM_SSL_int(ssl, const)
+# define QUIC_LISTENER_FROM_SSL(ssl) \
+    QUIC_LISTENER_FROM_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
+# define QUIC_LISTENER_FROM_CONST_SSL(ssl) \
+    QUIC_LISTENER_FROM_SSL_int(ssl, const)
 # define SSL_CONNECTION_FROM_QUIC_SSL(ssl) \
     SSL_CONNECTION_FROM_QUIC_SSL_int(ssl, SSL_CONNECTION_NO_CONST)
 # define SSL_CONNECTION_FROM_CONST_QUIC_SSL(ssl) \
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_pacer.h"
+#include "internal/safe_math.h"
+
+OSSL_SAFE_MATH_UNSIGNED(u64, uint64_t)
+
+void ossl_quic_pacer_init(QUIC_PACER *pacer)
+{
+    pacer->rate         = 0;
+    pacer->burst        = 0;
+    pacer->tokens       = 0;
+    pacer->last_update  = ossl_time_zero();
+}
+
+/* Adds the tokens which have accumulated since the last update. */
+static void pacer_refill(QUIC_PACER *pacer, OSSL_TIME now)
+{
+    uint64_t elapsed_us, add;
+    int err = 0;
+
+    if (ossl_time_compare(now, pacer->last_update) <= 0)
+        return;
+
+    elapsed_us = ossl_time2us(ossl_time_subtract(now, pacer->last_update));
+    add = safe_muldiv_u64(elapsed_us, pacer->rate, 1000000, &err);
+    if (err || add > pacer->burst)
+        add = pacer->burst;
+
+    /*
+     * If less than a byte has accumulated, leave last_update alone so that
+     * frequent calls do not lose the fractional part.
+     */
+    if (add == 0)
+        return;
+
+    pacer->tokens += (int64_t)add;
+    if (pacer->tokens > (int64_t)pacer->burst)
+        pacer->tokens = (int64_t)pacer->burst;
+
+    pacer->last_update = now;
+}
+
+void ossl_quic_pacer_set_rate(QUIC_PACER *pacer, uint64_t rate, uint64_t burst,
+                              OSSL_TIME now)
+{
+    if (pacer->rate != 0)
+        pacer_refill(pacer, now);
+    else
+        /* Start with a full bucket when pacing is (re-)enabled. */
+        pacer->tokens = (int64_t)burst;
+
+    if (burst > INT64_MAX)
+        burst = INT64_MAX;
+
+    pacer->rate         = rate;
+    pacer->burst        = burst;
+    if (pacer->tokens > (int64_t)burst)
+        pacer->tokens = (int64_t)burst;
+
+    if (rate == 0 || ossl_time_is_zero(pacer->last_update))
+        pacer->last_update = now;
+}
+
+int ossl_quic_pacer_can_send(QUIC_PACER *pacer, OSSL_TIME now)
+{
+    if (pacer->rate == 0)
+        return 1;
+
+    pacer_refill(pacer, now);
+    return pacer->tokens > 0;
+}
+
+void ossl_quic_pacer_on_sent(QUIC_PACER *pacer, uint64_t num_bytes)
+{
+    if (pacer->rate == 0)
+        return;
+
+    if (num_bytes > INT64_MAX / 2)
+        num_bytes = INT64_MAX / 2;
+
+    pacer->tokens -= (int64_t)num_bytes;
+
+    /* Do not let debt build up beyond one burst. */
+    if (pacer->tokens < -(int64_t)pacer->burst)
+        pacer->tokens = -(int64_t)pacer->burst;
+}
+
+OSSL_TIME ossl_quic_pacer_get_deadline(const QUIC_PACER *pacer)
+{
+    uint64_t need, wait_us;
+    int err = 0;
+
+    if (pacer->rate == 0 || pacer->tokens > 0)
+        return ossl_time_zero();
+
+    /* Time until the bucket holds at least one byte. */
+    need    = (uint64_t)(-pacer->tokens) + 1;
+    wait_us = safe_muldiv_u64(need, 1000000, pacer->rate, &err);
+    if (err)
+        return ossl_time_infinite();
+
+    /* Round up so that we do not wake up too early. */
+    return ossl_time_add(pacer->last_update, ossl_us2time(wait_us + 1));
+}
@@ -11,6 +11,9 @@
 #include "internal/quic_channel.h"
 #include "internal/quic_lcidm.h"
 #include "internal/quic_srtm.h"
+#include "internal/quic_cc.h"
+#include "internal/quic_shard.h"
+#include "internal/quic_token.h"
 #include "quic_port_local.h"
 #include "quic_channel_local.h"
 #include "quic_engine_local.h"
@@ -21,6 +24,7 @@
  * ===================
  */
 #define INIT_DCID_LEN                   8
+#define DEFAULT_MAX_INCOMING            32
 
 static int port_init(QUIC_PORT *port);
 static void port_cleanup(QUIC_PORT *port);
@@ -28,8 +32,12 @@ static OSSL_TIME get_time(void *arg);
 static void port_default_packet_handler(QUIC_URXE *e, void *arg,
                                         const QUIC_CONN_ID *dcid);
 static void port_rx_pre(QUIC_PORT *port);
+static int ch_sched_cmp(const QUIC_CHANNEL *a, const QUIC_CHANNEL *b);
+static void port_schedule_all(QUIC_PORT *port);
 
 DEFINE_LIST_OF_IMPL(ch, QUIC_CHANNEL);
+DEFINE_LIST_OF_IMPL(incoming_ch, QUIC_CHANNEL);
+DEFINE_LIST_OF_IMPL(sched_ch, QUIC_CHANNEL);
 DEFINE_LIST_OF_IMPL(port, QUIC_PORT);
 
 QUIC_PORT *ossl_quic_port_new(const QUIC_PORT_ARGS *args)
@@ -42,6 +50,11 @@ QUIC_PORT *ossl_quic_port_new(const QUIC_PORT_ARGS *args)
     port->engine        = args->engine;
     port->channel_ctx   = args->channel_ctx;
     port->is_multi_conn = args->is_multi_conn;
+    port->new_incoming_cb       = args->new_incoming_cb;
+    port->new_incoming_cb_arg   = args->new_incoming_cb_arg;
+    port->max_incoming          = DEFAULT_MAX_INCOMING;
+    port->shard_id              = -1;
+    port->ecn_mode              = QUIC_ECN_MODE_CLASSIC;
 
     if (!port_init(port)) {
         OPENSSL_free(port);
@@ -70,6 +83,9 @@ static int port_init(QUIC_PORT *port)
     if ((port->err_state = OSSL_ERR_STATE_new()) == NULL)
         goto err;
 
+    if ((port->sched_pq = ossl_pqueue_QUIC_CHANNEL_new(ch_sched_cmp)) == NULL)
+        goto err;
+
     if ((port->demux = ossl_quic_demux_new(/*BIO=*/NULL,
                                            /*Short CID Len=*/rx_short_dcid_len,
                                            get_time, port)) == NULL)
@@ -87,6 +103,10 @@ static int port_init(QUIC_PORT *port)
                                            rx_short_dcid_len)) == NULL)
         goto err;
 
+    if ((port->token_key = ossl_quic_token_key_new(port->engine->libctx,
+                                                   port->engine->propq)) == NULL)
+        goto err;
+
     port->rx_short_dcid_len = (unsigned char)rx_short_dcid_len;
     port->tx_init_dcid_len  = INIT_DCID_LEN;
     port->state             = QUIC_PORT_STATE_RUNNING;
@@ -113,9 +133,22 @@ static void port_cleanup(QUIC_PORT *port)
     ossl_quic_lcidm_free(port->lcidm);
     port->lcidm = NULL;
 
+    ossl_quic_token_key_free(port->token_key);
+    port->token_key = NULL;
+
+    if (port->shard_group != NULL) {
+        ossl_quic_shard_group_leave(port->shard_group, port->shard_id);
+        ossl_quic_shard_group_free(port->shard_group);
+        port->shard_group = NULL;
+        port->shard_id = -1;
+    }
+
     OSSL_ERR_STATE_free(port->err_state);
     port->err_state = NULL;
 
+    ossl_pqueue_QUIC_CHANNEL_free(port->sched_pq);
+    port->sched_pq = NULL;
+
     if (port->on_engine_list) {
         ossl_list_port_remove(&port->engine->port_list, port);
         port->on_engine_list = 0;
@@ -165,6 +198,13 @@ static OSSL_TIME get_time(void *port)
     return ossl_quic_port_get_time((QUIC_PORT *)port);
 }
 
+int ossl_quic_port_generate_token(QUIC_PORT *port, const BIO_ADDR *peer,
+                                  unsigned char *buf)
+{
+    return ossl_quic_token_generate(port->token_key, peer,
+                                    ossl_quic_port_get_time(port), buf);
+}
+
 int ossl_quic_port_get_rx_short_dcid_len(const QUIC_PORT *port)
 {
     return port->rx_short_dcid_len;
@@ -260,6 +300,7 @@ int ossl_quic_port_set_net_rbio(QUIC_PORT *port, BIO *net_rbio)
 
     ossl_quic_demux_set_bio(port->demux, net_rbio);
     port->net_rbio = net_rbio;
+    port_schedule_all(port);
     return 1;
 }
 
@@ -273,8 +314,10 @@ int ossl_quic_port_set_net_wbio(QUIC_PORT *port, BIO *net_wbio)
     if (!port_update_poll_desc(port, net_wbio, /*for_write=*/1))
         return 0;
 
-    OSSL_LIST_FOREACH(ch, ch, &port->channel_list)
+    OSSL_LIST_FOREACH(ch, ch, &port->channel_list) {
         ossl_qtx_set_bio(ch->qtx, net_wbio);
+        ossl_quic_port_schedule_channel(port, ch);
+    }
 
     port->net_wbio = net_wbio;
     return 1;
@@ -313,6 +356,8 @@ static QUIC_CHANNEL *port_make_channel(QUIC_PORT *port, SSL *tls, int is_server)
     args.tls        = (tls != NULL ? tls : port_new_handshake_layer(port));
     args.lcidm      = port->lcidm;
     args.srtm       = port->srtm;
+    args.cc_method  = port->cc_method;
+    args.ecn_mode   = port->ecn_mode;
     if (args.tls == NULL)
         return NULL;
 
@@ -332,6 +377,18 @@ static QUIC_CHANNEL *port_make_channel(QUIC_PORT *port, SSL *tls, int is_server)
     return ch;
 }
 
+/*
+ * Frees a channel created by port_make_channel() for an incoming connection,
+ * together with its handshake layer object.
+ */
+static void port_free_channel(QUIC_CHANNEL *ch)
+{
+    SSL *tls = ossl_quic_channel_get0_ssl(ch);
+
+    ossl_quic_channel_free(ch);
+    SSL_free(tls);
+}
+
 QUIC_CHANNEL *ossl_quic_port_create_outgoing(QUIC_PORT *port, SSL *tls)
 {
     return port_make_channel(port, tls, /*is_server=*/0);
@@ -349,11 +406,221 @@ QUIC_CHANNEL *ossl_quic_port_create_incoming(QUIC_PORT *port, SSL *tls)
     return ch;
 }
 
+void ossl_quic_port_set_allow_incoming(QUIC_PORT *port, int allow_incoming)
+{
+    port->allow_incoming = (allow_incoming != 0);
+    if (port->allow_incoming)
+        port->is_server = 1;
+}
+
+QUIC_CHANNEL *ossl_quic_port_pop_incoming(QUIC_PORT *port)
+{
+    QUIC_CHANNEL *ch;
+
+    ch = ossl_list_incoming_ch_head(&port->incoming_list);
+    if (ch == NULL)
+        return NULL;
+
+    ossl_list_incoming_ch_remove(&port->incoming_list, ch);
+    ch->on_incoming_list = 0;
+    return ch;
+}
+
+int ossl_quic_port_have_incoming(QUIC_PORT *port)
+{
+    return ossl_list_incoming_ch_head(&port->incoming_list) != NULL;
+}
+
+size_t ossl_quic_port_get_num_incoming_channels(const QUIC_PORT *port)
+{
+    return ossl_list_incoming_ch_num(&port->incoming_list);
+}
+
+int ossl_quic_port_join_shard_group(QUIC_PORT *port, QUIC_SHARD_GROUP *grp)
+{
+    int shard_id;
+
+    if (port->shard_group != NULL || port->rx_short_dcid_len == 0
+        || ossl_list_ch_num(&port->channel_list) > 0)
+        return 0;
+
+    if ((shard_id = ossl_quic_shard_group_join(grp)) < 0)
+        return 0;
+
+    if (!ossl_quic_lcidm_set_shard(port->lcidm, shard_id)
+        || !ossl_quic_shard_group_up_ref(grp)) {
+        ossl_quic_lcidm_set_shard(port->lcidm, -1);
+        ossl_quic_shard_group_leave(grp, shard_id);
+        return 0;
+    }
+
+    port->shard_group   = grp;
+    port->shard_id      = shard_id;
+    return 1;
+}
+
+QUIC_SHARD_GROUP *ossl_quic_port_get0_shard_group(const QUIC_PORT *port)
+{
+    return port->shard_group;
+}
+
+int ossl_quic_port_get_shard_id(const QUIC_PORT *port)
+{
+    return port->shard_id;
+}
+
+void ossl_quic_port_set_cc_method(QUIC_PORT *port,
+                                  const OSSL_CC_METHOD *cc_method)
+{
+    port->cc_method = cc_method;
+}
+
+const OSSL_CC_METHOD *ossl_quic_port_get_cc_method(const QUIC_PORT *port)
+{
+    return port->cc_method != NULL ? port->cc_method : &ossl_cc_newreno_method;
+}
+
+void ossl_quic_port_set_ecn_mode(QUIC_PORT *port, uint32_t ecn_mode)
+{
+    port->ecn_mode = ecn_mode;
+}
+
+uint32_t ossl_quic_port_get_ecn_mode(const QUIC_PORT *port)
+{
+    return port->ecn_mode;
+}
+
 /*
  * QUIC Port: Ticker-Mutator
  * =========================
  */
 
+/*
+ * QUIC Port: Tick Scheduling
+ * ==========================
+ *
+ * Ticking every channel on every port tick makes each wakeup O(channels), which
+ * is wasteful when most channels of a busy server are idle. Instead, a channel
+ * is only ticked when it has received datagrams, has been used by the
+ * application, has datagrams waiting to be sent, or when its tick deadline
+ * (idle timeout, loss detection, ACK delay, pacing, etc.) has expired.
+ */
+static int ch_sched_cmp(const QUIC_CHANNEL *a, const QUIC_CHANNEL *b)
+{
+    return ossl_time_compare(a->sched_deadline, b->sched_deadline);
+}
+
+/* Removes a channel from whichever list or queue it is scheduled on. */
+static void port_sched_unlink(QUIC_PORT *port, QUIC_CHANNEL *ch)
+{
+    switch (ch->sched_state) {
+    case QUIC_CHANNEL_SCHED_DUE:
+        ossl_list_sched_ch_remove(&port->due_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_NONE;
+        break;
+    case QUIC_CHANNEL_SCHED_WDES:
+        ossl_list_sched_ch_remove(&port->wdes_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_NONE;
+        break;
+    case QUIC_CHANNEL_SCHED_TICKING:
+        ossl_list_sched_ch_remove(&port->tick_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_NONE;
+        break;
+    default:
+        break;
+    }
+
+    if (ch->in_sched_pq) {
+        ossl_pqueue_QUIC_CHANNEL_remove(port->sched_pq, ch->sched_pq_idx);
+        ch->in_sched_pq = 0;
+    }
+}
+
+void ossl_quic_port_schedule_channel(QUIC_PORT *port, QUIC_CHANNEL *ch)
+{
+    if (ch->sched_state == QUIC_CHANNEL_SCHED_DUE
+        || ch->sched_state == QUIC_CHANNEL_SCHED_TICKING)
+        return;
+
+    port_sched_unlink(port, ch);
+    ossl_list_sched_ch_insert_tail(&port->due_list, ch);
+    ch->sched_state = QUIC_CHANNEL_SCHED_DUE;
+}
+
+void ossl_quic_port_unschedule_channel(QUIC_PORT *port, QUIC_CHANNEL *ch)
+{
+    port_sched_unlink(port, ch);
+
+    if (ch->sched_net_read_desired) {
+        --port->num_net_read_desired;
+        ch->sched_net_read_desired = 0;
+    }
+}
+
+static void port_schedule_all(QUIC_PORT *port)
+{
+    QUIC_CHANNEL *ch;
+
+    OSSL_LIST_FOREACH(ch, ch, &port->channel_list)
+        ossl_quic_port_schedule_channel(port, ch);
+}
+
+/* Schedules the next tick of a channel which has just been ticked. */
+static void port_reschedule_channel(QUIC_PORT *port, QUIC_CHANNEL *ch,
+                                    const QUIC_TICK_RESULT *r)
+{
+    if ((r->net_read_desired != 0) != ch->sched_net_read_desired) {
+        if (r->net_read_desired)
+            ++port->num_net_read_desired;
+        else
+            --port->num_net_read_desired;
+
+        ch->sched_net_read_desired = (r->net_read_desired != 0);
+    }
+
+    ch->sched_deadline = r->tick_deadline;
+
+    /* Already due again (e.g. it was used during its own tick). */
+    if (ch->sched_state != QUIC_CHANNEL_SCHED_NONE)
+        return;
+
+    if (r->net_write_desired) {
+        ossl_list_sched_ch_insert_tail(&port->wdes_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_WDES;
+    } else if (!ossl_time_is_infinite(r->tick_deadline)) {
+        if (!ossl_pqueue_QUIC_CHANNEL_push(port->sched_pq, ch,
+                                           &ch->sched_pq_idx)) {
+            /* Fall back to ticking every channel. */
+            port->sched_failed = 1;
+            return;
+        }
+
+        ch->in_sched_pq = 1;
+    }
+}
+
+/* Computes the merged tick result of all channels without visiting them. */
+static void port_get_sched_result(QUIC_PORT *port, QUIC_TICK_RESULT *res)
+{
+    QUIC_CHANNEL *ch;
+
+    res->net_read_desired   = (port->num_net_read_desired > 0);
+    res->net_write_desired  = (ossl_list_sched_ch_num(&port->wdes_list) > 0);
+
+    if (port->sched_failed
+        || ossl_list_sched_ch_num(&port->due_list) > 0) {
+        res->tick_deadline = ossl_time_zero();
+        return;
+    }
+
+    if ((ch = ossl_pqueue_QUIC_CHANNEL_peek(port->sched_pq)) != NULL)
+        res->tick_deadline = ch->sched_deadline;
+
+    OSSL_LIST_FOREACH(ch, sched_ch, &port->wdes_list)
+        res->tick_deadline = ossl_time_min(res->tick_deadline,
+                                           ch->sched_deadline);
+}
+
 /*
  * Tick function for this port. This does everything related to network I/O for
  * this port's network BIOs, and services child channels.
@@ -362,16 +629,20 @@ void ossl_quic_port_subtick(QUIC_PORT *port, QUIC_TICK_RESULT *res,
                             uint32_t flags)
 {
     QUIC_CHANNEL *ch;
+    OSSL_TIME now;
 
     res->net_read_desired   = 0;
     res->net_write_desired  = 0;
     res->tick_deadline      = ossl_time_infinite();
 
-    if (!port->engine->inhibit_tick) {
-        /* Handle any incoming data from network. */
-        if (ossl_quic_port_is_running(port))
-            port_rx_pre(port);
+    if (port->engine->inhibit_tick)
+        return;
 
+    /* Handle any incoming data from network. */
+    if (ossl_quic_port_is_running(port))
+        port_rx_pre(port);
+
+    if (port->sched_failed) {
         /* Iterate through all channels and service them. */
         OSSL_LIST_FOREACH(ch, ch, &port->channel_list) {
             QUIC_TICK_RESULT subr = {0};
@@ -379,7 +650,52 @@ void ossl_quic_port_subtick(QUIC_PORT *port, QUIC_TICK_RESULT *res,
             ossl_quic_channel_subtick(ch, &subr, flags);
             ossl_quic_tick_result_merge_into(res, &subr);
         }
+
+        return;
+    }
+
+    /* Channels whose deadlines have expired are due. */
+    now = ossl_quic_port_get_time(port);
+    while ((ch = ossl_pqueue_QUIC_CHANNEL_peek(port->sched_pq)) != NULL
+           && ossl_time_compare(ch->sched_deadline, now) <= 0)
+        ossl_quic_port_schedule_channel(port, ch);
+
+    /* Channels with datagrams waiting to be sent are always ticked. */
+    while ((ch = ossl_list_sched_ch_head(&port->wdes_list)) != NULL)
+        ossl_quic_port_schedule_channel(port, ch);
+
+    /*
+     * Service only the channels which are due now. Channels which become due
+     * while doing so are serviced on the next tick.
+     */
+    while ((ch = ossl_list_sched_ch_head(&port->due_list)) != NULL) {
+        ossl_list_sched_ch_remove(&port->due_list, ch);
+        ossl_list_sched_ch_insert_tail(&port->tick_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_TICKING;
+    }
+
+    while ((ch = ossl_list_sched_ch_head(&port->tick_list)) != NULL) {
+        QUIC_TICK_RESULT subr = {0};
+
+        ossl_list_sched_ch_remove(&port->tick_list, ch);
+        ch->sched_state = QUIC_CHANNEL_SCHED_NONE;
+
+        ossl_quic_channel_subtick(ch, &subr, flags);
+        port_reschedule_channel(port, ch, &subr);
     }
+
+    port_get_sched_result(port, res);
+}
+
+/* Called for each datagram forwarded to us by another member of our group. */
+static void port_on_forwarded_dgram(const unsigned char *data, size_t data_len,
+                                    const BIO_ADDR *peer, const BIO_ADDR *local,
+                                    void *arg)
+{
+    QUIC_PORT *port = arg;
+
+    /* If the demuxer cannot take the datagram, it is lost like any other. */
+    ossl_quic_demux_inject(port->demux, data, data_len, peer, local);
 }
 
 /* Process incoming datagrams, if any. */
@@ -406,6 +722,14 @@ static void port_rx_pre(QUIC_PORT *port)
     if (!port->is_server && !port->have_sent_any_pkt)
         return;
 
+    /*
+     * Datagrams forwarded to us by other shards are queued ahead of anything
+     * we receive from the network ourselves.
+     */
+    if (port->shard_group != NULL)
+        ossl_quic_shard_group_drain(port->shard_group, port->shard_id,
+                                    port_on_forwarded_dgram, port);
+
     /*
      * Get DEMUX to BIO_recvmmsg from the network and queue incoming datagrams
      * to the appropriate QRX instances.
@@ -424,22 +748,51 @@ static void port_rx_pre(QUIC_PORT *port)
 /*
  * Handles an incoming connection request and potentially decides to make a
  * connection from it. If a new connection is made, the new channel is written
- * to *new_ch.
+ * to *new_ch. addr_validated is set if the client presented a valid address
+ * validation token.
  */
 static void port_on_new_conn(QUIC_PORT *port, const BIO_ADDR *peer,
                              const QUIC_CONN_ID *scid,
                              const QUIC_CONN_ID *dcid,
+                             int addr_validated,
                              QUIC_CHANNEL **new_ch)
 {
+    QUIC_CHANNEL *ch;
+
     if (port->tserver_ch != NULL) {
         /* Specially assign to existing channel */
         if (!ossl_quic_channel_on_new_conn(port->tserver_ch, peer, scid, dcid))
             return;
 
+        if (addr_validated)
+            ossl_quic_channel_on_addr_validated(port->tserver_ch);
+
         *new_ch = port->tserver_ch;
         port->tserver_ch = NULL;
         return;
     }
+
+    if (!port->allow_incoming
+        || ossl_list_incoming_ch_num(&port->incoming_list) >= port->max_incoming)
+        return;
+
+    /* Create a new channel for the connection and queue it. */
+    if ((ch = port_make_channel(port, NULL, /*is_server=*/1)) == NULL)
+        return;
+
+    if (!ossl_quic_channel_on_new_conn(ch, peer, scid, dcid)
+        || (port->new_incoming_cb != NULL
+            && !port->new_incoming_cb(ch, port->new_incoming_cb_arg))) {
+        port_free_channel(ch);
+        return;
+    }
+
+    if (addr_validated)
+        ossl_quic_channel_on_addr_validated(ch);
+
+    ossl_list_incoming_ch_insert_tail(&port->incoming_list, ch);
+    ch->on_incoming_list = 1;
+    *new_ch = ch;
 }
 
 static int port_try_handle_stateless_reset(QUIC_PORT *port, const QUIC_URXE *e)
@@ -488,6 +841,46 @@ static int port_try_handle_stateless_reset(QUIC_PORT *port, const QUIC_URXE *e)
     return i > 0;
 }
 
+/*
+ * Forwards a datagram whose DCID is not known to us to the member of our shard
+ * group which issued the DCID. Only short header and Handshake packets are
+ * forwarded, as the DCID of any other packet type was chosen by the client
+ * rather than by a shard. Returns 1 if the datagram was forwarded, in which
+ * case the caller should release the URXE.
+ */
+static int port_try_forward(QUIC_PORT *port, const QUIC_URXE *e,
+                            const QUIC_CONN_ID *dcid)
+{
+    const unsigned char *data = ossl_quic_urxe_data(e);
+    int shard_id;
+
+    if (port->shard_group == NULL || dcid == NULL
+        || dcid->id_len != port->rx_short_dcid_len || dcid->id_len == 0
+        || e->data_len == 0)
+        return 0;
+
+    shard_id = ossl_quic_lcid_get_shard(dcid);
+    if (shard_id == port->shard_id)
+        return 0;
+
+    /* Long header packets other than QUIC v1 Handshake packets stay here. */
+    if ((data[0] & 0x80) != 0) {
+        PACKET pkt;
+        QUIC_PKT_HDR hdr;
+
+        if (!PACKET_buf_init(&pkt, data, e->data_len)
+            || !ossl_quic_wire_decode_pkt_hdr(&pkt, port->rx_short_dcid_len,
+                                              1, 0, &hdr, NULL)
+            || hdr.version != QUIC_VERSION_1
+            || hdr.type != QUIC_PKT_TYPE_HANDSHAKE)
+            return 0;
+    }
+
+    return ossl_quic_shard_group_forward(port->shard_group, shard_id,
+                                         data, e->data_len,
+                                         &e->peer, &e->local);
+}
+
 /*
  * This is called by the demux when we get a packet not destined for any known
  * DCID.
@@ -499,6 +892,7 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
     PACKET pkt;
     QUIC_PKT_HDR hdr;
     QUIC_CHANNEL *ch = NULL, *new_ch = NULL;
+    int addr_validated;
 
     /* Don't handle anything if we are no longer running. */
     if (!ossl_quic_port_is_running(port))
@@ -515,16 +909,19 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
         return;
     }
 
+    /* The DCID may have been issued by another shard. */
+    if (port_try_forward(port, e, dcid)) {
+        ossl_quic_demux_release_urxe(port->demux, e);
+        return;
+    }
+
     /*
      * If we have an incoming packet which doesn't match any existing connection
-     * we assume this is an attempt to make a new connection. Currently we
-     * require our caller to have precreated a latent 'incoming' channel via
-     * TSERVER which then gets turned into the new connection.
-     *
-     * TODO(QUIC SERVER): In the future we will construct channels dynamically
-     * in this case.
+     * we assume this is an attempt to make a new connection. Either our caller
+     * has precreated a latent 'incoming' channel via TSERVER which then gets
+     * turned into the new connection, or we construct a channel dynamically.
      */
-    if (port->tserver_ch == NULL)
+    if (port->tserver_ch == NULL && !port->allow_incoming)
         goto undesirable;
 
     /*
@@ -563,6 +960,17 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
     if (hdr.type != QUIC_PKT_TYPE_INITIAL)
         goto undesirable;
 
+    /*
+     * A client which presents a token we issued to it in a NEW_TOKEN frame has
+     * already proven it can receive packets at its address, so we need not
+     * apply the anti-amplification limit to it. An invalid token is ignored
+     * (RFC 9000 s. 8.1.3), as it may simply be from another server.
+     */
+    addr_validated = hdr.token_len > 0
+        && ossl_quic_token_validate(port->token_key, &e->peer,
+                                    ossl_quic_port_get_time(port),
+                                    hdr.token, hdr.token_len);
+
     /*
      * Try to process this as a valid attempt to initiate a connection.
      *
@@ -571,7 +979,7 @@ static void port_default_packet_handler(QUIC_URXE *e, void *arg,
      * processing without going through the DEMUX again.
      */
     port_on_new_conn(port, &e->peer, &hdr.src_conn_id, &hdr.dst_conn_id,
-                     &new_ch);
+                     addr_validated, &new_ch);
     if (new_ch != NULL)
         ossl_qrx_inject_urxe(new_ch->qrx, e);
 
@@ -13,6 +13,7 @@
 # include "internal/quic_port.h"
 # include "internal/quic_reactor.h"
 # include "internal/list.h"
+# include "internal/priority_queue.h"
 
 # ifndef OPENSSL_NO_QUIC
 
@@ -26,6 +27,15 @@
  * Other components should not include this header.
  */
 DECLARE_LIST_OF(ch, QUIC_CHANNEL);
+DECLARE_LIST_OF(incoming_ch, QUIC_CHANNEL);
+DECLARE_LIST_OF(sched_ch, QUIC_CHANNEL);
+DEFINE_PRIORITY_QUEUE_OF(QUIC_CHANNEL);
+
+/* Tick scheduling state of a channel (see QUIC_PORT.due_list). */
+# define QUIC_CHANNEL_SCHED_NONE        0   /* In sched_pq, or idle */
+# define QUIC_CHANNEL_SCHED_DUE         1   /* On due_list */
+# define QUIC_CHANNEL_SCHED_WDES        2   /* On wdes_list */
+# define QUIC_CHANNEL_SCHED_TICKING     3   /* On tick_list */
 
 /* A port is always in one of the following states: */
 enum {
@@ -62,15 +72,64 @@ struct quic_port_st {
     /* List of all child channels. */
     OSSL_LIST(ch)                   channel_list;
 
+    /*
+     * Channels created for incoming connections which have not yet been
+     * handed to the application. This is a subset of channel_list.
+     */
+    OSSL_LIST(incoming_ch)          incoming_list;
+
+    /*
+     * Tick scheduling. A port tick only services the channels which need it:
+     * those on due_list (which have received datagrams or been used by the
+     * application since they were last ticked), those on wdes_list (which
+     * are waiting for the network BIO to become writable) and those whose tick
+     * deadline has expired. All other channels with a finite tick deadline are
+     * kept in sched_pq, ordered by that deadline. tick_list holds the channels
+     * remaining to be serviced by the port tick in progress.
+     */
+    OSSL_LIST(sched_ch)             due_list;
+    OSSL_LIST(sched_ch)             wdes_list;
+    OSSL_LIST(sched_ch)             tick_list;
+    PRIORITY_QUEUE_OF(QUIC_CHANNEL) *sched_pq;
+
+    /* Number of channels whose last tick wanted to read from the network. */
+    size_t                          num_net_read_desired;
+
     /* Special TSERVER channel. To be removed in the future. */
     QUIC_CHANNEL                    *tserver_ch;
 
+    /* Called to notify the application layer of a new incoming channel. */
+    int                             (*new_incoming_cb)(QUIC_CHANNEL *ch,
+                                                       void *arg);
+    void                            *new_incoming_cb_arg;
+
+    /* Maximum number of channels held on the incoming queue. */
+    size_t                          max_incoming;
+
     /* LCIDM used for incoming packet routing by DCID. */
     QUIC_LCIDM                      *lcidm;
 
     /* SRTM used for incoming packet routing by SRT. */
     QUIC_SRTM                       *srtm;
 
+    /*
+     * Shard group we forward datagrams for other shards to, and receive
+     * datagrams forwarded to us from. NULL if not sharded.
+     */
+    QUIC_SHARD_GROUP                *shard_group;
+
+    /* Our shard ID in shard_group, or -1. */
+    int                             shard_id;
+
+    /* Congestion controller for new channels, or NULL for the default. */
+    const OSSL_CC_METHOD            *cc_method;
+
+    /* ECN mode for new channels (QUIC_ECN_MODE_*). */
+    uint32_t                        ecn_mode;
+
+    /* Key for the address validation tokens we issue to clients. */
+    QUIC_TOKEN_KEY                  *token_key;
+
     /* Port-level permanent errors (causing failure state) are stored here. */
     ERR_STATE                       *err_state;
 
@@ -93,6 +152,15 @@ struct quic_port_st {
 
     /* Are we on the QUIC_ENGINE linked list of ports? */
     unsigned int                    on_engine_list                  : 1;
+
+    /* Are new channels created automatically for incoming connections? */
+    unsigned int                    allow_incoming                  : 1;
+
+    /*
+     * Set if sched_pq could not be grown. The port then ticks every channel on
+     * every tick, as if no scheduling were done.
+     */
+    unsigned int                    sched_failed                    : 1;
 };
 
 # endif
@@ -58,6 +58,9 @@ struct rxe_st {
     /* Time we received the packet (not when we processed it). */
     OSSL_TIME           time;
 
+    /* ECN codepoint of the datagram which contained this packet. */
+    unsigned char       ecn;
+
     /* Total length of the datagram which contained this packet. */
     size_t              datagram_len;
 
@@ -167,6 +170,9 @@ struct ossl_qrx_st {
     /* Are we allowed to process 1-RTT packets yet? */
     unsigned char                   allow_1rtt;
 
+    /* May we receive 0-RTT packets at all? */
+    unsigned char                   allow_0rtt;
+
     /* Message callback related arguments */
     ossl_msg_cb msg_callback;
     void *msg_callback_arg;
@@ -193,6 +199,7 @@ OSSL_QRX *ossl_qrx_new(const OSSL_QRX_ARGS *args)
     qrx->demux                  = args->demux;
     qrx->short_conn_id_len      = args->short_conn_id_len;
     qrx->init_key_phase_bit     = args->init_key_phase_bit;
+    qrx->allow_0rtt             = args->allow_0rtt;
     qrx->max_deferred           = args->max_deferred;
     return qrx;
 }
@@ -502,7 +509,7 @@ static int qrx_validate_hdr_early(OSSL_QRX *qrx, RXE *rxe,
         return 0;
 
     /* Clients should never receive 0-RTT packets. */
-    if (rxe->hdr.type == QUIC_PKT_TYPE_0RTT)
+    if (rxe->hdr.type == QUIC_PKT_TYPE_0RTT && !qrx->allow_0rtt)
         return 0;
 
     /* Version negotiation and retry packets must be the first packet. */
@@ -871,6 +878,7 @@ static int qrx_process_pkt(OSSL_QRX *qrx, QUIC_URXE *urxe,
         rxe->peer           = urxe->peer;
         rxe->local          = urxe->local;
         rxe->time           = urxe->time;
+        rxe->ecn            = urxe->ecn;
         rxe->datagram_id    = urxe->datagram_id;
 
         /* Move RXE to pending. */
@@ -1056,6 +1064,7 @@ static int qrx_process_pkt(OSSL_QRX *qrx, QUIC_URXE *urxe,
     rxe->peer           = urxe->peer;
     rxe->local          = urxe->local;
     rxe->time           = urxe->time;
+    rxe->ecn            = urxe->ecn;
     rxe->datagram_id    = urxe->datagram_id;
 
     /* Move RXE to pending. */
@@ -1229,6 +1238,7 @@ int ossl_qrx_read_pkt(OSSL_QRX *qrx, OSSL_QRX_PKT **ppkt)
     rxe->pkt.hdr            = &rxe->hdr;
     rxe->pkt.pn             = rxe->pn;
     rxe->pkt.time           = rxe->time;
+    rxe->pkt.ecn            = rxe->ecn;
     rxe->pkt.datagram_len   = rxe->datagram_len;
     rxe->pkt.peer
         = BIO_ADDR_family(&rxe->peer) != AF_UNSPEC ? &rxe->peer : NULL;
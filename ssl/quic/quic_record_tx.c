@@ -10,6 +10,7 @@
 #include "internal/quic_record_tx.h"
 #include "internal/qlog_event_helpers.h"
 #include "internal/bio_addr.h"
+#include "internal/bio.h"
 #include "internal/common.h"
 #include "quic_record_shared.h"
 #include "internal/list.h"
@@ -20,19 +21,36 @@
  * ===
  * Encrypted packets awaiting transmission are kept in TX Entries (TXEs), which
  * are queued in linked lists just like TXEs.
+ *
+ * TXEs are allocated in arenas, each a single contiguous allocation holding a
+ * number of TXEs sized for the MDPL in effect when the arena was allocated.
+ * Free TXEs are reused most recently freed first, so the datagrams of a
+ * packet train built in one tick are encrypted into, and sent from, adjacent
+ * memory which is likely to still be in cache from the previous train.
+ *
+ * A TXE which must grow beyond its arena slot (because the MDPL has
+ * increased) is replaced by an individually allocated TXE and its slot is
+ * retired. An arena is freed once all of its slots are retired.
  */
 typedef struct txe_st TXE;
+typedef struct txe_arena_st TXE_ARENA;
 
 struct txe_st {
     OSSL_LIST_MEMBER(txe, TXE);
     size_t              data_len, alloc_len;
 
+    /* The arena containing this TXE, or NULL if individually allocated. */
+    TXE_ARENA          *arena;
+
     /*
      * Destination and local addresses, as applicable. Both of these are only
      * used if the family is not AF_UNSPEC.
      */
     BIO_ADDR            peer, local;
 
+    /* ECN codepoint of the datagram. */
+    uint32_t            ecn;
+
     /*
      * alloc_len allocated bytes (of which data_len bytes are valid) follow this
      * structure.
@@ -47,6 +65,26 @@ static ossl_inline unsigned char *txe_data(const TXE *e)
     return (unsigned char *)(e + 1);
 }
 
+struct txe_arena_st {
+    OSSL_LIST_MEMBER(txe_arena, TXE_ARENA);
+    size_t              num_txe, num_retired;
+
+    /* num_txe TXEs follow, each starting on a cache line boundary. */
+};
+
+DEFINE_LIST_OF(txe_arena, TXE_ARENA);
+
+#define TXE_ALIGN           64
+#define TXE_ROUND_UP(n)     (((n) + TXE_ALIGN - 1) & ~(size_t)(TXE_ALIGN - 1))
+
+/*
+ * Bounds on the number of TXEs in an arena. Each new arena is as large as all
+ * existing arenas combined, within these bounds, so that the TXEs needed by a
+ * connection quickly come to be spread over only a few arenas.
+ */
+#define TXE_ARENA_MIN       8
+#define TXE_ARENA_MAX       64
+
 /*
  * QTX
  * ===
@@ -61,6 +99,9 @@ struct ossl_qtx_st {
     /* TX BIO. */
     BIO                        *bio;
 
+    /* Whether the TX BIO sets the ECN codepoint of datagrams. */
+    int                         bio_ecn;
+
     /* QLOG instance retrieval callback if in use, or NULL. */
     QLOG                     *(*get_qlog_cb)(void *arg);
     void                       *get_qlog_cb_arg;
@@ -68,6 +109,10 @@ struct ossl_qtx_st {
     /* TX maximum datagram payload length. */
     size_t                      mdpl;
 
+    /* Arenas from which TXEs are allocated. */
+    OSSL_LIST(txe_arena)        arenas;
+    size_t                      arena_txe_count; /* sum(num_txe) in arenas */
+
     /*
      * List of TXEs which are not currently in use. These are moved to the
      * pending list (possibly via tx_cons first) as they are filled.
@@ -110,6 +155,12 @@ struct ossl_qtx_st {
 };
 
 /* Instantiates a new QTX. */
+/* Returns 1 if the BIO can set the ECN codepoint of the datagrams it sends. */
+static int qtx_bio_enable_ecn(BIO *bio)
+{
+    return bio != NULL && BIO_dgram_set_ecn(bio, 1) > 0;
+}
+
 OSSL_QTX *ossl_qtx_new(const OSSL_QTX_ARGS *args)
 {
     OSSL_QTX *qtx;
@@ -124,6 +175,7 @@ OSSL_QTX *ossl_qtx_new(const OSSL_QTX_ARGS *args)
     qtx->libctx             = args->libctx;
     qtx->propq              = args->propq;
     qtx->bio                = args->bio;
+    qtx->bio_ecn            = qtx_bio_enable_ecn(args->bio);
     qtx->mdpl               = args->mdpl;
     qtx->get_qlog_cb        = args->get_qlog_cb;
     qtx->get_qlog_cb_arg    = args->get_qlog_cb_arg;
@@ -137,7 +189,18 @@ static void qtx_cleanup_txl(TXE_LIST *l)
 
     for (e = ossl_list_txe_head(l); e != NULL; e = enext) {
         enext = ossl_list_txe_next(e);
-        OPENSSL_free(e);
+        if (e->arena == NULL)
+            OPENSSL_free(e);
+    }
+}
+
+static void qtx_cleanup_arenas(OSSL_QTX *qtx)
+{
+    TXE_ARENA *a, *anext;
+
+    for (a = ossl_list_txe_arena_head(&qtx->arenas); a != NULL; a = anext) {
+        anext = ossl_list_txe_arena_next(a);
+        OPENSSL_free(a);
     }
 }
 
@@ -152,7 +215,9 @@ void ossl_qtx_free(OSSL_QTX *qtx)
     /* Free TXE queue data. */
     qtx_cleanup_txl(&qtx->pending);
     qtx_cleanup_txl(&qtx->free);
-    OPENSSL_free(qtx->cons);
+    if (qtx->cons != NULL && qtx->cons->arena == NULL)
+        OPENSSL_free(qtx->cons);
+    qtx_cleanup_arenas(qtx);
 
     /* Drop keying material and crypto resources. */
     for (i = 0; i < QUIC_ENC_LEVEL_NUM; ++i)
@@ -213,103 +278,148 @@ int ossl_qtx_is_enc_level_provisioned(OSSL_QTX *qtx, uint32_t enc_level)
     return ossl_qrl_enc_level_set_get(&qtx->el_set, enc_level, 1) != NULL;
 }
 
-/* Allocate a new TXE. */
-static TXE *qtx_alloc_txe(size_t alloc_len)
+/*
+ * Allocates a new arena of TXEs with at least alloc_len bytes of buffer each
+ * and adds its TXEs to the free list. Returns 0 on allocation failure.
+ */
+static int qtx_alloc_arena(OSSL_QTX *qtx, size_t alloc_len)
 {
+    TXE_ARENA *a;
     TXE *txe;
+    size_t i, num_txe, stride;
+    unsigned char *p;
 
-    if (alloc_len >= SIZE_MAX - sizeof(TXE))
-        return NULL;
+    if (alloc_len >= SIZE_MAX / TXE_ARENA_MAX - sizeof(TXE) - TXE_ALIGN)
+        return 0;
 
-    txe = OPENSSL_malloc(sizeof(TXE) + alloc_len);
-    if (txe == NULL)
-        return NULL;
+    num_txe = qtx->arena_txe_count;
+    if (num_txe < TXE_ARENA_MIN)
+        num_txe = TXE_ARENA_MIN;
+    else if (num_txe > TXE_ARENA_MAX)
+        num_txe = TXE_ARENA_MAX;
 
-    ossl_list_txe_init_elem(txe);
-    txe->alloc_len = alloc_len;
-    txe->data_len = 0;
-    return txe;
+    /* Use any space left by rounding as buffer. */
+    stride      = TXE_ROUND_UP(sizeof(TXE) + alloc_len);
+    alloc_len   = stride - sizeof(TXE);
+
+    a = OPENSSL_malloc(TXE_ROUND_UP(sizeof(TXE_ARENA)) + num_txe * stride
+                       + TXE_ALIGN - 1);
+    if (a == NULL)
+        return 0;
+
+    ossl_list_txe_arena_init_elem(a);
+    a->num_txe      = num_txe;
+    a->num_retired  = 0;
+
+    /* Align the first TXE to a cache line. */
+    p = (unsigned char *)a + TXE_ROUND_UP(sizeof(TXE_ARENA));
+    p += (TXE_ALIGN - ((size_t)p & (TXE_ALIGN - 1))) & (TXE_ALIGN - 1);
+
+    /* Insert in reverse so that the TXEs are used in address order. */
+    for (i = num_txe; i > 0; --i) {
+        txe = (TXE *)(p + (i - 1) * stride);
+        ossl_list_txe_init_elem(txe);
+        txe->alloc_len  = alloc_len;
+        txe->data_len   = 0;
+        txe->arena      = a;
+        ossl_list_txe_insert_head(&qtx->free, txe);
+    }
+
+    ossl_list_txe_arena_insert_tail(&qtx->arenas, a);
+    qtx->arena_txe_count += num_txe;
+    return 1;
 }
 
 /*
- * Ensures there is at least one TXE in the free list, allocating a new entry
- * if necessary. The returned TXE is in the free list; it is not popped.
- *
- * alloc_len is a hint which may be used to determine the TXE size if allocation
- * is necessary. Returns NULL on allocation failure.
+ * Releases a TXE which is not in any list. The slot of an arena TXE is retired
+ * and the arena is freed once all of its slots are retired.
  */
-static TXE *qtx_ensure_free_txe(OSSL_QTX *qtx, size_t alloc_len)
+static void qtx_release_txe(OSSL_QTX *qtx, TXE *txe)
 {
-    TXE *txe;
+    TXE_ARENA *a = txe->arena;
 
-    txe = ossl_list_txe_head(&qtx->free);
-    if (txe != NULL)
-        return txe;
+    if (a == NULL) {
+        OPENSSL_free(txe);
+        return;
+    }
 
-    txe = qtx_alloc_txe(alloc_len);
-    if (txe == NULL)
-        return NULL;
+    if (++a->num_retired < a->num_txe)
+        return;
 
-    ossl_list_txe_insert_tail(&qtx->free, txe);
-    return txe;
+    ossl_list_txe_arena_remove(&qtx->arenas, a);
+    qtx->arena_txe_count -= a->num_txe;
+    OPENSSL_free(a);
+}
+
+/* Returns a TXE which is not in any list to the free list. */
+static void qtx_add_to_free(OSSL_QTX *qtx, TXE *txe)
+{
+    /* Reuse the most recently used TXE first, as it is most likely cached. */
+    ossl_list_txe_insert_head(&qtx->free, txe);
 }
 
 /*
- * Resize the data buffer attached to an TXE to be n bytes in size. The address
- * of the TXE might change; the new address is returned, or NULL on failure, in
- * which case the original TXE remains valid.
+ * Ensures there is at least one TXE of at least alloc_len bytes in the free
+ * list, allocating a new arena if necessary. The returned TXE is in the free
+ * list; it is not popped. Free TXEs which are too small (because the MDPL has
+ * increased) are released. Returns NULL on allocation failure.
  */
-static TXE *qtx_resize_txe(OSSL_QTX *qtx, TXE_LIST *txl, TXE *txe, size_t n)
+static TXE *qtx_ensure_free_txe(OSSL_QTX *qtx, size_t alloc_len)
 {
-    TXE *txe2, *p;
-
-    /* Should never happen. */
-    if (txe == NULL)
-        return NULL;
-
-    if (n >= SIZE_MAX - sizeof(TXE))
-        return NULL;
+    TXE *txe;
 
-    /* Remove the item from the list to avoid accessing freed memory */
-    p = ossl_list_txe_prev(txe);
-    ossl_list_txe_remove(txl, txe);
+    while ((txe = ossl_list_txe_head(&qtx->free)) != NULL) {
+        if (txe->alloc_len >= alloc_len)
+            return txe;
 
-    /*
-     * NOTE: We do not clear old memory, although it does contain decrypted
-     * data.
-     */
-    txe2 = OPENSSL_realloc(txe, sizeof(TXE) + n);
-    if (txe2 == NULL || txe == txe2) {
-        if (p == NULL)
-            ossl_list_txe_insert_head(txl, txe);
-        else
-            ossl_list_txe_insert_after(txl, p, txe);
-        return txe2;
+        ossl_list_txe_remove(&qtx->free, txe);
+        qtx_release_txe(qtx, txe);
     }
 
-    if (p == NULL)
-        ossl_list_txe_insert_head(txl, txe2);
-    else
-        ossl_list_txe_insert_after(txl, p, txe2);
-
-    if (qtx->cons == txe)
-        qtx->cons = txe2;
+    if (!qtx_alloc_arena(qtx, alloc_len))
+        return NULL;
 
-    txe2->alloc_len = n;
-    return txe2;
+    return ossl_list_txe_head(&qtx->free);
 }
 
 /*
- * Ensure the data buffer attached to an TXE is at least n bytes in size.
- * Returns NULL on failure.
+ * Ensure the data buffer attached to the TXE under construction is at least n
+ * bytes in size. The TXE is replaced by an individually allocated TXE with the
+ * same contents if it must grow. Returns NULL on failure, in which case the
+ * original TXE remains valid.
  */
-static TXE *qtx_reserve_txe(OSSL_QTX *qtx, TXE_LIST *txl,
-                            TXE *txe, size_t n)
+static TXE *qtx_reserve_cons(OSSL_QTX *qtx, size_t n)
 {
+    TXE *txe = qtx->cons, *txe2;
+
     if (txe->alloc_len >= n)
         return txe;
 
-    return qtx_resize_txe(qtx, txl, txe, n);
+    if (n >= SIZE_MAX - sizeof(TXE))
+        return NULL;
+
+    if (txe->arena == NULL) {
+        /*
+         * NOTE: We do not clear old memory, although it does contain decrypted
+         * data.
+         */
+        txe2 = OPENSSL_realloc(txe, sizeof(TXE) + n);
+        if (txe2 == NULL)
+            return NULL;
+    } else {
+        txe2 = OPENSSL_malloc(sizeof(TXE) + n);
+        if (txe2 == NULL)
+            return NULL;
+
+        memcpy(txe2, txe, sizeof(TXE) + txe->data_len);
+        txe2->arena = NULL;
+        qtx_release_txe(qtx, txe);
+    }
+
+    ossl_list_txe_init_elem(txe2);
+    txe2->alloc_len = n;
+    qtx->cons       = txe2;
+    return txe2;
 }
 
 /* Move a TXE from pending to free. */
@@ -321,7 +431,7 @@ static void qtx_pending_to_free(OSSL_QTX *qtx)
     ossl_list_txe_remove(&qtx->pending, txe);
     --qtx->pending_count;
     qtx->pending_bytes -= txe->data_len;
-    ossl_list_txe_insert_tail(&qtx->free, txe);
+    qtx_add_to_free(qtx, txe);
 }
 
 /* Add a TXE not currently in any list to the pending list. */
@@ -816,8 +926,9 @@ int ossl_qtx_write_pkt(OSSL_QTX *qtx, const OSSL_QTX_PKT *pkt)
     was_coalescing = (qtx->cons != NULL && qtx->cons->data_len > 0);
     if (was_coalescing)
         if (!addr_eq(&qtx->cons->peer, pkt->peer)
-            || !addr_eq(&qtx->cons->local, pkt->local)) {
-            /* Must stop coalescing if addresses have changed */
+            || !addr_eq(&qtx->cons->local, pkt->local)
+            || qtx->cons->ecn != pkt->ecn) {
+            /* Must stop coalescing if addresses or ECN have changed */
             ossl_qtx_finish_dgram(qtx);
             was_coalescing = 0;
         }
@@ -837,7 +948,8 @@ int ossl_qtx_write_pkt(OSSL_QTX *qtx, const OSSL_QTX_PKT *pkt)
          * Ensure TXE has at least MDPL bytes allocated. This should only be
          * possible if the MDPL has increased.
          */
-        if (!qtx_reserve_txe(qtx, NULL, txe, qtx->mdpl))
+        txe = qtx_reserve_cons(qtx, qtx->mdpl);
+        if (txe == NULL)
             return 0;
 
         if (!was_coalescing) {
@@ -851,6 +963,8 @@ int ossl_qtx_write_pkt(OSSL_QTX *qtx, const OSSL_QTX_PKT *pkt)
                 txe->local = *pkt->local;
             else
                 BIO_ADDR_clear(&txe->local);
+
+            txe->ecn = pkt->ecn;
         }
 
         ret = qtx_mutate_write(qtx, pkt, txe, enc_level);
@@ -907,7 +1021,7 @@ void ossl_qtx_finish_dgram(OSSL_QTX *qtx)
          * If we did not put anything in the datagram, just move it back to the
          * free list.
          */
-        ossl_list_txe_insert_tail(&qtx->free, txe);
+        qtx_add_to_free(qtx, txe);
     else
         qtx_add_to_pending(qtx, txe);
 
@@ -916,18 +1030,23 @@ void ossl_qtx_finish_dgram(OSSL_QTX *qtx)
     ++qtx->datagram_count;
 }
 
-static void txe_to_msg(TXE *txe, BIO_MSG *msg)
+static void txe_to_msg(OSSL_QTX *qtx, TXE *txe, BIO_MSG *msg)
 {
     msg->data       = txe_data(txe);
     msg->data_len   = txe->data_len;
-    msg->flags      = 0;
+    msg->flags      = qtx->bio_ecn ? txe->ecn & BIO_MSG_ECN_MASK : 0;
     msg->peer
         = BIO_ADDR_family(&txe->peer) != AF_UNSPEC ? &txe->peer : NULL;
     msg->local
         = BIO_ADDR_family(&txe->local) != AF_UNSPEC ? &txe->local : NULL;
 }
 
-#define MAX_MSGS_PER_SEND   32
+/*
+ * Pending datagrams are handed to the network BIO in batches. A train of
+ * equal-size datagrams to the same peer within a batch can be sent by the BIO
+ * as a single GSO send, so the batch size matches the BIO's GSO segment limit.
+ */
+#define MAX_MSGS_PER_SEND   64
 
 int ossl_qtx_flush_net(OSSL_QTX *qtx)
 {
@@ -946,7 +1065,7 @@ int ossl_qtx_flush_net(OSSL_QTX *qtx)
         for (txe = ossl_list_txe_head(&qtx->pending), i = 0;
              txe != NULL && i < OSSL_NELEM(msg);
              txe = ossl_list_txe_next(txe), ++i)
-            txe_to_msg(txe, &msg[i]);
+            txe_to_msg(qtx, txe, &msg[i]);
 
         if (!i)
             /* Nothing to send. */
@@ -1005,14 +1124,20 @@ int ossl_qtx_pop_net(OSSL_QTX *qtx, BIO_MSG *msg)
     if (txe == NULL)
         return 0;
 
-    txe_to_msg(txe, msg);
+    txe_to_msg(qtx, txe, msg);
     qtx_pending_to_free(qtx);
     return 1;
 }
 
 void ossl_qtx_set_bio(OSSL_QTX *qtx, BIO *bio)
 {
-    qtx->bio = bio;
+    qtx->bio        = bio;
+    qtx->bio_ecn    = qtx_bio_enable_ecn(bio);
+}
+
+int ossl_qtx_is_ecn_supported(OSSL_QTX *qtx)
+{
+    return qtx->bio_ecn;
 }
 
 int ossl_qtx_set_mdpl(OSSL_QTX *qtx, size_t mdpl)
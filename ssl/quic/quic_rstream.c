@@ -260,6 +260,42 @@ int ossl_quic_rstream_release_record(QUIC_RSTREAM *qrs, size_t read_len)
     return 1;
 }
 
+int ossl_quic_rstream_read_ref(QUIC_RSTREAM *qrs,
+                               const unsigned char **data, size_t *data_len,
+                               OSSL_QRX_PKT **pkt, int *fin)
+{
+    UINT_RANGE range;
+    size_t avail;
+
+    *data = NULL;
+    *data_len = 0;
+    *pkt = NULL;
+
+    if (!ossl_sframe_list_take_head(&qrs->fl, &range, data, pkt, fin)) {
+        if (ossl_sframe_list_is_head_locked(&qrs->fl)
+            || !ossl_quic_rstream_available(qrs, &avail, fin))
+            return 0;
+
+        /* Data moved to the ring buffer cannot be returned by reference. */
+        return avail == 0;
+    }
+
+    *data_len = (size_t)(range.end - range.start);
+    if (range.end > 0)
+        ring_buf_cpop_range(&qrs->rbuf, 0, range.end - 1, qrs->fl.cleanse);
+
+    if (qrs->rxfc != NULL
+        && !ossl_quic_rxfc_on_retire(qrs->rxfc, *data_len, get_rtt(qrs))) {
+        ossl_qrx_pkt_release(*pkt);
+        *pkt = NULL;
+        *data = NULL;
+        *data_len = 0;
+        return 0;
+    }
+
+    return 1;
+}
+
 static int write_at_ring_buf_cb(uint64_t logical_offset,
                                 const unsigned char *buf,
                                 size_t buf_len,
@@ -54,7 +54,8 @@ static int depack_do_frame_ping(PACKET *pkt, QUIC_CHANNEL *ch,
         return 0;
     }
 
-    ossl_quic_tx_packetiser_schedule_ack_eliciting(ch->txp, enc_level);
+    ossl_quic_tx_packetiser_schedule_ack_eliciting(ch->txp,
+                                                   ossl_quic_enc_level_to_pn_space(enc_level));
     return 1;
 }
 
@@ -337,6 +338,18 @@ static int depack_do_frame_new_token(PACKET *pkt, QUIC_CHANNEL *ch,
         return 0;
     }
 
+    if (ch->is_server) {
+        /*
+         * RFC 9000 s. 19.7: "Servers MUST treat receipt of a NEW_TOKEN frame
+         * as a connection error of type PROTOCOL_VIOLATION."
+         */
+        ossl_quic_channel_raise_protocol_error(ch,
+                                               OSSL_QUIC_ERR_PROTOCOL_VIOLATION,
+                                               OSSL_QUIC_FRAME_TYPE_NEW_TOKEN,
+                                               "NEW_TOKEN received by server");
+        return 0;
+    }
+
     if (token_len == 0) {
         /*
          * RFC 9000 s. 19.7: "A client MUST treat receipt of a NEW_TOKEN frame
@@ -350,7 +363,8 @@ static int depack_do_frame_new_token(PACKET *pkt, QUIC_CHANNEL *ch,
         return 0;
     }
 
-    /* TODO(QUIC FUTURE): ADD CODE to send |token| to the session manager */
+    /* Keep the token for use in a later connection to this server. */
+    ossl_quic_channel_on_new_token(ch, token, token_len);
 
     return 1;
 }
@@ -1040,6 +1054,55 @@ static int depack_do_frame_handshake_done(PACKET *pkt,
     return 1;
 }
 
+static int depack_do_frame_ack_frequency(PACKET *pkt,
+                                         QUIC_CHANNEL *ch,
+                                         OSSL_ACKM_RX_PKT *ackm_data)
+{
+    OSSL_QUIC_FRAME_ACK_FREQUENCY frame_data;
+
+    if (!ossl_quic_wire_decode_frame_ack_frequency(pkt, &frame_data)) {
+        ossl_quic_channel_raise_protocol_error(ch,
+                                               OSSL_QUIC_ERR_FRAME_ENCODING_ERROR,
+                                               OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY,
+                                               "decode error");
+        return 0;
+    }
+
+    /*
+     * draft-ietf-quic-ack-frequency s. 4: A Requested Max Ack Delay below the
+     * min_ack_delay we advertised is a PROTOCOL_VIOLATION.
+     */
+    if (frame_data.max_ack_delay_us < ch->tx_min_ack_delay) {
+        ossl_quic_channel_raise_protocol_error(ch,
+                                               OSSL_QUIC_ERR_PROTOCOL_VIOLATION,
+                                               OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY,
+                                               "requested max ack delay "
+                                               "below min_ack_delay");
+        return 0;
+    }
+
+    ossl_ackm_on_rx_ack_frequency(ch->ackm, &frame_data);
+    return 1;
+}
+
+static int depack_do_frame_immediate_ack(PACKET *pkt,
+                                         QUIC_CHANNEL *ch,
+                                         OSSL_ACKM_RX_PKT *ackm_data)
+{
+    if (!ossl_quic_wire_decode_frame_immediate_ack(pkt)) {
+        /* This can fail only with an internal error. */
+        ossl_quic_channel_raise_protocol_error(ch,
+                                               OSSL_QUIC_ERR_INTERNAL_ERROR,
+                                               OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK,
+                                               "internal error (decode frame immediate ack)");
+        return 0;
+    }
+
+    /* The ACKM will request an ACK once it learns of this packet. */
+    ackm_data->is_immediate_ack = 1;
+    return 1;
+}
+
 /* Main frame processor */
 
 static int depack_process_frames(QUIC_CHANNEL *ch, PACKET *pkt,
@@ -1375,6 +1438,38 @@ static int depack_process_frames(QUIC_CHANNEL *ch, PACKET *pkt,
                 return 0;
             break;
 
+        case OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY:
+        case OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK:
+            /*
+             * ACK frequency frames are valid in 0RTT and 1RTT packets, and
+             * only if we advertised support for the extension.
+             */
+            if (pkt_type != QUIC_PKT_TYPE_0RTT
+                && pkt_type != QUIC_PKT_TYPE_1RTT) {
+                ossl_quic_channel_raise_protocol_error(ch,
+                                                       OSSL_QUIC_ERR_PROTOCOL_VIOLATION,
+                                                       frame_type,
+                                                       "ACK frequency frames valid "
+                                                       "only in 0/1-RTT");
+                return 0;
+            }
+            if (ch->tx_min_ack_delay == 0) {
+                ossl_quic_channel_raise_protocol_error(ch,
+                                                       OSSL_QUIC_ERR_PROTOCOL_VIOLATION,
+                                                       frame_type,
+                                                       "ACK frequency extension "
+                                                       "not negotiated");
+                return 0;
+            }
+            if (frame_type == OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY) {
+                if (!depack_do_frame_ack_frequency(pkt, ch, ackm_data))
+                    return 0;
+            } else {
+                if (!depack_do_frame_immediate_ack(pkt, ch, ackm_data))
+                    return 0;
+            }
+            break;
+
         default:
             /* Unknown frame type */
             ossl_quic_channel_raise_protocol_error(ch,
@@ -1433,6 +1528,7 @@ int ossl_quic_handle_frames(QUIC_CHANNEL *ch, OSSL_QRX_PKT *qpacket)
      */
     ackm_data.pkt_num = qpacket->pn;
     ackm_data.time = qpacket->time;
+    ackm_data.ecn = qpacket->ecn;
     enc_level = ossl_quic_pkt_type_to_enc_level(qpacket->hdr->type);
     if (enc_level >= QUIC_ENC_LEVEL_NUM)
         /*
@@ -13,6 +13,7 @@
 
 struct stream_frame_st {
     struct stream_frame_st *prev, *next;
+    UINT_TREE_NODE node; /* keyed by range.start */
     UINT_RANGE range;
     OSSL_QRX_PKT *pkt;
     const unsigned char *data;
@@ -39,15 +40,37 @@ static STREAM_FRAME *stream_frame_new(UINT_RANGE *range, OSSL_QRX_PKT *pkt,
         ossl_qrx_pkt_up_ref(pkt);
 
     sf->range = *range;
+    sf->node.key = range->start;
     sf->pkt = pkt;
     sf->data = data;
 
     return sf;
 }
 
+#define FRAME_FROM_NODE(n) \
+    ((STREAM_FRAME *)((char *)(n) - offsetof(STREAM_FRAME, node)))
+
+/* Unlinks sf from the list and the index without freeing it. */
+static void unlink_frame(SFRAME_LIST *fl, STREAM_FRAME *sf)
+{
+    if (sf->prev != NULL)
+        sf->prev->next = sf->next;
+    else
+        fl->head = sf->next;
+
+    if (sf->next != NULL)
+        sf->next->prev = sf->prev;
+    else
+        fl->tail = sf->prev;
+
+    ossl_uint_tree_remove(&fl->index, &sf->node);
+    --fl->num_frames;
+}
+
 void ossl_sframe_list_init(SFRAME_LIST *fl)
 {
     memset(fl, 0, sizeof(*fl));
+    ossl_uint_tree_init(&fl->index);
 }
 
 void ossl_sframe_list_destroy(SFRAME_LIST *fl)
@@ -72,6 +95,7 @@ static int append_frame(SFRAME_LIST *fl, UINT_RANGE *range,
     if (fl->tail != NULL)
         fl->tail->next = new_frame;
     fl->tail = new_frame;
+    ossl_uint_tree_insert(&fl->index, &new_frame->node);
     ++fl->num_frames;
     return 1;
 }
@@ -99,6 +123,7 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
         if (fl->tail == NULL)
             return 0;
 
+        ossl_uint_tree_insert(&fl->index, &fl->tail->node);
         ++fl->num_frames;
         goto end;
     }
@@ -113,10 +138,19 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
         goto end;
     }
 
+    /*
+     * Find the last frame starting before the new frame, and the first frame
+     * not starting before it.
+     */
     prev_frame = NULL;
-    for (sf = fl->head; sf != NULL && sf->range.start < range->start;
-         sf = sf->next)
-        prev_frame = sf;
+    if (range->start > 0) {
+        UINT_TREE_NODE *n = ossl_uint_tree_find_le(&fl->index,
+                                                   range->start - 1);
+
+        if (n != NULL)
+            prev_frame = FRAME_FROM_NODE(n);
+    }
+    sf = prev_frame != NULL ? prev_frame->next : fl->head;
 
     if (!ossl_assert(sf != NULL))
         /* frame list invariant broken */
@@ -125,6 +159,10 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
     if (prev_frame != NULL && prev_frame->range.end >= range->end)
         goto end;
 
+    /* A frame with the same start encompasses the new frame. */
+    if (sf->range.start == range->start && sf->range.end >= range->end)
+        goto end;
+
     /*
      * Now we must create a new frame although in the end we might drop it,
      * because we will be potentially dropping existing overlapping frames.
@@ -138,15 +176,7 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
         STREAM_FRAME *drop_frame = next_frame;
 
         next_frame = next_frame->next;
-        if (next_frame != NULL)
-            next_frame->prev = drop_frame->prev;
-        if (prev_frame != NULL)
-            prev_frame->next = drop_frame->next;
-        if (fl->head == drop_frame)
-            fl->head = next_frame;
-        if (fl->tail == drop_frame)
-            fl->tail = prev_frame;
-        --fl->num_frames;
+        unlink_frame(fl, drop_frame);
         stream_frame_free(fl, drop_frame);
     }
 
@@ -170,6 +200,7 @@ int ossl_sframe_list_insert(SFRAME_LIST *fl, UINT_RANGE *range,
     else
         fl->head = new_frame;
 
+    ossl_uint_tree_insert(&fl->index, &new_frame->node);
     ++fl->num_frames;
 
  end:
@@ -229,19 +260,10 @@ int ossl_sframe_list_drop_frames(SFRAME_LIST *fl, uint64_t limit)
 
     fl->offset = limit;
 
-    for (sf = fl->head; sf != NULL && sf->range.end <= limit;) {
-        STREAM_FRAME *drop_frame = sf;
-
-        sf = sf->next;
-        --fl->num_frames;
-        stream_frame_free(fl, drop_frame);
+    while ((sf = fl->head) != NULL && sf->range.end <= limit) {
+        unlink_frame(fl, sf);
+        stream_frame_free(fl, sf);
     }
-    fl->head = sf;
-
-    if (sf != NULL)
-        sf->prev = NULL;
-    else
-        fl->tail = NULL;
 
     fl->head_locked = 0;
 
@@ -269,6 +291,30 @@ int ossl_sframe_list_is_head_locked(SFRAME_LIST *fl)
     return fl->head_locked;
 }
 
+int ossl_sframe_list_take_head(SFRAME_LIST *fl, UINT_RANGE *range,
+                               const unsigned char **data,
+                               OSSL_QRX_PKT **pkt, int *fin)
+{
+    STREAM_FRAME *sf = fl->head;
+    void *iter = NULL;
+
+    if (fl->head_locked || sf == NULL || sf->data == NULL
+        || !ossl_sframe_list_peek(fl, &iter, range, data, fin))
+        return 0;
+
+    /* Cleanse the part of the frame that has already been read. */
+    if (fl->cleanse && range->start > sf->range.start)
+        OPENSSL_cleanse((unsigned char *)sf->data,
+                        (size_t)(range->start - sf->range.start));
+
+    fl->offset = range->end;
+    unlink_frame(fl, sf);
+
+    *pkt = sf->pkt;
+    OPENSSL_free(sf);
+    return 1;
+}
+
 int ossl_sframe_list_move_data(SFRAME_LIST *fl,
                                sframe_list_write_at_cb *write_at_cb,
                                void *cb_arg)
@@ -314,14 +360,7 @@ int ossl_sframe_list_move_data(SFRAME_LIST *fl,
         if (prev_frame != NULL
             && prev_frame->range.end >= sf->range.start) {
             prev_frame->range.end = sf->range.end;
-            prev_frame->next = sf->next;
-
-            if (sf->next != NULL)
-                sf->next->prev = prev_frame;
-            else
-                fl->tail = prev_frame;
-
-            --fl->num_frames;
+            unlink_frame(fl, sf);
             stream_frame_free(fl, sf);
             sf = prev_frame;
             continue;
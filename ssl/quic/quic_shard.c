@@ -0,0 +1,230 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include "internal/quic_shard.h"
+#include "internal/quic_lcidm.h"
+#include "internal/bio_addr.h"
+#include "internal/refcount.h"
+
+/*
+ * QUIC Shard Group
+ * ================
+ */
+
+/* Maximum number of datagrams waiting in the mailbox of a single shard. */
+#define SHARD_MAX_QUEUED        256
+
+#define SHARD_MAX_SHARDS        (QUIC_LCID_MAX_SHARD + 1)
+
+typedef struct shard_dgram_st SHARD_DGRAM;
+
+struct shard_dgram_st {
+    SHARD_DGRAM     *next;
+    BIO_ADDR        peer, local;
+    size_t          data_len;
+    /* data_len bytes of datagram follow. */
+};
+
+typedef struct shard_st {
+    SHARD_DGRAM     *head, *tail;
+    size_t          num_queued;
+    unsigned int    in_use : 1;
+} SHARD;
+
+struct quic_shard_group_st {
+    CRYPTO_REF_COUNT    references;
+    CRYPTO_RWLOCK       *lock;
+    SHARD               shards[SHARD_MAX_SHARDS];
+};
+
+QUIC_SHARD_GROUP *ossl_quic_shard_group_new(void)
+{
+    QUIC_SHARD_GROUP *grp;
+
+    if ((grp = OPENSSL_zalloc(sizeof(*grp))) == NULL)
+        return NULL;
+
+    if ((grp->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(grp);
+        return NULL;
+    }
+
+    if (!CRYPTO_NEW_REF(&grp->references, 1)) {
+        CRYPTO_THREAD_lock_free(grp->lock);
+        OPENSSL_free(grp);
+        return NULL;
+    }
+
+    return grp;
+}
+
+int ossl_quic_shard_group_up_ref(QUIC_SHARD_GROUP *grp)
+{
+    int i;
+
+    if (CRYPTO_UP_REF(&grp->references, &i) <= 0)
+        return 0;
+
+    return i > 1;
+}
+
+static void shard_flush(SHARD *shard)
+{
+    SHARD_DGRAM *d, *dnext;
+
+    for (d = shard->head; d != NULL; d = dnext) {
+        dnext = d->next;
+        OPENSSL_free(d);
+    }
+
+    shard->head = shard->tail = NULL;
+    shard->num_queued = 0;
+}
+
+void ossl_quic_shard_group_free(QUIC_SHARD_GROUP *grp)
+{
+    size_t i;
+    int ref;
+
+    if (grp == NULL)
+        return;
+
+    CRYPTO_DOWN_REF(&grp->references, &ref);
+    if (ref > 0)
+        return;
+
+    for (i = 0; i < SHARD_MAX_SHARDS; ++i)
+        shard_flush(&grp->shards[i]);
+
+    CRYPTO_FREE_REF(&grp->references);
+    CRYPTO_THREAD_lock_free(grp->lock);
+    OPENSSL_free(grp);
+}
+
+int ossl_quic_shard_group_join(QUIC_SHARD_GROUP *grp)
+{
+    int i, shard_id = -1;
+
+    if (!CRYPTO_THREAD_write_lock(grp->lock))
+        return -1;
+
+    for (i = 0; i < SHARD_MAX_SHARDS; ++i)
+        if (!grp->shards[i].in_use) {
+            grp->shards[i].in_use = 1;
+            shard_id = i;
+            break;
+        }
+
+    CRYPTO_THREAD_unlock(grp->lock);
+    return shard_id;
+}
+
+void ossl_quic_shard_group_leave(QUIC_SHARD_GROUP *grp, int shard_id)
+{
+    SHARD *shard;
+
+    if (shard_id < 0 || shard_id >= SHARD_MAX_SHARDS
+        || !CRYPTO_THREAD_write_lock(grp->lock))
+        return;
+
+    shard = &grp->shards[shard_id];
+    shard_flush(shard);
+    shard->in_use = 0;
+
+    CRYPTO_THREAD_unlock(grp->lock);
+}
+
+int ossl_quic_shard_group_forward(QUIC_SHARD_GROUP *grp, int shard_id,
+                                  const unsigned char *data, size_t data_len,
+                                  const BIO_ADDR *peer, const BIO_ADDR *local)
+{
+    SHARD *shard;
+    SHARD_DGRAM *d;
+    int ok = 0;
+
+    if (shard_id < 0 || shard_id >= SHARD_MAX_SHARDS)
+        return 0;
+
+    /* Copy the datagram before taking the lock. */
+    if ((d = OPENSSL_malloc(sizeof(*d) + data_len)) == NULL)
+        return 0;
+
+    d->next     = NULL;
+    d->data_len = data_len;
+    memcpy(d + 1, data, data_len);
+
+    if (peer != NULL)
+        d->peer = *peer;
+    else
+        BIO_ADDR_clear(&d->peer);
+
+    if (local != NULL)
+        d->local = *local;
+    else
+        BIO_ADDR_clear(&d->local);
+
+    if (!CRYPTO_THREAD_write_lock(grp->lock)) {
+        OPENSSL_free(d);
+        return 0;
+    }
+
+    shard = &grp->shards[shard_id];
+    if (shard->in_use && shard->num_queued < SHARD_MAX_QUEUED) {
+        if (shard->tail != NULL)
+            shard->tail->next = d;
+        else
+            shard->head = d;
+
+        shard->tail = d;
+        ++shard->num_queued;
+        ok = 1;
+    }
+
+    CRYPTO_THREAD_unlock(grp->lock);
+
+    if (!ok)
+        OPENSSL_free(d);
+
+    return ok;
+}
+
+size_t ossl_quic_shard_group_drain(QUIC_SHARD_GROUP *grp, int shard_id,
+                                   ossl_quic_shard_dgram_cb *cb, void *arg)
+{
+    SHARD *shard;
+    SHARD_DGRAM *d, *dnext;
+    size_t n = 0;
+
+    if (shard_id < 0 || shard_id >= SHARD_MAX_SHARDS)
+        return 0;
+
+    shard = &grp->shards[shard_id];
+
+    /* Detach the whole queue so that cb is called without the lock held. */
+    if (!CRYPTO_THREAD_write_lock(grp->lock))
+        return 0;
+
+    d = shard->head;
+    shard->head = shard->tail = NULL;
+    shard->num_queued = 0;
+
+    CRYPTO_THREAD_unlock(grp->lock);
+
+    for (; d != NULL; d = dnext) {
+        dnext = d->next;
+        cb((const unsigned char *)(d + 1), d->data_len, &d->peer, &d->local,
+           arg);
+        OPENSSL_free(d);
+        ++n;
+    }
+
+    return n;
+}
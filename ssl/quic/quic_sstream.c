@@ -11,14 +11,48 @@
 #include "internal/uint_set.h"
 #include "internal/common.h"
 #include "internal/ring_buf.h"
+#include "internal/list.h"
 
 /*
  * ==================================================================
  * QUIC Send Stream
  */
+
+/*
+ * A segment of retained stream data, which is stored either in the ring buffer
+ * (buf == NULL) or in a caller-owned buffer appended by reference.
+ */
+typedef struct qss_seg_st QSS_SEG;
+
+struct qss_seg_st {
+    OSSL_LIST_MEMBER(qss_seg, QSS_SEG);
+    uint64_t                    start;      /* logical offset in stream */
+    uint64_t                    len;
+    uint64_t                    ring_start; /* logical offset in ring_buf */
+    const unsigned char         *buf;
+    SSL_buffer_release_cb_fn    release_cb;
+    void                        *release_arg;
+};
+
+DEFINE_LIST_OF(qss_seg, QSS_SEG);
+
 struct quic_sstream_st {
     struct ring_buf ring_buf;
 
+    /*
+     * Data appended by copying is stored in ring_buf. Data appended by
+     * reference is not copied, so once any such data has been appended, the
+     * logical offsets of the ring buffer no longer match those of the stream.
+     *
+     * While segs is empty, the logical offset of a byte in the stream is its
+     * logical offset in ring_buf plus ring_delta. Otherwise, segs describes
+     * all data retained in the stream, in order, as a contiguous sequence of
+     * segments ending at cur_size.
+     */
+    OSSL_LIST(qss_seg)  segs;
+    uint64_t            ring_delta;
+    uint64_t            cur_size;
+
     /*
      * Any logical byte in the stream is in one of these states:
      *
@@ -46,8 +80,8 @@ struct quic_sstream_st {
     UINT_SET        new_set, acked_set;
 
     /*
-     * The current size of the stream is ring_buf.head_offset. If
-     * have_final_size is true, this is also the final size of the stream.
+     * The current size of the stream is cur_size. If have_final_size is true,
+     * this is also the final size of the stream.
      */
     unsigned int    have_final_size     : 1;
     unsigned int    sent_final_size     : 1;
@@ -57,6 +91,14 @@ struct quic_sstream_st {
 
 static void qss_cull(QUIC_SSTREAM *qss);
 
+static void qss_seg_free(QSS_SEG *seg)
+{
+    if (seg->buf != NULL && seg->release_cb != NULL)
+        seg->release_cb(seg->buf, (size_t)seg->len, seg->release_arg);
+
+    OPENSSL_free(seg);
+}
+
 QUIC_SSTREAM *ossl_quic_sstream_new(size_t init_buf_size)
 {
     QUIC_SSTREAM *qss;
@@ -74,20 +116,78 @@ QUIC_SSTREAM *ossl_quic_sstream_new(size_t init_buf_size)
 
     ossl_uint_set_init(&qss->new_set);
     ossl_uint_set_init(&qss->acked_set);
+    ossl_list_qss_seg_init(&qss->segs);
     return qss;
 }
 
 void ossl_quic_sstream_free(QUIC_SSTREAM *qss)
 {
+    QSS_SEG *seg, *nseg;
+
     if (qss == NULL)
         return;
 
+    OSSL_LIST_FOREACH_DELSAFE(seg, nseg, qss_seg, &qss->segs) {
+        ossl_list_qss_seg_remove(&qss->segs, seg);
+        qss_seg_free(seg);
+    }
+
     ossl_uint_set_destroy(&qss->new_set);
     ossl_uint_set_destroy(&qss->acked_set);
     ring_buf_destroy(&qss->ring_buf, qss->cleanse);
     OPENSSL_free(qss);
 }
 
+/*
+ * Like ring_buf_get_buf_at(), but takes a logical offset in the stream and
+ * handles data appended by reference.
+ */
+static int qss_get_buf_at(QUIC_SSTREAM *qss, uint64_t offset,
+                          const unsigned char **buf, size_t *buf_len)
+{
+    QSS_SEG *seg;
+    uint64_t seg_off;
+    size_t l;
+
+    if (ossl_list_qss_seg_is_empty(&qss->segs)) {
+        if (offset < qss->ring_delta)
+            return 0;
+
+        return ring_buf_get_buf_at(&qss->ring_buf, offset - qss->ring_delta,
+                                   buf, buf_len);
+    }
+
+    if (offset == qss->cur_size) {
+        *buf        = NULL;
+        *buf_len    = 0;
+        return 1;
+    }
+
+    OSSL_LIST_FOREACH(seg, qss_seg, &qss->segs)
+        if (offset >= seg->start && offset - seg->start < seg->len)
+            break;
+
+    if (seg == NULL)
+        return 0;
+
+    seg_off = offset - seg->start;
+    if (seg->buf != NULL) {
+        *buf        = seg->buf + seg_off;
+        *buf_len    = (size_t)(seg->len - seg_off);
+        return 1;
+    }
+
+    if (!ring_buf_get_buf_at(&qss->ring_buf, seg->ring_start + seg_off,
+                             buf, &l))
+        return 0;
+
+    if (l > seg->len - seg_off)
+        l = (size_t)(seg->len - seg_off);
+
+    *buf_len = l;
+    return 1;
+}
+
 int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
                                        size_t skip,
                                        OSSL_QUIC_FRAME_STREAM *hdr,
@@ -97,7 +197,7 @@ int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
     size_t num_iov_ = 0, src_len = 0, total_len = 0, i;
     uint64_t max_len;
     const unsigned char *src = NULL;
-    UINT_SET_ITEM *range = ossl_list_uint_set_head(&qss->new_set);
+    UINT_SET_ITEM *range = ossl_list_uint_set_head(&qss->new_set.ranges);
 
     if (*num_iov < 2)
         return 0;
@@ -114,7 +214,7 @@ int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
         if (!qss->have_final_size || qss->sent_final_size)
             return 0;
 
-        hdr->offset = qss->ring_buf.head_offset;
+        hdr->offset = qss->cur_size;
         hdr->len    = 0;
         hdr->is_fin = 1;
         *num_iov    = 0;
@@ -130,20 +230,17 @@ int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
      */
     max_len = range->range.end - range->range.start + 1;
 
-    for (i = 0;; ++i) {
-        if (total_len >= max_len)
+    for (;;) {
+        if (total_len >= max_len || num_iov_ == *num_iov)
             break;
 
-        if (!ring_buf_get_buf_at(&qss->ring_buf,
-                                 range->range.start + total_len,
-                                 &src, &src_len))
+        if (!qss_get_buf_at(qss, range->range.start + total_len,
+                            &src, &src_len))
             return 0;
 
         if (src_len == 0)
             break;
 
-        assert(i < 2);
-
         if (total_len + src_len > max_len)
             src_len = (size_t)(max_len - total_len);
 
@@ -157,7 +254,7 @@ int ossl_quic_sstream_get_stream_frame(QUIC_SSTREAM *qss,
     hdr->offset = range->range.start;
     hdr->len    = total_len;
     hdr->is_fin = qss->have_final_size
-        && hdr->offset + hdr->len == qss->ring_buf.head_offset;
+        && hdr->offset + hdr->len == qss->cur_size;
 
     *num_iov    = num_iov_;
     return 1;
@@ -174,7 +271,7 @@ int ossl_quic_sstream_has_pending(QUIC_SSTREAM *qss)
 
 uint64_t ossl_quic_sstream_get_cur_size(QUIC_SSTREAM *qss)
 {
-    return qss->ring_buf.head_offset;
+    return qss->cur_size;
 }
 
 int ossl_quic_sstream_mark_transmitted(QUIC_SSTREAM *qss,
@@ -199,7 +296,7 @@ int ossl_quic_sstream_mark_transmitted_fin(QUIC_SSTREAM *qss,
      * We do not really need final_size since we already know the size of the
      * stream, but this serves as a sanity check.
      */
-    if (!qss->have_final_size || final_size != qss->ring_buf.head_offset)
+    if (!qss->have_final_size || final_size != qss->cur_size)
         return 0;
 
     qss->sent_final_size = 1;
@@ -274,7 +371,7 @@ int ossl_quic_sstream_get_final_size(QUIC_SSTREAM *qss, uint64_t *final_size)
         return 0;
 
     if (final_size != NULL)
-        *final_size = qss->ring_buf.head_offset;
+        *final_size = qss->cur_size;
 
     return 1;
 }
@@ -287,22 +384,36 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
     size_t l, consumed_ = 0;
     UINT_RANGE r;
     struct ring_buf old_ring_buf = qss->ring_buf;
+    QSS_SEG *tail = ossl_list_qss_seg_tail(&qss->segs), *seg = NULL;
 
     if (qss->have_final_size) {
         *consumed = 0;
         return 0;
     }
 
+    /*
+     * If we are tracking segments, the copied data extends the last segment if
+     * that is also in the ring buffer, or otherwise needs a new segment.
+     */
+    if (tail != NULL
+        && (tail->buf != NULL
+            || tail->ring_start + tail->len != old_ring_buf.head_offset)) {
+        seg = OPENSSL_zalloc(sizeof(*seg));
+        if (seg == NULL) {
+            *consumed = 0;
+            return 0;
+        }
+    }
+
     /*
      * Note: It is assumed that ossl_quic_sstream_append will be called during a
      * call to e.g. SSL_write and this function is therefore designed to support
      * such semantics. In particular, the buffer pointed to by buf is only
      * assumed to be valid for the duration of this call, therefore we must copy
      * the data here. We will later copy-and-encrypt the data during packet
-     * encryption, so this is a two-copy design. Supporting a one-copy design in
-     * the future will require applications to use a different kind of API.
-     * Supporting such changes in future will require corresponding enhancements
-     * to this code.
+     * encryption, so this is a two-copy design. Applications which can keep
+     * the buffer alive until it is acknowledged can use
+     * ossl_quic_sstream_append_ref() instead.
      */
     while (buf_len > 0) {
         l = ring_buf_push(&qss->ring_buf, buf, buf_len);
@@ -315,23 +426,95 @@ int ossl_quic_sstream_append(QUIC_SSTREAM *qss,
     }
 
     if (consumed_ > 0) {
-        r.start = old_ring_buf.head_offset;
+        r.start = qss->cur_size;
         r.end   = r.start + consumed_ - 1;
-        assert(r.end + 1 == qss->ring_buf.head_offset);
         if (!ossl_uint_set_insert(&qss->new_set, &r)) {
             qss->ring_buf = old_ring_buf;
+            OPENSSL_free(seg);
             *consumed = 0;
             return 0;
         }
+
+        if (seg != NULL) {
+            seg->start      = qss->cur_size;
+            seg->len        = consumed_;
+            seg->ring_start = old_ring_buf.head_offset;
+            ossl_list_qss_seg_insert_tail(&qss->segs, seg);
+        } else if (tail != NULL) {
+            tail->len += consumed_;
+        }
+
+        qss->cur_size += consumed_;
+    } else {
+        OPENSSL_free(seg);
     }
 
     *consumed = consumed_;
     return 1;
 }
 
+int ossl_quic_sstream_append_ref(QUIC_SSTREAM *qss,
+                                 const unsigned char *buf,
+                                 size_t buf_len,
+                                 SSL_buffer_release_cb_fn release_cb,
+                                 void *release_arg)
+{
+    UINT_RANGE r;
+    QSS_SEG *ring_seg = NULL, *seg = NULL;
+    size_t used = ring_buf_used(&qss->ring_buf);
+
+    if (qss->have_final_size || buf_len == 0
+        || buf_len > MAX_OFFSET - qss->cur_size)
+        return 0;
+
+    /*
+     * If this is the first segment, describe the data already retained in the
+     * ring buffer with a segment of its own.
+     */
+    if (ossl_list_qss_seg_is_empty(&qss->segs) && used > 0) {
+        ring_seg = OPENSSL_zalloc(sizeof(*ring_seg));
+        if (ring_seg == NULL)
+            return 0;
+
+        ring_seg->start         = qss->ring_buf.ctail_offset + qss->ring_delta;
+        ring_seg->len           = used;
+        ring_seg->ring_start    = qss->ring_buf.ctail_offset;
+    }
+
+    seg = OPENSSL_zalloc(sizeof(*seg));
+    if (seg == NULL)
+        goto err;
+
+    seg->start          = qss->cur_size;
+    seg->len            = buf_len;
+    seg->buf            = buf;
+    seg->release_cb     = release_cb;
+    seg->release_arg    = release_arg;
+
+    r.start = qss->cur_size;
+    r.end   = r.start + buf_len - 1;
+    if (!ossl_uint_set_insert(&qss->new_set, &r))
+        goto err;
+
+    if (ring_seg != NULL)
+        ossl_list_qss_seg_insert_tail(&qss->segs, ring_seg);
+
+    ossl_list_qss_seg_insert_tail(&qss->segs, seg);
+    qss->cur_size += buf_len;
+    return 1;
+
+err:
+    /* The caller retains ownership of buf on failure. */
+    OPENSSL_free(ring_seg);
+    OPENSSL_free(seg);
+    return 0;
+}
+
 static void qss_cull(QUIC_SSTREAM *qss)
 {
-    UINT_SET_ITEM *h = ossl_list_uint_set_head(&qss->acked_set);
+    UINT_SET_ITEM *h = ossl_list_uint_set_head(&qss->acked_set.ranges);
+    QSS_SEG *seg, *nseg;
+    uint64_t acked_end, n;
 
     /*
      * Potentially cull data from our ring buffer. This can happen once data has
@@ -349,9 +532,61 @@ static void qss_cull(QUIC_SSTREAM *qss)
      * We only need to check the first range entry in the integer set because we
      * can only cull contiguous areas at the start of the ring buffer anyway.
      */
-    if (h != NULL)
-        ring_buf_cpop_range(&qss->ring_buf, h->range.start, h->range.end,
-                            qss->cleanse);
+    if (h == NULL)
+        return;
+
+    if (ossl_list_qss_seg_is_empty(&qss->segs)) {
+        if (h->range.end >= qss->ring_delta)
+            ring_buf_cpop_range(&qss->ring_buf,
+                                h->range.start > qss->ring_delta
+                                    ? h->range.start - qss->ring_delta : 0,
+                                h->range.end - qss->ring_delta,
+                                qss->cleanse);
+        return;
+    }
+
+    /*
+     * Any data we have culled has been acknowledged, so once anything has been
+     * culled the first range always starts at 0. Segments are culled in order
+     * for the same reason as above, and a caller-owned buffer is released once
+     * all of it has been acknowledged.
+     */
+    if (h->range.start != 0)
+        return;
+
+    acked_end = h->range.end + 1;
+    OSSL_LIST_FOREACH_DELSAFE(seg, nseg, qss_seg, &qss->segs) {
+        if (seg->start >= acked_end)
+            break;
+
+        if (seg->buf == NULL) {
+            n = acked_end - seg->start;
+            if (n > seg->len)
+                n = seg->len;
+
+            ring_buf_cpop_range(&qss->ring_buf, seg->ring_start,
+                                seg->ring_start + n - 1, qss->cleanse);
+
+            if (n < seg->len) {
+                seg->start      += n;
+                seg->ring_start += n;
+                seg->len        -= n;
+                break;
+            }
+        } else if (acked_end - seg->start < seg->len) {
+            break;
+        }
+
+        ossl_list_qss_seg_remove(&qss->segs, seg);
+        qss_seg_free(seg);
+    }
+
+    /*
+     * If all retained data has been culled, the ring buffer is now empty and we
+     * can go back to mapping offsets directly.
+     */
+    if (ossl_list_qss_seg_is_empty(&qss->segs))
+        qss->ring_delta = qss->cur_size - qss->ring_buf.head_offset;
 }
 
 int ossl_quic_sstream_set_buffer_size(QUIC_SSTREAM *qss, size_t num_bytes)
@@ -385,11 +620,11 @@ int ossl_quic_sstream_is_totally_acked(QUIC_SSTREAM *qss)
     if (ossl_quic_sstream_get_cur_size(qss) == 0)
         return 1;
 
-    if (ossl_list_uint_set_num(&qss->acked_set) != 1)
+    if (ossl_list_uint_set_num(&qss->acked_set.ranges) != 1)
         return 0;
 
-    r = ossl_list_uint_set_head(&qss->acked_set)->range;
-    cur_size = qss->ring_buf.head_offset;
+    r = ossl_list_uint_set_head(&qss->acked_set.ranges)->range;
+    cur_size = qss->cur_size;
 
     /*
      * The invariants of UINT_SET guarantee a single list element if we have a
@@ -32,6 +32,13 @@ static void list_insert_tail(QUIC_STREAM_LIST_NODE *l,
     n->next = l;
 }
 
+/* Inserts n after p, where p is a list head or a node in a list. */
+static void list_insert_after(QUIC_STREAM_LIST_NODE *p,
+                              QUIC_STREAM_LIST_NODE *n)
+{
+    list_insert_tail(p->next, n);
+}
+
 static void list_remove(QUIC_STREAM_LIST_NODE *l,
                         QUIC_STREAM_LIST_NODE *n)
 {
@@ -68,11 +75,16 @@ static QUIC_STREAM *list_next(QUIC_STREAM_LIST_NODE *l, QUIC_STREAM_LIST_NODE *n
                                           offsetof(QUIC_STREAM, accept_node))
 #define ready_for_gc_next(l, s) list_next((l), &(s)->ready_for_gc_node, \
                                           offsetof(QUIC_STREAM, ready_for_gc_node))
+#define active_head(l)          list_next((l), (l), \
+                                          offsetof(QUIC_STREAM, active_node))
 #define accept_head(l)          list_next((l), (l), \
                                           offsetof(QUIC_STREAM, accept_node))
 #define ready_for_gc_head(l)    list_next((l), (l), \
                                           offsetof(QUIC_STREAM, ready_for_gc_node))
 
+#define active_stream(n)        ((QUIC_STREAM *)(((char *)(n)) \
+                                  - offsetof(QUIC_STREAM, active_node)))
+
 static unsigned long hash_stream(const QUIC_STREAM *s)
 {
     return (unsigned long)s->id;
@@ -87,6 +99,55 @@ static int cmp_stream(const QUIC_STREAM *a, const QUIC_STREAM *b)
     return 0;
 }
 
+/* Returns the index of the active queue for a stream of a given priority. */
+static size_t active_queue(const QUIC_STREAM *s)
+{
+    return (size_t)s->urgency * 2 + s->incremental;
+}
+
+static void stream_map_mark_active(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s)
+{
+    size_t q = active_queue(s);
+    QUIC_STREAM_LIST_NODE *l = &qsm->active_list[q], *p;
+
+    if (s->active)
+        return;
+
+    if (s->incremental) {
+        list_insert_tail(l, &s->active_node);
+
+        if (qsm->rr_cur[q] == NULL)
+            qsm->rr_cur[q] = s;
+    } else {
+        /*
+         * Non-incremental streams are sent in stream ID order. Streams usually
+         * become active in that order, so search backwards from the tail.
+         */
+        for (p = l->prev; p != l && active_stream(p)->id > s->id; p = p->prev);
+
+        list_insert_after(p, &s->active_node);
+    }
+
+    s->active = 1;
+}
+
+static void stream_map_mark_inactive(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s)
+{
+    size_t q = active_queue(s);
+
+    if (!s->active)
+        return;
+
+    if (qsm->rr_cur[q] == s)
+        qsm->rr_cur[q] = active_next(&qsm->active_list[q], s);
+    if (qsm->rr_cur[q] == s)
+        qsm->rr_cur[q] = NULL;
+
+    list_remove(&qsm->active_list[q], &s->active_node);
+
+    s->active = 0;
+}
+
 int ossl_quic_stream_map_init(QUIC_STREAM_MAP *qsm,
                               uint64_t (*get_stream_limit_cb)(int uni, void *arg),
                               void *get_stream_limit_cb_arg,
@@ -94,14 +155,20 @@ int ossl_quic_stream_map_init(QUIC_STREAM_MAP *qsm,
                               QUIC_RXFC *max_streams_uni_rxfc,
                               int is_server)
 {
+    size_t q;
+
     qsm->map = lh_QUIC_STREAM_new(hash_stream, cmp_stream);
-    qsm->active_list.prev = qsm->active_list.next = &qsm->active_list;
+    for (q = 0; q < QUIC_STREAM_ACTIVE_QUEUES; ++q) {
+        qsm->active_list[q].prev = qsm->active_list[q].next
+            = &qsm->active_list[q];
+        qsm->rr_cur[q] = NULL;
+    }
     qsm->accept_list.prev = qsm->accept_list.next = &qsm->accept_list;
     qsm->ready_for_gc_list.prev = qsm->ready_for_gc_list.next
         = &qsm->ready_for_gc_list;
     qsm->rr_stepping = 1;
     qsm->rr_counter  = 0;
-    qsm->rr_cur      = NULL;
+    qsm->rr_pending  = 0;
 
     qsm->num_accept_bidi    = 0;
     qsm->num_accept_uni     = 0;
@@ -167,6 +234,8 @@ QUIC_STREAM *ossl_quic_stream_map_alloc(QUIC_STREAM_MAP *qsm,
         : QUIC_RSTREAM_STATE_NONE;
 
     s->send_final_size  = UINT64_MAX;
+    s->urgency          = QUIC_STREAM_URGENCY_DEFAULT;
+    s->incremental      = 1;
 
     lh_QUIC_STREAM_insert(qsm->map, s);
     return s;
@@ -177,8 +246,7 @@ void ossl_quic_stream_map_release(QUIC_STREAM_MAP *qsm, QUIC_STREAM *stream)
     if (stream == NULL)
         return;
 
-    if (stream->active_node.next != NULL)
-        list_remove(&qsm->active_list, &stream->active_node);
+    stream_map_mark_inactive(qsm, stream);
     if (stream->accept_node.next != NULL)
         list_remove(&qsm->accept_list, &stream->accept_node);
     if (stream->ready_for_gc_node.next != NULL)
@@ -204,38 +272,30 @@ QUIC_STREAM *ossl_quic_stream_map_get_by_id(QUIC_STREAM_MAP *qsm,
     return lh_QUIC_STREAM_retrieve(qsm->map, &key);
 }
 
-static void stream_map_mark_active(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s)
+void ossl_quic_stream_map_set_rr_stepping(QUIC_STREAM_MAP *qsm, size_t stepping)
 {
-    if (s->active)
-        return;
-
-    list_insert_tail(&qsm->active_list, &s->active_node);
-
-    if (qsm->rr_cur == NULL)
-        qsm->rr_cur = s;
-
-    s->active = 1;
+    qsm->rr_stepping = stepping;
+    qsm->rr_counter  = 0;
 }
 
-static void stream_map_mark_inactive(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s)
+int ossl_quic_stream_map_set_priority(QUIC_STREAM_MAP *qsm, QUIC_STREAM *s,
+                                      unsigned int urgency, int incremental)
 {
-    if (!s->active)
-        return;
+    int was_active = s->active;
 
-    if (qsm->rr_cur == s)
-        qsm->rr_cur = active_next(&qsm->active_list, s);
-    if (qsm->rr_cur == s)
-        qsm->rr_cur = NULL;
+    if (urgency >= QUIC_STREAM_URGENCY_NUM)
+        return 0;
 
-    list_remove(&qsm->active_list, &s->active_node);
+    /* Move the stream to the queue for its new priority. */
+    stream_map_mark_inactive(qsm, s);
 
-    s->active = 0;
-}
+    s->urgency      = urgency;
+    s->incremental  = (incremental != 0);
 
-void ossl_quic_stream_map_set_rr_stepping(QUIC_STREAM_MAP *qsm, size_t stepping)
-{
-    qsm->rr_stepping = stepping;
-    qsm->rr_counter  = 0;
+    if (was_active)
+        stream_map_mark_active(qsm, s);
+
+    return 1;
 }
 
 static int stream_has_data_to_send(QUIC_STREAM *s)
@@ -838,15 +898,56 @@ int ossl_quic_stream_map_is_shutdown_flush_finished(QUIC_STREAM_MAP *qsm)
  * QUIC Stream Iterator
  * ====================
  */
+
+/*
+ * Positions the iterator at the first stream of the first non-empty queue,
+ * starting with it->queue.
+ */
+static void iter_seek_queue(QUIC_STREAM_ITER *it)
+{
+    QUIC_STREAM_MAP *qsm = it->qsm;
+
+    for (; it->queue < QUIC_STREAM_ACTIVE_QUEUES; ++it->queue) {
+        it->stream = qsm->rr_cur[it->queue];
+        if (it->stream == NULL)
+            it->stream = active_head(&qsm->active_list[it->queue]);
+
+        if (it->stream != NULL) {
+            it->first_stream = it->stream;
+            return;
+        }
+    }
+
+    it->stream = it->first_stream = NULL;
+}
+
 void ossl_quic_stream_iter_init(QUIC_STREAM_ITER *it, QUIC_STREAM_MAP *qsm,
                                 int advance_rr)
 {
-    it->qsm    = qsm;
-    it->stream = it->first_stream = qsm->rr_cur;
+    size_t q;
+
+    /*
+     * The rotation is applied when the next iterator is initialised, as the
+     * queues are only reached by this iterator as it advances.
+     */
+    if (qsm->rr_pending) {
+        qsm->rr_pending = 0;
+
+        /* Only the incremental queues (odd indices) are rotated. */
+        for (q = 1; q < QUIC_STREAM_ACTIVE_QUEUES; q += 2)
+            if (qsm->rr_cur[q] != NULL)
+                qsm->rr_cur[q] = active_next(&qsm->active_list[q],
+                                             qsm->rr_cur[q]);
+    }
+
+    it->qsm   = qsm;
+    it->queue = 0;
+    iter_seek_queue(it);
+
     if (advance_rr && it->stream != NULL
         && ++qsm->rr_counter >= qsm->rr_stepping) {
         qsm->rr_counter = 0;
-        qsm->rr_cur     = active_next(&qsm->active_list, qsm->rr_cur);
+        qsm->rr_pending = 1;
     }
 }
 
@@ -855,7 +956,9 @@ void ossl_quic_stream_iter_next(QUIC_STREAM_ITER *it)
     if (it->stream == NULL)
         return;
 
-    it->stream = active_next(&it->qsm->active_list, it->stream);
-    if (it->stream == it->first_stream)
-        it->stream = NULL;
+    it->stream = active_next(&it->qsm->active_list[it->queue], it->stream);
+    if (it->stream == it->first_stream) {
+        ++it->queue;
+        iter_seek_queue(it);
+    }
 }
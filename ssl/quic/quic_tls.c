@@ -51,6 +51,9 @@ struct quic_tls_st {
 
     /* Set if the handshake has completed */
     unsigned int complete : 1;
+
+    /* Set if we should try to send early data (client only) */
+    unsigned int early_data_enabled : 1;
 };
 
 struct ossl_record_layer_st {
@@ -754,6 +757,15 @@ int ossl_quic_tls_tick(QUIC_TLS *qtls)
 
         SSL_clear_options(qtls->args.s, SSL_OP_ENABLE_MIDDLEBOX_COMPAT);
         ossl_ssl_set_custom_record_layer(sc, &quic_tls_record_method, qtls);
+        sc->s3.flags |= TLS1_FLAGS_QUIC;
+
+        /*
+         * RFC 9001 s. 4.6.1: A server which accepts early data must advertise
+         * a max_early_data_size of 0xffffffff. The amount of 0-RTT data is
+         * limited by the QUIC flow control limits instead.
+         */
+        if (qtls->args.is_server && sc->max_early_data != 0)
+            sc->max_early_data = 0xffffffff;
 
         if (!ossl_tls_add_custom_ext_intern(NULL, &sc->cert->custext,
                                             qtls->args.is_server ? ENDPOINT_SERVER
@@ -782,6 +794,18 @@ int ossl_quic_tls_tick(QUIC_TLS *qtls)
         else
             SSL_set_connect_state(qtls->args.s);
 
+        /*
+         * We only offer early data if we have a session which allows it and
+         * which also has the transport parameters we have to abide by when
+         * sending 0-RTT data. The 0-RTT data itself is sent by the channel
+         * once the 0-RTT keys have been yielded.
+         */
+        if (!qtls->args.is_server && qtls->early_data_enabled
+            && sc->session != NULL
+            && sc->session->ext.max_early_data == 0xffffffff
+            && sc->session->ext.quic_transport_params != NULL)
+            sc->early_data_state = SSL_EARLY_DATA_CONNECTING;
+
         qtls->configured = 1;
     }
 
@@ -877,3 +901,47 @@ int ossl_quic_tls_has_bad_max_early_data(QUIC_TLS *qtls)
      */
     return max_early_data != 0xffffffff && max_early_data != 0;
 }
+
+void ossl_quic_tls_set_early_data_enabled(QUIC_TLS *qtls, int enabled)
+{
+    qtls->early_data_enabled = (enabled != 0);
+}
+
+int ossl_quic_tls_set1_session_transport_params(QUIC_TLS *qtls,
+                                                const unsigned char *params,
+                                                size_t params_len)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(qtls->args.s);
+    SSL_SESSION *sess;
+    unsigned char *copy;
+
+    if (sc == NULL || qtls->args.is_server)
+        return 0;
+
+    /* A resumed session may be shared, so we never modify it. */
+    sess = sc->session;
+    if (sess == NULL || sc->hit)
+        return 1;
+
+    if ((copy = OPENSSL_memdup(params, params_len)) == NULL)
+        return 0;
+
+    OPENSSL_free(sess->ext.quic_transport_params);
+    sess->ext.quic_transport_params     = copy;
+    sess->ext.quic_transport_params_len = params_len;
+    return 1;
+}
+
+int ossl_quic_tls_get0_session_transport_params(QUIC_TLS *qtls,
+                                                const unsigned char **params,
+                                                size_t *params_len)
+{
+    SSL_SESSION *sess = SSL_get0_session(qtls->args.s);
+
+    if (sess == NULL || sess->ext.quic_transport_params == NULL)
+        return 0;
+
+    *params     = sess->ext.quic_transport_params;
+    *params_len = sess->ext.quic_transport_params_len;
+    return 1;
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/quic_token.h"
+#include "internal/list.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <string.h>
+
+/*
+ * Token Format
+ * ============
+ *
+ *   Type (8)              QUIC_TOKEN_TYPE_NEW_TOKEN
+ *   Nonce (96)
+ *   Issue Time (64)       milliseconds, encrypted
+ *   Tag (128)
+ *
+ * The type byte and the client's IP address are authenticated as AAD using
+ * AES-256-GCM. The type byte allows tokens of other kinds (e.g. Retry tokens)
+ * to be distinguished in future.
+ */
+#define QUIC_TOKEN_TYPE_NEW_TOKEN   0x4e
+#define TOKEN_NONCE_LEN             12
+#define TOKEN_TIME_LEN              8
+#define TOKEN_TAG_LEN               16
+#define TOKEN_KEY_LEN               32
+
+/* Tolerance for tokens issued slightly in the future of our clock. */
+#define TOKEN_MAX_CLOCK_SKEW        ossl_seconds2time(60)
+
+struct quic_token_key_st {
+    OSSL_LIB_CTX    *libctx;
+    EVP_CIPHER_CTX  *enc_ctx, *dec_ctx;
+};
+
+QUIC_TOKEN_KEY *ossl_quic_token_key_new(OSSL_LIB_CTX *libctx,
+                                        const char *propq)
+{
+    QUIC_TOKEN_KEY *key;
+    EVP_CIPHER *cipher = NULL;
+    unsigned char secret[TOKEN_KEY_LEN];
+
+    if ((key = OPENSSL_zalloc(sizeof(*key))) == NULL)
+        return NULL;
+
+    key->libctx = libctx;
+
+    if (RAND_priv_bytes_ex(libctx, secret, sizeof(secret),
+                           sizeof(secret) * 8) != 1)
+        goto err;
+
+    if ((cipher = EVP_CIPHER_fetch(libctx, "AES-256-GCM", propq)) == NULL)
+        goto err;
+
+    if ((key->enc_ctx = EVP_CIPHER_CTX_new()) == NULL
+        || (key->dec_ctx = EVP_CIPHER_CTX_new()) == NULL)
+        goto err;
+
+    if (!EVP_EncryptInit_ex2(key->enc_ctx, cipher, secret, NULL, NULL)
+        || !EVP_DecryptInit_ex2(key->dec_ctx, cipher, secret, NULL, NULL))
+        goto err;
+
+    EVP_CIPHER_free(cipher);
+    OPENSSL_cleanse(secret, sizeof(secret));
+    return key;
+
+err:
+    EVP_CIPHER_free(cipher);
+    OPENSSL_cleanse(secret, sizeof(secret));
+    ossl_quic_token_key_free(key);
+    return NULL;
+}
+
+void ossl_quic_token_key_free(QUIC_TOKEN_KEY *key)
+{
+    if (key == NULL)
+        return;
+
+    EVP_CIPHER_CTX_free(key->enc_ctx);
+    EVP_CIPHER_CTX_free(key->dec_ctx);
+    OPENSSL_free(key);
+}
+
+/*
+ * Writes the AAD for a token to buf, which must be at least 18 bytes long:
+ * the token type, the address family and the raw IP address.
+ */
+static int token_aad(const BIO_ADDR *peer, unsigned char *buf, size_t *len)
+{
+    size_t addr_len = 0;
+
+    buf[0] = QUIC_TOKEN_TYPE_NEW_TOKEN;
+    buf[1] = (unsigned char)BIO_ADDR_family(peer);
+
+    if (!BIO_ADDR_rawaddress(peer, NULL, &addr_len) || addr_len > 16
+        || !BIO_ADDR_rawaddress(peer, buf + 2, &addr_len))
+        return 0;
+
+    *len = 2 + addr_len;
+    return 1;
+}
+
+int ossl_quic_token_generate(QUIC_TOKEN_KEY *key, const BIO_ADDR *peer,
+                             OSSL_TIME now, unsigned char *buf)
+{
+    unsigned char aad[18], *nonce = buf + 1;
+    unsigned char *ct = nonce + TOKEN_NONCE_LEN, *tag = ct + TOKEN_TIME_LEN;
+    unsigned char pt[TOKEN_TIME_LEN];
+    uint64_t ms = ossl_time2ms(now);
+    size_t aad_len, i;
+    int l;
+
+    if (!token_aad(peer, aad, &aad_len))
+        return 0;
+
+    for (i = 0; i < TOKEN_TIME_LEN; ++i)
+        pt[i] = (unsigned char)(ms >> (8 * (TOKEN_TIME_LEN - 1 - i)));
+
+    buf[0] = QUIC_TOKEN_TYPE_NEW_TOKEN;
+    if (RAND_bytes_ex(key->libctx, nonce, TOKEN_NONCE_LEN, 0) != 1)
+        return 0;
+
+    if (!EVP_EncryptInit_ex2(key->enc_ctx, NULL, NULL, nonce, NULL)
+        || !EVP_EncryptUpdate(key->enc_ctx, NULL, &l, aad, (int)aad_len)
+        || !EVP_EncryptUpdate(key->enc_ctx, ct, &l, pt, sizeof(pt))
+        || !EVP_EncryptFinal_ex(key->enc_ctx, ct + l, &l)
+        || EVP_CIPHER_CTX_ctrl(key->enc_ctx, EVP_CTRL_AEAD_GET_TAG,
+                               TOKEN_TAG_LEN, tag) != 1)
+        return 0;
+
+    return 1;
+}
+
+int ossl_quic_token_validate(QUIC_TOKEN_KEY *key, const BIO_ADDR *peer,
+                             OSSL_TIME now, const unsigned char *token,
+                             size_t token_len)
+{
+    unsigned char aad[18], pt[TOKEN_TIME_LEN], tag[TOKEN_TAG_LEN];
+    const unsigned char *nonce = token + 1, *ct = nonce + TOKEN_NONCE_LEN;
+    uint64_t ms = 0;
+    OSSL_TIME issued;
+    size_t aad_len, i;
+    int l;
+
+    if (token_len != QUIC_TOKEN_LEN || token[0] != QUIC_TOKEN_TYPE_NEW_TOKEN)
+        return 0;
+
+    if (!token_aad(peer, aad, &aad_len))
+        return 0;
+
+    memcpy(tag, ct + TOKEN_TIME_LEN, sizeof(tag));
+
+    if (!EVP_DecryptInit_ex2(key->dec_ctx, NULL, NULL, nonce, NULL)
+        || !EVP_DecryptUpdate(key->dec_ctx, NULL, &l, aad, (int)aad_len)
+        || !EVP_DecryptUpdate(key->dec_ctx, pt, &l, ct, TOKEN_TIME_LEN)
+        || EVP_CIPHER_CTX_ctrl(key->dec_ctx, EVP_CTRL_AEAD_SET_TAG,
+                               TOKEN_TAG_LEN, tag) != 1
+        || EVP_DecryptFinal_ex(key->dec_ctx, pt + l, &l) != 1)
+        return 0;
+
+    for (i = 0; i < TOKEN_TIME_LEN; ++i)
+        ms = (ms << 8) | pt[i];
+
+    issued = ossl_ms2time(ms);
+    if (ossl_time_compare(issued,
+                          ossl_time_add(now, TOKEN_MAX_CLOCK_SKEW)) > 0)
+        return 0;
+
+    return ossl_time_compare(ossl_time_subtract(now, issued),
+                             QUIC_TOKEN_LIFETIME) <= 0;
+}
+
+/*
+ * Client Token Store
+ * ==================
+ *
+ * The number of servers is small and bounded, so entries are kept in a list in
+ * order of last update and looked up by linear search.
+ */
+typedef struct token_entry_st TOKEN_ENTRY;
+
+struct token_entry_st {
+    OSSL_LIST_MEMBER(token_entry, TOKEN_ENTRY);
+    char            *server_id;
+    unsigned char   *token;
+    size_t          token_len;
+};
+
+DEFINE_LIST_OF(token_entry, TOKEN_ENTRY);
+
+struct quic_token_store_st {
+    CRYPTO_RWLOCK           *lock;
+    OSSL_LIST(token_entry)  entries; /* most recently updated first */
+};
+
+QUIC_TOKEN_STORE *ossl_quic_token_store_new(void)
+{
+    QUIC_TOKEN_STORE *store;
+
+    if ((store = OPENSSL_zalloc(sizeof(*store))) == NULL)
+        return NULL;
+
+    if ((store->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(store);
+        return NULL;
+    }
+
+    ossl_list_token_entry_init(&store->entries);
+    return store;
+}
+
+static void token_entry_free(TOKEN_ENTRY *e)
+{
+    OPENSSL_free(e->server_id);
+    OPENSSL_free(e->token);
+    OPENSSL_free(e);
+}
+
+void ossl_quic_token_store_free(QUIC_TOKEN_STORE *store)
+{
+    TOKEN_ENTRY *e, *enext;
+
+    if (store == NULL)
+        return;
+
+    OSSL_LIST_FOREACH_DELSAFE(e, enext, token_entry, &store->entries)
+        token_entry_free(e);
+
+    CRYPTO_THREAD_lock_free(store->lock);
+    OPENSSL_free(store);
+}
+
+static TOKEN_ENTRY *token_store_find(QUIC_TOKEN_STORE *store,
+                                     const char *server_id)
+{
+    TOKEN_ENTRY *e;
+
+    OSSL_LIST_FOREACH(e, token_entry, &store->entries)
+        if (strcmp(e->server_id, server_id) == 0)
+            return e;
+
+    return NULL;
+}
+
+int ossl_quic_token_store_add(QUIC_TOKEN_STORE *store, const char *server_id,
+                              const unsigned char *token, size_t token_len)
+{
+    TOKEN_ENTRY *e;
+    unsigned char *copy;
+
+    if ((copy = OPENSSL_memdup(token, token_len)) == NULL)
+        return 0;
+
+    if (!CRYPTO_THREAD_write_lock(store->lock)) {
+        OPENSSL_free(copy);
+        return 0;
+    }
+
+    if ((e = token_store_find(store, server_id)) != NULL) {
+        ossl_list_token_entry_remove(&store->entries, e);
+        OPENSSL_free(e->token);
+    } else {
+        if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL
+            || (e->server_id = OPENSSL_strdup(server_id)) == NULL) {
+            CRYPTO_THREAD_unlock(store->lock);
+            OPENSSL_free(e);
+            OPENSSL_free(copy);
+            return 0;
+        }
+
+        if (ossl_list_token_entry_num(&store->entries)
+            >= QUIC_TOKEN_STORE_MAX_SERVERS) {
+            TOKEN_ENTRY *oldest = ossl_list_token_entry_tail(&store->entries);
+
+            ossl_list_token_entry_remove(&store->entries, oldest);
+            token_entry_free(oldest);
+        }
+    }
+
+    e->token     = copy;
+    e->token_len = token_len;
+    ossl_list_token_entry_insert_head(&store->entries, e);
+
+    CRYPTO_THREAD_unlock(store->lock);
+    return 1;
+}
+
+int ossl_quic_token_store_take(QUIC_TOKEN_STORE *store, const char *server_id,
+                               unsigned char **token, size_t *token_len)
+{
+    TOKEN_ENTRY *e;
+
+    if (!CRYPTO_THREAD_write_lock(store->lock))
+        return 0;
+
+    if ((e = token_store_find(store, server_id)) != NULL)
+        ossl_list_token_entry_remove(&store->entries, e);
+
+    CRYPTO_THREAD_unlock(store->lock);
+
+    if (e == NULL)
+        return 0;
+
+    *token      = e->token;
+    *token_len  = e->token_len;
+    e->token    = NULL;
+    token_entry_free(e);
+    return 1;
+}
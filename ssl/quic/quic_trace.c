@@ -392,6 +392,25 @@ static int frame_conn_closed(BIO *bio, PACKET *pkt)
     return 1;
 }
 
+static int frame_ack_frequency(BIO *bio, PACKET *pkt)
+{
+    OSSL_QUIC_FRAME_ACK_FREQUENCY frame_data;
+
+    if (!ossl_quic_wire_decode_frame_ack_frequency(pkt, &frame_data))
+        return 0;
+
+    BIO_printf(bio, "    Sequence Number: %llu\n",
+               (unsigned long long)frame_data.seq_num);
+    BIO_printf(bio, "    Ack-Eliciting Threshold: %llu\n",
+               (unsigned long long)frame_data.ack_eliciting_threshold);
+    BIO_printf(bio, "    Requested Max Ack Delay: %llu\n",
+               (unsigned long long)frame_data.max_ack_delay_us);
+    BIO_printf(bio, "    Reordering Threshold: %llu\n",
+               (unsigned long long)frame_data.reordering_threshold);
+
+    return 1;
+}
+
 static int trace_frame_data(BIO *bio, PACKET *pkt)
 {
     uint64_t frame_type;
@@ -546,6 +565,18 @@ static int trace_frame_data(BIO *bio, PACKET *pkt)
             return 0;
         break;
 
+    case OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY:
+        BIO_puts(bio, "Ack frequency\n");
+        if (!frame_ack_frequency(bio, pkt))
+            return 0;
+        break;
+
+    case OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK:
+        BIO_puts(bio, "Immediate ack\n");
+        if (!ossl_quic_wire_decode_frame_immediate_ack(pkt))
+            return 0;
+        break;
+
     default:
         return 0;
     }
@@ -210,6 +210,7 @@ int ossl_quic_tserver_set_handshake_mutator(QUIC_TSERVER *srv,
 
 int ossl_quic_tserver_tick(QUIC_TSERVER *srv)
 {
+    ossl_quic_channel_schedule_tick(srv->ch);
     ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(srv->ch), 0);
 
     if (ossl_quic_channel_is_active(srv->ch))
@@ -530,6 +531,7 @@ int ossl_quic_tserver_shutdown(QUIC_TSERVER *srv, uint64_t app_error_code)
     if (ossl_quic_channel_is_terminated(srv->ch))
         return 1;
 
+    ossl_quic_channel_schedule_tick(srv->ch);
     ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(srv->ch), 0);
 
     return ossl_quic_channel_is_terminated(srv->ch);
@@ -543,6 +545,7 @@ int ossl_quic_tserver_ping(QUIC_TSERVER *srv)
     if (!ossl_quic_channel_ping(srv->ch))
         return 0;
 
+    ossl_quic_channel_schedule_tick(srv->ch);
     ossl_quic_reactor_tick(ossl_quic_channel_get_reactor(srv->ch), 0);
     return 1;
 }
@@ -23,6 +23,7 @@
 #define MIN_FRAME_SIZE_STREAM           3 /* minimum useful size (for non-FIN) */
 #define MIN_FRAME_SIZE_MAX_STREAMS_BIDI 2
 #define MIN_FRAME_SIZE_MAX_STREAMS_UNI  2
+#define MIN_FRAME_SIZE_ACK_FREQUENCY    6
 
 /*
  * Packet Archetypes
@@ -48,6 +49,9 @@
 
 #define TX_PACKETISER_ARCHETYPE_NUM                 3
 
+/* Maximum number of datagrams the pacer allows to be sent in one burst. */
+#define TXP_PACER_BURST_DGRAMS                      10
+
 struct ossl_quic_tx_packetiser_st {
     OSSL_QUIC_TX_PACKETISER_ARGS args;
 
@@ -62,6 +66,7 @@ struct ossl_quic_tx_packetiser_st {
 
     /* Subcomponents of the TXP that we own. */
     QUIC_FIFD       fifd;       /* QUIC Frame-in-Flight Dispatcher */
+    QUIC_PACER      pacer;      /* QUIC Pacer */
 
     /* Internal state. */
     uint64_t        next_pn[QUIC_PN_SPACE_NUM]; /* Next PN to use in given PN space. */
@@ -87,6 +92,30 @@ struct ossl_quic_tx_packetiser_st {
     /* Has the handshake been completed? */
     unsigned int    handshake_complete      : 1;
 
+    /*
+     * ACK frequency extension state. If the peer supports the extension, we
+     * send ACK_FREQUENCY frames asking it to acknowledge every
+     * ack_freq_threshold + 1 ACK-eliciting packets, as wanted by the congestion
+     * controller.
+     */
+    unsigned int    ack_freq_enabled        : 1;
+    unsigned int    want_ack_frequency      : 1;
+    uint64_t        ack_freq_seq_num;
+    uint64_t        ack_freq_threshold;
+    uint64_t        ack_freq_max_ack_delay_us;
+
+    /* ECN codepoint to send packets with (OSSL_ACKM_ECN_*). */
+    uint32_t        ecn;
+
+    /*
+     * Anti-amplification limit (RFC 9000 s. 8). Until the peer's address has
+     * been validated, we may send at most three times the number of bytes we
+     * have received from it.
+     */
+    unsigned int    addr_validated          : 1;
+    uint64_t        unvalidated_bytes_recv;
+    uint64_t        unvalidated_bytes_xmit;
+
     OSSL_QUIC_FRAME_CONN_CLOSE  conn_close_frame;
 
     /*
@@ -384,6 +413,7 @@ struct archetype_data {
     unsigned int allow_ping                 : 1;
     unsigned int allow_crypto               : 1;
     unsigned int allow_handshake_done       : 1;
+    unsigned int allow_ack_frequency        : 1;
     unsigned int allow_path_challenge       : 1;
     unsigned int allow_path_response        : 1;
     unsigned int allow_new_conn_id          : 1;
@@ -429,6 +459,7 @@ static int txp_should_try_staging(OSSL_QUIC_TX_PACKETISER *txp,
                                   uint64_t cc_limit,
                                   uint32_t *conn_close_enc_level);
 static size_t txp_determine_pn_len(OSSL_QUIC_TX_PACKETISER *txp);
+static int txp_pacer_can_send(OSSL_QUIC_TX_PACKETISER *txp);
 static int txp_determine_ppl_from_pl(OSSL_QUIC_TX_PACKETISER *txp,
                                      size_t pl,
                                      uint32_t enc_level,
@@ -475,6 +506,9 @@ OSSL_QUIC_TX_PACKETISER *ossl_quic_tx_packetiser_new(const OSSL_QUIC_TX_PACKETIS
 
     txp->args           = *args;
     txp->last_tx_time   = ossl_time_zero();
+    txp->ack_freq_threshold = 1;
+    txp->addr_validated = 1;
+    ossl_quic_pacer_init(&txp->pacer);
 
     if (!ossl_quic_fifd_init(&txp->fifd,
                              txp->args.cfq, txp->args.ackm, txp->args.txpim,
@@ -635,6 +669,14 @@ void ossl_quic_tx_packetiser_set_qlog_cb(OSSL_QUIC_TX_PACKETISER *txp,
 
 }
 
+void ossl_quic_tx_packetiser_set_cc(OSSL_QUIC_TX_PACKETISER *txp,
+                                    const OSSL_CC_METHOD *cc_method,
+                                    OSSL_CC_DATA *cc_data)
+{
+    txp->args.cc_method = cc_method;
+    txp->args.cc_data   = cc_data;
+}
+
 int ossl_quic_tx_packetiser_discard_enc_level(OSSL_QUIC_TX_PACKETISER *txp,
                                               uint32_t enc_level)
 {
@@ -659,6 +701,69 @@ void ossl_quic_tx_packetiser_schedule_handshake_done(OSSL_QUIC_TX_PACKETISER *tx
     txp->want_handshake_done = 1;
 }
 
+void ossl_quic_tx_packetiser_set_ack_frequency(OSSL_QUIC_TX_PACKETISER *txp,
+                                               uint64_t max_ack_delay_us)
+{
+    txp->ack_freq_enabled           = 1;
+    txp->ack_freq_max_ack_delay_us  = max_ack_delay_us;
+}
+
+void ossl_quic_tx_packetiser_set_ecn(OSSL_QUIC_TX_PACKETISER *txp,
+                                     uint32_t ecn)
+{
+    txp->ecn = ecn;
+}
+
+void ossl_quic_tx_packetiser_set_addr_validated(OSSL_QUIC_TX_PACKETISER *txp,
+                                                int validated)
+{
+    txp->addr_validated = (validated != 0);
+}
+
+void ossl_quic_tx_packetiser_record_received_bytes(OSSL_QUIC_TX_PACKETISER *txp,
+                                                   size_t n)
+{
+    if (!txp->addr_validated)
+        txp->unvalidated_bytes_recv += n;
+}
+
+/*
+ * Returns 1 if the anti-amplification limit permits us to send a datagram. As
+ * we do not know how large the datagram will be before generating it, we
+ * assume it may be as large as the MDPL.
+ */
+static int txp_amp_can_send(OSSL_QUIC_TX_PACKETISER *txp)
+{
+    return txp->addr_validated
+        || txp->unvalidated_bytes_xmit + txp_get_mdpl(txp)
+           <= txp->unvalidated_bytes_recv * 3;
+}
+
+/*
+ * Asks the congestion controller how often it wants the peer to acknowledge
+ * packets, and schedules an ACK_FREQUENCY frame if this has changed enough.
+ * Lower thresholds are sent promptly, as the congestion controller needs a
+ * faster ACK clock; higher thresholds are only sent once they have doubled so
+ * that we do not send a frame for every small change in the window.
+ */
+static void txp_update_ack_frequency(OSSL_QUIC_TX_PACKETISER *txp)
+{
+    uint64_t threshold;
+
+    if (!txp->ack_freq_enabled || !txp->handshake_complete
+        || txp->args.cc_method->get_ack_eliciting_threshold == NULL)
+        return;
+
+    threshold
+        = txp->args.cc_method->get_ack_eliciting_threshold(txp->args.cc_data);
+
+    if (threshold < txp->ack_freq_threshold
+        || threshold >= 2 * txp->ack_freq_threshold) {
+        txp->ack_freq_threshold = threshold;
+        txp->want_ack_frequency = 1;
+    }
+}
+
 void ossl_quic_tx_packetiser_schedule_ack_eliciting(OSSL_QUIC_TX_PACKETISER *txp,
                                                     uint32_t pn_space)
 {
@@ -785,6 +890,25 @@ int ossl_quic_tx_packetiser_generate(OSSL_QUIC_TX_PACKETISER *txp,
      */
     ossl_qtx_finish_dgram(txp->args.qtx);
 
+    /*
+     * We cannot send anything, not even an ACK, while we are limited by the
+     * anti-amplification limit. The peer will send more (e.g. a PTO probe)
+     * which lifts the limit.
+     */
+    if (!txp_amp_can_send(txp)) {
+        res = 1;
+        goto out;
+    }
+
+    /*
+     * If pacing does not permit us to send yet, treat ourselves as CC-limited
+     * for now. ACKs and probes are still permitted.
+     */
+    if (!txp_pacer_can_send(txp))
+        cc_limit = 0;
+
+    txp_update_ack_frequency(txp);
+
     /* 1. Archetype Selection */
     archetype = txp_determine_archetype(txp, cc_limit);
 
@@ -910,6 +1034,10 @@ int ossl_quic_tx_packetiser_generate(OSSL_QUIC_TX_PACKETISER *txp,
                 status->sent_handshake
                     = (pkt[enc_level].h_valid
                        && pkt[enc_level].h.bytes_appended > 0);
+
+            if (!txp->addr_validated)
+                txp->unvalidated_bytes_xmit
+                    += pkt[enc_level].tpkt->ackm_pkt.num_bytes;
         }
 
         if (txpim_pkt_reffed)
@@ -945,6 +1073,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -965,6 +1094,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -985,6 +1115,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 0,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1008,6 +1139,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 1,
@@ -1028,6 +1160,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 1,
@@ -1048,6 +1181,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 0,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1071,6 +1205,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1091,6 +1226,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1111,6 +1247,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 0,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1134,6 +1271,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 1,
+            /*allow_ack_frequency             =*/ 1,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 1,
             /*allow_new_conn_id               =*/ 1,
@@ -1154,6 +1292,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 1,
             /*allow_crypto                    =*/ 1,
             /*allow_handshake_done            =*/ 1,
+            /*allow_ack_frequency             =*/ 1,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 1,
             /*allow_new_conn_id               =*/ 1,
@@ -1174,6 +1313,7 @@ static const struct archetype_data archetypes[QUIC_ENC_LEVEL_NUM][TX_PACKETISER_
             /*allow_ping                      =*/ 0,
             /*allow_crypto                    =*/ 0,
             /*allow_handshake_done            =*/ 0,
+            /*allow_ack_frequency             =*/ 0,
             /*allow_path_challenge            =*/ 0,
             /*allow_path_response             =*/ 0,
             /*allow_new_conn_id               =*/ 0,
@@ -1420,6 +1560,10 @@ static int txp_should_try_staging(OSSL_QUIC_TX_PACKETISER *txp,
     if (a.allow_handshake_done && txp->want_handshake_done)
         return 1;
 
+    /* Do we want to produce an ACK_FREQUENCY frame? */
+    if (a.allow_ack_frequency && txp->want_ack_frequency)
+        return 1;
+
     /* Do we want to produce a CONNECTION_CLOSE frame? */
     if (a.allow_conn_close && txp->want_conn_close &&
         *conn_close_enc_level == enc_level)
@@ -1462,7 +1606,8 @@ static int txp_should_try_staging(OSSL_QUIC_TX_PACKETISER *txp,
             }
        }
 
-    if (a.allow_stream_rel && txp->handshake_complete) {
+    if (a.allow_stream_rel
+        && (txp->handshake_complete || enc_level == QUIC_ENC_LEVEL_0RTT)) {
         QUIC_STREAM_ITER it;
 
         /* If there are any active streams, 0/1-RTT wants to produce a packet.
@@ -1522,6 +1667,34 @@ static size_t txp_get_mdpl(OSSL_QUIC_TX_PACKETISER *txp)
     return ossl_qtx_get_mdpl(txp->args.qtx);
 }
 
+/*
+ * Updates the pacer from the congestion controller's current pacing rate and
+ * returns 1 if it permits a packet to be sent now. Pacing is only performed if
+ * we have been given a statistics manager from which to obtain the RTT.
+ */
+static int txp_pacer_can_send(OSSL_QUIC_TX_PACKETISER *txp)
+{
+    OSSL_TIME now;
+    OSSL_RTT_INFO rtt_info;
+    uint64_t rate = 0;
+
+    if (txp->args.statm == NULL)
+        return 1;
+
+    now = txp->args.now(txp->args.now_arg);
+
+    if (txp->args.cc_method->get_pacing_rate != NULL) {
+        ossl_statm_get_rtt_info(txp->args.statm, &rtt_info);
+        rate = txp->args.cc_method->get_pacing_rate(txp->args.cc_data,
+                                                    rtt_info.smoothed_rtt);
+    }
+
+    /* Allow an initial-window sized burst (RFC 9002 s. 7.7). */
+    ossl_quic_pacer_set_rate(&txp->pacer, rate,
+                             TXP_PACER_BURST_DGRAMS * txp_get_mdpl(txp), now);
+    return ossl_quic_pacer_can_send(&txp->pacer, now);
+}
+
 static QUIC_SSTREAM *get_sstream_by_id(uint64_t stream_id, uint32_t pn_space,
                                        void *arg)
 {
@@ -1550,6 +1723,10 @@ static void on_regen_notify(uint64_t frame_type, uint64_t stream_id,
         case OSSL_QUIC_FRAME_TYPE_MAX_DATA:
             txp->want_max_data = 1;
             break;
+        case OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY:
+            /* Resent with a new sequence number and the current threshold. */
+            txp->want_ack_frequency = 1;
+            break;
         case OSSL_QUIC_FRAME_TYPE_MAX_STREAMS_BIDI:
             txp->want_max_streams_bidi = 1;
             break;
@@ -1842,9 +2019,9 @@ static int txp_generate_pre_token(OSSL_QUIC_TX_PACKETISER *txp,
         if (wpkt == NULL)
             return 0;
 
-        /* We do not currently support ECN */
+        /* Only report ECN counts once we have received an ECN-marked packet. */
         ack2 = *ack;
-        ack2.ecn_present = 0;
+        ack2.ecn_present = (ack->ect0 | ack->ect1 | ack->ecnce) != 0;
 
         if (ossl_quic_wire_encode_frame_ack(wpkt,
                                             txp->args.ack_delay_exponent,
@@ -2622,6 +2799,34 @@ static int txp_generate_for_el(OSSL_QUIC_TX_PACKETISER *txp,
         }
     }
 
+    /* ACK_FREQUENCY (Regenerate) */
+    if (a.allow_ack_frequency && txp->want_ack_frequency
+        && tx_helper_get_space_left(h) >= MIN_FRAME_SIZE_ACK_FREQUENCY) {
+        WPACKET *wpkt = tx_helper_begin(h);
+        OSSL_QUIC_FRAME_ACK_FREQUENCY f;
+
+        if (wpkt == NULL)
+            goto fatal_err;
+
+        f.seq_num                   = txp->ack_freq_seq_num;
+        f.ack_eliciting_threshold   = txp->ack_freq_threshold;
+        f.max_ack_delay_us          = txp->ack_freq_max_ack_delay_us;
+        /* Keep RFC 9000 behaviour so that loss detection is not delayed. */
+        f.reordering_threshold      = 1;
+
+        if (ossl_quic_wire_encode_frame_ack_frequency(wpkt, &f)) {
+            tpkt->had_ack_frequency_frame = 1;
+            have_ack_eliciting            = 1;
+
+            if (!tx_helper_commit(h))
+                goto fatal_err;
+
+            tx_helper_unrestrict(h); /* no longer need PING */
+        } else {
+            tx_helper_rollback(h);
+        }
+    }
+
     /* MAX_DATA (Regenerate) */
     if (a.allow_conn_fc
         && (txp->want_max_data
@@ -2783,8 +2988,12 @@ static int txp_generate_for_el(OSSL_QUIC_TX_PACKETISER *txp,
         if (!txp_generate_crypto_frames(txp, pkt, &have_ack_eliciting))
             goto fatal_err;
 
-    /* Stream-specific frames */
-    if (a.allow_stream_rel && txp->handshake_complete)
+    /*
+     * Stream-specific frames. Before the handshake is complete these may only
+     * be sent as early data.
+     */
+    if (a.allow_stream_rel
+        && (txp->handshake_complete || enc_level == QUIC_ENC_LEVEL_0RTT))
         if (!txp_generate_stream_related(txp, pkt,
                                          &have_ack_eliciting,
                                          &pkt->stream_head))
@@ -2795,14 +3004,24 @@ static int txp_generate_for_el(OSSL_QUIC_TX_PACKETISER *txp,
 
     if (!have_ack_eliciting && txp_need_ping(txp, pn_space, &a)) {
         WPACKET *wpkt;
+        int ok;
 
         assert(h->reserve > 0);
         wpkt = tx_helper_begin(h);
         if (wpkt == NULL)
             goto fatal_err;
 
-        if (!ossl_quic_wire_encode_frame_ping(wpkt)
-            || !tx_helper_commit(h))
+        /*
+         * When probing in the Application PN space, ask a peer which supports
+         * the ACK frequency extension to respond without delay.
+         */
+        if (txp->ack_freq_enabled && a.require_ack_eliciting
+            && pn_space == QUIC_PN_SPACE_APP)
+            ok = ossl_quic_wire_encode_frame_immediate_ack(wpkt);
+        else
+            ok = ossl_quic_wire_encode_frame_ping(wpkt);
+
+        if (!ok || !tx_helper_commit(h))
             /*
              * We treat a request to be ACK-eliciting as a requirement, so this
              * is an error.
@@ -2830,6 +3049,7 @@ static int txp_generate_for_el(OSSL_QUIC_TX_PACKETISER *txp,
     tpkt->ackm_pkt.is_ack_eliciting = have_ack_eliciting;
     tpkt->ackm_pkt.is_pto_probe     = 0;
     tpkt->ackm_pkt.is_mtu_probe     = 0;
+    tpkt->ackm_pkt.ecn              = txp->ecn;
     tpkt->ackm_pkt.time             = txp->args.now(txp->args.now_arg);
     tpkt->pkt_type                  = pkt->phdr.type;
 
@@ -2911,6 +3131,7 @@ static int txp_pkt_commit(OSSL_QUIC_TX_PACKETISER *txp,
         ? NULL : &txp->args.peer;
     txpkt.pn        = txp->next_pn[pn_space];
     txpkt.flags     = OSSL_QTX_PKT_FLAG_COALESCE; /* always try to coalesce */
+    txpkt.ecn       = tpkt->ackm_pkt.ecn;
 
     /* Generate TXPIM chunks representing STOP_SENDING and RESET_STREAM frames. */
     for (stream = pkt->stream_head; stream != NULL; stream = stream->txp_next)
@@ -2946,6 +3167,9 @@ static int txp_pkt_commit(OSSL_QUIC_TX_PACKETISER *txp,
     ++txp->next_pn[pn_space];
     *txpim_pkt_reffed = 1;
 
+    if (tpkt->ackm_pkt.is_inflight)
+        ossl_quic_pacer_on_sent(&txp->pacer, tpkt->ackm_pkt.num_bytes);
+
     /* Send the packet. */
     if (!ossl_qtx_write_pkt(txp->args.qtx, &txpkt))
         return 0;
@@ -3004,6 +3228,11 @@ static int txp_pkt_commit(OSSL_QUIC_TX_PACKETISER *txp,
     if (tpkt->had_handshake_done_frame)
         txp->want_handshake_done = 0;
 
+    if (tpkt->had_ack_frequency_frame) {
+        txp->want_ack_frequency = 0;
+        ++txp->ack_freq_seq_num;
+    }
+
     if (tpkt->had_max_data_frame) {
         txp->want_max_data = 0;
         ossl_quic_rxfc_has_cwm_changed(txp->args.conn_rxfc, 1);
@@ -3128,9 +3357,16 @@ OSSL_TIME ossl_quic_tx_packetiser_get_deadline(OSSL_QUIC_TX_PACKETISER *txp)
      * turn relied on by the QUIC_CHANNEL code to determine the channel event
      * handling deadline.
      */
-    OSSL_TIME deadline = ossl_time_infinite();
+    OSSL_TIME deadline = ossl_time_infinite(), pacer_deadline;
     uint32_t enc_level, pn_space;
 
+    /*
+     * While limited by the anti-amplification limit we cannot send anything
+     * until we receive more from the peer, so there is no deadline.
+     */
+    if (!txp_amp_can_send(txp))
+        return deadline;
+
     /*
      * ACK generation is not CC-gated - packets containing only ACKs are allowed
      * to bypass CC. We want to generate ACK frames even if we are currently
@@ -3150,6 +3386,13 @@ OSSL_TIME ossl_quic_tx_packetiser_get_deadline(OSSL_QUIC_TX_PACKETISER *txp)
     if (txp->args.cc_method->get_tx_allowance(txp->args.cc_data) == 0)
         deadline = ossl_time_min(deadline,
                                  txp->args.cc_method->get_wakeup_deadline(txp->args.cc_data));
+    else if (!ossl_time_is_zero(pacer_deadline
+                                = ossl_quic_pacer_get_deadline(&txp->pacer)))
+        /*
+         * When will the pacer let us send more? If the pacer would let us send
+         * now, there is no pacing-related event to wait for.
+         */
+        deadline = ossl_time_min(deadline, pacer_deadline);
 
     return deadline;
 }
@@ -24,9 +24,27 @@ typedef struct quic_txpim_pkt_ex_list {
     QUIC_TXPIM_PKT_EX          *head, *tail;
 } QUIC_TXPIM_PKT_EX_LIST;
 
+/*
+ * Packet entries are allocated in arenas which are only freed with the TXPIM,
+ * so that the entries for a train of packets sent together are usually
+ * adjacent in memory. Each new arena is as large as all existing arenas
+ * combined, within the bounds below.
+ */
+typedef struct quic_txpim_arena_st QUIC_TXPIM_ARENA;
+
+struct quic_txpim_arena_st {
+    QUIC_TXPIM_ARENA           *next;
+    size_t                      num_pkt;
+    QUIC_TXPIM_PKT_EX           pkt[1]; /* num_pkt entries */
+};
+
+#define ARENA_MIN_PKTS  8
+#define ARENA_MAX_PKTS  64
+
 struct quic_txpim_st {
     QUIC_TXPIM_PKT_EX_LIST  free_list;
-    size_t                  in_use;
+    QUIC_TXPIM_ARENA       *arenas;
+    size_t                  in_use, num_pkt;
 };
 
 #define MAX_ALLOC_CHUNKS 512
@@ -41,18 +59,19 @@ QUIC_TXPIM *ossl_quic_txpim_new(void)
     return txpim;
 }
 
-static void free_list(QUIC_TXPIM_PKT_EX_LIST *l)
+static void free_arenas(QUIC_TXPIM_ARENA *a)
 {
-    QUIC_TXPIM_PKT_EX *n, *nnext;
+    QUIC_TXPIM_ARENA *anext;
+    size_t i;
 
-    for (n = l->head; n != NULL; n = nnext) {
-        nnext = n->next;
+    for (; a != NULL; a = anext) {
+        anext = a->next;
 
-        OPENSSL_free(n->chunks);
-        OPENSSL_free(n);
-    }
+        for (i = 0; i < a->num_pkt; ++i)
+            OPENSSL_free(a->pkt[i].chunks);
 
-    l->head = l->tail = NULL;
+        OPENSSL_free(a);
+    }
 }
 
 void ossl_quic_txpim_free(QUIC_TXPIM *txpim)
@@ -61,7 +80,7 @@ void ossl_quic_txpim_free(QUIC_TXPIM *txpim)
         return;
 
     assert(txpim->in_use == 0);
-    free_list(&txpim->free_list);
+    free_arenas(txpim->arenas);
     OPENSSL_free(txpim);
 }
 
@@ -78,30 +97,46 @@ static void list_remove(QUIC_TXPIM_PKT_EX_LIST *l, QUIC_TXPIM_PKT_EX *n)
     n->prev = n->next = NULL;
 }
 
-static void list_insert_tail(QUIC_TXPIM_PKT_EX_LIST *l, QUIC_TXPIM_PKT_EX *n)
+static void list_insert_head(QUIC_TXPIM_PKT_EX_LIST *l, QUIC_TXPIM_PKT_EX *n)
 {
-    n->prev = l->tail;
-    n->next = NULL;
-    l->tail = n;
-    if (n->prev != NULL)
-        n->prev->next = n;
-    if (l->head == NULL)
-        l->head = n;
+    n->prev = NULL;
+    n->next = l->head;
+    l->head = n;
+    if (n->next != NULL)
+        n->next->prev = n;
+    if (l->tail == NULL)
+        l->tail = n;
 }
 
 static QUIC_TXPIM_PKT_EX *txpim_get_free(QUIC_TXPIM *txpim)
 {
     QUIC_TXPIM_PKT_EX *ex = txpim->free_list.head;
+    QUIC_TXPIM_ARENA *a;
+    size_t i, num_pkt;
 
     if (ex != NULL)
         return ex;
 
-    ex = OPENSSL_zalloc(sizeof(*ex));
-    if (ex == NULL)
+    num_pkt = txpim->num_pkt;
+    if (num_pkt < ARENA_MIN_PKTS)
+        num_pkt = ARENA_MIN_PKTS;
+    else if (num_pkt > ARENA_MAX_PKTS)
+        num_pkt = ARENA_MAX_PKTS;
+
+    a = OPENSSL_zalloc(sizeof(*a) + (num_pkt - 1) * sizeof(a->pkt[0]));
+    if (a == NULL)
         return NULL;
 
-    list_insert_tail(&txpim->free_list, ex);
-    return ex;
+    a->num_pkt      = num_pkt;
+    a->next         = txpim->arenas;
+    txpim->arenas   = a;
+    txpim->num_pkt  += num_pkt;
+
+    /* Insert in reverse so that the entries are used in address order. */
+    for (i = num_pkt; i > 0; --i)
+        list_insert_head(&txpim->free_list, &a->pkt[i - 1]);
+
+    return txpim->free_list.head;
 }
 
 static void txpim_clear(QUIC_TXPIM_PKT_EX *ex)
@@ -116,6 +151,7 @@ static void txpim_clear(QUIC_TXPIM_PKT_EX *ex)
     ex->public.had_max_streams_uni_frame   = 0;
     ex->public.had_ack_frame               = 0;
     ex->public.had_conn_close              = 0;
+    ex->public.had_ack_frequency_frame     = 0;
 }
 
 QUIC_TXPIM_PKT *ossl_quic_txpim_pkt_alloc(QUIC_TXPIM *txpim)
@@ -137,7 +173,9 @@ void ossl_quic_txpim_pkt_release(QUIC_TXPIM *txpim, QUIC_TXPIM_PKT *fpkt)
 
     assert(txpim->in_use > 0);
     --txpim->in_use;
-    list_insert_tail(&txpim->free_list, ex);
+
+    /* LIFO, so that recently used and probably cached entries are reused first. */
+    list_insert_head(&txpim->free_list, ex);
 }
 
 void ossl_quic_txpim_pkt_add_cfq_item(QUIC_TXPIM_PKT *fpkt,
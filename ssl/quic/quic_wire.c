@@ -392,6 +392,24 @@ int ossl_quic_wire_encode_frame_handshake_done(WPACKET *pkt)
     return encode_frame_hdr(pkt, OSSL_QUIC_FRAME_TYPE_HANDSHAKE_DONE);
 }
 
+int ossl_quic_wire_encode_frame_ack_frequency(WPACKET *pkt,
+                                              const OSSL_QUIC_FRAME_ACK_FREQUENCY *f)
+{
+    if (!encode_frame_hdr(pkt, OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY)
+            || !WPACKET_quic_write_vlint(pkt, f->seq_num)
+            || !WPACKET_quic_write_vlint(pkt, f->ack_eliciting_threshold)
+            || !WPACKET_quic_write_vlint(pkt, f->max_ack_delay_us)
+            || !WPACKET_quic_write_vlint(pkt, f->reordering_threshold))
+        return 0;
+
+    return 1;
+}
+
+int ossl_quic_wire_encode_frame_immediate_ack(WPACKET *pkt)
+{
+    return encode_frame_hdr(pkt, OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK);
+}
+
 unsigned char *ossl_quic_wire_encode_transport_param_bytes(WPACKET *pkt,
                                                            uint64_t id,
                                                            const unsigned char *value,
@@ -909,6 +927,24 @@ int ossl_quic_wire_decode_frame_handshake_done(PACKET *pkt)
     return expect_frame_header(pkt, OSSL_QUIC_FRAME_TYPE_HANDSHAKE_DONE);
 }
 
+int ossl_quic_wire_decode_frame_ack_frequency(PACKET *pkt,
+                                              OSSL_QUIC_FRAME_ACK_FREQUENCY *f)
+{
+    if (!expect_frame_header(pkt, OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY)
+            || !PACKET_get_quic_vlint(pkt, &f->seq_num)
+            || !PACKET_get_quic_vlint(pkt, &f->ack_eliciting_threshold)
+            || !PACKET_get_quic_vlint(pkt, &f->max_ack_delay_us)
+            || !PACKET_get_quic_vlint(pkt, &f->reordering_threshold))
+        return 0;
+
+    return 1;
+}
+
+int ossl_quic_wire_decode_frame_immediate_ack(PACKET *pkt)
+{
+    return expect_frame_header(pkt, OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK);
+}
+
 int ossl_quic_wire_peek_transport_param(PACKET *pkt, uint64_t *id)
 {
     return PACKET_peek_quic_vlint(pkt, id);
@@ -1036,6 +1072,8 @@ ossl_quic_frame_type_to_string(uint64_t frame_type)
     X(CONN_CLOSE_TRANSPORT)
     X(CONN_CLOSE_APP)
     X(HANDSHAKE_DONE)
+    X(IMMEDIATE_ACK)
+    X(ACK_FREQUENCY)
     X(STREAM)
     X(STREAM_FIN)
     X(STREAM_LEN)
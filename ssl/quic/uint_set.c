@@ -35,13 +35,16 @@
  * implemented as a doubly linked sorted list of range structures, which are
  * automatically split and merged as necessary.
  *
- * This data structure requires O(n) traversal of the list for insertion,
- * removal and query when we are not adding/removing ranges which are near the
- * beginning or end of the set of ranges. For the applications for which this
- * data structure is used (e.g. QUIC PN tracking for ACK generation), it is
- * expected that the number of integer ranges needed at any given time will
- * generally be small and that most operations will be close to the beginning or
- * end of the range.
+ * The ranges are also indexed by their start in a balanced search tree
+ * (UINT_TREE), so that the range containing or preceding any integer is found
+ * in O(log n) time. Under heavy packet loss or reordering a set may hold
+ * thousands of ranges, and operations in the middle of the set would otherwise
+ * require a walk of the list. Once the first affected range has been found,
+ * the list is used to visit its neighbours. Each range is merged away at most
+ * once, so the cost of insertion is amortised O(log n).
+ *
+ * Appending to or extending the last range, the most common operation when
+ * tracking PNs, does not touch the tree beyond a single insertion.
  *
  * Invariant: The data structure is always sorted in ascending order by value.
  *
@@ -57,199 +60,141 @@
  *            item inside the data structure can represent a span of zero
  *            integers.
  */
+#define ITEM_FROM_NODE(n) \
+    ((UINT_SET_ITEM *)((char *)(n) - offsetof(UINT_SET_ITEM, node)))
+
 void ossl_uint_set_init(UINT_SET *s)
 {
-    ossl_list_uint_set_init(s);
+    ossl_list_uint_set_init(&s->ranges);
+    ossl_uint_tree_init(&s->index);
 }
 
 void ossl_uint_set_destroy(UINT_SET *s)
 {
     UINT_SET_ITEM *x, *xnext;
 
-    for (x = ossl_list_uint_set_head(s); x != NULL; x = xnext) {
+    for (x = ossl_list_uint_set_head(&s->ranges); x != NULL; x = xnext) {
         xnext = ossl_list_uint_set_next(x);
         OPENSSL_free(x);
     }
+
+    ossl_uint_set_init(s);
 }
 
-/* Possible merge of x, prev(x) */
-static void uint_set_merge_adjacent(UINT_SET *s, UINT_SET_ITEM *x)
+static UINT_SET_ITEM *create_set_item(uint64_t start, uint64_t end)
 {
-    UINT_SET_ITEM *xprev = ossl_list_uint_set_prev(x);
-
-    if (xprev == NULL)
-        return;
+    UINT_SET_ITEM *x = OPENSSL_malloc(sizeof(UINT_SET_ITEM));
 
-    if (x->range.start - 1 != xprev->range.end)
-        return;
+    if (x == NULL)
+        return NULL;
 
-    x->range.start = xprev->range.start;
-    ossl_list_uint_set_remove(s, xprev);
-    OPENSSL_free(xprev);
+    ossl_list_uint_set_init_elem(x);
+    x->node.key    = start;
+    x->range.start = start;
+    x->range.end   = end;
+    return x;
 }
 
-static uint64_t u64_min(uint64_t x, uint64_t y)
+/* Adds a new item to the set after the item prev, or at the head if NULL. */
+static void add_item(UINT_SET *s, UINT_SET_ITEM *prev, UINT_SET_ITEM *x)
 {
-    return x < y ? x : y;
+    if (prev == NULL)
+        ossl_list_uint_set_insert_head(&s->ranges, x);
+    else
+        ossl_list_uint_set_insert_after(&s->ranges, prev, x);
+
+    ossl_uint_tree_insert(&s->index, &x->node);
 }
 
-static uint64_t u64_max(uint64_t x, uint64_t y)
+static void free_item(UINT_SET *s, UINT_SET_ITEM *x)
 {
-    return x > y ? x : y;
+    ossl_list_uint_set_remove(&s->ranges, x);
+    ossl_uint_tree_remove(&s->index, &x->node);
+    OPENSSL_free(x);
 }
 
 /*
- * Returns 1 if there exists an integer x which falls within both ranges a and
- * b.
+ * Changes the start of a range. This never changes the order of the ranges, so
+ * the key can be updated in place.
  */
-static int uint_range_overlaps(const UINT_RANGE *a,
-                               const UINT_RANGE *b)
+static void set_item_start(UINT_SET_ITEM *x, uint64_t start)
 {
-    return u64_min(a->end, b->end)
-        >= u64_max(a->start, b->start);
+    x->range.start = start;
+    x->node.key    = start;
 }
 
-static UINT_SET_ITEM *create_set_item(uint64_t start, uint64_t end)
+/* Returns the range with the greatest start <= v, or NULL. */
+static UINT_SET_ITEM *find_le(const UINT_SET *s, uint64_t v)
 {
-    UINT_SET_ITEM *x = OPENSSL_malloc(sizeof(UINT_SET_ITEM));
+    UINT_TREE_NODE *n = ossl_uint_tree_find_le(&s->index, v);
 
-    if (x == NULL)
-        return NULL;
+    return n != NULL ? ITEM_FROM_NODE(n) : NULL;
+}
 
-    ossl_list_uint_set_init_elem(x);
-    x->range.start = start;
-    x->range.end   = end;
-    return x;
+/*
+ * Returns 1 if the range x contains v or ends immediately before v, so that
+ * adding v to the set would extend x. Careful to avoid overflow.
+ */
+static int range_reaches(const UINT_SET_ITEM *x, uint64_t v)
+{
+    return x->range.end >= v || x->range.end + 1 == v;
 }
 
 int ossl_uint_set_insert(UINT_SET *s, const UINT_RANGE *range)
 {
-    UINT_SET_ITEM *x, *xnext, *z, *zprev, *f;
+    UINT_SET_ITEM *x, *z, *xnext;
     uint64_t start = range->start, end = range->end;
 
     if (!ossl_assert(start <= end))
         return 0;
 
-    if (ossl_list_uint_set_is_empty(s)) {
-        /* Nothing in the set yet, so just add this range. */
-        x = create_set_item(start, end);
-        if (x == NULL)
-            return 0;
-        ossl_list_uint_set_insert_head(s, x);
+    z = ossl_list_uint_set_tail(&s->ranges);
+    if (z != NULL && start > z->range.end && z->range.end + 1 == start) {
+        /* Extend the last range (fast path). */
+        z->range.end = end;
         return 1;
     }
 
-    z = ossl_list_uint_set_tail(s);
-    if (start > z->range.end) {
-        /*
-         * Range is after the latest range in the set, so append.
-         *
-         * Note: The case where the range is before the earliest range in the
-         * set is handled as a degenerate case of the final case below. See
-         * optimization note (*) below.
-         */
-        if (z->range.end + 1 == start) {
-            z->range.end = end;
-            return 1;
-        }
-
-        x = create_set_item(start, end);
-        if (x == NULL)
-            return 0;
-        ossl_list_uint_set_insert_tail(s, x);
-        return 1;
-    }
+    z = find_le(s, start);
+    if (z != NULL && range_reaches(z, start)) {
+        /* The new range overlaps or extends an existing range z. */
+        if (z->range.end >= end)
+            return 1; /* An existing range dwarfs our new range. */
 
-    f = ossl_list_uint_set_head(s);
-    if (start <= f->range.start && end >= z->range.end) {
+        x = z;
+        x->range.end = end;
+    } else {
         /*
-         * New range dwarfs all ranges in our set.
-         *
-         * Free everything except the first range in the set, which we scavenge
-         * and reuse.
+         * The first range starting after our new range, if any. If the new
+         * range overlaps or borders it, extend it backwards.
          */
-        x = ossl_list_uint_set_head(s);
-        x->range.start = start;
-        x->range.end = end;
-        for (x = ossl_list_uint_set_next(x); x != NULL; x = xnext) {
-            xnext = ossl_list_uint_set_next(x);
-            ossl_list_uint_set_remove(s, x);
-        }
-        return 1;
-    }
-
-    /*
-     * Walk backwards since we will most often be inserting at the end. As an
-     * optimization, test the head node first and skip iterating over the
-     * entire list if we are inserting at the start. The assumption is that
-     * insertion at the start and end of the space will be the most common
-     * operations. (*)
-     */
-    z = end < f->range.start ? f : z;
+        x = z != NULL ? ossl_list_uint_set_next(z)
+                      : ossl_list_uint_set_head(&s->ranges);
 
-    for (; z != NULL; z = zprev) {
-        zprev = ossl_list_uint_set_prev(z);
-
-        /* An existing range dwarfs our new range (optimisation). */
-        if (z->range.start <= start && z->range.end >= end)
-            return 1;
-
-        if (uint_range_overlaps(&z->range, range)) {
+        if (x != NULL && (x->range.start <= end || x->range.start - 1 == end)) {
+            set_item_start(x, start);
+            if (x->range.end < end)
+                x->range.end = end;
+        } else {
             /*
-             * Our new range overlaps an existing range, or possibly several
-             * existing ranges.
+             * The new range is between ranges without overlapping or touching
+             * them, so insert it between them, preserving sort.
              */
-            UINT_SET_ITEM *ovend = z;
+            if ((x = create_set_item(start, end)) == NULL)
+                return 0;
 
-            ovend->range.end = u64_max(end, z->range.end);
-
-            /* Get earliest overlapping range. */
-            while (zprev != NULL && uint_range_overlaps(&zprev->range, range)) {
-                z = zprev;
-                zprev = ossl_list_uint_set_prev(z);
-            }
+            add_item(s, z, x);
+            return 1;
+        }
+    }
 
-            ovend->range.start = u64_min(start, z->range.start);
+    /* Absorb any following ranges which x now overlaps or borders. */
+    while ((xnext = ossl_list_uint_set_next(x)) != NULL
+           && range_reaches(x, xnext->range.start)) {
+        if (xnext->range.end > x->range.end)
+            x->range.end = xnext->range.end;
 
-            /* Replace sequence of nodes z..ovend with updated ovend only. */
-            while (z != ovend) {
-                z = ossl_list_uint_set_next(x = z);
-                ossl_list_uint_set_remove(s, x);
-                OPENSSL_free(x);
-            }
-            break;
-        } else if (end < z->range.start
-                    && (zprev == NULL || start > zprev->range.end)) {
-            if (z->range.start == end + 1) {
-                /* We can extend the following range backwards. */
-                z->range.start = start;
-
-                /*
-                 * If this closes a gap we now need to merge
-                 * consecutive nodes.
-                 */
-                uint_set_merge_adjacent(s, z);
-            } else if (zprev != NULL && zprev->range.end + 1 == start) {
-                /* We can extend the preceding range forwards. */
-                zprev->range.end = end;
-
-                /*
-                 * If this closes a gap we now need to merge
-                 * consecutive nodes.
-                 */
-                uint_set_merge_adjacent(s, z);
-            } else {
-                /*
-                 * The new interval is between intervals without overlapping or
-                 * touching them, so insert between, preserving sort.
-                 */
-                x = create_set_item(start, end);
-                if (x == NULL)
-                    return 0;
-                ossl_list_uint_set_insert_before(s, z, x);
-            }
-            break;
-        }
+        free_item(s, xnext);
     }
 
     return 1;
@@ -257,58 +202,59 @@ int ossl_uint_set_insert(UINT_SET *s, const UINT_RANGE *range)
 
 int ossl_uint_set_remove(UINT_SET *s, const UINT_RANGE *range)
 {
-    UINT_SET_ITEM *z, *zprev, *y;
+    UINT_SET_ITEM *z, *znext, *y;
     uint64_t start = range->start, end = range->end;
 
     if (!ossl_assert(start <= end))
         return 0;
 
-    /* Walk backwards since we will most often be removing at the end. */
-    for (z = ossl_list_uint_set_tail(s); z != NULL; z = zprev) {
-        zprev = ossl_list_uint_set_prev(z);
+    /* Find the first range which could overlap the range being removed. */
+    z = find_le(s, start);
+    if (z == NULL)
+        z = ossl_list_uint_set_head(&s->ranges);
+    else if (z->range.end < start)
+        z = ossl_list_uint_set_next(z);
 
-        if (start > z->range.end)
-            /* No overlapping ranges can exist beyond this point, so stop. */
-            break;
+    for (; z != NULL && z->range.start <= end; z = znext) {
+        znext = ossl_list_uint_set_next(z);
 
         if (start <= z->range.start && end >= z->range.end) {
             /*
              * The range being removed dwarfs this range, so it should be
              * removed.
              */
-            ossl_list_uint_set_remove(s, z);
-            OPENSSL_free(z);
-        } else if (start <= z->range.start && end >= z->range.start) {
+            free_item(s, z);
+        } else if (start <= z->range.start) {
             /*
              * The range being removed includes start of this range, but does
              * not cover the entire range (as this would be caught by the case
-             * above). Shorten the range.
+             * above). Shorten the range. No later range can overlap.
              */
             assert(end < z->range.end);
-            z->range.start = end + 1;
+            set_item_start(z, end + 1);
+            break;
         } else if (end >= z->range.end) {
             /*
              * The range being removed includes the end of this range, but does
              * not cover the entire range (as this would be caught by the case
-             * above). Shorten the range. We can also stop iterating.
+             * above). Shorten the range.
              */
             assert(start > z->range.start);
-            assert(start > 0);
             z->range.end = start - 1;
-            break;
-        } else if (start > z->range.start && end < z->range.end) {
+        } else {
             /*
              * The range being removed falls entirely in this range, so cut it
              * into two. Cases where a zero-length range would be created are
-             * handled by the above cases.
+             * handled by the above cases. This can only be the first range
+             * visited, so the set is unchanged on failure.
              */
-            y = create_set_item(end + 1, z->range.end);
-            ossl_list_uint_set_insert_after(s, z, y);
+            assert(start > z->range.start && end < z->range.end);
+            if ((y = create_set_item(end + 1, z->range.end)) == NULL)
+                return 0;
+
+            add_item(s, z, y);
             z->range.end = start - 1;
             break;
-        } else {
-            /* Assert no partial overlap; all cases should be covered above. */
-            assert(!uint_range_overlaps(&z->range, range));
         }
     }
 
@@ -317,16 +263,7 @@ int ossl_uint_set_remove(UINT_SET *s, const UINT_RANGE *range)
 
 int ossl_uint_set_query(const UINT_SET *s, uint64_t v)
 {
-    UINT_SET_ITEM *x;
-
-    if (ossl_list_uint_set_is_empty(s))
-        return 0;
-
-    for (x = ossl_list_uint_set_tail(s); x != NULL; x = ossl_list_uint_set_prev(x))
-        if (x->range.start <= v && x->range.end >= v)
-            return 1;
-        else if (x->range.end < v)
-            return 0;
+    const UINT_SET_ITEM *x = find_le(s, v);
 
-    return 0;
+    return x != NULL && x->range.end >= v;
 }
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "internal/uint_tree.h"
+#include <stddef.h>
+
+/*
+ * uint64_t Keyed Search Trees
+ * ===========================
+ *
+ * This is a conventional AVL tree with parent pointers. Every node stores the
+ * height of the subtree rooted at it, and after each insertion or removal the
+ * path from the modified node to the root is walked, restoring the invariant
+ * that the heights of the two subtrees of any node differ by at most one.
+ *
+ * Since nodes are embedded in caller-owned structures, removal of a node with
+ * two children relinks its in-order successor into its place rather than
+ * copying keys between nodes.
+ */
+void ossl_uint_tree_init(UINT_TREE *t)
+{
+    t->root = NULL;
+}
+
+static int node_height(const UINT_TREE_NODE *n)
+{
+    return n != NULL ? n->height : 0;
+}
+
+static void node_update(UINT_TREE_NODE *n)
+{
+    int hl = node_height(n->left), hr = node_height(n->right);
+
+    n->height = (hl > hr ? hl : hr) + 1;
+}
+
+static void replace_child(UINT_TREE *t, UINT_TREE_NODE *parent,
+                          UINT_TREE_NODE *old_child, UINT_TREE_NODE *new_child)
+{
+    if (parent == NULL)
+        t->root = new_child;
+    else if (parent->left == old_child)
+        parent->left = new_child;
+    else
+        parent->right = new_child;
+}
+
+static UINT_TREE_NODE *rotate_left(UINT_TREE *t, UINT_TREE_NODE *x)
+{
+    UINT_TREE_NODE *y = x->right;
+
+    x->right = y->left;
+    if (y->left != NULL)
+        y->left->parent = x;
+
+    y->parent = x->parent;
+    replace_child(t, x->parent, x, y);
+
+    y->left   = x;
+    x->parent = y;
+
+    node_update(x);
+    node_update(y);
+    return y;
+}
+
+static UINT_TREE_NODE *rotate_right(UINT_TREE *t, UINT_TREE_NODE *x)
+{
+    UINT_TREE_NODE *y = x->left;
+
+    x->left = y->right;
+    if (y->right != NULL)
+        y->right->parent = x;
+
+    y->parent = x->parent;
+    replace_child(t, x->parent, x, y);
+
+    y->right  = x;
+    x->parent = y;
+
+    node_update(x);
+    node_update(y);
+    return y;
+}
+
+/* Restores the AVL invariant on the path from n to the root. */
+static void rebalance(UINT_TREE *t, UINT_TREE_NODE *n)
+{
+    int bal;
+
+    for (; n != NULL; n = n->parent) {
+        node_update(n);
+        bal = node_height(n->left) - node_height(n->right);
+
+        if (bal > 1) {
+            if (node_height(n->left->left) < node_height(n->left->right))
+                rotate_left(t, n->left);
+
+            n = rotate_right(t, n);
+        } else if (bal < -1) {
+            if (node_height(n->right->right) < node_height(n->right->left))
+                rotate_right(t, n->right);
+
+            n = rotate_left(t, n);
+        }
+    }
+}
+
+void ossl_uint_tree_insert(UINT_TREE *t, UINT_TREE_NODE *n)
+{
+    UINT_TREE_NODE *p = NULL, **link = &t->root;
+
+    while (*link != NULL) {
+        p    = *link;
+        link = n->key < p->key ? &p->left : &p->right;
+    }
+
+    n->parent = p;
+    n->left   = NULL;
+    n->right  = NULL;
+    n->height = 1;
+    *link     = n;
+
+    rebalance(t, p);
+}
+
+void ossl_uint_tree_remove(UINT_TREE *t, UINT_TREE_NODE *n)
+{
+    UINT_TREE_NODE *s, *child, *rebal_from;
+
+    if (n->left != NULL && n->right != NULL) {
+        /* Move the in-order successor of n into its place. */
+        for (s = n->right; s->left != NULL; s = s->left);
+
+        if (s->parent == n) {
+            rebal_from = s;
+        } else {
+            rebal_from = s->parent;
+
+            rebal_from->left = s->right;
+            if (s->right != NULL)
+                s->right->parent = rebal_from;
+
+            s->right         = n->right;
+            s->right->parent = s;
+        }
+
+        s->left         = n->left;
+        s->left->parent = s;
+        s->parent       = n->parent;
+        replace_child(t, n->parent, n, s);
+    } else {
+        child = n->left != NULL ? n->left : n->right;
+        if (child != NULL)
+            child->parent = n->parent;
+
+        replace_child(t, n->parent, n, child);
+        rebal_from = n->parent;
+    }
+
+    n->parent = n->left = n->right = NULL;
+    rebalance(t, rebal_from);
+}
+
+UINT_TREE_NODE *ossl_uint_tree_find_le(const UINT_TREE *t, uint64_t key)
+{
+    UINT_TREE_NODE *n = t->root, *best = NULL;
+
+    while (n != NULL)
+        if (n->key <= key) {
+            best = n;
+            n    = n->right;
+        } else {
+            n    = n->left;
+        }
+
+    return best;
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include "internal/common.h"
+#include "internal/sockets.h"
+#include "poll_builder.h"
+
+#if defined(OPENSSL_SYS_WINDOWS) || !defined(POLLIN)
+# define RIO_USE_SELECT
+#endif
+
+void ossl_rio_poll_builder_init(RIO_POLL_BUILDER *rpb)
+{
+    rpb->entries        = NULL;
+    rpb->num_entries    = 0;
+    rpb->cap_entries    = 0;
+    rpb->groups         = NULL;
+    rpb->num_groups     = 0;
+    rpb->os_state       = NULL;
+}
+
+void ossl_rio_poll_builder_cleanup(RIO_POLL_BUILDER *rpb)
+{
+    OPENSSL_free(rpb->entries);
+    OPENSSL_free(rpb->groups);
+    OPENSSL_free(rpb->os_state);
+    ossl_rio_poll_builder_init(rpb);
+}
+
+int ossl_rio_poll_builder_add(RIO_POLL_BUILDER *rpb, int fd,
+                              unsigned int roles, unsigned int events,
+                              size_t idx, OSSL_TIME deadline)
+{
+    RIO_POLL_ENTRY *e;
+    size_t new_cap;
+
+    if (rpb->num_entries == rpb->cap_entries) {
+        new_cap = rpb->cap_entries == 0 ? 16 : rpb->cap_entries * 2;
+        e = OPENSSL_realloc(rpb->entries, new_cap * sizeof(*e));
+        if (e == NULL)
+            return 0;
+
+        rpb->entries        = e;
+        rpb->cap_entries    = new_cap;
+    }
+
+    e = &rpb->entries[rpb->num_entries++];
+    e->fd       = fd;
+    e->roles    = roles;
+    e->events   = events & roles;
+    e->idx      = idx;
+    e->deadline = deadline;
+    return 1;
+}
+
+static int entry_cmp(const void *a_, const void *b_)
+{
+    const RIO_POLL_ENTRY *a = a_, *b = b_;
+
+    if (a->fd != b->fd)
+        return a->fd < b->fd ? -1 : 1;
+
+    /* Keep the item order stable within a group. */
+    return a->idx < b->idx ? -1 : a->idx > b->idx ? 1 : 0;
+}
+
+void ossl_rio_poll_builder_update_group(RIO_POLL_BUILDER *rpb,
+                                        RIO_POLL_GROUP *g)
+{
+    size_t i;
+    const RIO_POLL_ENTRY *e;
+
+    g->events   = 0;
+    g->deadline = ossl_time_infinite();
+
+    for (i = 0; i < g->num; ++i) {
+        e = &rpb->entries[g->first + i];
+        g->events   |= e->events;
+        g->deadline = ossl_time_min(g->deadline, e->deadline);
+    }
+}
+
+int ossl_rio_poll_builder_finish(RIO_POLL_BUILDER *rpb)
+{
+    size_t i, n = 0;
+    RIO_POLL_GROUP *g = NULL;
+
+    if (rpb->num_entries == 0)
+        return 1;
+
+    /*
+     * Sorting rather than searching for an existing group on each registration
+     * keeps this O(n log n) in the number of items.
+     */
+    qsort(rpb->entries, rpb->num_entries, sizeof(RIO_POLL_ENTRY), entry_cmp);
+
+    rpb->groups = OPENSSL_malloc(rpb->num_entries * sizeof(RIO_POLL_GROUP));
+    if (rpb->groups == NULL)
+        return 0;
+
+    for (i = 0; i < rpb->num_entries; ++i) {
+        if (g == NULL || g->fd != rpb->entries[i].fd) {
+            g = &rpb->groups[n++];
+            g->fd       = rpb->entries[i].fd;
+            g->revents  = 0;
+            g->first    = i;
+            g->num      = 0;
+        }
+
+        ++g->num;
+    }
+
+    rpb->num_groups = n;
+    for (i = 0; i < n; ++i)
+        ossl_rio_poll_builder_update_group(rpb, &rpb->groups[i]);
+
+#ifndef RIO_USE_SELECT
+    rpb->os_state = OPENSSL_malloc(n * sizeof(struct pollfd));
+    if (rpb->os_state == NULL)
+        return 0;
+#endif
+
+    return 1;
+}
+
+OSSL_TIME ossl_rio_poll_builder_get_deadline(const RIO_POLL_BUILDER *rpb)
+{
+    size_t i;
+    OSSL_TIME deadline = ossl_time_infinite();
+
+    for (i = 0; i < rpb->num_groups; ++i)
+        deadline = ossl_time_min(deadline, rpb->groups[i].deadline);
+
+    return deadline;
+}
+
+int ossl_rio_poll_builder_have_fds(const RIO_POLL_BUILDER *rpb)
+{
+    /* Groups are sorted by FD, so -1 can only be the first group. */
+    return rpb->num_groups > 1
+        || (rpb->num_groups == 1 && rpb->groups[0].fd >= 0);
+}
+
+#ifdef RIO_USE_SELECT
+
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline)
+{
+    fd_set rfd_set, wfd_set, efd_set;
+    struct timeval tv, *ptv;
+    RIO_POLL_GROUP *g;
+    int maxfd = -1, pres;
+    size_t i;
+
+    FD_ZERO(&rfd_set);
+    FD_ZERO(&wfd_set);
+    FD_ZERO(&efd_set);
+
+    for (i = 0; i < rpb->num_groups; ++i) {
+        g = &rpb->groups[i];
+        g->revents = 0;
+        if (g->fd < 0)
+            continue;
+
+# ifndef OPENSSL_SYS_WINDOWS
+        /* On *NIX the fd_set is a bitmap and we must check the limit. */
+        if (g->fd >= FD_SETSIZE) {
+            ERR_raise_data(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT,
+                           "FD %d exceeds FD_SETSIZE", g->fd);
+            return 0;
+        }
+# endif
+
+        if ((g->events & RIO_POLL_R) != 0)
+            openssl_fdset(g->fd, &rfd_set);
+        if ((g->events & RIO_POLL_W) != 0)
+            openssl_fdset(g->fd, &wfd_set);
+
+        /* Always check for error conditions. */
+        openssl_fdset(g->fd, &efd_set);
+
+        if (g->fd > maxfd)
+            maxfd = g->fd;
+    }
+
+    do {
+        /*
+         * select expects a timeout, not a deadline, so do the conversion.
+         * Update for each call to ensure the correct value is used if we repeat
+         * due to EINTR.
+         */
+        if (ossl_time_is_infinite(deadline)) {
+            ptv = NULL;
+        } else {
+            tv  = ossl_time_to_timeval(ossl_time_subtract(deadline,
+                                                          ossl_time_now()));
+            ptv = &tv;
+        }
+
+        pres = select(maxfd + 1, &rfd_set, &wfd_set, &efd_set, ptv);
+    } while (pres == -1 && get_last_socket_error_is_eintr());
+
+    if (pres < 0) {
+        ERR_raise_data(ERR_LIB_SYS, get_last_socket_error(),
+                       "calling select()");
+        return 0;
+    }
+
+    for (i = 0; pres > 0 && i < rpb->num_groups; ++i) {
+        g = &rpb->groups[i];
+        if (g->fd < 0)
+            continue;
+
+        if (FD_ISSET(g->fd, &rfd_set))
+            g->revents |= RIO_POLL_R;
+        if (FD_ISSET(g->fd, &wfd_set))
+            g->revents |= RIO_POLL_W;
+        if (FD_ISSET(g->fd, &efd_set))
+            g->revents |= RIO_POLL_E;
+    }
+
+    return 1;
+}
+
+#else
+
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline)
+{
+    struct pollfd *pfds = rpb->os_state;
+    RIO_POLL_GROUP *g;
+    size_t i, npfd = 0;
+    int pres, timeout_ms;
+    uint64_t ms;
+
+    for (i = 0; i < rpb->num_groups; ++i) {
+        g = &rpb->groups[i];
+        g->revents = 0;
+        if (g->fd < 0)
+            continue;
+
+        /*
+         * Error and hangup conditions are reported even if no events are
+         * requested.
+         */
+        pfds[npfd].fd       = g->fd;
+        pfds[npfd].events   = ((g->events & RIO_POLL_R) != 0 ? POLLIN : 0)
+                            | ((g->events & RIO_POLL_W) != 0 ? POLLOUT : 0);
+        pfds[npfd].revents  = 0;
+        ++npfd;
+    }
+
+    do {
+        if (ossl_time_is_infinite(deadline)) {
+            timeout_ms = -1;
+        } else {
+            /* Round up so that we do not wake before the deadline. */
+            ms = ossl_time2ms(ossl_time_add(ossl_time_subtract(deadline,
+                                                               ossl_time_now()),
+                                            ossl_ticks2time(OSSL_TIME_MS - 1)));
+            timeout_ms = ms > INT_MAX ? INT_MAX : (int)ms;
+        }
+
+        pres = poll(pfds, npfd, timeout_ms);
+    } while (pres == -1 && get_last_socket_error_is_eintr());
+
+    if (pres < 0) {
+        ERR_raise_data(ERR_LIB_SYS, get_last_socket_error(),
+                       "calling poll()");
+        return 0;
+    }
+
+    for (i = 0, npfd = 0; pres > 0 && i < rpb->num_groups; ++i) {
+        g = &rpb->groups[i];
+        if (g->fd < 0)
+            continue;
+
+        if ((pfds[npfd].revents & (POLLIN | POLLHUP)) != 0)
+            g->revents |= RIO_POLL_R;
+        if ((pfds[npfd].revents & POLLOUT) != 0)
+            g->revents |= RIO_POLL_W;
+        if ((pfds[npfd].revents & (POLLERR | POLLNVAL)) != 0)
+            g->revents |= RIO_POLL_E;
+
+        ++npfd;
+    }
+
+    return 1;
+}
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_RIO_POLL_BUILDER_H
+# define OSSL_RIO_POLL_BUILDER_H
+
+# include "internal/time.h"
+
+/*
+ * RIO_POLL_BUILDER
+ * ================
+ *
+ * Collects the OS-level FDs which an SSL_poll() call needs to wait on and
+ * waits on them. Many SSL_poll() items commonly share a single FD (for example,
+ * all streams of a QUIC connection, or all connections served by a QUIC
+ * listener), so registrations are grouped by FD and each FD is passed to the OS
+ * only once. Each group remembers which registrations it covers, allowing the
+ * caller to revisit only the items whose FDs became ready or whose deadlines
+ * expired after a wait.
+ *
+ * A registration may use an FD of -1 if it only contributes a deadline.
+ */
+# define RIO_POLL_R     (1U << 0)   /* FD readable (or hung up) */
+# define RIO_POLL_W     (1U << 1)   /* FD writable */
+# define RIO_POLL_E     (1U << 2)   /* Error condition on FD (output only) */
+
+typedef struct rio_poll_entry_st {
+    int         fd;
+    unsigned int roles;     /* Which of RIO_POLL_R/W this FD serves */
+    unsigned int events;    /* Subset of roles currently wanted */
+    size_t      idx;        /* Index of the SSL_poll() item */
+    OSSL_TIME   deadline;
+} RIO_POLL_ENTRY;
+
+typedef struct rio_poll_group_st {
+    int         fd;
+    unsigned int events;    /* Union of the events of all entries */
+    unsigned int revents;   /* Set by ossl_rio_poll_builder_poll() */
+    size_t      first, num; /* Range of entries in this group */
+    OSSL_TIME   deadline;   /* Earliest deadline of all entries */
+} RIO_POLL_GROUP;
+
+typedef struct rio_poll_builder_st {
+    RIO_POLL_ENTRY  *entries;
+    size_t          num_entries, cap_entries;
+    RIO_POLL_GROUP  *groups;
+    size_t          num_groups;
+    void            *os_state;
+} RIO_POLL_BUILDER;
+
+void ossl_rio_poll_builder_init(RIO_POLL_BUILDER *rpb);
+void ossl_rio_poll_builder_cleanup(RIO_POLL_BUILDER *rpb);
+
+/* Registers an FD (or -1) for the SSL_poll() item with index idx. */
+int ossl_rio_poll_builder_add(RIO_POLL_BUILDER *rpb, int fd,
+                              unsigned int roles, unsigned int events,
+                              size_t idx, OSSL_TIME deadline);
+
+/*
+ * Groups all registrations by FD. Must be called once after all registrations
+ * have been made and before ossl_rio_poll_builder_poll() is called.
+ */
+int ossl_rio_poll_builder_finish(RIO_POLL_BUILDER *rpb);
+
+/*
+ * Recomputes the events and deadline of a group after the caller has changed
+ * the events or deadlines of its entries.
+ */
+void ossl_rio_poll_builder_update_group(RIO_POLL_BUILDER *rpb,
+                                        RIO_POLL_GROUP *g);
+
+/* Returns the earliest deadline of all groups. */
+OSSL_TIME ossl_rio_poll_builder_get_deadline(const RIO_POLL_BUILDER *rpb);
+
+/* Returns 1 if at least one registered FD is not -1. */
+int ossl_rio_poll_builder_have_fds(const RIO_POLL_BUILDER *rpb);
+
+/*
+ * Waits until at least one FD is ready or the deadline is reached, then sets
+ * the revents field of every group. A deadline of ossl_time_zero() polls
+ * without waiting. Returns 0 on failure.
+ */
+int ossl_rio_poll_builder_poll(RIO_POLL_BUILDER *rpb, OSSL_TIME deadline);
+
+#endif
@@ -11,6 +11,8 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include "../ssl_local.h"
+#include "internal/quic_ssl.h"
+#include "poll_builder.h"
 
 #define ITEM_N(items, stride, n) \
     (*(SSL_POLL_ITEM *)((char *)(items) + (n)*(stride)))
@@ -33,6 +35,196 @@
         FAIL_FROM(i + 1);                                                   \
     } while (0)
 
+/*
+ * Determines the current readiness of an item. os_ready is the OS-level
+ * readiness (RIO_POLL_*) of an FD the item is registered on, or 0 if the FD has
+ * not been polled. For items whose readiness is derived from their FDs, events
+ * already reported in the item during this call are retained, as an item may be
+ * registered on more than one FD.
+ */
+static int poll_readout(SSL_POLL_ITEM *item, int do_tick, unsigned int os_ready,
+                        uint64_t *p_revents)
+{
+    uint64_t events = item->events, revents = 0;
+    SSL *ssl;
+
+    switch (item->desc.type) {
+    case BIO_POLL_DESCRIPTOR_TYPE_SSL:
+        ssl = item->desc.value.ssl;
+        if (ssl == NULL)
+            /* NULL items are no-ops and have revents reported as 0 */
+            break;
+
+        switch (ssl->type) {
+#ifndef OPENSSL_NO_QUIC
+        case SSL_TYPE_QUIC_CONNECTION:
+        case SSL_TYPE_QUIC_XSO:
+            /* Raises ERR on failure. */
+            return ossl_quic_conn_poll_events(ssl, events, do_tick, p_revents);
+#endif
+
+        case SSL_TYPE_SSL_CONNECTION:
+            revents = item->revents;
+
+            /* Buffered records can be read without touching the socket. */
+            if ((events & SSL_POLL_EVENT_R) != 0 && SSL_has_pending(ssl))
+                revents |= SSL_POLL_EVENT_R;
+
+            if ((os_ready & (RIO_POLL_R | RIO_POLL_E)) != 0)
+                revents |= events & SSL_POLL_EVENT_R;
+            if ((os_ready & (RIO_POLL_W | RIO_POLL_E)) != 0)
+                revents |= events & SSL_POLL_EVENT_W;
+            if ((os_ready & RIO_POLL_E) != 0)
+                revents |= events & SSL_POLL_EVENT_EC;
+            break;
+
+        default:
+            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                           "SSL_poll does not support this kind of SSL "
+                           "object");
+            return 0;
+        }
+        break;
+
+    case BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD:
+        revents = item->revents;
+
+        if ((os_ready & (RIO_POLL_R | RIO_POLL_E)) != 0)
+            revents |= events & SSL_POLL_EVENT_R;
+        if ((os_ready & (RIO_POLL_W | RIO_POLL_E)) != 0)
+            revents |= events & SSL_POLL_EVENT_W;
+        if ((os_ready & RIO_POLL_E) != 0)
+            revents |= events & (SSL_POLL_EVENT_ER | SSL_POLL_EVENT_EW);
+        break;
+
+    default:
+        ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                       "SSL_poll does not support unknown poll descriptor "
+                       "type %d", item->desc.type);
+        return 0;
+    }
+
+    *p_revents = revents;
+    return 1;
+}
+
+static int is_quic_item(const SSL_POLL_ITEM *item)
+{
+#ifndef OPENSSL_NO_QUIC
+    const SSL *ssl;
+
+    if (item->desc.type != BIO_POLL_DESCRIPTOR_TYPE_SSL
+        || (ssl = item->desc.value.ssl) == NULL)
+        return 0;
+
+    return ssl->type == SSL_TYPE_QUIC_CONNECTION
+        || ssl->type == SSL_TYPE_QUIC_XSO;
+#else
+    return 0;
+#endif
+}
+
+/* Registers the read FD and (if different) the write FD of an item. */
+static int poll_register_fds(RIO_POLL_BUILDER *rpb, size_t idx,
+                             int rfd, unsigned int want_r,
+                             int wfd, unsigned int want_w,
+                             OSSL_TIME deadline)
+{
+    unsigned int events = (want_r ? RIO_POLL_R : 0) | (want_w ? RIO_POLL_W : 0);
+
+    if (rfd == wfd)
+        return ossl_rio_poll_builder_add(rpb, rfd, RIO_POLL_R | RIO_POLL_W,
+                                         events, idx, deadline);
+
+    if (rfd < 0 && wfd < 0)
+        return ossl_rio_poll_builder_add(rpb, -1, 0, 0, idx, deadline);
+
+    return (rfd < 0
+            || ossl_rio_poll_builder_add(rpb, rfd, RIO_POLL_R, events,
+                                         idx, deadline))
+        && (wfd < 0
+            || ossl_rio_poll_builder_add(rpb, wfd, RIO_POLL_W, events,
+                                         idx, deadline));
+}
+
+/*
+ * Registers the FDs an item needs to wait on. QUIC objects are registered on
+ * the FDs of the reactor serving them, with the reactor's tick deadline.
+ */
+static int poll_register(RIO_POLL_BUILDER *rpb, SSL_POLL_ITEM *item, size_t idx,
+                         int *unpollable)
+{
+    SSL *ssl;
+    int rfd, wfd;
+#ifndef OPENSSL_NO_QUIC
+    int want_r, want_w, can_poll;
+    OSSL_TIME deadline;
+#endif
+
+    switch (item->desc.type) {
+    case BIO_POLL_DESCRIPTOR_TYPE_SSL:
+        ssl = item->desc.value.ssl;
+        if (ssl == NULL)
+            return 1;
+
+#ifndef OPENSSL_NO_QUIC
+        if (is_quic_item(item)) {
+            if (!ossl_quic_conn_poll_wait_info(ssl, &rfd, &want_r,
+                                               &wfd, &want_w,
+                                               &deadline, &can_poll))
+                return 0;
+
+            if (!can_poll)
+                *unpollable = 1;
+
+            return poll_register_fds(rpb, idx, rfd, want_r, wfd, want_w,
+                                     deadline);
+        }
+#endif
+
+        rfd = SSL_get_rfd(ssl);
+        wfd = SSL_get_wfd(ssl);
+        if (rfd < 0 || wfd < 0) {
+            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                           "SSL_poll requires TLS SSL objects to use socket "
+                           "BIOs");
+            return 0;
+        }
+
+        return poll_register_fds(rpb, idx,
+                                 rfd, (item->events & SSL_POLL_EVENT_R) != 0,
+                                 wfd, (item->events & SSL_POLL_EVENT_W) != 0,
+                                 ossl_time_infinite());
+
+    case BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD:
+        rfd = item->desc.value.fd;
+        return poll_register_fds(rpb, idx,
+                                 rfd, (item->events & SSL_POLL_EVENT_R) != 0,
+                                 rfd, (item->events & SSL_POLL_EVENT_W) != 0,
+                                 ossl_time_infinite());
+
+    default:
+        return 1;
+    }
+}
+
+#ifndef OPENSSL_NO_QUIC
+/* Refreshes what a QUIC entry waits on after its reactor has been ticked. */
+static void poll_refresh_quic(RIO_POLL_ENTRY *e, SSL_POLL_ITEM *item)
+{
+    int rfd, wfd, want_r, want_w, can_poll;
+    OSSL_TIME deadline;
+
+    if (!ossl_quic_conn_poll_wait_info(item->desc.value.ssl, &rfd, &want_r,
+                                       &wfd, &want_w, &deadline, &can_poll))
+        return;
+
+    e->events   = e->roles & ((want_r ? RIO_POLL_R : 0)
+                              | (want_w ? RIO_POLL_W : 0));
+    e->deadline = deadline;
+}
+#endif
+
 int SSL_poll(SSL_POLL_ITEM *items,
              size_t num_items,
              size_t stride,
@@ -40,85 +232,141 @@ int SSL_poll(SSL_POLL_ITEM *items,
              uint64_t flags,
              size_t *p_result_count)
 {
-    int ok = 1;
-    size_t i, result_count = 0;
+    int ok = 1, unpollable = 0, have_quic = 0, ticked, is_quic;
+    size_t i, k, result_count = 0;
     SSL_POLL_ITEM *item;
-    SSL *ssl;
     uint64_t revents;
-    ossl_unused uint64_t events;
-    ossl_unused int do_tick = ((flags & SSL_POLL_FLAG_NO_HANDLE_EVENTS) == 0);
+    int do_tick = ((flags & SSL_POLL_FLAG_NO_HANDLE_EVENTS) == 0);
     int is_immediate
         = (timeout != NULL
            && timeout->tv_sec == 0 && timeout->tv_usec == 0);
+    OSSL_TIME deadline, wait_deadline, now;
+    RIO_POLL_BUILDER rpb;
+    RIO_POLL_GROUP *g;
+    RIO_POLL_ENTRY *e;
 
-    /*
-     * Prevent calls which use SSL_poll functionality which is not currently
-     * supported.
-     */
-    if (!is_immediate) {
-        ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                       "SSL_poll does not currently support blocking "
-                       "operation");
-        FAIL_FROM(0);
-    }
+    ossl_rio_poll_builder_init(&rpb);
 
     /* Trivial case. */
     if (num_items == 0)
         goto out;
 
-    /* Poll current state of each item. */
+    if (timeout == NULL)
+        deadline = ossl_time_infinite();
+    else
+        deadline = ossl_time_add(ossl_time_now(),
+                                 ossl_time_from_timeval(*timeout));
+
+    /*
+     * Poll current state of each item. Items whose readiness depends on the OS
+     * are registered for an OS-level poll; QUIC items only need to be
+     * registered if we may have to block.
+     */
     for (i = 0; i < num_items; ++i) {
-        item    = &ITEM_N(items, stride, i);
-        events  = item->events;
-        revents = 0;
-
-        switch (item->desc.type) {
-        case BIO_POLL_DESCRIPTOR_TYPE_SSL:
-            ssl = item->desc.value.ssl;
-            if (ssl == NULL)
-                /* NULL items are no-ops and have revents reported as 0 */
-                break;
-
-            switch (ssl->type) {
-#ifndef OPENSSL_NO_QUIC
-            case SSL_TYPE_QUIC_CONNECTION:
-            case SSL_TYPE_QUIC_XSO:
-                if (!ossl_quic_conn_poll_events(ssl, events, do_tick, &revents))
-                    /* above call raises ERR */
-                    FAIL_ITEM(i);
+        item            = &ITEM_N(items, stride, i);
+        item->revents   = 0;
 
-                if (revents != 0)
-                    ++result_count;
+        if (!poll_readout(item, do_tick, 0, &revents))
+            FAIL_ITEM(i);
 
-                break;
-#endif
+        is_quic = is_quic_item(item);
+        have_quic |= is_quic;
+        if ((!is_immediate || !is_quic)
+            && !poll_register(&rpb, item, i, &unpollable))
+            FAIL_ITEM(i);
 
-            default:
+        item->revents = revents;
+        if (revents != 0)
+            ++result_count;
+    }
+
+    if (!ossl_rio_poll_builder_finish(&rpb))
+        FAIL_FROM(num_items);
+
+    while (rpb.num_groups > 0) {
+        if (result_count > 0 || is_immediate) {
+            /* Only pick up OS-level readiness of non-QUIC items. */
+            wait_deadline = ossl_time_zero();
+        } else {
+            if (have_quic && !do_tick) {
                 ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                               "SSL_poll currently only supports QUIC SSL "
-                               "objects");
-                FAIL_ITEM(i);
+                               "SSL_POLL_FLAG_NO_HANDLE_EVENTS cannot be used "
+                               "with a blocking SSL_poll on QUIC SSL objects");
+                FAIL_FROM(num_items);
+            }
+
+            if (unpollable) {
+                ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                               "SSL_poll cannot block on a QUIC SSL object "
+                               "whose network BIOs do not support polling");
+                FAIL_FROM(num_items);
+            }
+
+            wait_deadline = ossl_time_min(deadline,
+                                          ossl_rio_poll_builder_get_deadline(&rpb));
+
+            if (ossl_time_is_infinite(wait_deadline)
+                && !ossl_rio_poll_builder_have_fds(&rpb)) {
+                ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
+                               "SSL_poll has nothing to wait on and would "
+                               "block forever");
+                FAIL_FROM(num_items);
             }
-            break;
-        case BIO_POLL_DESCRIPTOR_TYPE_SOCK_FD:
-            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                           "SSL_poll currently does not support polling "
-                           "sockets");
-            FAIL_ITEM(i);
-        default:
-            ERR_raise_data(ERR_LIB_SSL, SSL_R_POLL_REQUEST_NOT_SUPPORTED,
-                           "SSL_poll does not support unknown poll descriptor "
-                           "type %d", item->desc.type);
-            FAIL_ITEM(i);
         }
 
-        item->revents = revents;
-    }
+        if (!ossl_rio_poll_builder_poll(&rpb, wait_deadline))
+            FAIL_FROM(num_items);
 
-    /* TODO(QUIC POLLING): Blocking mode */
-    /* TODO(QUIC POLLING): Support for polling FDs */
+        /*
+         * Only revisit the items registered on FDs which became ready, or
+         * whose reactors need to be ticked.
+         */
+        now = ossl_time_now();
+        for (i = 0; i < rpb.num_groups; ++i) {
+            g = &rpb.groups[i];
+            if (g->revents == 0 && ossl_time_compare(g->deadline, now) > 0)
+                continue;
+
+            /* Several QUIC items on one FD normally share a reactor. */
+            ticked = !do_tick;
+            for (k = 0; k < g->num; ++k) {
+                e       = &rpb.entries[g->first + k];
+                item    = &ITEM_N(items, stride, e->idx);
+                is_quic = is_quic_item(item);
+
+                if (!poll_readout(item, is_quic && !ticked, g->revents,
+                                  &revents)) {
+                    if (item->revents == 0)
+                        ++result_count;
+                    item->revents = SSL_POLL_EVENT_F;
+                    FAIL_FROM(num_items);
+                }
+
+                if (item->revents == 0 && revents != 0)
+                    ++result_count;
+                else if (item->revents != 0 && revents == 0)
+                    --result_count;
+
+                item->revents = revents;
+
+#ifndef OPENSSL_NO_QUIC
+                if (is_quic) {
+                    ticked = 1;
+                    poll_refresh_quic(e, item);
+                }
+#endif
+            }
+
+            ossl_rio_poll_builder_update_group(&rpb, g);
+        }
+
+        if (result_count > 0 || is_immediate
+            || ossl_time_compare(now, deadline) >= 0)
+            break;
+    }
 
 out:
+    ossl_rio_poll_builder_cleanup(&rpb);
     if (p_result_count != NULL)
         *p_result_count = result_count;
 
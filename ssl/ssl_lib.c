@@ -30,6 +30,7 @@
 #include "internal/thread_once.h"
 #include "internal/ktls.h"
 #include "internal/to_hex.h"
+#include "internal/quic_token.h"
 #include "quic/quic_local.h"
 
 static int ssl_undefined_function_3(SSL_CONNECTION *sc, unsigned char *r,
@@ -944,7 +945,8 @@ int SSL_is_dtls(const SSL *s)
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
 
 #ifndef OPENSSL_NO_QUIC
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return 0;
 #endif
 
@@ -959,7 +961,8 @@ int SSL_is_tls(const SSL *s)
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
 
 #ifndef OPENSSL_NO_QUIC
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return 0;
 #endif
 
@@ -972,7 +975,8 @@ int SSL_is_tls(const SSL *s)
 int SSL_is_quic(const SSL *s)
 {
 #ifndef OPENSSL_NO_QUIC
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return 1;
 #endif
     return 0;
@@ -2414,15 +2418,29 @@ int SSL_read_early_data(SSL *s, void *buf, size_t num, size_t *readbytes)
 
 int SSL_get_early_data_status(const SSL *s)
 {
-    const SSL_CONNECTION *sc = SSL_CONNECTION_FROM_CONST_SSL_ONLY(s);
+    const SSL_CONNECTION *sc = SSL_CONNECTION_FROM_CONST_SSL(s);
 
-    /* TODO(QUIC 0RTT): 0-RTT support */
     if (sc == NULL)
         return 0;
 
     return sc->ext.early_data;
 }
 
+int SSL_set_quic_early_data_enabled(SSL *s, int enabled)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return ossl_quic_set_early_data_enabled(s, enabled);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return 0;
+#endif
+}
+
 static int ssl_peek_internal(SSL *s, void *buf, size_t num, size_t *readbytes)
 {
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
@@ -2493,6 +2511,36 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
     return ret;
 }
 
+int SSL_read_buffer(SSL *s, const unsigned char **buf, size_t *buf_len)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return ossl_quic_read_buffer(s, buf, buf_len);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return 0;
+#endif
+}
+
+int SSL_release_read_buffer(SSL *s, const unsigned char *buf)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return ossl_quic_release_read_buffer(s, buf);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return 0;
+#endif
+}
+
 int ssl_write_internal(SSL *s, const void *buf, size_t num,
                        uint64_t flags, size_t *written)
 {
@@ -2655,6 +2703,22 @@ int SSL_write_ex2(SSL *s, const void *buf, size_t num, uint64_t flags,
     return ret;
 }
 
+int SSL_write_buffer(SSL *s, const void *buf, size_t num, uint64_t flags,
+                     SSL_buffer_release_cb_fn release_cb, void *release_arg)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    return ossl_quic_write_buffer(s, buf, num, flags, release_cb, release_arg);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return 0;
+#endif
+}
+
 int SSL_write_early_data(SSL *s, const void *buf, size_t num, size_t *written)
 {
     int ret, early_data_state;
@@ -4003,6 +4067,13 @@ SSL_CTX *SSL_CTX_new_ex(OSSL_LIB_CTX *libctx, const char *propq,
         ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
         goto err;
     }
+#ifndef OPENSSL_NO_QUIC
+    if (IS_QUIC_METHOD(meth)
+        && (ret->quic_token_store = ossl_quic_token_store_new()) == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
+#endif
     ret->cert_store = X509_STORE_new();
     if (ret->cert_store == NULL) {
         ERR_raise(ERR_LIB_SSL, ERR_R_X509_LIB);
@@ -4374,6 +4445,9 @@ void SSL_CTX_free(SSL_CTX *a)
 #ifndef OPENSSL_NO_QLOG
     OPENSSL_free(a->qlog_title);
 #endif
+#ifndef OPENSSL_NO_QUIC
+    ossl_quic_token_store_free(a->quic_token_store);
+#endif
 
     OPENSSL_free(a);
 }
@@ -4981,7 +5055,8 @@ const char *SSL_get_version(const SSL *s)
 
 #ifndef OPENSSL_NO_QUIC
     /* We only support QUICv1 - so if its QUIC its QUICv1 */
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return "QUICv1";
 #endif
 
@@ -5343,7 +5418,8 @@ int SSL_version(const SSL *s)
 
 #ifndef OPENSSL_NO_QUIC
     /* We only support QUICv1 - so if its QUIC its QUICv1 */
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return OSSL_QUIC1_VERSION;
 #endif
     if (sc == NULL)
@@ -5358,7 +5434,8 @@ int SSL_client_version(const SSL *s)
 
 #ifndef OPENSSL_NO_QUIC
     /* We only support QUICv1 - so if its QUIC its QUICv1 */
-    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO)
+    if (s->type == SSL_TYPE_QUIC_CONNECTION || s->type == SSL_TYPE_QUIC_XSO
+        || s->type == SSL_TYPE_QUIC_LISTENER)
         return OSSL_QUIC1_VERSION;
 #endif
     if (sc == NULL)
@@ -7760,6 +7837,93 @@ size_t SSL_get_accept_stream_queue_len(SSL *s)
 #endif
 }
 
+SSL *SSL_new_listener(SSL_CTX *ctx, uint64_t flags)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC_CTX(ctx)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    return ossl_quic_new_listener(ctx, flags);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return NULL;
+#endif
+}
+
+SSL *SSL_new_listener_shard(SSL *ssl, uint64_t flags)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(ssl)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    return ossl_quic_new_listener_shard(ssl, flags);
+#else
+    ERR_raise(ERR_LIB_SSL, ERR_R_UNSUPPORTED);
+    return NULL;
+#endif
+}
+
+int SSL_listen(SSL *ssl)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(ssl))
+        return 0;
+
+    return ossl_quic_listen(ssl);
+#else
+    return 0;
+#endif
+}
+
+SSL *SSL_accept_connection(SSL *ssl, uint64_t flags)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(ssl))
+        return NULL;
+
+    return ossl_quic_accept_connection(ssl, flags);
+#else
+    return NULL;
+#endif
+}
+
+size_t SSL_get_accept_connection_queue_len(SSL *ssl)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(ssl))
+        return 0;
+
+    return ossl_quic_get_accept_connection_queue_len(ssl);
+#else
+    return 0;
+#endif
+}
+
+int SSL_is_listener(SSL *ssl)
+{
+#ifndef OPENSSL_NO_QUIC
+    return ssl != NULL && ssl->type == SSL_TYPE_QUIC_LISTENER;
+#else
+    return 0;
+#endif
+}
+
+SSL *SSL_get0_listener(SSL *s)
+{
+#ifndef OPENSSL_NO_QUIC
+    if (!IS_QUIC(s))
+        return NULL;
+
+    return ossl_quic_get0_listener(s);
+#else
+    return NULL;
+#endif
+}
+
 int SSL_stream_reset(SSL *s,
                      const SSL_STREAM_RESET_ARGS *args,
                      size_t args_len)
@@ -37,6 +37,7 @@
 # include "internal/time.h"
 # include "internal/ssl.h"
 # include "internal/cryptlib.h"
+# include "internal/quic_predef.h"
 # include "record/record.h"
 
 # ifdef OPENSSL_BUILD_SHLIBSSL
@@ -549,6 +550,12 @@ struct ssl_session_st {
          * performed at all.
          */
         uint8_t max_fragment_len_mode;
+        /*
+         * QUIC transport parameters the server sent, which a client must
+         * remember in order to send 0-RTT data (RFC 9000 s. 7.4.1)
+         */
+        unsigned char *quic_transport_params;
+        size_t quic_transport_params_len;
     } ext;
 # ifndef OPENSSL_NO_SRP
     char *srp_username;
@@ -1184,6 +1191,11 @@ struct ssl_ctx_st {
 # ifndef OPENSSL_NO_QLOG
     char *qlog_title; /* Session title for qlog */
 # endif
+
+# ifndef OPENSSL_NO_QUIC
+    /* Address validation tokens received from QUIC servers */
+    QUIC_TOKEN_STORE *quic_token_store;
+# endif
 };
 
 typedef struct cert_pkey_st CERT_PKEY;
@@ -1191,6 +1203,7 @@ typedef struct cert_pkey_st CERT_PKEY;
 #define SSL_TYPE_SSL_CONNECTION  0
 #define SSL_TYPE_QUIC_CONNECTION 1
 #define SSL_TYPE_QUIC_XSO        2
+#define SSL_TYPE_QUIC_LISTENER   3
 
 struct ssl_st {
     int type;
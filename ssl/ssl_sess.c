@@ -157,6 +157,7 @@ static SSL_SESSION *ssl_session_dup_intern(const SSL_SESSION *src, int ticket)
     dest->ext.hostname = NULL;
     dest->ext.tick = NULL;
     dest->ext.alpn_selected = NULL;
+    dest->ext.quic_transport_params = NULL;
 #ifndef OPENSSL_NO_SRP
     dest->srp_username = NULL;
 #endif
@@ -245,6 +246,14 @@ static SSL_SESSION *ssl_session_dup_intern(const SSL_SESSION *src, int ticket)
             goto err;
     }
 
+    if (src->ext.quic_transport_params != NULL) {
+        dest->ext.quic_transport_params
+            = OPENSSL_memdup(src->ext.quic_transport_params,
+                             src->ext.quic_transport_params_len);
+        if (dest->ext.quic_transport_params == NULL)
+            goto err;
+    }
+
 #ifndef OPENSSL_NO_SRP
     if (src->srp_username) {
         dest->srp_username = OPENSSL_strdup(src->srp_username);
@@ -866,6 +875,7 @@ void SSL_SESSION_free(SSL_SESSION *ss)
     OPENSSL_free(ss->srp_username);
 #endif
     OPENSSL_free(ss->ext.alpn_selected);
+    OPENSSL_free(ss->ext.quic_transport_params);
     OPENSSL_free(ss->ticket_appdata);
     CRYPTO_FREE_REF(&ss->references);
     OPENSSL_clear_free(ss, sizeof(*ss));
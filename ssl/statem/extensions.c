@@ -1734,9 +1734,15 @@ static int final_early_data(SSL_CONNECTION *s, unsigned int context, int sent)
         return 1;
     }
 
+    /*
+     * A TLS server only accepts early data if SSL_read_early_data() is being
+     * used. QUIC servers do not use that API; the early data is carried in
+     * 0-RTT packets and max_early_data alone determines whether we accept it.
+     */
     if (s->max_early_data == 0
             || !s->hit
-            || s->early_data_state != SSL_EARLY_DATA_ACCEPTING
+            || (s->early_data_state != SSL_EARLY_DATA_ACCEPTING
+                && !SSL_IS_QUIC_HANDSHAKE(s))
             || !s->ext.early_data_ok
             || s->hello_retry_request != SSL_HRR_NONE
             || (s->allow_early_data_cb != NULL
@@ -473,8 +473,10 @@ static WRITE_TRAN ossl_statem_client13_write_transition(SSL_CONNECTION *s)
         return WRITE_TRAN_CONTINUE;
 
     case TLS_ST_CR_FINISHED:
-        if (s->early_data_state == SSL_EARLY_DATA_WRITE_RETRY
-                || s->early_data_state == SSL_EARLY_DATA_FINISHED_WRITING)
+        /* QUIC does not use EndOfEarlyData (RFC 9001 s. 8.3) */
+        if (!SSL_IS_QUIC_HANDSHAKE(s)
+                && (s->early_data_state == SSL_EARLY_DATA_WRITE_RETRY
+                    || s->early_data_state == SSL_EARLY_DATA_FINISHED_WRITING))
             st->hand_state = TLS_ST_PENDING_EARLY_DATA_END;
         else if ((s->options & SSL_OP_ENABLE_MIDDLEBOX_COMPAT) != 0
                  && s->hello_retry_request == SSL_HRR_NONE)
@@ -777,6 +779,14 @@ WORK_STATE ossl_statem_client_pre_work(SSL_CONNECTION *s, WORK_STATE wst)
         /* Fall through */
 
     case TLS_ST_EARLY_DATA:
+        if (SSL_IS_QUIC_HANDSHAKE(s)) {
+            /*
+             * QUIC sends early data in 0-RTT packets which do not go through
+             * us, so there is no need to pause the handshake here.
+             */
+            s->early_data_state = SSL_EARLY_DATA_FINISHED_WRITING;
+            return WORK_FINISHED_CONTINUE;
+        }
         return tls_finish_handshake(s, wst, 0, 1);
 
     case TLS_ST_OK:
@@ -964,6 +974,7 @@ int ossl_statem_client_construct_message(SSL_CONNECTION *s,
         break;
 
     case TLS_ST_PENDING_EARLY_DATA_END:
+    case TLS_ST_EARLY_DATA:
         *confunc = NULL;
         *mt = SSL3_MT_DUMMY;
         break;
@@ -1797,10 +1808,12 @@ MSG_PROCESS_RETURN tls_process_server_hello(SSL_CONNECTION *s, PACKET *pkt)
          * immediately. Otherwise we have to defer this until after all possible
          * early data is written. We could just always defer until the last
          * moment except QUIC needs it done at the same time as the read keys
-         * are changed. Since QUIC doesn't do TLS early data or need middlebox
-         * compat this doesn't cause a problem.
+         * are changed. QUIC sends early data in 0-RTT packets, which use
+         * different keys to the handshake, and doesn't need middlebox compat,
+         * so we never defer for QUIC.
          */
-        if (s->early_data_state == SSL_EARLY_DATA_NONE
+        if ((s->early_data_state == SSL_EARLY_DATA_NONE
+                    || SSL_IS_QUIC_HANDSHAKE(s))
                 && (s->options & SSL_OP_ENABLE_MIDDLEBOX_COMPAT) == 0
                 && !ssl->method->ssl3_enc->change_cipher_state(s,
                     SSL3_CC_HANDSHAKE | SSL3_CHANGE_CIPHER_CLIENT_WRITE)) {
@@ -3798,6 +3811,7 @@ CON_FUNC_RETURN tls_construct_client_certificate(SSL_CONNECTION *s,
      */
     if (SSL_CONNECTION_IS_TLS13(s)
             && SSL_IS_FIRST_HANDSHAKE(s)
+            && !SSL_IS_QUIC_HANDSHAKE(s)
             && (s->early_data_state != SSL_EARLY_DATA_NONE
                 || (s->options & SSL_OP_ENABLE_MIDDLEBOX_COMPAT) != 0)
             && (!ssl->method->ssl3_enc->change_cipher_state(s,
@@ -3887,6 +3901,7 @@ CON_FUNC_RETURN tls_construct_client_compressed_certificate(SSL_CONNECTION *sc,
      * moment. We need to do it now.
      */
     if (SSL_IS_FIRST_HANDSHAKE(sc)
+            && !SSL_IS_QUIC_HANDSHAKE(sc)
             && (sc->early_data_state != SSL_EARLY_DATA_NONE
                 || (sc->options & SSL_OP_ENABLE_MIDDLEBOX_COMPAT) != 0)
             && (!ssl->method->ssl3_enc->change_cipher_state(sc,
@@ -84,7 +84,9 @@ static int ossl_statem_server13_read_transition(SSL_CONNECTION *s, int mt)
                 return 1;
             }
             break;
-        } else if (s->ext.early_data == SSL_EARLY_DATA_ACCEPTED) {
+        } else if (s->ext.early_data == SSL_EARLY_DATA_ACCEPTED
+                   && !SSL_IS_QUIC_HANDSHAKE(s)) {
+            /* QUIC does not use EndOfEarlyData (RFC 9001 s. 8.3) */
             if (mt == SSL3_MT_END_OF_EARLY_DATA) {
                 st->hand_state = TLS_ST_SR_END_OF_EARLY_DATA;
                 return 1;
@@ -966,7 +968,13 @@ WORK_STATE ossl_statem_server_post_work(SSL_CONNECTION *s, WORK_STATE wst)
                 return WORK_ERROR;
             }
 
-            if (s->ext.early_data != SSL_EARLY_DATA_ACCEPTED
+            /*
+             * If we accepted early data we normally keep reading with the
+             * early data keys until we get EndOfEarlyData. QUIC has no
+             * EndOfEarlyData, and keeps both keys in use at the same time.
+             */
+            if ((s->ext.early_data != SSL_EARLY_DATA_ACCEPTED
+                    || SSL_IS_QUIC_HANDSHAKE(s))
                 && !ssl->method->ssl3_enc->change_cipher_state(s,
                         SSL3_CC_HANDSHAKE |SSL3_CHANGE_CIPHER_SERVER_READ)) {
                 /* SSLfatal() already called */
@@ -13,6 +13,7 @@
 #include "testutil.h"
 #include "internal/sockets.h"
 #include "internal/bio_addr.h"
+#include "internal/bio.h"
 
 #if !defined(OPENSSL_NO_DGRAM) && !defined(OPENSSL_NO_SOCK)
 
@@ -109,7 +110,7 @@ static int test_bio_dgram_impl(int af, int use_local)
     struct in6_addr ina6;
 #endif
     void *pina;
-    size_t inal, i;
+    size_t inal, i, off;
     union BIO_sock_info_u info1 = {0}, info2 = {0};
     char rx_buf[128], rx_buf2[128];
     BIO_MSG tx_msg[128], rx_msg[128];
@@ -412,6 +413,70 @@ static int test_bio_dgram_impl(int af, int use_local)
     if (!TEST_mem_eq(tx_buf, OSSL_NELEM(tx_msg), rx_buf, OSSL_NELEM(tx_msg)))
         goto err;
 
+    /*
+     * Send a train of equal-size datagrams ending with a shorter one, which
+     * the sendmmsg implementation may coalesce into a single GSO send. They
+     * must still arrive as separate datagrams of the original sizes.
+     */
+    for (i = 0; i < 6; ++i) {
+        tx_msg[i].data      = tx_buf + i * 16;
+        tx_msg[i].data_len  = i < 5 ? 16 : 9;
+        tx_msg[i].peer      = addr2;
+        tx_msg[i].local     = use_local ? addr1 : NULL;
+        tx_msg[i].flags     = 0;
+    }
+    if (!TEST_true(do_sendmmsg(b1, tx_msg, 6, 0, &num_processed))
+        || !TEST_size_t_eq(num_processed, 6))
+        goto err;
+
+    for (i = 0; i < 6; ++i) {
+        rx_msg[i].data      = rx_buf + i * 16;
+        rx_msg[i].data_len  = 16;
+        rx_msg[i].peer      = NULL;
+        rx_msg[i].local     = NULL;
+        rx_msg[i].flags     = 0;
+    }
+    memset(rx_buf, 0, sizeof(rx_buf));
+    if (!TEST_true(do_recvmmsg(b2, rx_msg, 6, 0, &num_processed))
+        || !TEST_size_t_eq(num_processed, 6))
+        goto err;
+
+    for (i = 0; i < 6; ++i)
+        if (!TEST_size_t_eq(rx_msg[i].data_len, tx_msg[i].data_len))
+            goto err;
+
+    if (!TEST_mem_eq(tx_buf, 5 * 16 + 9, rx_buf, 5 * 16 + 9))
+        goto err;
+
+    /*
+     * With GRO enabled, the kernel may deliver the same train as a single
+     * message, in which case it reports the segment size.
+     */
+    if (BIO_dgram_set_gro(b2, 1) > 0) {
+        if (!TEST_true(do_sendmmsg(b1, tx_msg, 6, 0, &num_processed))
+            || !TEST_size_t_eq(num_processed, 6))
+            goto err;
+
+        memset(rx_buf, 0, sizeof(rx_buf));
+        for (off = 0; off < 5 * 16 + 9; off += rx_msg[0].data_len) {
+            rx_msg[0].data      = rx_buf + off;
+            rx_msg[0].data_len  = sizeof(rx_buf) - off;
+            rx_msg[0].peer      = NULL;
+            rx_msg[0].local     = NULL;
+            rx_msg[0].flags     = 0;
+            if (!TEST_true(do_recvmmsg(b2, rx_msg, 1, 0, &num_processed)))
+                goto err;
+
+            if (BIO_MSG_GRO_SEG_LEN(rx_msg[0].flags) != 0
+                && !TEST_size_t_eq(BIO_MSG_GRO_SEG_LEN(rx_msg[0].flags), 16))
+                goto err;
+        }
+
+        if (!TEST_size_t_eq(off, 5 * 16 + 9)
+            || !TEST_mem_eq(tx_buf, off, rx_buf, off))
+            goto err;
+    }
+
     testresult = 1;
 err:
     BIO_free(b1);
@@ -104,6 +104,16 @@ static OSSL_TIME dummy_get_wakeup_deadline(OSSL_CC_DATA *cc)
     return ossl_time_infinite();
 }
 
+static uint64_t dummy_get_pacing_rate(OSSL_CC_DATA *cc, OSSL_TIME srtt)
+{
+    return 0;
+}
+
+static uint64_t dummy_get_ack_eliciting_threshold(OSSL_CC_DATA *cc)
+{
+    return 1;
+}
+
 static int dummy_on_data_sent(OSSL_CC_DATA *cc,
                               uint64_t num_bytes)
 {
@@ -143,6 +153,8 @@ const OSSL_CC_METHOD ossl_cc_dummy_method = {
     dummy_unbind_diagnostic,
     dummy_get_tx_allowance,
     dummy_get_wakeup_deadline,
+    dummy_get_pacing_rate,
+    dummy_get_ack_eliciting_threshold,
     dummy_on_data_sent,
     dummy_on_data_acked,
     dummy_on_data_lost,
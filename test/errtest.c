@@ -11,6 +11,7 @@
 #include <openssl/opensslconf.h>
 #include <openssl/err.h>
 #include <openssl/macros.h>
+#include "internal/err.h"
 
 #include "testutil.h"
 
@@ -425,6 +426,70 @@ static int test_save_restore(int idx)
     return res;
 }
 
+static int test_speculative_marks(void)
+{
+    const char *data;
+    int res = 0;
+#if !defined(OPENSSL_NO_FILENAMES) && !defined(OPENSSL_NO_ERR)
+    const char *file, *func;
+    int line, expected_line;
+#endif
+
+    ERR_clear_error();
+    ERR_raise(ERR_LIB_CRYPTO, ERR_R_MALLOC_FAILURE);
+
+    /* Errors inside the speculative mark are complete, until they're popped */
+    ossl_err_set_speculative_mark();
+    ERR_raise_data(ERR_LIB_NONE, ERR_R_INTERNAL_ERROR, "dropped %d", 1);
+    ERR_add_error_data(1, " and more");
+    if (!TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error_data(&data, NULL)),
+                     ERR_R_INTERNAL_ERROR)
+        || !TEST_str_eq(data, "dropped 1 and more"))
+        goto err;
+    ossl_err_pop_speculative_mark();
+    if (!TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error()),
+                     ERR_R_MALLOC_FAILURE))
+        goto err;
+
+    /* Errors that survive nested speculative marks get their own location */
+    ossl_err_set_speculative_mark();
+    ossl_err_set_speculative_mark();
+#if !defined(OPENSSL_NO_FILENAMES) && !defined(OPENSSL_NO_ERR)
+    expected_line = __LINE__ + 2; /* The error is raised on the next line */
+#endif
+    ERR_raise_data(ERR_LIB_NONE, ERR_R_PASSED_NULL_PARAMETER, "kept");
+    ossl_err_clear_speculative_mark();
+    ossl_err_clear_speculative_mark();
+#if !defined(OPENSSL_NO_FILENAMES) && !defined(OPENSSL_NO_ERR)
+    if (!TEST_int_eq(ERR_GET_REASON(ERR_peek_last_error_all(&file, &line,
+                                                            &func, &data,
+                                                            NULL)),
+                     ERR_R_PASSED_NULL_PARAMETER)
+        || !TEST_str_eq(file, __FILE__)
+        || !TEST_ptr_ne(file, __FILE__)
+        || !TEST_int_eq(line, expected_line)
+        || !TEST_str_eq(func, "test_speculative_marks")
+        || !TEST_str_eq(data, "kept"))
+        goto err;
+#endif
+
+    /* A slot that kept its buffer from a speculative error is reused */
+    ERR_clear_error();
+    ossl_err_set_speculative_mark();
+    ERR_raise_data(ERR_LIB_NONE, ERR_R_INTERNAL_ERROR, "%s", "reused");
+    ossl_err_pop_speculative_mark();
+    ERR_raise(ERR_LIB_NONE, ERR_R_INTERNAL_ERROR);
+    ERR_add_error_data(2, "appended", " data");
+    if (!TEST_str_eq(ERR_peek_last_error_data(&data, NULL) != 0 ? data : NULL,
+                     "appended data"))
+        goto err;
+
+    res = 1;
+ err:
+    ERR_clear_error();
+    return res;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(preserves_system_error);
@@ -436,5 +501,6 @@ int setup_tests(void)
     ADD_TEST(test_marks);
     ADD_ALL_TESTS(test_save_restore, 2);
     ADD_TEST(test_clear_error);
+    ADD_TEST(test_speculative_marks);
     return 1;
 }
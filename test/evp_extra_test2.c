@@ -749,6 +749,64 @@ static int test_provider_unload_effective(int testid)
     return ok;
 }
 
+static int test_provider_pin(void)
+{
+    OSSL_LIB_CTX *ctx = NULL;
+    OSSL_PROVIDER *provider = NULL;
+    EVP_MD *md1 = NULL, *md2 = NULL;
+    EVP_MD_CTX *mdctx = NULL;
+    EVP_SIGNATURE *sig = NULL;
+    unsigned char out[EVP_MAX_MD_SIZE];
+    int i, ok = 0;
+
+    if (!TEST_ptr(ctx = OSSL_LIB_CTX_new())
+        || !TEST_ptr(provider = OSSL_PROVIDER_load(ctx, "default"))
+        || !TEST_true(OSSL_PROVIDER_pin(provider)))
+        goto err;
+
+    /* Fetching twice must give back the same pinned method */
+    if (!TEST_ptr(md1 = EVP_MD_fetch(ctx, "SHA2-256", NULL))
+        || !TEST_ptr(md2 = EVP_MD_fetch(ctx, "SHA2-256", NULL))
+        || !TEST_ptr_eq(md1, md2)
+        || !TEST_ptr(sig = EVP_SIGNATURE_fetch(ctx, "RSA", NULL))
+        || !TEST_true(EVP_SIGNATURE_up_ref(sig)))
+        goto err;
+    EVP_SIGNATURE_free(sig);
+    EVP_MD_free(md2);
+    md2 = NULL;
+
+    /* Freeing a pinned method is a no-op, it stays with the library context */
+    for (i = 0; i < 3; i++) {
+        if (!TEST_ptr(mdctx = EVP_MD_CTX_new())
+            || !TEST_true(EVP_DigestInit_ex2(mdctx, md1, NULL))
+            || !TEST_true(EVP_DigestUpdate(mdctx, "abc", 3))
+            || !TEST_true(EVP_DigestFinal_ex(mdctx, out, NULL)))
+            goto err;
+        EVP_MD_CTX_free(mdctx);
+        mdctx = NULL;
+        EVP_MD_free(md1);
+    }
+    if (!TEST_ptr(md2 = EVP_MD_fetch(ctx, "SHA2-256", NULL))
+        || !TEST_ptr_eq(md1, md2)
+        || !TEST_int_eq(EVP_MD_get_size(md2), 32))
+        goto err;
+
+    /* The provider outlives the unload until the library context is freed */
+    OSSL_PROVIDER_unload(provider);
+    provider = NULL;
+    if (!TEST_str_eq(EVP_MD_get0_name(md2), "SHA2-256"))
+        goto err;
+
+    ok = 1;
+ err:
+    EVP_MD_CTX_free(mdctx);
+    EVP_MD_free(md2);
+    EVP_SIGNATURE_free(sig);
+    OSSL_PROVIDER_unload(provider);
+    OSSL_LIB_CTX_free(ctx);
+    return ok;
+}
+
 static int test_d2i_PrivateKey_ex(int testid)
 {
     int ok = 0;
@@ -1488,6 +1546,7 @@ int setup_tests(void)
     ADD_TEST(test_evp_md_ctx_copy);
     ADD_TEST(test_evp_md_ctx_copy2);
     ADD_ALL_TESTS(test_provider_unload_effective, 2);
+    ADD_TEST(test_provider_pin);
 #if !defined OPENSSL_NO_DES && !defined OPENSSL_NO_MD5
     ADD_TEST(test_evp_pbe_alg_add);
 #endif
@@ -9,6 +9,7 @@
 
 #include <openssl/evp.h>
 #include "internal/namemap.h"
+#include "internal/nelem.h"
 #include "testutil.h"
 
 #define NAME1 "name1"
@@ -70,6 +71,48 @@ static int test_namemap_stored(void)
         && test_namemap(nm);
 }
 
+/*
+ * Test that library contexts created after the first one, which get their
+ * legacy names copied from a snapshot, see the same names and numbers.
+ */
+static int test_namemap_legacy_snapshot(void)
+{
+    static const char *names[] = {
+        "SHA256", "sha256", "2.16.840.1.101.3.4.2.1", "AES-128-CBC",
+        "aes-128-cbc", "RSA", "rsaEncryption", "DHX", "EC"
+    };
+    OSSL_LIB_CTX *ctx1 = NULL, *ctx2 = NULL;
+    OSSL_NAMEMAP *nm1, *nm2;
+    size_t i;
+    int num, ok = 0;
+
+    if (!TEST_ptr(ctx1 = OSSL_LIB_CTX_new())
+        || !TEST_ptr(nm1 = ossl_namemap_stored(ctx1))
+        || !TEST_ptr(ctx2 = OSSL_LIB_CTX_new())
+        || !TEST_ptr(nm2 = ossl_namemap_stored(ctx2)))
+        goto err;
+
+    for (i = 0; i < OSSL_NELEM(names); i++) {
+        num = ossl_namemap_name2num(nm1, names[i]);
+        if (!TEST_int_gt(num, 0)
+            || !TEST_int_eq(ossl_namemap_name2num(nm2, names[i]), num)
+            || !TEST_str_eq(ossl_namemap_num2name(nm1, num, 0),
+                            ossl_namemap_num2name(nm2, num, 0)))
+            goto err;
+    }
+    /* Both namemaps are independent of each other from here on */
+    if (!TEST_int_ne(ossl_namemap_add_name(nm2, 0, NAME1),
+                        ossl_namemap_name2num(nm1, "SHA256"))
+        || !TEST_int_eq(ossl_namemap_name2num(nm1, NAME1), 0))
+        goto err;
+
+    ok = 1;
+ err:
+    OSSL_LIB_CTX_free(ctx1);
+    OSSL_LIB_CTX_free(ctx2);
+    return ok;
+}
+
 /*
  * Test that EVP_get_digestbyname() will use the namemap when it can't find
  * entries in the legacy method database.
@@ -175,6 +218,7 @@ int setup_tests(void)
     ADD_TEST(test_namemap_empty);
     ADD_TEST(test_namemap_independent);
     ADD_TEST(test_namemap_stored);
+    ADD_TEST(test_namemap_legacy_snapshot);
     ADD_TEST(test_digestbyname);
     ADD_TEST(test_cipherbyname);
     ADD_TEST(test_digest_is_a);
@@ -8,6 +8,7 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 #include <openssl/provider.h>
 #include <openssl/param_build.h>
 #include "testutil.h"
@@ -232,6 +233,32 @@ static int test_builtin_provider(void)
     return ok;
 }
 
+static int test_init_phase(void)
+{
+    OSSL_LIB_CTX *libctx = OSSL_LIB_CTX_new();
+    OSSL_PROVIDER *prov = NULL;
+    const char *name;
+    uint64_t usec;
+    int mallocs, found = 0;
+    size_t i;
+
+    if (!TEST_ptr(libctx)
+        || !TEST_ptr(prov = OSSL_PROVIDER_load(libctx, "default")))
+        goto err;
+
+    for (i = 0; OPENSSL_get_init_phase(i, &name, &usec, &mallocs); i++)
+        if (strcmp(name, "provider default") == 0)
+            found = 1;
+    if (!TEST_true(found)
+        || !TEST_false(OPENSSL_get_init_phase(i, &name, NULL, NULL)))
+        found = 0;
+
+ err:
+    OSSL_PROVIDER_unload(prov);
+    OSSL_LIB_CTX_free(libctx);
+    return found;
+}
+
 /* Test relies on fetching the MD4 digest from the legacy provider */
 #ifndef OPENSSL_NO_MD4
 static int test_builtin_provider_with_child(void)
@@ -324,6 +351,7 @@ int setup_tests(void)
     }
 
     if (!loaded) {
+        ADD_TEST(test_init_phase);
         ADD_TEST(test_builtin_provider);
 #ifndef OPENSSL_NO_MD4
         ADD_TEST(test_builtin_provider_with_child);
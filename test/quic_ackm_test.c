@@ -1079,6 +1079,104 @@ err:
     return testresult;
 }
 
+/*
+ * ACK Frequency Test
+ * ******************************************************************
+ */
+static int rx_ack_freq_pkt(struct helper *h, QUIC_PN pn, int immediate_ack)
+{
+    OSSL_ACKM_RX_PKT pkt = {0};
+
+    pkt.pkt_num             = pn;
+    pkt.time                = fake_time;
+    pkt.pkt_space           = QUIC_PN_SPACE_APP;
+    pkt.is_ack_eliciting    = 1;
+    pkt.is_immediate_ack    = immediate_ack;
+
+    return TEST_int_eq(ossl_ackm_on_rx_packet(h->ackm, &pkt), 1);
+}
+
+static int test_rx_ack_frequency(void)
+{
+    int testresult = 0;
+    struct helper h;
+    QUIC_PN pn = 0;
+    size_t i;
+    OSSL_QUIC_FRAME_ACK_FREQUENCY f = {0};
+
+    if (!TEST_int_eq(helper_init(&h, 0), 1))
+        goto err;
+
+    /* The first packet is always ACKed immediately. */
+    if (!rx_ack_freq_pkt(&h, pn++, 0)
+            || !TEST_true(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP))
+            || !TEST_ptr(ossl_ackm_get_ack_frame(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    /* Peer asks us to ACK every tenth packet, within 50 ms. */
+    f.seq_num                   = 1;
+    f.ack_eliciting_threshold   = 9;
+    f.max_ack_delay_us          = 50000;
+    f.reordering_threshold      = 1;
+    ossl_ackm_on_rx_ack_frequency(h.ackm, &f);
+
+    for (i = 0; i < 9; ++i) {
+        if (!rx_ack_freq_pkt(&h, pn++, 0)
+                || !TEST_false(ossl_ackm_is_ack_desired(h.ackm,
+                                                        QUIC_PN_SPACE_APP)))
+            goto err;
+    }
+
+    /* The requested max_ack_delay replaces the default of 25 ms. */
+    if (!TEST_int_eq(ossl_time_compare(ossl_ackm_get_ack_deadline(h.ackm,
+                                                                  QUIC_PN_SPACE_APP),
+                                       ossl_time_add(fake_time,
+                                                     ossl_ms2time(50))), 0))
+        goto err;
+
+    if (!rx_ack_freq_pkt(&h, pn++, 0)
+            || !TEST_true(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP))
+            || !TEST_ptr(ossl_ackm_get_ack_frame(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    /* IMMEDIATE_ACK overrides the threshold. */
+    if (!rx_ack_freq_pkt(&h, pn++, 1)
+            || !TEST_true(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP))
+            || !TEST_ptr(ossl_ackm_get_ack_frame(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    /* A gap still triggers an immediate ACK with a reordering threshold of 1. */
+    ++pn;
+    if (!rx_ack_freq_pkt(&h, pn++, 0)
+            || !TEST_true(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP))
+            || !TEST_ptr(ossl_ackm_get_ack_frame(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    /* A reordering threshold of 0 disables this. */
+    f.seq_num                   = 2;
+    f.reordering_threshold      = 0;
+    ossl_ackm_on_rx_ack_frequency(h.ackm, &f);
+
+    ++pn;
+    if (!rx_ack_freq_pkt(&h, pn++, 0)
+            || !TEST_false(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    /* A stale frame is ignored. */
+    f.seq_num                   = 1;
+    f.ack_eliciting_threshold   = 0;
+    ossl_ackm_on_rx_ack_frequency(h.ackm, &f);
+
+    if (!rx_ack_freq_pkt(&h, pn++, 0)
+            || !TEST_false(ossl_ackm_is_ack_desired(h.ackm, QUIC_PN_SPACE_APP)))
+        goto err;
+
+    testresult = 1;
+err:
+    helper_destroy(&h);
+    return testresult;
+}
+
 /*
  * Driver
  * ******************************************************************
@@ -1112,5 +1210,6 @@ int setup_tests(void)
                   OSSL_NELEM(tx_ack_cases) * MODE_NUM * QUIC_PN_SPACE_NUM);
     ADD_ALL_TESTS(test_tx_ack_time_script, OSSL_NELEM(tx_ack_time_scripts));
     ADD_ALL_TESTS(test_rx_ack, OSSL_NELEM(rx_test_scripts) * QUIC_PN_SPACE_NUM);
+    ADD_TEST(test_rx_ack_frequency);
     return 1;
 }
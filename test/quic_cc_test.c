@@ -1,5 +1,5 @@
 /*
- * Copyright 2022-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2022-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -13,6 +13,7 @@
 #include "testutil.h"
 #include <openssl/ssl.h>
 #include "internal/quic_cc.h"
+#include "internal/quic_pacer.h"
 #include "internal/priority_queue.h"
 
 /*
@@ -46,6 +47,10 @@ static void step_time(uint32_t ms)
  * congestion controller of ack/loss events automatically but the caller is
  * responsible for querying the congestion controller and choosing the size of
  * simulated transmitted packets.
+ *
+ * Alternatively, the simulator can model a link with a bottleneck of a given
+ * rate and a drop-tail queue in front of it (see net_sim_set_link()), which may
+ * additionally lose packets at random.
  */
 typedef struct net_pkt_st {
     /*
@@ -102,6 +107,15 @@ struct net_sim {
     PRIORITY_QUEUE_OF(NET_PKT) *pkts;
 
     uint64_t total_acked, total_lost; /* bytes */
+
+    /* Bottleneck link model, used if rate is non-zero. */
+    uint64_t rate;          /* bytes/s */
+    uint64_t queue_limit;   /* bytes */
+    uint32_t loss_permille; /* random loss */
+    uint64_t rand_state;
+    OSSL_TIME link_free_time;
+
+    OSSL_TIME srtt;         /* Smoothed RTT seen by the sender */
 };
 
 static int net_sim_init(struct net_sim *s,
@@ -119,12 +133,78 @@ static int net_sim_init(struct net_sim *s,
     s->total_acked      = 0;
     s->total_lost       = 0;
 
+    s->rate             = 0;
+    s->queue_limit      = 0;
+    s->loss_permille    = 0;
+    s->rand_state       = 1;
+    s->link_free_time   = ossl_time_zero();
+    s->srtt             = ossl_time_zero();
+
     if (!TEST_ptr(s->pkts = ossl_pqueue_NET_PKT_new(net_pkt_cmp)))
         return 0;
 
     return 1;
 }
 
+static void net_sim_set_link(struct net_sim *s, uint64_t rate,
+                             uint64_t queue_limit, uint32_t loss_permille)
+{
+    s->rate             = rate;
+    s->queue_limit      = queue_limit;
+    s->loss_permille    = loss_permille;
+}
+
+/* Deterministic pseudo-random loss so that results are reproducible. */
+static int net_sim_random_loss(struct net_sim *s)
+{
+    s->rand_state = s->rand_state * 6364136223846793005ULL
+                    + 1442695040888963407ULL;
+    return (s->rand_state >> 33) % 1000 < s->loss_permille;
+}
+
+/*
+ * Works out the fate of a packet sent into the bottleneck link. The packet is
+ * dropped if the queue in front of the bottleneck is full, and otherwise
+ * arrives once it has been serialised onto the link and |latency| has passed.
+ * Loss is detected a little later than an acknowledgement for a subsequent
+ * packet would have arrived.
+ */
+static int net_sim_send_link(struct net_sim *s, NET_PKT *pkt, size_t sz)
+{
+    OSSL_TIME start, tx_done;
+    uint64_t queued;
+
+    start   = ossl_time_max(fake_time, s->link_free_time);
+    queued  = ossl_time2us(ossl_time_subtract(start, fake_time))
+              * s->rate / 1000000;
+    tx_done = ossl_time_add(start, ossl_us2time(sz * 1000000 / s->rate));
+
+    if (queued + sz > s->queue_limit) {
+        /* Tail drop; the packet never makes it onto the link. */
+        pkt->determination_time = ossl_time_add(start,
+                                                ossl_ms2time(2 * s->latency
+                                                             + s->latency / 4));
+        pkt->next_time          = pkt->determination_time;
+        return 0;
+    }
+
+    s->link_free_time   = tx_done;
+    pkt->arrive_time    = ossl_time_add(tx_done, ossl_ms2time(s->latency));
+
+    if (net_sim_random_loss(s)) {
+        pkt->determination_time = ossl_time_add(pkt->arrive_time,
+                                                ossl_ms2time(s->latency
+                                                             + s->latency / 4));
+        pkt->next_time          = pkt->determination_time;
+        return 0;
+    }
+
+    pkt->determination_time = ossl_time_add(pkt->arrive_time,
+                                            ossl_ms2time(s->latency));
+    pkt->next_time          = pkt->arrive_time;
+    return 1;
+}
+
 static void do_free(NET_PKT *pkt)
 {
     OPENSSL_free(pkt);
@@ -153,11 +233,18 @@ static int net_sim_send(struct net_sim *s, size_t sz)
         goto err;
 
     /* Do we have room for the packet in the network? */
-    success = (sz <= s->spare_capacity);
+    if (s->rate > 0)
+        success = net_sim_send_link(s, pkt, sz);
+    else
+        success = (sz <= s->spare_capacity);
 
     pkt->tx_time = fake_time;
     pkt->success = success;
-    if (success) {
+    if (s->rate > 0) {
+        /* net_sim_send_link() has already scheduled the packet. */
+        if (success)
+            s->spare_capacity  -= sz;
+    } else if (success) {
         /* This packet will arrive successfully after |latency| time. */
         pkt->arrive_time        = ossl_time_add(pkt->tx_time,
                                                 ossl_ms2time(s->latency));
@@ -245,6 +332,7 @@ static int net_sim_process_one(struct net_sim *s, int skip_forward)
         OPENSSL_free(pkt);
     } else {
         OSSL_CC_ACK_INFO ack_info = {0};
+        OSSL_TIME rtt;
 
         ack_info.tx_time = pkt->tx_time;
         ack_info.tx_size = pkt->size;
@@ -252,6 +340,13 @@ static int net_sim_process_one(struct net_sim *s, int skip_forward)
         if (!TEST_true(s->ccm->on_data_acked(s->cc, &ack_info)))
             return 0;
 
+        rtt = ossl_time_subtract(fake_time, pkt->tx_time);
+        if (ossl_time_is_zero(s->srtt))
+            s->srtt = rtt;
+        else
+            s->srtt = ossl_time_divide(ossl_time_add(ossl_time_multiply(s->srtt, 7),
+                                                     rtt), 8);
+
         s->total_acked += pkt->size;
         ossl_pqueue_NET_PKT_pop(s->pkts);
         OPENSSL_free(pkt);
@@ -474,17 +569,308 @@ err:
     return testresult;
 }
 
+/*
+ * Link Simulation Tests
+ * =====================
+ *
+ * Simulations of links with a bottleneck of a given rate, in which each
+ * congestion controller should achieve a minimum share of the link rate.
+ */
+static const OSSL_CC_METHOD *const cc_methods[] = {
+    &ossl_cc_newreno_method,
+    &ossl_cc_cubic_method,
+    &ossl_cc_bbr_method
+};
+
+static const char *const cc_method_names[] = {
+    "newreno", "cubic", "bbr"
+};
+
+#define CC_NEWRENO  0
+#define CC_CUBIC    1
+#define CC_BBR      2
+
+struct link_params {
+    const char  *name;
+    uint64_t    rate;           /* bytes/s */
+    uint64_t    latency;        /* ms, one way */
+    uint64_t    queue_limit;    /* bytes */
+    uint32_t    loss_permille;
+};
+
+static const struct link_params links[] = {
+    /* 100 Mb/s, 200 ms RTT, shallow buffer. */
+    { "high-bdp", 12500000, 100, 625000, 0 },
+    /* 10 Mb/s, 100 ms RTT, buffer of one BDP, 1% random loss. */
+    { "lossy", 1250000, 50, 125000, 10 },
+};
+
+#define LINK_HIGH_BDP   0
+#define LINK_LOSSY      1
+
+#define LINK_DURATION_MS 30000
+
+#define PACER_BURST_DGRAMS 10
+
+/*
+ * Runs a bulk transfer for LINK_DURATION_MS over the given link and returns
+ * the goodput achieved in bytes/s and the number of bytes lost. If paced is
+ * set, transmissions are spread out at the congestion controller's pacing
+ * rate as the TX packetiser would do.
+ */
+static int run_link_sim(const OSSL_CC_METHOD *ccm,
+                        const struct link_params *link, int paced,
+                        uint64_t *goodput, uint64_t *lost)
+{
+    int testresult = 0;
+    int rc;
+    int have_sim = 0;
+    OSSL_CC_DATA *cc = NULL;
+    size_t mdpl = 1472;
+    OSSL_TIME end, deadline;
+    struct net_sim sim;
+    OSSL_PARAM params[2];
+    QUIC_PACER pacer;
+    NET_PKT *next;
+
+    ossl_quic_pacer_init(&pacer);
+
+    fake_time = TIME_BASE;
+    end = ossl_time_add(fake_time, ossl_ms2time(LINK_DURATION_MS));
+
+    if (!TEST_ptr(cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    if (!TEST_true(net_sim_init(&sim, ccm, cc, 0, link->latency)))
+        goto err;
+
+    have_sim = 1;
+    net_sim_set_link(&sim, link->rate, link->queue_limit, link->loss_permille);
+
+    params[0] = OSSL_PARAM_construct_size_t(OSSL_CC_OPTION_MAX_DGRAM_PAYLOAD_LEN,
+                                            &mdpl);
+    params[1] = OSSL_PARAM_construct_end();
+
+    if (!TEST_true(ccm->set_input_params(cc, params)))
+        goto err;
+
+    while (ossl_time_compare(fake_time, end) < 0) {
+        /* Always fill the entire TX allowance, subject to pacing. */
+        while (ccm->get_tx_allowance(cc) >= mdpl) {
+            if (paced) {
+                ossl_quic_pacer_set_rate(&pacer,
+                                         ccm->get_pacing_rate(cc, sim.srtt),
+                                         PACER_BURST_DGRAMS * mdpl, fake_time);
+                if (!ossl_quic_pacer_can_send(&pacer, fake_time))
+                    break;
+            }
+
+            if (!TEST_true(net_sim_send(&sim, mdpl)))
+                goto err;
+
+            ossl_quic_pacer_on_sent(&pacer, mdpl);
+        }
+
+        /*
+         * Skip to the next event, or to the time at which the pacer lets us
+         * send again if that comes first.
+         */
+        deadline = ossl_time_infinite();
+        if (ccm->get_tx_allowance(cc) >= mdpl)
+            deadline = ossl_quic_pacer_get_deadline(&pacer);
+
+        next = ossl_pqueue_NET_PKT_peek(sim.pkts);
+        if (!ossl_time_is_infinite(deadline)
+            && (next == NULL
+                || ossl_time_compare(deadline, next->next_time) < 0)) {
+            fake_time = ossl_time_max(fake_time, deadline);
+            rc = net_sim_process(&sim, 0);
+        } else {
+            rc = net_sim_process(&sim, 1);
+        }
+
+        if (!TEST_int_gt(rc, 0))
+            goto err;
+
+        /* Nothing in flight, so we must be allowed to send. */
+        if (rc == 3 && !TEST_uint64_t_ge(ccm->get_tx_allowance(cc), mdpl))
+            goto err;
+    }
+
+    *goodput = sim.total_acked * 1000 / LINK_DURATION_MS;
+    *lost = sim.total_lost;
+    testresult = 1;
+err:
+    if (have_sim)
+        net_sim_cleanup(&sim);
+
+    if (cc != NULL)
+        ccm->free(cc);
+
+    return testresult;
+}
+
+static int run_link_sim_util(int method, int link, uint64_t *util_pct)
+{
+    uint64_t goodput, lost;
+
+    if (!run_link_sim(cc_methods[method], &links[link], 0, &goodput, &lost))
+        return 0;
+
+    *util_pct = goodput * 100 / links[link].rate;
+    TEST_info("%s on %s link: %llu kB/s (%llu%% of link rate)",
+              cc_method_names[method], links[link].name,
+              (unsigned long long)(goodput / 1000),
+              (unsigned long long)*util_pct);
+    return 1;
+}
+
+/* Minimum utilisation in percent, indexed by link and method. */
+static const uint64_t link_min_util[][OSSL_NELEM(cc_methods)] = {
+    /* newreno cubic bbr */
+    { 40, 80, 70 },     /* high-bdp */
+    {  5,  5, 80 },     /* lossy */
+};
+
+static int test_link(int idx)
+{
+    int method = idx % OSSL_NELEM(cc_methods);
+    int link = idx / OSSL_NELEM(cc_methods);
+    uint64_t util;
+
+    if (!run_link_sim_util(method, link, &util))
+        return 0;
+
+    return TEST_uint64_t_ge(util, link_min_util[link][method]);
+}
+
+/* CUBIC should make better use of a high-BDP link than NewReno. */
+static int test_high_bdp_cubic_vs_newreno(void)
+{
+    uint64_t newreno, cubic;
+
+    if (!run_link_sim_util(CC_NEWRENO, LINK_HIGH_BDP, &newreno)
+        || !run_link_sim_util(CC_CUBIC, LINK_HIGH_BDP, &cubic))
+        return 0;
+
+    return TEST_uint64_t_gt(cubic, newreno);
+}
+
+/* Random loss should hurt the model-based controller least. */
+static int test_lossy_bbr_vs_loss_based(void)
+{
+    uint64_t newreno, cubic, bbr;
+
+    if (!run_link_sim_util(CC_NEWRENO, LINK_LOSSY, &newreno)
+        || !run_link_sim_util(CC_CUBIC, LINK_LOSSY, &cubic)
+        || !run_link_sim_util(CC_BBR, LINK_LOSSY, &bbr))
+        return 0;
+
+    return TEST_uint64_t_ge(cubic, newreno)
+        && TEST_uint64_t_gt(bbr, cubic);
+}
+
+/*
+ * Pacing should never cost throughput on the high-BDP link. As BBR does not
+ * back off in response to loss, unpaced bursts overflow the shallow buffer
+ * continually; pacing at the model's rate should avoid most of this loss.
+ */
+static int test_paced_link(int idx)
+{
+    uint64_t goodput, paced_goodput, lost, paced_lost;
+
+    if (!run_link_sim(cc_methods[idx], &links[LINK_HIGH_BDP], 0,
+                      &goodput, &lost)
+        || !run_link_sim(cc_methods[idx], &links[LINK_HIGH_BDP], 1,
+                         &paced_goodput, &paced_lost))
+        return 0;
+
+    TEST_info("%s on high-bdp link: %llu kB/s, %llu kB lost unpaced; "
+              "%llu kB/s, %llu kB lost paced", cc_method_names[idx],
+              (unsigned long long)(goodput / 1000),
+              (unsigned long long)(lost / 1000),
+              (unsigned long long)(paced_goodput / 1000),
+              (unsigned long long)(paced_lost / 1000));
+
+    if (!TEST_uint64_t_ge(paced_goodput, goodput * 9 / 10))
+        return 0;
+
+    return idx != CC_BBR || TEST_uint64_t_lt(paced_lost, lost / 4);
+}
+
+/*
+ * Pacer Test
+ * ==========
+ */
+static int test_pacer(void)
+{
+    QUIC_PACER pacer;
+    OSSL_TIME t = TIME_BASE;
+
+    ossl_quic_pacer_init(&pacer);
+
+    /* Pacing is disabled by default. */
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t))
+        || !TEST_true(ossl_time_is_zero(ossl_quic_pacer_get_deadline(&pacer))))
+        return 0;
+
+    ossl_quic_pacer_on_sent(&pacer, 100000);
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    /* 1 MB/s with a burst of 3000 bytes; we start with a full bucket. */
+    ossl_quic_pacer_set_rate(&pacer, 1000000, 3000, t);
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    ossl_quic_pacer_on_sent(&pacer, 1500);
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    ossl_quic_pacer_on_sent(&pacer, 1500);
+    if (!TEST_false(ossl_quic_pacer_can_send(&pacer, t))
+        || !TEST_true(ossl_time_compare(ossl_quic_pacer_get_deadline(&pacer),
+                                        t) > 0))
+        return 0;
+
+    /* An overdraft must be paid off before the next send. */
+    ossl_quic_pacer_on_sent(&pacer, 1500);
+    t = ossl_time_add(t, ossl_us2time(1000));
+    if (!TEST_false(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    /* Waking up at the deadline must permit a send. */
+    t = ossl_quic_pacer_get_deadline(&pacer);
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    /* Idle time cannot accumulate more than a burst. */
+    t = ossl_time_add(t, ossl_ms2time(1000));
+    if (!TEST_true(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    ossl_quic_pacer_on_sent(&pacer, 3000);
+    if (!TEST_false(ossl_quic_pacer_can_send(&pacer, t)))
+        return 0;
+
+    /* Disabling pacing lifts the restriction immediately. */
+    ossl_quic_pacer_set_rate(&pacer, 0, 0, t);
+    return TEST_true(ossl_quic_pacer_can_send(&pacer, t))
+        && TEST_true(ossl_time_is_zero(ossl_quic_pacer_get_deadline(&pacer)));
+}
+
 /*
  * Sanity Test
  * ===========
  *
- * Basic test of the congestion control APIs.
+ * Basic test of the congestion control APIs, for the loss-based congestion
+ * controllers (NewReno and CUBIC).
  */
-static int test_sanity(void)
+static int test_sanity(int idx)
 {
     int testresult = 0;
     OSSL_CC_DATA *cc = NULL;
-    const OSSL_CC_METHOD *ccm = &ossl_cc_newreno_method;
+    const OSSL_CC_METHOD *ccm = cc_methods[idx];
     OSSL_CC_LOSS_INFO loss_info = {0};
     OSSL_CC_ACK_INFO ack_info = {0};
     uint64_t allowance, allowance2;
@@ -525,6 +911,10 @@ static int test_sanity(void)
     if (!TEST_true(ossl_time_is_zero(ccm->get_wakeup_deadline(cc))))
         goto err;
 
+    /* Every ack-eliciting packet should be ACKed during slow start. */
+    if (!TEST_uint64_t_eq(ccm->get_ack_eliciting_threshold(cc), 1))
+        goto err;
+
     /* No bytes should currently be in flight. */
     if (!TEST_uint64_t_eq(diag_cur_bytes_in_flight, 0))
         goto err;
@@ -599,6 +989,11 @@ static int test_sanity(void)
     if (!TEST_uint64_t_lt(ccm->get_tx_allowance(cc), allowance))
         goto err;
 
+    /* The ACK-eliciting threshold is bounded once out of slow start. */
+    if (!TEST_uint64_t_ge(ccm->get_ack_eliciting_threshold(cc), 1)
+        || !TEST_uint64_t_le(ccm->get_ack_eliciting_threshold(cc), 9))
+        goto err;
+
     testresult = 1;
 
 err:
@@ -608,6 +1003,86 @@ err:
     return testresult;
 }
 
+/*
+ * BBR does not take isolated loss as a congestion signal, but must react to
+ * persistent congestion.
+ */
+static int test_bbr_loss(void)
+{
+    int testresult = 0;
+    OSSL_CC_DATA *cc = NULL;
+    const OSSL_CC_METHOD *ccm = &ossl_cc_bbr_method;
+    OSSL_CC_LOSS_INFO loss_info = {0};
+    OSSL_CC_ACK_INFO ack_info = {0};
+    uint64_t allowance, diag_cwnd = UINT64_MAX, diag_min_cwnd = UINT64_MAX;
+    uint64_t cwnd;
+    OSSL_PARAM params[3];
+    int i;
+
+    fake_time = TIME_BASE;
+
+    if (!TEST_ptr(cc = ccm->new(fake_now, NULL)))
+        goto err;
+
+    params[0] = OSSL_PARAM_construct_uint64(OSSL_CC_OPTION_CUR_CWND_SIZE,
+                                            &diag_cwnd);
+    params[1] = OSSL_PARAM_construct_uint64(OSSL_CC_OPTION_MIN_CWND_SIZE,
+                                            &diag_min_cwnd);
+    params[2] = OSSL_PARAM_construct_end();
+
+    if (!TEST_true(ccm->bind_diagnostics(cc, params)))
+        goto err;
+
+    /* Grow the window a little. */
+    for (i = 0; i < 10; ++i) {
+        if (!TEST_true(ccm->on_data_sent(cc, 1200)))
+            goto err;
+
+        ack_info.tx_time = fake_time;
+        ack_info.tx_size = 1200;
+        step_time(50);
+        if (!TEST_true(ccm->on_data_acked(cc, &ack_info)))
+            goto err;
+    }
+
+    cwnd = diag_cwnd;
+    if (!TEST_uint64_t_gt(cwnd, diag_min_cwnd))
+        goto err;
+
+    /* Isolated loss leaves the window alone. */
+    allowance = ccm->get_tx_allowance(cc);
+    if (!TEST_true(ccm->on_data_sent(cc, 1200)))
+        goto err;
+
+    loss_info.tx_time = fake_time;
+    loss_info.tx_size = 1200;
+    step_time(50);
+    if (!TEST_true(ccm->on_data_lost(cc, &loss_info))
+        || !TEST_true(ccm->on_data_lost_finished(cc, 0))
+        || !TEST_uint64_t_eq(diag_cwnd, cwnd)
+        || !TEST_uint64_t_eq(ccm->get_tx_allowance(cc), allowance))
+        goto err;
+
+    /* Persistent congestion collapses the window. */
+    if (!TEST_true(ccm->on_data_sent(cc, 1200)))
+        goto err;
+
+    loss_info.tx_time = fake_time;
+    step_time(50);
+    if (!TEST_true(ccm->on_data_lost(cc, &loss_info))
+        || !TEST_true(ccm->on_data_lost_finished(cc,
+                                                 OSSL_CC_LOST_FLAG_PERSISTENT_CONGESTION))
+        || !TEST_uint64_t_eq(diag_cwnd, diag_min_cwnd))
+        goto err;
+
+    testresult = 1;
+err:
+    if (cc != NULL)
+        ccm->free(cc);
+
+    return testresult;
+}
+
 int setup_tests(void)
 {
 
@@ -624,6 +1099,12 @@ int setup_tests(void)
 #endif
 
     ADD_TEST(test_simulate);
-    ADD_TEST(test_sanity);
+    ADD_ALL_TESTS(test_sanity, 2);
+    ADD_TEST(test_bbr_loss);
+    ADD_ALL_TESTS(test_link, OSSL_NELEM(links) * OSSL_NELEM(cc_methods));
+    ADD_TEST(test_high_bdp_cubic_vs_newreno);
+    ADD_TEST(test_lossy_bbr_vs_loss_based);
+    ADD_ALL_TESTS(test_paced_link, OSSL_NELEM(cc_methods));
+    ADD_TEST(test_pacer);
     return 1;
 }
@@ -99,8 +99,46 @@ err:
     return testresult;
 }
 
+static int test_lcidm_shard(void)
+{
+    int testresult = 0, i;
+    QUIC_LCIDM *lcidm = NULL, *lcidm_zero = NULL;
+    QUIC_CONN_ID lcid;
+    OSSL_QUIC_FRAME_NEW_CONN_ID ncid_frame;
+
+    if (!TEST_ptr(lcidm = ossl_quic_lcidm_new(NULL, 8))
+        || !TEST_ptr(lcidm_zero = ossl_quic_lcidm_new(NULL, 0))
+        || !TEST_false(ossl_quic_lcidm_set_shard(lcidm_zero, 1))
+        || !TEST_false(ossl_quic_lcidm_set_shard(lcidm, -2))
+        || !TEST_false(ossl_quic_lcidm_set_shard(lcidm, QUIC_LCID_MAX_SHARD + 1))
+        || !TEST_true(ossl_quic_lcidm_set_shard(lcidm, 0xa5))
+        || !TEST_true(ossl_quic_lcidm_generate_initial(lcidm, ptrs + 0, &lcid))
+        || !TEST_int_eq(ossl_quic_lcid_get_shard(&lcid), 0xa5))
+        goto err;
+
+    /* Every LCID of every connection carries the shard ID */
+    for (i = 0; i < 8; ++i)
+        if (!TEST_true(ossl_quic_lcidm_generate(lcidm, ptrs + 0, &ncid_frame))
+            || !TEST_size_t_eq(ncid_frame.conn_id.id_len, 8)
+            || !TEST_int_eq(ossl_quic_lcid_get_shard(&ncid_frame.conn_id), 0xa5))
+            goto err;
+
+    if (!TEST_true(ossl_quic_lcidm_set_shard(lcidm, 0))
+        || !TEST_true(ossl_quic_lcidm_generate_initial(lcidm, ptrs + 1, &lcid))
+        || !TEST_int_eq(ossl_quic_lcid_get_shard(&lcid), 0)
+        || !TEST_true(ossl_quic_lcidm_set_shard(lcidm, -1)))
+        goto err;
+
+    testresult = 1;
+err:
+    ossl_quic_lcidm_free(lcidm);
+    ossl_quic_lcidm_free(lcidm_zero);
+    return testresult;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_lcidm);
+    ADD_TEST(test_lcidm_shard);
     return 1;
 }
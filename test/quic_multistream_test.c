@@ -5530,16 +5530,18 @@ ossl_unused static int script_85_poll(struct helper *h, struct helper_local *hl)
     item->revents = UINT64_MAX;
     ++item;
 
-    /* Non-zero timeout is not supported. */
+    /*
+     * Items are already ready, so a non-zero timeout must not cause a wait
+     * (and therefore must not fail because the network BIOs are not
+     * pollable).
+     */
     result_count = SIZE_MAX;
-    ERR_set_mark();
-    if (!TEST_false(SSL_poll(items, OSSL_NELEM(items), sizeof(SSL_POLL_ITEM),
-                             &nz_timeout, 0,
-                             &result_count))
-        || !TEST_size_t_eq(result_count, 0))
+    if (!TEST_true(SSL_poll(items, OSSL_NELEM(items), sizeof(SSL_POLL_ITEM),
+                            &nz_timeout, 0,
+                            &result_count))
+        || !TEST_size_t_gt(result_count, 0))
         return 0;
 
-    ERR_pop_to_mark();
     result_count = SIZE_MAX;
     ret = SSL_poll(items, OSSL_NELEM(items), sizeof(SSL_POLL_ITEM),
                    &timeout, 0,
@@ -5904,6 +5906,8 @@ static const struct forbidden_frame_type forbidden_frame_types[] = {
     { QUIC_PKT_TYPE_INITIAL, OSSL_QUIC_FRAME_TYPE_PATH_RESPONSE, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
     { QUIC_PKT_TYPE_INITIAL, OSSL_QUIC_FRAME_TYPE_CONN_CLOSE_APP, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
     { QUIC_PKT_TYPE_INITIAL, OSSL_QUIC_FRAME_TYPE_HANDSHAKE_DONE, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
+    { QUIC_PKT_TYPE_INITIAL, OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
+    { QUIC_PKT_TYPE_INITIAL, OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
 
     { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_STREAM, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
     { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_RESET_STREAM, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
@@ -5923,6 +5927,8 @@ static const struct forbidden_frame_type forbidden_frame_types[] = {
     { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_PATH_RESPONSE, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
     { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_CONN_CLOSE_APP, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
     { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_HANDSHAKE_DONE, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
+    { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_ACK_FREQUENCY, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
+    { QUIC_PKT_TYPE_HANDSHAKE, OSSL_QUIC_FRAME_TYPE_IMMEDIATE_ACK, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
 
     /* Client uses a zero-length CID so this is not allowed. */
     { QUIC_PKT_TYPE_1RTT, OSSL_QUIC_FRAME_TYPE_RETIRE_CONN_ID, OSSL_QUIC_ERR_PROTOCOL_VIOLATION },
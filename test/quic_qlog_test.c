@@ -7,7 +7,9 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <string.h>
 #include "internal/qlog.h"
+#include "internal/qlog_bin.h"
 #include "testutil.h"
 
 /*
@@ -74,25 +76,36 @@ static OSSL_TIME now(void *arg)
     return t;
 }
 
-static int test_qlog(void)
+static void init_trace_info(QLOG_TRACE_INFO *qti)
+{
+    last_time = ossl_time_from_time_t(170653117);
+
+    qti->odcid.id_len        = 1;
+    qti->odcid.id[0]         = 0x55;
+    qti->title               = "test title";
+    qti->description         = "test description";
+    qti->group_id            = "test group ID";
+    qti->override_process_id = 123;
+    qti->now_cb              = now;
+    qti->override_impl_name  = "OpenSSL/x.y.z";
+}
+
+/*
+ * Runs the same sequence of events through the JSON-SEQ encoder (idx 0) and
+ * the binary encoder (idx 1). The binary output is converted back to JSON-SEQ,
+ * which must match the output of the JSON-SEQ encoder exactly.
+ */
+static int test_qlog(int idx)
 {
     int testresult = 0;
     QLOG_TRACE_INFO qti = {0};
     QLOG *qlog;
-    BIO *bio;
+    BIO *bio = NULL, *json_bio = NULL;
     char *buf = NULL;
     size_t buf_len = 0;
+    uint64_t num_dropped = 1;
 
-    last_time = ossl_time_from_time_t(170653117);
-
-    qti.odcid.id_len        = 1;
-    qti.odcid.id[0]         = 0x55;
-    qti.title               = "test title";
-    qti.description         = "test description";
-    qti.group_id            = "test group ID";
-    qti.override_process_id = 123;
-    qti.now_cb              = now;
-    qti.override_impl_name  = "OpenSSL/x.y.z";
+    init_trace_info(&qti);
 
     if (!TEST_ptr(qlog = ossl_qlog_new(&qti)))
         goto err;
@@ -100,6 +113,10 @@ static int test_qlog(void)
     if (!TEST_true(ossl_qlog_set_event_type_enabled(qlog, QLOG_EVENT_TYPE_transport_packet_sent, 1)))
         goto err;
 
+    if (idx == 1
+        && !TEST_true(ossl_qlog_set_format(qlog, QLOG_FORMAT_BINARY, 0)))
+        goto err;
+
     if (!TEST_ptr(bio = BIO_new(BIO_s_mem())))
         goto err;
 
@@ -138,7 +155,17 @@ static int test_qlog(void)
     if (!TEST_true(ossl_qlog_flush(qlog)))
         goto err;
 
-    buf_len = BIO_get_mem_data(bio, &buf);
+    if (idx == 1) {
+        if (!TEST_ptr(json_bio = BIO_new(BIO_s_mem()))
+            || !TEST_true(ossl_qlog_bin_to_json(bio, json_bio, &num_dropped))
+            || !TEST_uint64_t_eq(num_dropped, 0))
+            goto err;
+
+        buf_len = BIO_get_mem_data(json_bio, &buf);
+    } else {
+        buf_len = BIO_get_mem_data(bio, &buf);
+    }
+
     if (!TEST_size_t_gt(buf_len, 0))
         goto err;
 
@@ -148,6 +175,68 @@ static int test_qlog(void)
     testresult = 1;
 err:
     ossl_qlog_free(qlog);
+    BIO_free(json_bio);
+    return testresult;
+}
+
+/*
+ * Events logged in the binary format are held in a ring buffer until flushed,
+ * with the oldest events discarded when the ring is full. The header and the
+ * most recent events must survive and the discarded events must be reported.
+ */
+static int test_qlog_binary_ring(void)
+{
+    int testresult = 0;
+    QLOG_TRACE_INFO qti = {0};
+    QLOG *qlog;
+    BIO *bio = NULL, *json_bio = NULL;
+    char *buf = NULL;
+    size_t buf_len = 0;
+    uint64_t i, num_dropped = 0;
+
+    init_trace_info(&qti);
+
+    if (!TEST_ptr(qlog = ossl_qlog_new(&qti)))
+        goto err;
+
+    if (!TEST_true(ossl_qlog_set_event_type_enabled(qlog, QLOG_EVENT_TYPE_transport_packet_sent, 1))
+        || !TEST_true(ossl_qlog_set_format(qlog, QLOG_FORMAT_BINARY, 256)))
+        goto err;
+
+    if (!TEST_ptr(bio = BIO_new(BIO_s_mem()))
+        || !TEST_true(ossl_qlog_set_sink_bio(qlog, bio)))
+        goto err;
+
+    for (i = 0; i < 100; ++i) {
+        QLOG_EVENT_BEGIN(qlog, transport, packet_sent)
+            QLOG_U64("seq", i);
+        QLOG_EVENT_END()
+    }
+
+    if (!TEST_true(ossl_qlog_flush(qlog)))
+        goto err;
+
+    if (!TEST_ptr(json_bio = BIO_new(BIO_s_mem()))
+        || !TEST_true(ossl_qlog_bin_to_json(bio, json_bio, &num_dropped))
+        || !TEST_uint64_t_gt(num_dropped, 0)
+        || !TEST_uint64_t_lt(num_dropped, 100))
+        goto err;
+
+    /* NUL-terminate for the string searches below. */
+    if (!TEST_int_eq(BIO_write(json_bio, "", 1), 1))
+        goto err;
+
+    buf_len = BIO_get_mem_data(json_bio, &buf);
+    if (!TEST_size_t_gt(buf_len, 0)
+        || !TEST_ptr(strstr(buf, "\"title\":\"test title\""))
+        || !TEST_ptr(strstr(buf, "\"seq\":99}"))
+        || !TEST_ptr_null(strstr(buf, "\"seq\":0}")))
+        goto err;
+
+    testresult = 1;
+err:
+    ossl_qlog_free(qlog);
+    BIO_free(json_bio);
     return testresult;
 }
 
@@ -242,7 +331,8 @@ err:
 
 int setup_tests(void)
 {
-    ADD_TEST(test_qlog);
+    ADD_ALL_TESTS(test_qlog, 2);
+    ADD_TEST(test_qlog_binary_ring);
     ADD_ALL_TESTS(test_qlog_filter, OSSL_NELEM(filters));
     return 1;
 }
@@ -3700,6 +3700,117 @@ static int test_tx_script(int idx)
     return tx_run_script(tx_scripts[idx]);
 }
 
+/*
+ * Datagrams which have been written but not yet popped accumulate in the QTX.
+ * Check that they remain intact when enough of them are queued to need several
+ * TXE arenas, and when the MDPL is increased while a datagram is still being
+ * coalesced.
+ */
+#define TX_ARENA_NUM_DGRAMS     200
+#define TX_ARENA_OVERHEAD       (1 + 4 + 2 + 16) /* hdr + DCID + PN + tag */
+/* As above, plus version, CID lengths and a two byte Length field. */
+#define TX_ARENA_OVERHEAD_LONG  (TX_ARENA_OVERHEAD + 4 + 2 + 2)
+
+static int tx_arena_write(OSSL_QTX *qtx, uint32_t pkt_type, uint64_t pn,
+                          size_t body_len, uint32_t flags)
+{
+    static const unsigned char body[1400]; /* PADDING frames */
+    QUIC_PKT_HDR hdr = tx_script_4a_hdr;
+    OSSL_QTX_IOVEC iovec;
+    OSSL_QTX_PKT pkt = tx_script_4a_pkt;
+
+    iovec.buf       = body;
+    iovec.buf_len   = body_len;
+    if (pkt_type != QUIC_PKT_TYPE_1RTT) {
+        hdr.type    = pkt_type;
+        hdr.fixed   = 1;
+        hdr.version = 1;
+    }
+
+    pkt.hdr         = &hdr;
+    pkt.iovec       = &iovec;
+    pkt.num_iovec   = 1;
+    pkt.pn          = pn;
+    pkt.flags       = flags;
+    return TEST_true(ossl_qtx_write_pkt(qtx, &pkt));
+}
+
+static int tx_arena_check_dgram(OSSL_QTX *qtx, size_t expect_len)
+{
+    BIO_MSG msg = {0};
+
+    return TEST_true(ossl_qtx_pop_net(qtx, &msg))
+        && TEST_size_t_eq(msg.data_len, expect_len);
+}
+
+static int test_tx_arena(void)
+{
+    int testresult = 0;
+    OSSL_QTX *qtx = NULL;
+    OSSL_QTX_ARGS args = {0};
+    BIO_MSG msg = {0};
+    uint64_t pn = 0;
+    size_t i;
+
+    args.mdpl = 1200;
+
+    if (!TEST_ptr(qtx = ossl_qtx_new(&args))
+        || !TEST_true(ossl_qtx_provide_secret(qtx, QUIC_ENC_LEVEL_1RTT,
+                                              QRL_SUITE_AES128GCM, NULL,
+                                              tx_script_4_secret,
+                                              sizeof(tx_script_4_secret)))
+        || !TEST_true(ossl_qtx_provide_secret(qtx, QUIC_ENC_LEVEL_HANDSHAKE,
+                                              QRL_SUITE_AES128GCM, NULL,
+                                              tx_script_4_secret,
+                                              sizeof(tx_script_4_secret))))
+        goto err;
+
+    /* Queue many small datagrams, then drain them. */
+    for (i = 0; i < TX_ARENA_NUM_DGRAMS; ++i)
+        if (!tx_arena_write(qtx, QUIC_PKT_TYPE_1RTT, pn++, 100, 0))
+            goto err;
+
+    if (!TEST_size_t_eq(ossl_qtx_get_queue_len_datagrams(qtx),
+                        TX_ARENA_NUM_DGRAMS))
+        goto err;
+
+    for (i = 0; i < TX_ARENA_NUM_DGRAMS; ++i)
+        if (!tx_arena_check_dgram(qtx, 100 + TX_ARENA_OVERHEAD))
+            goto err;
+
+    if (!TEST_false(ossl_qtx_pop_net(qtx, &msg)))
+        goto err;
+
+    /*
+     * Start a coalesced datagram in a TXE sized for the old MDPL, then grow it
+     * beyond that size after the MDPL increases.
+     */
+    if (!tx_arena_write(qtx, QUIC_PKT_TYPE_HANDSHAKE, 0, 100,
+                        OSSL_QTX_PKT_FLAG_COALESCE)
+        || !TEST_true(ossl_qtx_set_mdpl(qtx, 1472))
+        || !tx_arena_write(qtx, QUIC_PKT_TYPE_1RTT, pn++, 1300, 0)
+        || !tx_arena_check_dgram(qtx, 1400 + TX_ARENA_OVERHEAD_LONG
+                                      + TX_ARENA_OVERHEAD))
+        goto err;
+
+    /* Datagrams at the new MDPL cannot reuse the smaller free TXEs. */
+    for (i = 0; i < TX_ARENA_NUM_DGRAMS; ++i)
+        if (!tx_arena_write(qtx, QUIC_PKT_TYPE_1RTT, pn++, 1400, 0))
+            goto err;
+
+    for (i = 0; i < TX_ARENA_NUM_DGRAMS; ++i)
+        if (!tx_arena_check_dgram(qtx, 1400 + TX_ARENA_OVERHEAD))
+            goto err;
+
+    if (!TEST_false(ossl_qtx_pop_net(qtx, &msg)))
+        goto err;
+
+    testresult = 1;
+err:
+    ossl_qtx_free(qtx);
+    return testresult;
+}
+
 int setup_tests(void)
 {
     ADD_ALL_TESTS(test_rx_script, OSSL_NELEM(rx_scripts));
@@ -3714,5 +3825,6 @@ int setup_tests(void)
      */
     ADD_ALL_TESTS(test_wire_pkt_hdr, NUM_WIRE_PKT_HDR_TESTS + 1);
     ADD_ALL_TESTS(test_tx_script, OSSL_NELEM(tx_scripts));
+    ADD_TEST(test_tx_arena);
     return 1;
 }
@@ -8,6 +8,8 @@
  */
 #include "internal/packet.h"
 #include "internal/quic_stream.h"
+#include "internal/quic_stream_map.h"
+#include "internal/uint_set.h"
 #include "testutil.h"
 
 static int compare_iov(const unsigned char *ref, size_t ref_len,
@@ -213,6 +215,151 @@ static int test_sstream_simple(void)
     return testresult;
 }
 
+struct ref_release_info {
+    size_t num_calls, num_bytes;
+};
+
+static void ref_release(const void *buf, size_t buf_len, void *arg)
+{
+    struct ref_release_info *info = arg;
+
+    ++info->num_calls;
+    info->num_bytes += buf_len;
+}
+
+/*
+ * Tests interleaving data appended by copy and by reference, and that buffers
+ * appended by reference are released once acknowledged.
+ */
+static int test_sstream_ref(void)
+{
+    int testresult = 0;
+    QUIC_SSTREAM *sstream = NULL;
+    OSSL_QUIC_FRAME_STREAM hdr;
+    OSSL_QTX_IOVEC iov[4];
+    size_t num_iov, consumed, i, rd;
+    struct ref_release_info info = {0};
+    unsigned char ref_a[20], ref_b[7], ref_c[3], expect[45], buf[45];
+
+    for (i = 0; i < sizeof(ref_a); ++i)
+        ref_a[i] = (unsigned char)(0xa0 + i);
+    for (i = 0; i < sizeof(ref_b); ++i)
+        ref_b[i] = (unsigned char)(0xb0 + i);
+    for (i = 0; i < sizeof(ref_c); ++i)
+        ref_c[i] = (unsigned char)(0xc0 + i);
+
+    memcpy(expect, data_1, 10);
+    memcpy(expect + 10, ref_a, 20);
+    memcpy(expect + 30, data_1 + 10, 5);
+    memcpy(expect + 35, ref_b, 7);
+    memcpy(expect + 42, data_1 + 13, 3);
+
+    if (!TEST_ptr(sstream = ossl_quic_sstream_new(64)))
+        goto err;
+
+    /* 0..9 copied, 10..29 by ref, 30..34 copied, 35..41 by ref */
+    if (!TEST_true(ossl_quic_sstream_append(sstream, data_1, 10, &consumed))
+        || !TEST_size_t_eq(consumed, 10)
+        || !TEST_true(ossl_quic_sstream_append_ref(sstream, ref_a,
+                                                   sizeof(ref_a),
+                                                   ref_release, &info))
+        || !TEST_true(ossl_quic_sstream_append(sstream, data_1 + 10, 5,
+                                               &consumed))
+        || !TEST_size_t_eq(consumed, 5)
+        || !TEST_true(ossl_quic_sstream_append_ref(sstream, ref_b,
+                                                   sizeof(ref_b),
+                                                   ref_release, &info)))
+        goto err;
+
+    /* Only copied data uses buffer space. */
+    if (!TEST_uint64_t_eq(ossl_quic_sstream_get_cur_size(sstream), 42)
+        || !TEST_size_t_eq(ossl_quic_sstream_get_buffer_used(sstream), 15))
+        goto err;
+
+    /* With two IOVs, the frame stops at the end of the first reference. */
+    num_iov = 2;
+    if (!TEST_true(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr, iov,
+                                                      &num_iov))
+        || !TEST_uint64_t_eq(hdr.offset, 0)
+        || !TEST_uint64_t_eq(hdr.len, 30)
+        || !TEST_size_t_eq(num_iov, 2)
+        || !TEST_ptr_eq(iov[1].buf, ref_a))
+        goto err;
+
+    num_iov = OSSL_NELEM(iov);
+    if (!TEST_true(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr, iov,
+                                                      &num_iov))
+        || !TEST_uint64_t_eq(hdr.len, 42)
+        || !TEST_size_t_eq(num_iov, 4))
+        goto err;
+
+    for (i = 0, rd = 0; i < num_iov; rd += iov[i].buf_len, ++i)
+        memcpy(buf + rd, iov[i].buf, iov[i].buf_len);
+
+    if (!TEST_mem_eq(buf, rd, expect, 42))
+        goto err;
+
+    if (!TEST_true(ossl_quic_sstream_mark_transmitted(sstream, 0, 41)))
+        goto err;
+
+    /* Lost data appended by reference is retransmitted from the same buffer. */
+    num_iov = OSSL_NELEM(iov);
+    if (!TEST_true(ossl_quic_sstream_mark_lost(sstream, 15, 20))
+        || !TEST_true(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr, iov,
+                                                         &num_iov))
+        || !TEST_uint64_t_eq(hdr.offset, 15)
+        || !TEST_uint64_t_eq(hdr.len, 6)
+        || !TEST_size_t_eq(num_iov, 1)
+        || !TEST_ptr_eq(iov[0].buf, ref_a + 5)
+        || !TEST_true(ossl_quic_sstream_mark_transmitted(sstream, 15, 20)))
+        goto err;
+
+    /* Copied data at the start of the stream is culled as usual. */
+    if (!TEST_true(ossl_quic_sstream_mark_acked(sstream, 0, 4))
+        || !TEST_size_t_eq(ossl_quic_sstream_get_buffer_used(sstream), 10))
+        goto err;
+
+    /* Nothing is released until the acknowledged prefix covers it. */
+    if (!TEST_true(ossl_quic_sstream_mark_acked(sstream, 12, 41))
+        || !TEST_size_t_eq(info.num_calls, 0))
+        goto err;
+
+    if (!TEST_true(ossl_quic_sstream_mark_acked(sstream, 5, 11))
+        || !TEST_size_t_eq(info.num_calls, 2)
+        || !TEST_size_t_eq(info.num_bytes, sizeof(ref_a) + sizeof(ref_b))
+        || !TEST_size_t_eq(ossl_quic_sstream_get_buffer_used(sstream), 0)
+        || !TEST_true(ossl_quic_sstream_is_totally_acked(sstream)))
+        goto err;
+
+    /* Copied data can follow once everything has been released. */
+    num_iov = OSSL_NELEM(iov);
+    if (!TEST_true(ossl_quic_sstream_append(sstream, data_1 + 13, 3,
+                                            &consumed))
+        || !TEST_size_t_eq(consumed, 3)
+        || !TEST_true(ossl_quic_sstream_get_stream_frame(sstream, 0, &hdr, iov,
+                                                         &num_iov))
+        || !TEST_uint64_t_eq(hdr.offset, 42)
+        || !TEST_uint64_t_eq(hdr.len, 3)
+        || !TEST_size_t_eq(num_iov, 1)
+        || !TEST_mem_eq(iov[0].buf, iov[0].buf_len, expect + 42, 3))
+        goto err;
+
+    /* Unacknowledged buffers are released when the stream is freed. */
+    if (!TEST_true(ossl_quic_sstream_append_ref(sstream, ref_c, sizeof(ref_c),
+                                                ref_release, &info)))
+        goto err;
+
+    ossl_quic_sstream_free(sstream);
+    sstream = NULL;
+    if (!TEST_size_t_eq(info.num_calls, 3))
+        goto err;
+
+    testresult = 1;
+ err:
+    ossl_quic_sstream_free(sstream);
+    return testresult;
+}
+
 static int test_sstream_bulk(int idx)
 {
     int testresult = 0;
@@ -472,6 +619,90 @@ static int test_rstream_simple(int idx)
     return ret;
 }
 
+/*
+ * Tests that ossl_quic_rstream_read_ref() returns the queued frame data in
+ * order without copying it.
+ */
+static int test_rstream_ref(void)
+{
+    QUIC_RSTREAM *rstream = NULL;
+    int ret = 0, fin = 1;
+    const unsigned char *data = NULL, *record;
+    size_t data_len = 1, readbytes, rec_len;
+    unsigned char buf[3];
+    OSSL_QRX_PKT *pkt = NULL;
+    const size_t total = sizeof(simple_data) - 1;
+
+    if (!TEST_ptr(rstream = ossl_quic_rstream_new(NULL, NULL, 0)))
+        goto err;
+
+    /* Nothing contiguous from offset 0 yet */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 5,
+                                                simple_data + 5, 10, 0))
+        || !TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                 &pkt, &fin))
+        || !TEST_ptr_null(data)
+        || !TEST_size_t_eq(data_len, 0)
+        || !TEST_false(fin))
+        goto err;
+
+    /* Each frame is returned as a reference to the queued data */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 0,
+                                                simple_data, 5, 0))
+        || !TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                 &pkt, &fin))
+        || !TEST_ptr_eq(data, simple_data)
+        || !TEST_size_t_eq(data_len, 5)
+        || !TEST_ptr_null(pkt)
+        || !TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                 &pkt, &fin))
+        || !TEST_ptr_eq(data, simple_data + 5)
+        || !TEST_size_t_eq(data_len, 10)
+        || !TEST_false(fin))
+        goto err;
+
+    /* A partially read frame is returned from the read offset */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 15,
+                                                simple_data + 15, 10, 0))
+        || !TEST_true(ossl_quic_rstream_read(rstream, buf, sizeof(buf),
+                                             &readbytes, &fin))
+        || !TEST_mem_eq(buf, readbytes, simple_data + 15, sizeof(buf))
+        || !TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                 &pkt, &fin))
+        || !TEST_ptr_eq(data, simple_data + 18)
+        || !TEST_size_t_eq(data_len, 7))
+        goto err;
+
+    /* Not possible while the head is locked by get_record */
+    if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, 25,
+                                                simple_data + 25,
+                                                total - 25, 1))
+        || !TEST_true(ossl_quic_rstream_get_record(rstream, &record, &rec_len,
+                                                   &fin))
+        || !TEST_size_t_eq(rec_len, total - 25)
+        || !TEST_false(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                  &pkt, &fin))
+        || !TEST_true(ossl_quic_rstream_release_record(rstream, 0)))
+        goto err;
+
+    /* The last frame carries the fin */
+    if (!TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                              &pkt, &fin))
+        || !TEST_ptr_eq(data, simple_data + 25)
+        || !TEST_size_t_eq(data_len, total - 25)
+        || !TEST_true(fin)
+        || !TEST_true(ossl_quic_rstream_read_ref(rstream, &data, &data_len,
+                                                 &pkt, &fin))
+        || !TEST_size_t_eq(data_len, 0)
+        || !TEST_true(fin))
+        goto err;
+
+    ret = 1;
+ err:
+    ossl_quic_rstream_free(rstream);
+    return ret;
+}
+
 static int test_rstream_random(int idx)
 {
     unsigned char *bulk_data = NULL;
@@ -595,11 +826,228 @@ static int test_rstream_random(int idx)
     return ret;
 }
 
+/*
+ * Receive every other frame of a stream in descending order, then the rest in
+ * descending order, so that each insertion lands in the middle of a long list
+ * of frames with gaps between them.
+ */
+static int test_rstream_reorder(void)
+{
+    unsigned char *bulk_data = NULL;
+    unsigned char *read_buf = NULL;
+    QUIC_RSTREAM *rstream = NULL;
+    const size_t frame_size = 8, num_frames = 4096;
+    const size_t data_size = frame_size * num_frames;
+    size_t i, j, off, readbytes = 0;
+    int fin = 0, ret = 0;
+
+    if (!TEST_ptr(bulk_data = OPENSSL_malloc(data_size))
+        || !TEST_ptr(read_buf = OPENSSL_malloc(data_size))
+        || !TEST_ptr(rstream = ossl_quic_rstream_new(NULL, NULL, 0)))
+        goto err;
+
+    for (i = 0; i < data_size; ++i)
+        bulk_data[i] = (unsigned char)(test_random() & 0xFF);
+
+    for (j = 0; j < 2; ++j)
+        for (i = num_frames - 1 - j; i < num_frames; i -= 2) {
+            off = i * frame_size;
+            if (!TEST_true(ossl_quic_rstream_queue_data(rstream, NULL, off,
+                                                        bulk_data + off,
+                                                        frame_size,
+                                                        i == num_frames - 1)))
+                goto err;
+
+            /* Nothing is readable until the first frame arrives. */
+            if (i == 0)
+                break;
+            if (!TEST_true(ossl_quic_rstream_available(rstream, &readbytes,
+                                                       &fin))
+                || !TEST_size_t_eq(readbytes, 0))
+                goto err;
+        }
+
+    if (!TEST_true(ossl_quic_rstream_read(rstream, read_buf, data_size,
+                                          &readbytes, &fin))
+        || !TEST_true(fin)
+        || !TEST_mem_eq(read_buf, readbytes, bulk_data, data_size))
+        goto err;
+
+    ret = 1;
+
+ err:
+    ossl_quic_rstream_free(rstream);
+    OPENSSL_free(bulk_data);
+    OPENSSL_free(read_buf);
+    return ret;
+}
+
+/* Checks a UINT_SET against a bitmap of the integers [0, 256). */
+static int check_uint_set(const UINT_SET *set, const unsigned char *bits)
+{
+    UINT_SET_ITEM *x, *prev = NULL;
+    uint64_t v;
+
+    for (v = 0; v < 256; ++v)
+        if (!TEST_int_eq(ossl_uint_set_query(set, v), bits[v]))
+            return 0;
+
+    for (x = ossl_list_uint_set_head(&set->ranges); x != NULL;
+         prev = x, x = ossl_list_uint_set_next(x)) {
+        if (!TEST_uint64_t_le(x->range.start, x->range.end)
+            || (prev != NULL
+                && !TEST_uint64_t_gt(x->range.start, prev->range.end + 1)))
+            return 0;
+
+        for (v = x->range.start; v <= x->range.end; ++v)
+            if (!TEST_true(v < 256 && bits[v]))
+                return 0;
+    }
+
+    return 1;
+}
+
+static int test_uint_set_random(int idx)
+{
+    UINT_SET set;
+    UINT_RANGE r;
+    unsigned char bits[256] = {0};
+    uint64_t v;
+    int i, insert, ret = 0;
+
+    ossl_uint_set_init(&set);
+
+    for (i = 0; i < 2000; ++i) {
+        r.start = test_random() % 256;
+        r.end   = r.start + test_random() % (idx % 2 == 0 ? 4 : 32);
+        if (r.end > 255)
+            r.end = 255;
+
+        /* Mostly insert so that the set does not stay empty. */
+        insert = test_random() % 3 != 0;
+        if (insert) {
+            if (!TEST_true(ossl_uint_set_insert(&set, &r)))
+                goto err;
+        } else if (!TEST_true(ossl_uint_set_remove(&set, &r))) {
+            goto err;
+        }
+
+        for (v = r.start; v <= r.end; ++v)
+            bits[v] = (unsigned char)insert;
+
+        if (!check_uint_set(&set, bits))
+            goto err;
+    }
+
+    ret = 1;
+ err:
+    ossl_uint_set_destroy(&set);
+    return ret;
+}
+
+/*
+ * Returns 1 if iterating over the active streams yields the streams with the
+ * given IDs, in order.
+ */
+static int check_stream_iter(QUIC_STREAM_MAP *qsm, int advance_rr,
+                             const uint64_t *ids, size_t num_ids)
+{
+    QUIC_STREAM_ITER it;
+    size_t i = 0;
+
+    for (ossl_quic_stream_iter_init(&it, qsm, advance_rr);
+         it.stream != NULL; ossl_quic_stream_iter_next(&it), ++i)
+        if (!TEST_size_t_lt(i, num_ids)
+            || !TEST_uint64_t_eq(it.stream->id, ids[i]))
+            return 0;
+
+    return TEST_size_t_eq(i, num_ids);
+}
+
+static int test_stream_priority(void)
+{
+    static const uint64_t order_default[] = { 2, 6, 10, 14, 18 };
+    static const uint64_t order_prio[]    = { 18, 6, 14, 2, 10 };
+    static const uint64_t order_prio_rr[] = { 18, 6, 14, 10, 2 };
+    static const uint64_t order_moved[]   = { 6, 14, 18, 10, 2 };
+    static const uint64_t order_final[]   = { 6, 18, 10 };
+    QUIC_STREAM_MAP qsm;
+    QUIC_STREAM *qs[5];
+    size_t i;
+    int ret = 0;
+
+    /*
+     * Use streams initiated by the peer which have no send part, so that
+     * whether a stream is active is determined by want_stop_sending alone.
+     */
+    if (!TEST_true(ossl_quic_stream_map_init(&qsm, NULL, NULL, NULL, NULL, 1)))
+        return 0;
+
+    for (i = 0; i < OSSL_NELEM(qs); ++i) {
+        if (!TEST_ptr(qs[i] = ossl_quic_stream_map_alloc(&qsm, i * 4 + 2,
+                                                         QUIC_STREAM_INITIATOR_CLIENT
+                                                         | QUIC_STREAM_DIR_UNI)))
+            goto err;
+
+        /* Make the stream active. */
+        qs[i]->want_stop_sending = 1;
+        ossl_quic_stream_map_update_state(&qsm, qs[i]);
+    }
+
+    /* By default, all streams are served round-robin. */
+    if (!check_stream_iter(&qsm, 0, order_default, OSSL_NELEM(order_default)))
+        goto err;
+
+    /*
+     * Stream 18 is most urgent. Streams 14 and 6 are the next most urgent,
+     * are not incremental and so are served in stream ID order regardless of
+     * the order in which they were prioritised. Streams 2 and 10 keep the
+     * default priority.
+     */
+    if (!TEST_false(ossl_quic_stream_map_set_priority(&qsm, qs[4],
+                                                      QUIC_STREAM_URGENCY_NUM, 0))
+        || !TEST_true(ossl_quic_stream_map_set_priority(&qsm, qs[4], 0, 1))
+        || !TEST_true(ossl_quic_stream_map_set_priority(&qsm, qs[3], 1, 0))
+        || !TEST_true(ossl_quic_stream_map_set_priority(&qsm, qs[1], 1, 0)))
+        goto err;
+
+    if (!check_stream_iter(&qsm, 0, order_prio, OSSL_NELEM(order_prio)))
+        goto err;
+
+    /* Only incremental streams are rotated. */
+    if (!check_stream_iter(&qsm, 1, order_prio, OSSL_NELEM(order_prio))
+        || !check_stream_iter(&qsm, 0, order_prio_rr, OSSL_NELEM(order_prio_rr)))
+        goto err;
+
+    /* Priorities can be changed while a stream is active. */
+    if (!TEST_true(ossl_quic_stream_map_set_priority(&qsm, qs[4], 2, 1))
+        || !check_stream_iter(&qsm, 0, order_moved, OSSL_NELEM(order_moved)))
+        goto err;
+
+    /* Inactive streams are not visited. */
+    qs[3]->want_stop_sending = 0;
+    ossl_quic_stream_map_update_state(&qsm, qs[3]);
+    qs[0]->want_stop_sending = 0;
+    ossl_quic_stream_map_update_state(&qsm, qs[0]);
+    if (!check_stream_iter(&qsm, 0, order_final, OSSL_NELEM(order_final)))
+        goto err;
+
+    ret = 1;
+ err:
+    ossl_quic_stream_map_cleanup(&qsm);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_sstream_simple);
+    ADD_TEST(test_sstream_ref);
     ADD_ALL_TESTS(test_sstream_bulk, 100);
     ADD_ALL_TESTS(test_rstream_simple, 4);
+    ADD_TEST(test_rstream_ref);
     ADD_ALL_TESTS(test_rstream_random, 100);
+    ADD_TEST(test_rstream_reorder);
+    ADD_ALL_TESTS(test_uint_set_random, 10);
+    ADD_TEST(test_stream_priority);
     return 1;
 }
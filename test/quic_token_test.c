@@ -0,0 +1,146 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include "internal/quic_token.h"
+#include "internal/sockets.h"
+#include "testutil.h"
+
+static int make_addr(BIO_ADDR *addr, uint32_t ip, uint16_t port)
+{
+    uint32_t ina = htonl(ip);
+
+    return BIO_ADDR_rawmake(addr, AF_INET, &ina, sizeof(ina), htons(port));
+}
+
+static int test_token_validate(void)
+{
+    int testresult = 0;
+    QUIC_TOKEN_KEY *key = NULL, *key2 = NULL;
+    BIO_ADDR *addr = NULL, *addr_port = NULL, *addr_other = NULL;
+    unsigned char token[QUIC_TOKEN_LEN], bad[QUIC_TOKEN_LEN];
+    OSSL_TIME now = ossl_seconds2time(1000000);
+
+    if (!TEST_ptr(key = ossl_quic_token_key_new(NULL, NULL))
+        || !TEST_ptr(key2 = ossl_quic_token_key_new(NULL, NULL))
+        || !TEST_ptr(addr = BIO_ADDR_new())
+        || !TEST_ptr(addr_port = BIO_ADDR_new())
+        || !TEST_ptr(addr_other = BIO_ADDR_new())
+        || !TEST_true(make_addr(addr, 0x7f000001, 4433))
+        || !TEST_true(make_addr(addr_port, 0x7f000001, 4434))
+        || !TEST_true(make_addr(addr_other, 0x7f000002, 4433)))
+        goto err;
+
+    if (!TEST_true(ossl_quic_token_generate(key, addr, now, token)))
+        goto err;
+
+    /* Valid for the same address on any port */
+    if (!TEST_true(ossl_quic_token_validate(key, addr, now, token,
+                                            sizeof(token)))
+        || !TEST_true(ossl_quic_token_validate(key, addr_port, now, token,
+                                               sizeof(token))))
+        goto err;
+
+    /* Not valid for another address, another key or when truncated */
+    if (!TEST_false(ossl_quic_token_validate(key, addr_other, now, token,
+                                             sizeof(token)))
+        || !TEST_false(ossl_quic_token_validate(key2, addr, now, token,
+                                                sizeof(token)))
+        || !TEST_false(ossl_quic_token_validate(key, addr, now, token,
+                                                sizeof(token) - 1)))
+        goto err;
+
+    /* Not valid when modified */
+    memcpy(bad, token, sizeof(bad));
+    bad[sizeof(bad) / 2] ^= 1;
+    if (!TEST_false(ossl_quic_token_validate(key, addr, now, bad, sizeof(bad))))
+        goto err;
+
+    /* Only valid within the token lifetime */
+    if (!TEST_true(ossl_quic_token_validate(key, addr,
+                                            ossl_time_add(now,
+                                                          QUIC_TOKEN_LIFETIME),
+                                            token, sizeof(token)))
+        || !TEST_false(ossl_quic_token_validate(key, addr,
+                                                ossl_time_add(now,
+                                                              ossl_time_add(QUIC_TOKEN_LIFETIME,
+                                                                            ossl_ms2time(1))),
+                                                token, sizeof(token)))
+        || !TEST_false(ossl_quic_token_validate(key, addr,
+                                                ossl_time_subtract(now,
+                                                                   ossl_seconds2time(3600)),
+                                                token, sizeof(token))))
+        goto err;
+
+    testresult = 1;
+err:
+    BIO_ADDR_free(addr);
+    BIO_ADDR_free(addr_port);
+    BIO_ADDR_free(addr_other);
+    ossl_quic_token_key_free(key);
+    ossl_quic_token_key_free(key2);
+    return testresult;
+}
+
+static int test_token_store(void)
+{
+    int testresult = 0, i;
+    QUIC_TOKEN_STORE *store;
+    unsigned char *token = NULL;
+    size_t token_len = 0;
+    char id[16];
+
+    if (!TEST_ptr(store = ossl_quic_token_store_new()))
+        goto err;
+
+    if (!TEST_false(ossl_quic_token_store_take(store, "a", &token, &token_len))
+        || !TEST_true(ossl_quic_token_store_add(store, "a",
+                                                (const unsigned char *)"123", 3))
+        || !TEST_true(ossl_quic_token_store_add(store, "a",
+                                                (const unsigned char *)"4567", 4))
+        || !TEST_true(ossl_quic_token_store_add(store, "b",
+                                                (const unsigned char *)"89", 2)))
+        goto err;
+
+    /* Only the latest token is kept, and it can only be taken once */
+    if (!TEST_true(ossl_quic_token_store_take(store, "a", &token, &token_len))
+        || !TEST_mem_eq(token, token_len, "4567", 4)
+        || !TEST_false(ossl_quic_token_store_take(store, "a", &token,
+                                                  &token_len)))
+        goto err;
+    OPENSSL_free(token);
+    token = NULL;
+
+    /* The least recently updated server is forgotten first */
+    for (i = 0; i < QUIC_TOKEN_STORE_MAX_SERVERS; ++i) {
+        BIO_snprintf(id, sizeof(id), "s%d", i);
+        if (!TEST_true(ossl_quic_token_store_add(store, id,
+                                                 (const unsigned char *)"x",
+                                                 1)))
+            goto err;
+    }
+
+    if (!TEST_false(ossl_quic_token_store_take(store, "b", &token, &token_len))
+        || !TEST_true(ossl_quic_token_store_take(store, "s0", &token,
+                                                 &token_len)))
+        goto err;
+
+    testresult = 1;
+err:
+    OPENSSL_free(token);
+    ossl_quic_token_store_free(store);
+    return testresult;
+}
+
+int setup_tests(void)
+{
+    ADD_TEST(test_token_validate);
+    ADD_TEST(test_token_store);
+    return 1;
+}
@@ -1187,6 +1187,66 @@ static const unsigned char encode_case_23_expect[] = {
     0x80, 0x00, 0x45, 0x45,
 };
 
+/* 24. ACK_FREQUENCY */
+static const OSSL_QUIC_FRAME_ACK_FREQUENCY encode_case_24_f = {
+    0x1234, 9, 25000, 1
+};
+
+static int encode_case_24_enc(WPACKET *pkt)
+{
+    if (!TEST_int_eq(ossl_quic_wire_encode_frame_ack_frequency(pkt,
+                                                               &encode_case_24_f), 1))
+        return 0;
+
+    return 1;
+}
+
+static int encode_case_24_dec(PACKET *pkt, ossl_ssize_t fail)
+{
+    OSSL_QUIC_FRAME_ACK_FREQUENCY f = {0};
+
+    if (!TEST_int_eq(ossl_quic_wire_decode_frame_ack_frequency(pkt, &f),
+                     fail < 0))
+        return 0;
+
+    if (fail >= 0)
+        return 1;
+
+    if (!TEST_mem_eq(&f, sizeof(f), &encode_case_24_f, sizeof(encode_case_24_f)))
+        return 0;
+
+    return 1;
+}
+
+static const unsigned char encode_case_24_expect[] = {
+    0x40, 0xAF,                 /* Type */
+    0x52, 0x34,                 /* Sequence Number */
+    0x09,                       /* Ack-Eliciting Threshold */
+    0x80, 0x00, 0x61, 0xA8,     /* Request Max Ack Delay */
+    0x01,                       /* Reordering Threshold */
+};
+
+/* 25. IMMEDIATE_ACK */
+static int encode_case_25_enc(WPACKET *pkt)
+{
+    if (!TEST_int_eq(ossl_quic_wire_encode_frame_immediate_ack(pkt), 1))
+        return 0;
+
+    return 1;
+}
+
+static int encode_case_25_dec(PACKET *pkt, ossl_ssize_t fail)
+{
+    if (!TEST_int_eq(ossl_quic_wire_decode_frame_immediate_ack(pkt), fail < 0))
+        return 0;
+
+    return 1;
+}
+
+static const unsigned char encode_case_25_expect[] = {
+    0x1F
+};
+
 #define ENCODE_CASE(n)                          \
     {                                           \
       encode_case_##n##_enc,                    \
@@ -1220,6 +1280,8 @@ static const struct encode_test_case encode_cases[] = {
     ENCODE_CASE(21)
     ENCODE_CASE(22)
     ENCODE_CASE(23)
+    ENCODE_CASE(24)
+    ENCODE_CASE(25)
 };
 
 static int test_wire_encode(int idx)
@@ -20,6 +20,8 @@
 #include "testutil/output.h"
 #include "../ssl/ssl_local.h"
 #include "internal/quic_error.h"
+#include "internal/quic_channel.h"
+#include "internal/bio.h"
 
 static OSSL_LIB_CTX *libctx = NULL;
 static OSSL_PROVIDER *defctxnull = NULL;
@@ -1030,6 +1032,462 @@ static int test_back_pressure(void)
 }
 
 
+static void write_buffer_release(const void *buf, size_t buf_len, void *arg)
+{
+    size_t *released = arg;
+
+    *released += buf_len;
+}
+
+/*
+ * Test that SSL_write_buffer() sends a buffer larger than the stream's send
+ * buffer and flow control window without copying it, and releases it once the
+ * peer has acknowledged all of it.
+ */
+static int test_write_buffer(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0, i;
+    unsigned char *msg = NULL, *rcv = NULL;
+    const size_t msglen = 2 * 1024 * 1024;
+    size_t total = 0, readbytes, released = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey, 0, &qtserv,
+                                                    &clientquic, NULL, NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    if (!TEST_ptr(msg = OPENSSL_malloc(msglen))
+            || !TEST_ptr(rcv = OPENSSL_malloc(msglen))
+            || !TEST_int_eq(RAND_bytes_ex(libctx, msg, msglen, 0), 1))
+        goto err;
+
+    /* Invalid flags are rejected and the buffer is not taken. */
+    if (!TEST_false(SSL_write_buffer(clientquic, msg, msglen, 1U << 31,
+                                     write_buffer_release, &released)))
+        goto err;
+
+    /* The whole buffer is accepted at once, regardless of flow control. */
+    if (!TEST_true(SSL_write_buffer(clientquic, msg, msglen,
+                                    SSL_WRITE_FLAG_CONCLUDE,
+                                    write_buffer_release, &released)))
+        goto err;
+
+    for (i = 0; i < 100000; i++) {
+        ossl_quic_tserver_tick(qtserv);
+        if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, rcv + total,
+                                              msglen - total, &readbytes)))
+            goto err;
+
+        total += readbytes;
+        SSL_handle_events(clientquic);
+
+        if (released > 0 && ossl_quic_tserver_has_read_ended(qtserv, 0))
+            break;
+
+        if (readbytes == 0 && !qtest_wait_for_timeout(clientquic, qtserv))
+            goto err;
+    }
+
+    if (!TEST_size_t_eq(released, msglen)
+            || !TEST_mem_eq(rcv, total, msg, msglen))
+        goto err;
+
+    testresult = 1;
+ err:
+    SSL_free(clientquic);
+    ossl_quic_tserver_free(qtserv);
+    SSL_CTX_free(cctx);
+    OPENSSL_free(msg);
+    OPENSSL_free(rcv);
+
+    return testresult;
+}
+
+
+/*
+ * Test that SSL_read_buffer() returns the stream data in order, that chunks
+ * stay valid until released, and that it can be mixed with SSL_read_ex().
+ */
+static int test_read_buffer(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    int testresult = 0, i, err, concluded = 0, eos = 0;
+    unsigned char *msg = NULL, *rcv = NULL;
+    const unsigned char *held[4] = { NULL }, *chunk;
+    size_t held_len[4] = { 0 }, held_off[4] = { 0 };
+    const size_t msglen = 256 * 1024;
+    size_t sent = 0, total = 0, written, readbytes, j, nheld = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey, 0, &qtserv,
+                                                    &clientquic, NULL, NULL))
+            || !TEST_true(SSL_set_blocking_mode(clientquic, 0))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    if (!TEST_ptr(msg = OPENSSL_malloc(msglen))
+            || !TEST_ptr(rcv = OPENSSL_malloc(msglen))
+            || !TEST_int_eq(RAND_bytes_ex(libctx, msg, msglen, 0), 1))
+        goto err;
+
+    /* Open the stream from the client side */
+    if (!TEST_true(SSL_write_ex(clientquic, "x", 1, &written)))
+        goto err;
+
+    /* Only buffers returned by SSL_read_buffer() can be released */
+    if (!TEST_false(SSL_release_read_buffer(clientquic, msg)))
+        goto err;
+
+    for (i = 0; i < 100000 && !eos; i++) {
+        ossl_quic_tserver_tick(qtserv);
+        if (sent < msglen && ossl_quic_tserver_is_connected(qtserv)) {
+            if (!TEST_true(ossl_quic_tserver_write(qtserv, 0, msg + sent,
+                                                   msglen - sent, &written)))
+                goto err;
+            sent += written;
+        } else if (sent == msglen && !concluded) {
+            if (!TEST_true(ossl_quic_tserver_conclude(qtserv, 0)))
+                goto err;
+            concluded = 1;
+        }
+        ossl_quic_tserver_tick(qtserv);
+
+        /* Hold up to four chunks, then release them in reverse order */
+        for (;;) {
+            if (i % 2 == 0) {
+                if (!SSL_read_buffer(clientquic, &chunk, &readbytes))
+                    break;
+                memcpy(rcv + total, chunk, readbytes);
+                held[nheld] = chunk;
+                held_off[nheld] = total;
+                held_len[nheld++] = readbytes;
+            } else if (!SSL_read_ex(clientquic, rcv + total,
+                                    msglen - total < 1000 ? msglen - total
+                                                          : 1000,
+                                    &readbytes)) {
+                break;
+            }
+            total += readbytes;
+
+            if (nheld == OSSL_NELEM(held)) {
+                while (nheld > 0) {
+                    --nheld;
+                    if (!TEST_true(SSL_release_read_buffer(clientquic,
+                                                           held[nheld])))
+                        goto err;
+                }
+            }
+        }
+
+        err = SSL_get_error(clientquic, 0);
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            eos = 1;
+        } else if (!TEST_int_eq(err, SSL_ERROR_WANT_READ)) {
+            goto err;
+        }
+
+        /* Data which is still held is intact */
+        for (j = 0; j < nheld; j++)
+            if (!TEST_mem_eq(held[j], held_len[j],
+                             msg + held_off[j], held_len[j]))
+                goto err;
+    }
+
+    if (!TEST_true(eos)
+            || !TEST_mem_eq(rcv, total, msg, msglen))
+        goto err;
+
+    /* A chunk cannot be released twice */
+    if (nheld > 0) {
+        if (!TEST_true(SSL_release_read_buffer(clientquic, held[0]))
+                || !TEST_false(SSL_release_read_buffer(clientquic, held[0])))
+            goto err;
+    }
+
+    testresult = 1;
+ err:
+    /* Chunks still held are released when the stream is freed */
+    SSL_free(clientquic);
+    ossl_quic_tserver_free(qtserv);
+    SSL_CTX_free(cctx);
+    OPENSSL_free(msg);
+    OPENSSL_free(rcv);
+
+    return testresult;
+}
+
+/*
+ * Test QUIC 0-RTT. The first connection establishes a session. The second
+ * resumes it and sends early data, which the server accepts and can read
+ * before the client has completed the handshake. The third replays the same
+ * ticket, so the server's anti-replay protection rejects the early data and
+ * the client must send it again once the handshake has completed.
+ */
+static int test_quic_early_data(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL_CTX *sctx = SSL_CTX_new_ex(libctx, NULL, TLS_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    SSL_SESSION *sess = NULL;
+    int testresult = 0, i, conn;
+    static const char msg[] = "An early message";
+    unsigned char buf[64];
+    size_t written, readbytes = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_ptr(sctx)
+            || !TEST_true(SSL_CTX_set_max_early_data(sctx, 1024)))
+        goto err;
+
+    for (conn = 0; conn < 3; conn++) {
+        if (!TEST_true(qtest_create_quic_objects(libctx, cctx, sctx, cert,
+                                                 privkey, 0, &qtserv,
+                                                 &clientquic, NULL, NULL))
+                || !TEST_true(SSL_set_blocking_mode(clientquic, 0)))
+            goto err;
+
+        if (conn == 0) {
+            if (!TEST_true(qtest_create_quic_connection(qtserv, clientquic))
+                    || !TEST_true(SSL_write_ex(clientquic, msg, sizeof(msg),
+                                               &written)))
+                goto err;
+        } else {
+            if (!TEST_true(SSL_set_session(clientquic, sess))
+                    || !TEST_true(SSL_set_quic_early_data_enabled(clientquic,
+                                                                  1)))
+                goto err;
+
+            /* We can write before the handshake has completed */
+            if (!TEST_true(SSL_write_ex(clientquic, msg, sizeof(msg),
+                                        &written))
+                    || !TEST_size_t_eq(written, sizeof(msg))
+                    || !TEST_false(SSL_is_init_finished(clientquic)))
+                goto err;
+        }
+
+        /*
+         * If the early data is accepted the server can read it without the
+         * client doing anything further.
+         */
+        for (i = 0, readbytes = 0; i < 10 && readbytes == 0; i++) {
+            ossl_quic_tserver_tick(qtserv);
+            if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, buf, sizeof(buf),
+                                                  &readbytes)))
+                goto err;
+        }
+
+        if (conn == 1) {
+            if (!TEST_mem_eq(buf, readbytes, msg, sizeof(msg))
+                    || !TEST_false(SSL_is_init_finished(clientquic)))
+                goto err;
+        } else if (conn == 2) {
+            if (!TEST_size_t_eq(readbytes, 0))
+                goto err;
+        }
+
+        if (conn > 0
+                && !TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+            goto err;
+
+        /* Rejected early data is sent again after the handshake */
+        for (i = 0; i < 10 && readbytes == 0; i++) {
+            SSL_handle_events(clientquic);
+            ossl_quic_tserver_tick(qtserv);
+            if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, buf, sizeof(buf),
+                                                  &readbytes)))
+                goto err;
+        }
+
+        if (!TEST_mem_eq(buf, readbytes, msg, sizeof(msg)))
+            goto err;
+
+        switch (conn) {
+        case 0:
+            if (!TEST_int_eq(SSL_get_early_data_status(clientquic),
+                             SSL_EARLY_DATA_NOT_SENT))
+                goto err;
+
+            /* Wait for a session ticket which permits 0-RTT */
+            for (i = 0; i < 10 && sess == NULL; i++) {
+                ossl_quic_tserver_tick(qtserv);
+                SSL_handle_events(clientquic);
+                if (SSL_get0_session(clientquic) != NULL
+                        && SSL_SESSION_get_max_early_data(SSL_get0_session(clientquic))
+                           != 0)
+                    sess = SSL_get1_session(clientquic);
+            }
+            if (!TEST_ptr(sess)
+                    || !TEST_uint_eq(SSL_SESSION_get_max_early_data(sess),
+                                     0xffffffff))
+                goto err;
+            break;
+        case 1:
+            if (!TEST_int_eq(SSL_get_early_data_status(clientquic),
+                             SSL_EARLY_DATA_ACCEPTED)
+                    || !TEST_true(SSL_session_reused(clientquic)))
+                goto err;
+            break;
+        case 2:
+            if (!TEST_int_eq(SSL_get_early_data_status(clientquic),
+                             SSL_EARLY_DATA_REJECTED)
+                    || !TEST_false(SSL_session_reused(clientquic)))
+                goto err;
+            break;
+        }
+
+        if (!TEST_true(qtest_shutdown(qtserv, clientquic)))
+            goto err;
+
+        ossl_quic_tserver_free(qtserv);
+        qtserv = NULL;
+        SSL_free(clientquic);
+        clientquic = NULL;
+    }
+
+    testresult = 1;
+ err:
+    SSL_SESSION_free(sess);
+    SSL_free(clientquic);
+    ossl_quic_tserver_free(qtserv);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+
+    return testresult;
+}
+
+/*
+ * Test that SSL_poll() blocks until an item becomes ready or the timeout
+ * expires.
+ * Test 0: A QUIC connection SSL object
+ * Test 1: A TLS SSL object over TCP
+ */
+static int test_ssl_poll_blocking(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    SSL_POLL_ITEM item = {0};
+    struct timeval tv;
+    static const char msg[] = "Hello World";
+    unsigned char buf[32];
+    size_t numbytes, result_count;
+    int cfd = -1, sfd = -1, testresult = 0;
+    OSSL_TIME start;
+
+    if (!qtest_supports_blocking())
+        return TEST_skip("Blocking tests not supported in this build");
+
+    if (idx == 0) {
+        if (!TEST_ptr(cctx = SSL_CTX_new_ex(libctx, NULL,
+                                            OSSL_QUIC_client_method()))
+                || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL,
+                                                        cert, privkey,
+                                                        QTEST_FLAG_BLOCK,
+                                                        &qtserv, &clientssl,
+                                                        NULL, NULL))
+                || !TEST_true(qtest_create_quic_connection(qtserv, clientssl)))
+            goto end;
+    } else {
+        if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                           TLS_client_method(), 0, 0,
+                                           &sctx, &cctx, cert, privkey))
+                /*
+                 * Unread tickets would make the client socket readable.
+                 */
+                || !TEST_true(SSL_CTX_set_num_tickets(sctx, 0))
+                || !TEST_true(create_test_sockets(&cfd, &sfd, SOCK_STREAM,
+                                                  NULL))
+                || !TEST_true(create_ssl_objects2(sctx, cctx, &serverssl,
+                                                  &clientssl, sfd, cfd))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE)))
+            goto end;
+        /* The SSL objects now own the sockets. */
+        cfd = sfd = -1;
+    }
+
+    if (!TEST_true(SSL_write_ex(clientssl, msg, sizeof(msg), &numbytes)))
+        goto end;
+
+    /* Nothing to read yet, so we must time out. */
+    item.desc    = SSL_as_poll_descriptor(clientssl);
+    item.events  = SSL_POLL_EVENT_R;
+    tv.tv_sec    = 0;
+    tv.tv_usec   = 100000;
+    start        = ossl_time_now();
+    if (!TEST_true(SSL_poll(&item, 1, sizeof(item), &tv, 0, &result_count))
+            || !TEST_size_t_eq(result_count, 0)
+            || !TEST_uint64_t_eq(item.revents, 0)
+            || !TEST_uint64_t_ge(ossl_time2ms(ossl_time_subtract(ossl_time_now(),
+                                                                 start)),
+                                 90))
+        goto end;
+
+    /* Echo the message back to the client. */
+    if (idx == 0) {
+        do {
+            if (!TEST_true(wait_until_sock_readable(
+                               BIO_get_fd(ossl_quic_tserver_get0_rbio(qtserv),
+                                          NULL))))
+                goto end;
+
+            ossl_quic_tserver_tick(qtserv);
+            if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, buf, sizeof(buf),
+                                                  &numbytes)))
+                goto end;
+        } while (numbytes == 0);
+
+        if (!TEST_true(ossl_quic_tserver_write(qtserv, 0, buf, numbytes,
+                                               &numbytes)))
+            goto end;
+        ossl_quic_tserver_tick(qtserv);
+    } else {
+        if (!TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &numbytes))
+                || !TEST_true(SSL_write_ex(serverssl, buf, numbytes,
+                                           &numbytes)))
+            goto end;
+    }
+
+    /* Now the item must become readable well before the timeout. */
+    tv.tv_sec   = 10;
+    tv.tv_usec  = 0;
+    start       = ossl_time_now();
+    if (!TEST_true(SSL_poll(&item, 1, sizeof(item), &tv, 0, &result_count))
+            || !TEST_size_t_eq(result_count, 1)
+            || !TEST_uint64_t_eq(item.revents, SSL_POLL_EVENT_R)
+            || !TEST_uint64_t_lt(ossl_time2ms(ossl_time_subtract(ossl_time_now(),
+                                                                 start)),
+                                 5000))
+        goto end;
+
+    if (!TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &numbytes))
+            || !TEST_mem_eq(buf, numbytes, msg, sizeof(msg)))
+        goto end;
+
+    testresult = 1;
+ end:
+    if (cfd != -1)
+        BIO_closesocket(cfd);
+    if (sfd != -1)
+        BIO_closesocket(sfd);
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 static int dgram_ctr = 0;
 
 static void dgram_cb(int write_p, int version, int content_type,
@@ -1420,6 +1878,204 @@ static int test_get_shutdown(void)
     return testresult;
 }
 
+/*
+ * Test selection of the congestion controller.
+ */
+static int test_congestion_control(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    uint64_t v;
+    int testresult = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey,
+                                                    QTEST_FLAG_FAKE_TIME,
+                                                    &qtserv, &clientquic,
+                                                    NULL, NULL)))
+        goto err;
+
+    if (!TEST_true(SSL_get_quic_congestion_control(clientquic, &v))
+            || !TEST_uint64_t_eq(v, SSL_VALUE_QUIC_CC_NEWRENO)
+            || !TEST_false(SSL_set_quic_congestion_control(clientquic, 42))
+            || !TEST_true(SSL_set_quic_congestion_control(clientquic,
+                                                          SSL_VALUE_QUIC_CC_CUBIC))
+            || !TEST_true(SSL_get_quic_congestion_control(clientquic, &v))
+            || !TEST_uint64_t_eq(v, SSL_VALUE_QUIC_CC_CUBIC))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    /* It cannot be changed once the connection has sent packets */
+    if (!TEST_false(SSL_set_quic_congestion_control(clientquic,
+                                                    SSL_VALUE_QUIC_CC_BBR))
+            || !TEST_true(SSL_get_quic_congestion_control(clientquic, &v))
+            || !TEST_uint64_t_eq(v, SSL_VALUE_QUIC_CC_CUBIC))
+        goto err;
+    ERR_clear_error();
+
+    testresult = 1;
+ err:
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test configuration of ECN, and that ECN is validated on a path which supports
+ * it.
+ */
+static int test_ecn(int idx)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    QUIC_CHANNEL *ch;
+    uint64_t v, mode = idx == 0 ? SSL_VALUE_QUIC_ECN_CLASSIC
+                                : SSL_VALUE_QUIC_ECN_SCALABLE;
+    const char *msg = "Hello World";
+    unsigned char buf[32];
+    size_t numbytes;
+    OSSL_TIME deadline;
+    int testresult = 0;
+
+    if (!qtest_supports_blocking())
+        return TEST_skip("Blocking tests not supported in this build");
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey, QTEST_FLAG_BLOCK,
+                                                    &qtserv, &clientquic,
+                                                    NULL, NULL))
+            || !TEST_true(SSL_set_tlsext_host_name(clientquic, "localhost")))
+        goto err;
+
+    if (!TEST_true(SSL_get_quic_ecn(clientquic, &v))
+            || !TEST_uint64_t_eq(v, SSL_VALUE_QUIC_ECN_CLASSIC)
+            || !TEST_false(SSL_set_quic_ecn(clientquic, 42))
+            || !TEST_true(SSL_set_quic_ecn(clientquic, mode))
+            || !TEST_true(SSL_get_quic_ecn(clientquic, &v))
+            || !TEST_uint64_t_eq(v, mode))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(qtest_create_quic_connection(qtserv, clientquic)))
+        goto err;
+
+    /* It cannot be changed once the connection has sent packets */
+    if (!TEST_false(SSL_set_quic_ecn(clientquic, SSL_VALUE_QUIC_ECN_OFF))
+            || !TEST_true(SSL_get_quic_ecn(clientquic, &v))
+            || !TEST_uint64_t_eq(v, mode))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(SSL_write_ex(clientquic, msg, strlen(msg), &numbytes))
+            || !TEST_size_t_eq(numbytes, strlen(msg)))
+        goto err;
+
+    deadline = ossl_time_add(ossl_time_now(), ossl_ms2time(5000));
+    do {
+        ossl_quic_tserver_tick(qtserv);
+        if (!TEST_true(ossl_quic_tserver_read(qtserv, 0, buf, sizeof(buf),
+                                              &numbytes))
+                || !TEST_true(ossl_time_compare(ossl_time_now(), deadline) < 0))
+            goto err;
+    } while (numbytes == 0);
+
+    if (!TEST_mem_eq(buf, numbytes, msg, strlen(msg)))
+        goto err;
+
+    /* Wait for the server to acknowledge the client's packets */
+    ch = ossl_quic_conn_get_channel(clientquic);
+    if (BIO_dgram_set_ecn(SSL_get_wbio(clientquic), 1) > 0) {
+        while (ossl_quic_channel_get_ecn_state(ch) != QUIC_ECN_STATE_CAPABLE) {
+            if (!TEST_uint_ne(ossl_quic_channel_get_ecn_state(ch),
+                              QUIC_ECN_STATE_FAILED)
+                    || !TEST_true(ossl_time_compare(ossl_time_now(),
+                                                    deadline) < 0))
+                goto err;
+
+            ossl_quic_tserver_tick(qtserv);
+            SSL_handle_events(clientquic);
+        }
+    } else {
+        TEST_info("ECN is not supported by the datagram BIO");
+    }
+
+    if (!TEST_true(qtest_shutdown(qtserv, clientquic)))
+        goto err;
+
+    testresult = 1;
+ err:
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test configuration of stream priorities.
+ */
+static int test_stream_priority(void)
+{
+    SSL_CTX *cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method());
+    SSL *clientquic = NULL, *stream = NULL;
+    QUIC_TSERVER *qtserv = NULL;
+    uint64_t v;
+    int testresult = 0;
+
+    if (!TEST_ptr(cctx)
+            || !TEST_true(qtest_create_quic_objects(libctx, cctx, NULL, cert,
+                                                    privkey,
+                                                    QTEST_FLAG_FAKE_TIME,
+                                                    &qtserv, &clientquic,
+                                                    NULL, NULL))
+            || !TEST_true(qtest_create_quic_connection(qtserv, clientquic))
+            || !TEST_ptr(stream = SSL_new_stream(clientquic, 0)))
+        goto err;
+
+    /* Defaults */
+    if (!TEST_true(SSL_get_stream_urgency(stream, &v))
+            || !TEST_uint64_t_eq(v, 3)
+            || !TEST_true(SSL_get_stream_incremental(stream, &v))
+            || !TEST_uint64_t_eq(v, 1))
+        goto err;
+
+    if (!TEST_true(SSL_set_stream_urgency(stream, 0))
+            || !TEST_false(SSL_set_stream_urgency(stream, 8))
+            || !TEST_true(SSL_set_stream_incremental(stream, 0))
+            || !TEST_false(SSL_set_stream_incremental(stream, 2))
+            || !TEST_true(SSL_get_stream_urgency(stream, &v))
+            || !TEST_uint64_t_eq(v, 0)
+            || !TEST_true(SSL_get_stream_incremental(stream, &v))
+            || !TEST_uint64_t_eq(v, 0))
+        goto err;
+    ERR_clear_error();
+
+    /* Priorities can be changed while data is pending. */
+    if (!TEST_true(SSL_write(stream, "apple", 5) == 5)
+            || !TEST_true(SSL_set_stream_urgency(stream, 7))
+            || !TEST_true(SSL_get_stream_urgency(stream, &v))
+            || !TEST_uint64_t_eq(v, 7))
+        goto err;
+
+    testresult = 1;
+ err:
+    SSL_free(stream);
+    ossl_quic_tserver_free(qtserv);
+    SSL_free(clientquic);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 #define MAX_LOOPS   2000
 
 /*
@@ -2256,6 +2912,398 @@ static int test_session_cb(void)
     return testresult;
 }
 
+static int listener_alpn_select_cb(SSL *ssl, const unsigned char **out,
+                                   unsigned char *outlen,
+                                   const unsigned char *in,
+                                   unsigned int inlen, void *arg)
+{
+    static const unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+
+    if (SSL_select_next_proto((unsigned char **)out, outlen, alpn, sizeof(alpn),
+                              in, inlen) != OPENSSL_NPN_NEGOTIATED)
+        return SSL_TLSEXT_ERR_ALERT_FATAL;
+
+    return SSL_TLSEXT_ERR_OK;
+}
+
+/*
+ * Test that a QUIC listener accepts an incoming connection which can then be
+ * used to exchange data with the client.
+ */
+static int test_listener(void)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *listener = NULL, *clientquic = NULL, *serverquic = NULL;
+    BIO *cbio = NULL, *sbio = NULL;
+    BIO_ADDR *peeraddr = NULL;
+    struct in_addr ina = {0};
+    static const unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+    static const char *msg = "A test message";
+    unsigned char buf[32];
+    size_t msglen = strlen(msg), numbytes;
+    uint64_t cc;
+    int i, cret = 0, sret = 0, testresult = 0;
+
+    if (!TEST_ptr(cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method()))
+            || !TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL,
+                                               OSSL_QUIC_server_method()))
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(sctx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(sctx, privkey,
+                                                        SSL_FILETYPE_PEM), 1))
+        goto err;
+    SSL_CTX_set_alpn_select_cb(sctx, listener_alpn_select_cb, NULL);
+
+    /* Server-side connections are only created by listeners */
+    if (!TEST_ptr_null(SSL_new(sctx))
+            || !TEST_ptr_null(SSL_new_listener(cctx, 0))
+            || !TEST_ptr(listener = SSL_new_listener(sctx, 0))
+            || !TEST_true(SSL_is_listener(listener))
+            || !TEST_ptr_eq(SSL_get0_listener(listener), listener))
+        goto err;
+
+    /* A listener cannot be used as a connection */
+    if (!TEST_false(SSL_listen(listener))
+            || !TEST_false(SSL_connect(listener)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(BIO_new_bio_dgram_pair(&cbio, 0, &sbio, 0))
+            || !TEST_true(BIO_dgram_set_caps(cbio, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_true(BIO_dgram_set_caps(sbio, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_ptr(peeraddr = BIO_ADDR_new())
+            || !TEST_true(BIO_ADDR_rawmake(peeraddr, AF_INET, &ina, sizeof(ina),
+                                           htons(0))))
+        goto err;
+
+    SSL_set_bio(listener, sbio, sbio);
+    sbio = NULL;
+    if (!TEST_true(SSL_set_blocking_mode(listener, 0))
+            || !TEST_true(SSL_set_quic_congestion_control(listener,
+                                                          SSL_VALUE_QUIC_CC_BBR))
+            || !TEST_true(SSL_listen(listener))
+            || !TEST_ptr_null(SSL_accept_connection(listener, 0))
+            || !TEST_size_t_eq(SSL_get_accept_connection_queue_len(listener), 0))
+        goto err;
+
+    if (!TEST_ptr(clientquic = SSL_new(cctx))
+            || !TEST_false(SSL_is_listener(clientquic))
+            || !TEST_ptr_null(SSL_get0_listener(clientquic))
+            || !TEST_false(SSL_set_alpn_protos(clientquic, alpn, sizeof(alpn)))
+            || !TEST_true(SSL_set_blocking_mode(clientquic, 0))
+            || !TEST_true(SSL_set1_initial_peer_addr(clientquic, peeraddr)))
+        goto err;
+    SSL_set_bio(clientquic, cbio, cbio);
+    cbio = NULL;
+
+    for (i = 0; i < 1000 && (cret != 1 || sret != 1); i++) {
+        if (cret != 1)
+            cret = SSL_connect(clientquic);
+        if (serverquic == NULL)
+            serverquic = SSL_accept_connection(listener, 0);
+        else if (sret != 1)
+            sret = SSL_do_handshake(serverquic);
+    }
+    if (!TEST_int_eq(cret, 1)
+            || !TEST_int_eq(sret, 1)
+            || !TEST_ptr_eq(SSL_get0_listener(serverquic), listener)
+            || !TEST_false(SSL_is_listener(serverquic))
+            || !TEST_size_t_eq(SSL_get_accept_connection_queue_len(listener), 0))
+        goto err;
+
+    /* Accepted connections use the congestion controller of the listener */
+    if (!TEST_true(SSL_get_quic_congestion_control(serverquic, &cc))
+            || !TEST_uint64_t_eq(cc, SSL_VALUE_QUIC_CC_BBR))
+        goto err;
+
+    /* Client to server */
+    if (!TEST_true(SSL_write_ex(clientquic, msg, msglen, &numbytes))
+            || !TEST_size_t_eq(numbytes, msglen))
+        goto err;
+    for (i = 0; i < 1000; i++) {
+        SSL_handle_events(clientquic);
+        if (SSL_read_ex(serverquic, buf, sizeof(buf), &numbytes))
+            break;
+    }
+    if (!TEST_mem_eq(buf, numbytes, msg, msglen))
+        goto err;
+
+    /* Server to client */
+    if (!TEST_true(SSL_write_ex(serverquic, msg, msglen, &numbytes))
+            || !TEST_size_t_eq(numbytes, msglen))
+        goto err;
+    for (i = 0; i < 1000; i++) {
+        SSL_handle_events(listener);
+        if (SSL_read_ex(clientquic, buf, sizeof(buf), &numbytes))
+            break;
+    }
+    if (!TEST_mem_eq(buf, numbytes, msg, msglen))
+        goto err;
+
+    /* The listener stays alive until the connection is freed */
+    SSL_free(listener);
+    listener = NULL;
+    if (!TEST_true(SSL_handle_events(serverquic)))
+        goto err;
+
+    testresult = 1;
+ err:
+    SSL_free(serverquic);
+    SSL_free(clientquic);
+    SSL_free(listener);
+    BIO_free(cbio);
+    BIO_free(sbio);
+    BIO_ADDR_free(peeraddr);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test that a packet arriving at the wrong listener of a shard group is passed
+ * to the listener which owns the connection.
+ */
+static int test_listener_shard(void)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *listener_a = NULL, *listener_b = NULL, *clientquic = NULL;
+    SSL *serverquic = NULL;
+    BIO *cbio_a = NULL, *sbio_a = NULL, *cbio_b = NULL, *sbio_b = NULL;
+    BIO_ADDR *peeraddr = NULL;
+    struct in_addr ina = {0};
+    static const unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+    static const char *msg = "A test message";
+    unsigned char buf[32];
+    size_t msglen = strlen(msg), numbytes = 0;
+    int i, cret = 0, sret = 0, testresult = 0;
+
+    if (!TEST_ptr(cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method()))
+            || !TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL,
+                                               OSSL_QUIC_server_method()))
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(sctx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(sctx, privkey,
+                                                        SSL_FILETYPE_PEM), 1))
+        goto err;
+    SSL_CTX_set_alpn_select_cb(sctx, listener_alpn_select_cb, NULL);
+
+    if (!TEST_ptr(listener_a = SSL_new_listener(sctx, 0))
+            || !TEST_ptr(listener_b = SSL_new_listener_shard(listener_a, 0))
+            || !TEST_true(SSL_is_listener(listener_b))
+            || !TEST_ptr_null(SSL_new_listener_shard(listener_b, 1)))
+        goto err;
+    ERR_clear_error();
+
+    if (!TEST_true(BIO_new_bio_dgram_pair(&cbio_a, 0, &sbio_a, 0))
+            || !TEST_true(BIO_new_bio_dgram_pair(&cbio_b, 0, &sbio_b, 0))
+            || !TEST_true(BIO_dgram_set_caps(cbio_a, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_true(BIO_dgram_set_caps(sbio_a, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_true(BIO_dgram_set_caps(cbio_b, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_true(BIO_dgram_set_caps(sbio_b, BIO_DGRAM_CAP_HANDLES_DST_ADDR))
+            || !TEST_ptr(peeraddr = BIO_ADDR_new())
+            || !TEST_true(BIO_ADDR_rawmake(peeraddr, AF_INET, &ina, sizeof(ina),
+                                           htons(0))))
+        goto err;
+
+    SSL_set_bio(listener_a, sbio_a, sbio_a);
+    sbio_a = NULL;
+    SSL_set_bio(listener_b, sbio_b, sbio_b);
+    sbio_b = NULL;
+    if (!TEST_true(SSL_set_blocking_mode(listener_a, 0))
+            || !TEST_true(SSL_set_blocking_mode(listener_b, 0))
+            || !TEST_true(SSL_listen(listener_a))
+            || !TEST_true(SSL_listen(listener_b)))
+        goto err;
+
+    if (!TEST_ptr(clientquic = SSL_new(cctx))
+            || !TEST_ptr_null(SSL_new_listener_shard(clientquic, 0))
+            || !TEST_false(SSL_set_alpn_protos(clientquic, alpn, sizeof(alpn)))
+            || !TEST_true(SSL_set_blocking_mode(clientquic, 0))
+            || !TEST_true(SSL_set1_initial_peer_addr(clientquic, peeraddr)))
+        goto err;
+    ERR_clear_error();
+    SSL_set_bio(clientquic, cbio_a, cbio_a);
+    cbio_a = NULL;
+
+    for (i = 0; i < 1000 && (cret != 1 || sret != 1); i++) {
+        if (cret != 1)
+            cret = SSL_connect(clientquic);
+        if (serverquic == NULL)
+            serverquic = SSL_accept_connection(listener_a, 0);
+        else if (sret != 1)
+            sret = SSL_do_handshake(serverquic);
+    }
+    if (!TEST_int_eq(cret, 1)
+            || !TEST_int_eq(sret, 1))
+        goto err;
+
+    /*
+     * From now on the client sends to the socket of listener B, as it would if
+     * its address had changed and the kernel picked another socket for it.
+     */
+    SSL_set0_wbio(clientquic, cbio_b);
+    cbio_b = NULL;
+
+    if (!TEST_true(SSL_write_ex(clientquic, msg, msglen, &numbytes))
+            || !TEST_size_t_eq(numbytes, msglen))
+        goto err;
+    for (i = 0; i < 1000; i++) {
+        SSL_handle_events(clientquic);
+        SSL_handle_events(listener_b);
+        if (SSL_read_ex(serverquic, buf, sizeof(buf), &numbytes))
+            break;
+    }
+    if (!TEST_mem_eq(buf, numbytes, msg, msglen)
+            || !TEST_ptr_null(SSL_accept_connection(listener_b, 0))
+            || !TEST_size_t_eq(SSL_get_accept_connection_queue_len(listener_b),
+                               0))
+        goto err;
+
+    /* The reply still reaches the client through listener A */
+    if (!TEST_true(SSL_write_ex(serverquic, msg, msglen, &numbytes))
+            || !TEST_size_t_eq(numbytes, msglen))
+        goto err;
+    for (i = 0; i < 1000; i++) {
+        SSL_handle_events(listener_a);
+        if (SSL_read_ex(clientquic, buf, sizeof(buf), &numbytes))
+            break;
+    }
+    if (!TEST_mem_eq(buf, numbytes, msg, msglen))
+        goto err;
+
+    testresult = 1;
+ err:
+    SSL_free(serverquic);
+    SSL_free(clientquic);
+    SSL_free(listener_a);
+    SSL_free(listener_b);
+    BIO_free(cbio_a);
+    BIO_free(sbio_a);
+    BIO_free(cbio_b);
+    BIO_free(sbio_b);
+    BIO_ADDR_free(peeraddr);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test that a client presents the address validation token it received in a
+ * NEW_TOKEN frame when it next connects to the same server, which then
+ * considers the client's address validated before the handshake completes.
+ */
+static int test_new_token(void)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *listener = NULL, *clientquic = NULL, *serverquic = NULL;
+    BIO *bio;
+    BIO_ADDR *peeraddr = NULL;
+    static const unsigned char alpn[] = { 8, 'o', 's', 's', 'l', 't', 'e', 's', 't' };
+    OSSL_TIME deadline;
+    int conn, validated = 0, cret, sret, cfd = -1, sfd = -1, testresult = 0;
+
+    if (!qtest_supports_blocking())
+        return TEST_skip("Blocking tests not supported in this build");
+
+    if (!TEST_ptr(cctx = SSL_CTX_new_ex(libctx, NULL, OSSL_QUIC_client_method()))
+            || !TEST_ptr(sctx = SSL_CTX_new_ex(libctx, NULL,
+                                               OSSL_QUIC_server_method()))
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(sctx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(sctx, privkey,
+                                                        SSL_FILETYPE_PEM), 1))
+        goto err;
+    SSL_CTX_set_alpn_select_cb(sctx, listener_alpn_select_cb, NULL);
+
+    /*
+     * Tokens are bound to the client's address, so we need real sockets. Both
+     * connections are made from the same client socket.
+     */
+    if (!TEST_ptr(peeraddr = BIO_ADDR_new())
+            || !TEST_true(create_test_sockets(&cfd, &sfd, SOCK_DGRAM,
+                                              peeraddr))
+            || !TEST_ptr(listener = SSL_new_listener(sctx, 0))
+            || !TEST_ptr(bio = BIO_new_dgram(sfd, BIO_CLOSE)))
+        goto err;
+    sfd = -1;
+    SSL_set_bio(listener, bio, bio);
+
+    if (!TEST_true(SSL_set_blocking_mode(listener, 0))
+            || !TEST_true(SSL_listen(listener)))
+        goto err;
+
+    for (conn = 0; conn < 2; ++conn) {
+        if (!TEST_ptr(clientquic = SSL_new(cctx))
+                || !TEST_false(SSL_set_alpn_protos(clientquic, alpn,
+                                                   sizeof(alpn)))
+                || !TEST_true(SSL_set_tlsext_host_name(clientquic, "localhost"))
+                || !TEST_true(SSL_set_blocking_mode(clientquic, 0))
+                || !TEST_true(SSL_set1_initial_peer_addr(clientquic, peeraddr))
+                || !TEST_ptr(bio = BIO_new_dgram(cfd, BIO_NOCLOSE)))
+            goto err;
+        SSL_set_bio(clientquic, bio, bio);
+
+        cret = sret = 0;
+        deadline = ossl_time_add(ossl_time_now(), ossl_ms2time(5000));
+        while (cret != 1 || sret != 1) {
+            if (!TEST_true(ossl_time_compare(ossl_time_now(), deadline) < 0))
+                goto err;
+
+            if (cret != 1)
+                cret = SSL_connect(clientquic);
+
+            if (serverquic == NULL) {
+                /*
+                 * The client cannot have sent a Handshake packet before we
+                 * accept the connection, so its address can only have been
+                 * validated by a token.
+                 */
+                if ((serverquic = SSL_accept_connection(listener, 0)) != NULL)
+                    validated = ossl_quic_channel_is_addr_validated(
+                                    ossl_quic_conn_get_channel(serverquic));
+            } else if (sret != 1) {
+                sret = SSL_do_handshake(serverquic);
+            }
+        }
+
+        /* Only the second connection has a token from the first */
+        if (!TEST_int_eq(validated, conn == 1))
+            goto err;
+
+        /* The NEW_TOKEN frame is sent with the HANDSHAKE_DONE frame */
+        while (!ossl_quic_channel_is_handshake_confirmed(
+                    ossl_quic_conn_get_channel(clientquic))) {
+            if (!TEST_true(ossl_time_compare(ossl_time_now(), deadline) < 0))
+                goto err;
+
+            SSL_handle_events(serverquic);
+            SSL_handle_events(clientquic);
+        }
+
+        SSL_free(serverquic);
+        serverquic = NULL;
+        SSL_free(clientquic);
+        clientquic = NULL;
+    }
+
+    testresult = 1;
+ err:
+    SSL_free(serverquic);
+    SSL_free(clientquic);
+    SSL_free(listener);
+    if (cfd != -1)
+        BIO_closesocket(cfd);
+    if (sfd != -1)
+        BIO_closesocket(sfd);
+    BIO_ADDR_free(peeraddr);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
 /***********************************************************************************/
 
 OPT_TEST_DECLARE_USAGE("provider config certsdir datadir\n")
@@ -2339,6 +3387,10 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_quic_set_fd, 3);
     ADD_TEST(test_bio_ssl);
     ADD_TEST(test_back_pressure);
+    ADD_TEST(test_write_buffer);
+    ADD_TEST(test_read_buffer);
+    ADD_TEST(test_quic_early_data);
+    ADD_ALL_TESTS(test_ssl_poll_blocking, 2);
     ADD_TEST(test_multiple_dgrams);
     ADD_ALL_TESTS(test_non_io_retry, 2);
     ADD_TEST(test_quic_psk);
@@ -2347,8 +3399,14 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_noisy_dgram, 2);
     ADD_TEST(test_bw_limit);
     ADD_TEST(test_get_shutdown);
+    ADD_TEST(test_congestion_control);
+    ADD_ALL_TESTS(test_ecn, 2);
+    ADD_TEST(test_stream_priority);
     ADD_ALL_TESTS(test_tparam, OSSL_NELEM(tparam_tests));
     ADD_TEST(test_session_cb);
+    ADD_TEST(test_listener);
+    ADD_TEST(test_listener_shard);
+    ADD_TEST(test_new_token);
 
     return 1;
  err:
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Rough timing of calls whose cost is dominated by OSSL_PARAM construction
+ * and name dispatch in the provider, rather than by any cryptography.
+ * This is not run as part of the test suite.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/core_names.h>
+#include <openssl/rsa.h>
+
+static const char *prog;
+static const unsigned char key[32];
+static const unsigned char iv[16];
+
+typedef int (*bench_fn)(void *arg);
+
+static int cipher_get_params(void *arg)
+{
+    EVP_CIPHER_CTX *ctx = arg;
+    size_t ivlen = 0, keylen = 0;
+    unsigned int pad = 0, num = 0;
+    OSSL_PARAM params[5];
+
+    params[0] = OSSL_PARAM_construct_size_t(OSSL_CIPHER_PARAM_IVLEN, &ivlen);
+    params[1] = OSSL_PARAM_construct_size_t(OSSL_CIPHER_PARAM_KEYLEN, &keylen);
+    params[2] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_PADDING, &pad);
+    params[3] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_NUM, &num);
+    params[4] = OSSL_PARAM_construct_end();
+    return EVP_CIPHER_CTX_get_params(ctx, params);
+}
+
+static int cipher_set_params(void *arg)
+{
+    EVP_CIPHER_CTX *ctx = arg;
+    unsigned int pad = 1, num = 0;
+    OSSL_PARAM params[3];
+
+    params[0] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_PADDING, &pad);
+    params[1] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_NUM, &num);
+    params[2] = OSSL_PARAM_construct_end();
+    return EVP_CIPHER_CTX_set_params(ctx, params);
+}
+
+static int cipher_ctrl_set_tag(void *arg)
+{
+    static unsigned char tag[16];
+
+    return EVP_CIPHER_CTX_ctrl(arg, EVP_CTRL_AEAD_SET_TAG, sizeof(tag), tag) > 0;
+}
+
+static int cipher_ctrl_set_ivlen(void *arg)
+{
+    return EVP_CIPHER_CTX_ctrl(arg, EVP_CTRL_AEAD_SET_IVLEN, 12, NULL) > 0;
+}
+
+static int pkey_ctrl_keygen_bits(void *arg)
+{
+    return EVP_PKEY_CTX_set_rsa_keygen_bits(arg, 2048) > 0;
+}
+
+static int pkey_ctrl_str_primes(void *arg)
+{
+    return EVP_PKEY_CTX_ctrl_str(arg, "rsa_keygen_primes", "2") > 0;
+}
+
+static void run(const char *name, bench_fn fn, void *arg, long count)
+{
+    clock_t start, end;
+    double secs;
+    long i;
+
+    if (arg == NULL) {
+        printf("%-24s skipped\n", name);
+        return;
+    }
+    /* Warm up caches and any lazily initialised state */
+    for (i = 0; i < 1000; i++)
+        if (!fn(arg)) {
+            fprintf(stderr, "%s: %s failed\n", prog, name);
+            ERR_print_errors_fp(stderr);
+            exit(EXIT_FAILURE);
+        }
+
+    start = clock();
+    for (i = 0; i < count; i++)
+        fn(arg);
+    end = clock();
+
+    secs = (double)(end - start) / CLOCKS_PER_SEC;
+    printf("%-24s %10ld calls %8.1f ns/call\n", name, count,
+           secs * 1e9 / (double)count);
+}
+
+static EVP_CIPHER_CTX *new_cipher_ctx(const char *name, int enc)
+{
+    EVP_CIPHER *cipher = EVP_CIPHER_fetch(NULL, name, NULL);
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+
+    if (cipher == NULL || ctx == NULL
+        || !EVP_CipherInit_ex2(ctx, cipher, key, iv, enc, NULL)) {
+        EVP_CIPHER_CTX_free(ctx);
+        ctx = NULL;
+    }
+    EVP_CIPHER_free(cipher);
+    return ctx;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [-c count]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    long count = 1000000;
+    EVP_CIPHER_CTX *cbc, *ccm, *chacha;
+    EVP_PKEY_CTX *rsa;
+
+    prog = argv[0];
+    if (argc == 3 && strcmp(argv[1], "-c") == 0) {
+        if ((count = atol(argv[2])) <= 0)
+            usage();
+    } else if (argc != 1) {
+        usage();
+    }
+
+    cbc = new_cipher_ctx("AES-128-CBC", 1);
+    ccm = new_cipher_ctx("AES-128-CCM", 1);
+    chacha = new_cipher_ctx("ChaCha20-Poly1305", 0);
+    rsa = EVP_PKEY_CTX_new_from_name(NULL, "RSA", NULL);
+    if (rsa != NULL && EVP_PKEY_keygen_init(rsa) <= 0) {
+        EVP_PKEY_CTX_free(rsa);
+        rsa = NULL;
+    }
+
+    run("cbc get_params", cipher_get_params, cbc, count);
+    run("cbc set_params", cipher_set_params, cbc, count);
+    run("ccm get_params", cipher_get_params, ccm, count);
+    run("ccm ctrl SET_IVLEN", cipher_ctrl_set_ivlen, ccm, count);
+    run("chacha ctrl SET_TAG", cipher_ctrl_set_tag, chacha, count);
+    run("rsa ctrl keygen_bits", pkey_ctrl_keygen_bits, rsa, count);
+    run("rsa ctrl_str primes", pkey_ctrl_str_primes, rsa, count);
+
+    EVP_CIPHER_CTX_free(cbc);
+    EVP_CIPHER_CTX_free(ccm);
+    EVP_CIPHER_CTX_free(chacha);
+    EVP_PKEY_CTX_free(rsa);
+    return EXIT_SUCCESS;
+}
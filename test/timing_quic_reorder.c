@@ -0,0 +1,160 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Rough timing of the QUIC structures which track out-of-order data: the
+ * stream frame list used to reassemble received stream data, and the integer
+ * set used for ACK ranges and received PN tracking. Each is fed a reordering
+ * pattern which leaves many gaps outstanding and then fills them.
+ * This is not run as part of the test suite.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal/quic_sf_list.h"
+#include "internal/uint_set.h"
+
+static const char *prog;
+
+/*
+ * Orders in which the items 0..n-1 are delivered. All patterns deliver each
+ * item exactly once.
+ */
+enum {
+    PATTERN_GAPS_ASCENDING,     /* evens ascending, then odds ascending */
+    PATTERN_GAPS_DESCENDING,    /* evens ascending, then odds descending */
+    PATTERN_RANDOM,             /* random permutation */
+    PATTERN_NUM
+};
+
+static const char *pattern_names[PATTERN_NUM] = {
+    "gaps-ascending", "gaps-descending", "random"
+};
+
+static void make_order(size_t *order, size_t n, int pattern)
+{
+    size_t i, j, k = 0, tmp;
+
+    switch (pattern) {
+    case PATTERN_GAPS_ASCENDING:
+    case PATTERN_GAPS_DESCENDING:
+        for (i = 0; i < n; i += 2)
+            order[k++] = i;
+        if (pattern == PATTERN_GAPS_ASCENDING)
+            for (i = 1; i < n; i += 2)
+                order[k++] = i;
+        else
+            for (i = n / 2; i > 0; --i)
+                order[k++] = 2 * i - 1;
+        break;
+    default:
+        for (i = 0; i < n; ++i)
+            order[i] = i;
+        for (i = n - 1; i > 0; --i) {
+            j = (size_t)rand() % (i + 1);
+            tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+        break;
+    }
+}
+
+static int run_sframe_list(const size_t *order, size_t n)
+{
+    static const unsigned char data[16];
+    SFRAME_LIST fl;
+    UINT_RANGE r;
+    size_t i;
+    int ok = 1;
+
+    ossl_sframe_list_init(&fl);
+    for (i = 0; i < n && ok; ++i) {
+        r.start = order[i] * sizeof(data);
+        r.end   = r.start + sizeof(data);
+        ok = ossl_sframe_list_insert(&fl, &r, NULL, data, 0);
+    }
+    ossl_sframe_list_destroy(&fl);
+    return ok;
+}
+
+static int run_uint_set(const size_t *order, size_t n)
+{
+    UINT_SET set;
+    UINT_RANGE r;
+    size_t i;
+    int ok = 1;
+
+    ossl_uint_set_init(&set);
+    for (i = 0; i < n && ok; ++i) {
+        r.start = r.end = order[i];
+        ok = ossl_uint_set_insert(&set, &r);
+    }
+    for (i = 0; i < n && ok; ++i)
+        ok = ossl_uint_set_query(&set, order[i]);
+    ossl_uint_set_destroy(&set);
+    return ok;
+}
+
+static void run(const char *name, int (*fn)(const size_t *order, size_t n),
+                const size_t *order, size_t n, int pattern)
+{
+    clock_t start, end;
+    double secs;
+
+    start = clock();
+    if (!fn(order, n)) {
+        fprintf(stderr, "%s: %s failed\n", prog, name);
+        exit(EXIT_FAILURE);
+    }
+    end = clock();
+
+    secs = (double)(end - start) / CLOCKS_PER_SEC;
+    printf("%-12s %-16s %8zu items %10.1f ns/item\n", name,
+           pattern_names[pattern], n, secs * 1e9 / (double)n);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: %s [-n items]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    long n = 100000;
+    size_t *order;
+    int pattern;
+
+    prog = argv[0];
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        if ((n = atol(argv[2])) <= 0)
+            usage();
+    } else if (argc != 1) {
+        usage();
+    }
+
+    if ((order = malloc((size_t)n * sizeof(*order))) == NULL) {
+        fprintf(stderr, "%s: out of memory\n", prog);
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+    for (pattern = 0; pattern < PATTERN_NUM; ++pattern) {
+        make_order(order, (size_t)n, pattern);
+        run("sframe_list", run_sframe_list, order, (size_t)n, pattern);
+        run("uint_set", run_uint_set, order, (size_t)n, pattern);
+    }
+
+    free(order);
+    return EXIT_SUCCESS;
+}
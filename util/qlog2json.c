@@ -0,0 +1,58 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Converts a binary qlog (as written when OSSL_QLOG_FORMAT=binary) to the
+ * equivalent JSON-SEQ qlog. Reads from the named file, or from standard input
+ * if no file is named, and writes to standard output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <openssl/bio.h>
+#include "internal/qlog_bin.h"
+
+int main(int argc, char **argv)
+{
+    BIO *in = NULL, *out = NULL;
+    uint64_t num_dropped = 0;
+    int ok = 0;
+
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [file.bqlog]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (argc == 2)
+        in = BIO_new_file(argv[1], "rb");
+    else
+        in = BIO_new_fp(stdin, BIO_NOCLOSE);
+
+    out = BIO_new_fp(stdout, BIO_NOCLOSE);
+    if (in == NULL || out == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0],
+                argc == 2 ? argv[1] : "standard input");
+        goto err;
+    }
+
+    if (!ossl_qlog_bin_to_json(in, out, &num_dropped)) {
+        fprintf(stderr, "%s: malformed binary qlog\n", argv[0]);
+        goto err;
+    }
+
+    if (num_dropped > 0)
+        fprintf(stderr, "%s: %llu events were dropped by the writer\n",
+                argv[0], (unsigned long long)num_dropped);
+
+    ok = 1;
+err:
+    BIO_free(in);
+    BIO_free(out);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}